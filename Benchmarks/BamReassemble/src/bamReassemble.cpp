@@ -0,0 +1,165 @@
+/*
+ * bamReassemble.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the reassembly of a DM1 storm: BAM messages interleaved from many sources, given to BamReassembler
+ *  as already decoded TP.CM and TP.DT frames, with and without decoding the reassembled DM1. The whole receive path
+ *  from the raw frames of the bus is also measured, decoding every packet in the factory before the reassembler or
+ *  giving the raw packets straight to it.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include <Types.h>
+
+#include <J1939Factory.h>
+#include <Diagnosis/Frames/DM1.h>
+#include <Transport/BAM/BamReassembler.h>
+#include <Transport/BAM/BamFragmenter.h>
+
+
+#define SOURCES				32
+#define ROUNDS				4096
+#define DTCS				10		//Every DM1 is 46 bytes, 7 packets
+
+using namespace J1939;
+
+
+/*
+ * The messages are decoded in the given factory, the reassembly alone is measured if DM1 is not registered
+ */
+static double measure(const std::vector<const J1939Frame*>& packets, J1939Factory& factory) {
+
+	BamReassembler reassembler(&factory, SOURCES);
+	u64 reassembled = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u32 round = 0; round < ROUNDS; ++round) {
+
+		for(auto packet = packets.begin(); packet != packets.end(); ++packet) {
+			reassembler.handleFrame(**packet);
+		}
+
+		while(reassembler.reassembledFramesPending()) {
+			reassembler.dequeueReassembledFrame();
+			++reassembled;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if(reassembled == 0xFFFFFFFF)	printf(" ");		//Keep the messages
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (ROUNDS * packets.size());
+}
+
+struct RawFrame {
+	u32 id;
+	u8 data[J1939_MAX_SIZE];
+	size_t length;
+};
+
+/*
+ * Receive path from the bus, as in j1939Sniffer
+ */
+static double measureRaw(const std::vector<RawFrame>& frames, J1939Factory& factory, bool decodePackets) {
+
+	BamReassembler reassembler(&factory, SOURCES);
+	u64 reassembled = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u32 round = 0; round < ROUNDS; ++round) {
+
+		for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+
+			if(decodePackets) {
+
+				std::unique_ptr<J1939Frame> packet = factory.getJ1939Frame(frame->id, frame->data, frame->length);
+
+				if(packet && reassembler.toBeHandled(*packet)) {
+					reassembler.handleFrame(*packet);
+				}
+
+			} else if(reassembler.toBeHandled(frame->id, frame->data, frame->length)) {
+				reassembler.handleFrame(frame->id, frame->data, frame->length);
+			}
+		}
+
+		while(reassembler.reassembledFramesPending()) {
+			reassembler.dequeueReassembledFrame();
+			++reassembled;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if(reassembled == 0xFFFFFFFF)	printf(" ");		//Keep the messages
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (ROUNDS * frames.size());
+}
+
+int main(int argc, char **argv) {
+
+	std::vector<TPCMFrame> connFrames(SOURCES);
+	std::vector<std::vector<TPDTFrame> > dataFrames(SOURCES);
+
+	for(u32 src = 0; src < SOURCES; ++src) {
+
+		DM1 dm1;
+
+		for(u32 i = 0; i < DTCS; ++i) {
+			dm1.addDTC(DTC(100 + i, 3, 1));
+		}
+
+		dm1.setSrcAddr(src);
+
+		BamFragmenter fragmenter;
+		fragmenter.fragment(dm1);
+
+		connFrames[src] = fragmenter.getConnFrame();
+		dataFrames[src] = fragmenter.getDataFrames();
+	}
+
+	//Packets of all the sources interleaved as in the bus
+	std::vector<const J1939Frame*> packets;
+
+	for(u32 src = 0; src < SOURCES; ++src) {
+		packets.push_back(&connFrames[src]);
+	}
+
+	for(size_t sq = 0; sq < dataFrames[0].size(); ++sq) {
+		for(u32 src = 0; src < SOURCES; ++src) {
+			packets.push_back(&dataFrames[src][sq]);
+		}
+	}
+
+	std::vector<RawFrame> rawFrames(packets.size());
+
+	for(size_t i = 0; i < packets.size(); ++i) {
+		rawFrames[i].length = sizeof(rawFrames[i].data);
+		packets[i]->encode(rawFrames[i].id, rawFrames[i].data, rawFrames[i].length);
+	}
+
+	J1939Factory withoutDM1;
+	withoutDM1.unRegisterFrame(DM1_PGN);
+
+	double decoded = measure(packets, J1939Factory::getInstance());
+	double reassembled = measure(packets, withoutDM1);
+	double decodedPackets = measureRaw(rawFrames, withoutDM1, true);
+	double rawPackets = measureRaw(rawFrames, withoutDM1, false);
+
+	printf("DM1 of %zu packets interleaved from %u sources\n", dataFrames[0].size(), SOURCES);
+	printf("Reassembly:          %8.2f ns/packet\n", reassembled);
+	printf("Reassembly + decode: %8.2f ns/packet\n", decoded);
+	printf("Reassembly from the bus, packets decoded: %8.2f ns/packet\n", decodedPackets);
+	printf("Reassembly from the bus, raw packets:     %8.2f ns/packet\n", rawPackets);
+
+	return 0;
+}
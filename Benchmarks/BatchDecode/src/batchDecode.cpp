@@ -0,0 +1,158 @@
+/*
+ * batchDecode.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the throughput in SPN values per second of decoding a capture frame by frame with J1939Factory
+ *  and in batch with BatchDecoder and each of its kernels.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <Types.h>
+#include <Utils.h>
+
+#include <J1939Factory.h>
+#include <BatchDecoder.h>
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define CAPTURE_SIZE		(1 << 20)
+#define BATCH_SIZE			4096
+
+using namespace J1939;
+
+
+static void registerFrames() {
+
+	{
+		GenericFrame eec1(0xF004);
+		eec1.setName("EEC1");
+		eec1.setLength(8);
+		eec1.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+		eec1.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+		eec1.registerSPN(SPNNumeric(513, "Actual Engine - Percent Torque", 2, 1, -125, 1, "%"));
+		eec1.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+		eec1.registerSPN(SPNNumeric(1483, "Source Address of Controlling Device", 5, 1, 0, 1, ""));
+		eec1.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+		eec1.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+		J1939Factory::getInstance().registerFrame(eec1);
+	}
+
+	{
+		GenericFrame ccvs(0xFEF1);
+		ccvs.setName("CCVS");
+		ccvs.setLength(8);
+		ccvs.registerSPN(SPNStatus(69, "Two Speed Axle Switch", 0, 0, 2));
+		ccvs.registerSPN(SPNStatus(70, "Parking Brake Switch", 0, 2, 2));
+		ccvs.registerSPN(SPNNumeric(84, "Wheel-Based Vehicle Speed", 1, 0.00390625, 0, 2, "km/h"));
+		ccvs.registerSPN(SPNStatus(595, "Cruise Control Active", 3, 0, 2));
+		ccvs.registerSPN(SPNStatus(597, "Brake Switch", 3, 4, 2));
+		ccvs.registerSPN(SPNStatus(598, "Clutch Switch", 3, 6, 2));
+		ccvs.registerSPN(SPNNumeric(86, "Cruise Control Set Speed", 5, 1, 0, 1, "km/h"));
+		J1939Factory::getInstance().registerFrame(ccvs);
+	}
+
+	{
+		GenericFrame et1(0xFEEE);
+		et1.setName("ET1");
+		et1.setLength(8);
+		et1.registerSPN(SPNNumeric(110, "Engine Coolant Temperature", 0, 1, -40, 1, "deg C"));
+		et1.registerSPN(SPNNumeric(174, "Engine Fuel Temperature 1", 1, 1, -40, 1, "deg C"));
+		et1.registerSPN(SPNNumeric(175, "Engine Oil Temperature 1", 2, 0.03125, -273, 2, "deg C"));
+		et1.registerSPN(SPNNumeric(176, "Turbo Oil Temperature", 4, 0.03125, -273, 2, "deg C"));
+		J1939Factory::getInstance().registerFrame(et1);
+	}
+
+}
+
+int main(int argc, char **argv) {
+
+	registerFrames();
+
+	const u32 ids[] = {0x0CF00400, 0x18FEF100, 0x18FEEE00, 0x18FF1200 /*Not registered*/};
+
+	std::vector<RawFrame> capture(CAPTURE_SIZE);
+
+	u32 seed = 1939;
+
+	for(size_t i = 0; i < capture.size(); ++i) {
+
+		capture[i].id = ids[i % (sizeof(ids)/sizeof(ids[0]))];
+		capture[i].length = 8;
+		capture[i].timestamp = i;
+
+		for(int j = 0; j < 8; ++j) {
+			seed = seed * 1103515245 + 12345;
+			capture[i].data[j] = (seed >> 16) & 0xFF;
+		}
+	}
+
+	size_t spnValues = 0;
+	double checksum = 0;
+
+	//Frame by frame with the factory, reading all the SPNs of the decoded frame
+	auto start = std::chrono::steady_clock::now();
+
+	for(auto raw = capture.begin(); raw != capture.end(); ++raw) {
+
+		std::unique_ptr<J1939Frame> frame = J1939Factory::getInstance().getJ1939Frame(raw->id, raw->data, raw->length);
+
+		if(!frame) continue;
+
+		std::map<u32, SPN*> spns = static_cast<GenericFrame*>(frame.get())->getSPNs();
+
+		for(auto spn = spns.begin(); spn != spns.end(); ++spn) {
+			checksum += (spn->second->getType() == SPN::SPN_NUMERIC ? static_cast<SPNNumeric*>(spn->second)->getFormattedValue() :
+					static_cast<SPNStatus*>(spn->second)->getValue());
+			++spnValues;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("J1939Factory::getJ1939Frame:  %8.2f M SPN values/s\n", spnValues / seconds / 1e6);
+
+	const char* names[] = {"auto", "scalar", "SSE2", "AVX2"};
+	EBatchKernel kernels[] = {BATCH_KERNEL_SCALAR, BATCH_KERNEL_SSE2, BATCH_KERNEL_AVX2};
+
+	for(size_t k = 0; k < sizeof(kernels)/sizeof(kernels[0]); ++k) {
+
+		BatchDecoder decoder;
+
+		if(!decoder.setKernel(kernels[k])) {
+			printf("BatchDecoder (%s) not supported\n", names[kernels[k]]);
+			continue;
+		}
+
+		spnValues = 0;
+		start = std::chrono::steady_clock::now();
+
+		for(size_t first = 0; first < capture.size(); first += BATCH_SIZE) {
+
+			decoder.decode(capture.data() + first, J1939_MIN(BATCH_SIZE, capture.size() - first));
+
+			for(auto columns = decoder.getAllColumns().begin(); columns != decoder.getAllColumns().end(); ++columns) {
+				spnValues += columns->second.getRows() * columns->second.getLayout()->getSPNCount();
+				checksum += columns->second.getColumn(0).back();
+			}
+
+			decoder.clear();
+		}
+
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		printf("BatchDecoder (%-6s):        %8.2f M SPN values/s\n", names[kernels[k]], spnValues / seconds / 1e6);
+	}
+
+	printf("Checksum %f\n", checksum);
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * batchReceive.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the reception of the frames queued in a socket with SocketCanReceiver, one recvmsg per frame against
+ *  batches of one recvmmsg. A datagram socket pair stands for the raw CAN socket, no CAN interface is needed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include <chrono>
+
+#include <Backends/Sockets/SocketCanReceiver.h>
+
+
+#define FRAMES				(1 << 20)
+#define QUEUED				256			//Frames written before receiving them, fits in the socket buffer
+
+using namespace Can;
+
+
+static double measure(Sockets::SocketCanReceiver& receiver, int writer, bool batch) {
+
+	canfd_frame frame;
+	memset(&frame, 0, sizeof(frame));
+
+	frame.can_id = 0x18FEF100 | CAN_EFF_FLAG;
+	frame.len = 8;
+
+	CanFrame frames[CAN_RECEIVE_BATCH_SIZE];
+	Utils::TimeStamp timestamps[CAN_RECEIVE_BATCH_SIZE];
+
+	double elapsed = 0;
+
+	for(u32 sent = 0; sent < FRAMES; sent += QUEUED) {
+
+		for(u32 i = 0; i < QUEUED; ++i) {
+			if(write(writer, &frame, sizeof(can_frame)) != sizeof(can_frame)) {
+				perror("write");
+				return 0;
+			}
+		}
+
+		//Only the reception is measured
+		auto start = std::chrono::steady_clock::now();
+
+		for(u32 received = 0; received < QUEUED;) {
+			if(batch) {
+				received += receiver.receive(frames, timestamps, CAN_RECEIVE_BATCH_SIZE);
+			} else {
+				receiver.receive(frames[0], timestamps[0]);
+				++received;
+			}
+		}
+
+		elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	return elapsed / FRAMES;
+}
+
+int main(int argc, char **argv) {
+
+	int socks[2];
+
+	if(socketpair(AF_UNIX, SOCK_DGRAM, 0, socks) != 0) {
+		perror("socketpair");
+		return 1;
+	}
+
+	int bufferSize = 1 << 20;
+
+	setsockopt(socks[0], SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+	setsockopt(socks[1], SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+
+	Sockets::SocketCanReceiver receiver(socks[0], false);
+
+	double single = measure(receiver, socks[1], false);
+	double batch = measure(receiver, socks[1], true);
+
+	printf("%u frames, %u queued at a time\n", FRAMES, QUEUED);
+	printf("recvmsg per frame:          %8.2f ns/frame\n", single);
+	printf("recvmmsg of %3u frames:     %8.2f ns/frame\n", CAN_RECEIVE_BATCH_SIZE, batch);
+
+	close(socks[0]);
+	close(socks[1]);
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * changeDetect.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the detection of the changed SPNs of periodic traffic where most of the frames repeat, with a map of
+ *  the last payloads and GenericFrame::compare as the GUI did, against ChangeDetector.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Types.h>
+
+#include <J1939Factory.h>
+#include <ChangeDetector.h>
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define SOURCES				32
+#define FRAMES				(1 << 20)
+#define CHANGE_PERIOD		8		//One frame out of CHANGE_PERIOD changes the engine speed
+
+using namespace J1939;
+
+
+struct BenchFrame {
+	u32 id;
+	u8 data[8];
+};
+
+static void buildFrame(GenericFrame& frame) {
+
+	frame.setName("EEC1");
+	frame.setLength(8);
+
+	frame.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+	frame.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(513, "Actual Engine - Percent Torque", 2, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	frame.registerSPN(SPNNumeric(1483, "Source Address of Controlling Device", 5, 1, 0, 1, ""));
+	frame.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+	frame.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+}
+
+template<class Detect>
+static double measure(const std::vector<BenchFrame>& frames, Detect detect) {
+
+	u32 changes = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+		changes += detect(*frame);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if(changes == 0xFFFFFFFF)	printf(" ");		//Keep the detections
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / frames.size();
+}
+
+int main(int argc, char **argv) {
+
+	GenericFrame eec1(0xF004);
+	buildFrame(eec1);
+
+	J1939Factory::getInstance().registerFrame(eec1);
+
+	std::vector<BenchFrame> frames(FRAMES);
+
+	for(u32 i = 0; i < FRAMES; ++i) {
+
+		BenchFrame& frame = frames[i];
+		u8 payload[] = {0xF1, 0x7D, 0x82, 0x40, 0x1F, 0x00, 0xF3, 0x7D};
+
+		frame.id = 0x0CF00400 | (i % SOURCES);
+
+		payload[3] = ((i / SOURCES) / CHANGE_PERIOD) & 0xFF;
+
+		memcpy(frame.data, payload, sizeof(payload));
+	}
+
+	std::map<u32, std::string> lastPayloads;
+
+	double compare = measure(frames, [&](const BenchFrame& frame) {
+
+		std::string data(reinterpret_cast<const char*>(frame.data), sizeof(frame.data));
+		std::string& last = lastPayloads[frame.id];
+
+		if(last == data) {
+			return 0;
+		}
+
+		u32 changed = eec1.compare(data, last).size();
+
+		last = data;
+
+		return static_cast<int>(changed);
+	});
+
+	ChangeDetector detector;
+
+	double detect = measure(frames, [&](const BenchFrame& frame) {
+
+		ChangeResult result = detector.update(frame.id, frame.data, sizeof(frame.data));
+
+		return static_cast<int>(__builtin_popcountll(result.changedSPNs));
+	});
+
+	printf("Map + GenericFrame::compare: %8.2f ns/frame\n", compare);
+	printf("ChangeDetector:              %8.2f ns/frame\n", detect);
+
+	J1939Factory::getInstance().unRegisterFrame(0xF004);
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * dataBaseLoad.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the start-up cost of loading a database of the size of the J1939 digital annex from json and from the
+ *  precompiled binary format, and registering the frames in a factory one by one and at once.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+
+#include <Types.h>
+
+#include <GenericFrame.h>
+#include <J1939Factory.h>
+#include <J1939DataBase.h>
+#include <BinaryDataBase.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define FRAMES				2000
+#define SPNS_PER_FRAME		8
+#define JSON_FILE			"/tmp/dataBaseLoad.json"
+#define BINARY_FILE			"/tmp/dataBaseLoad.j1939db"
+
+using namespace J1939;
+
+
+template<class Load>
+static double measure(Load load) {
+
+	auto start = std::chrono::steady_clock::now();
+
+	load();
+
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char **argv) {
+
+	J1939DataBase database;
+
+	u32 spnNumber = 1;
+
+	for(u32 i = 0; i < FRAMES; ++i) {
+
+		GenericFrame frame(0xF000 + i);		//Far from the reserved PGNs
+
+		frame.setName("Frame " + std::to_string(i));
+		frame.setLength(8);
+
+		for(u32 j = 0; j < SPNS_PER_FRAME / 2; ++j) {
+
+			SPNStatusSpec::DescMap descriptions;
+			descriptions[0] = "Off";
+			descriptions[1] = "On";
+			descriptions[2] = "Error";
+			descriptions[3] = "Not available";
+
+			frame.registerSPN(SPNNumeric(spnNumber, "Numeric SPN " + std::to_string(spnNumber), j, 0.125, -125, 1, "rpm"));
+			frame.registerSPN(SPNStatus(spnNumber + 1, "Status SPN " + std::to_string(spnNumber + 1), 4 + j, 0, 2, descriptions));
+
+			spnNumber += 2;
+		}
+
+		database.addFrame(frame);
+	}
+
+	if(!database.writeJsonFile(JSON_FILE) || !database.writeBinaryFile(BINARY_FILE)) {
+		printf("Databases could not be written in /tmp\n");
+		return 1;
+	}
+
+	size_t jsonFrames = 0, binaryFrames = 0, mappedFrames = 0;
+
+	double json = measure([&]() {
+		J1939DataBase ddbb;
+		ddbb.parseJsonFile(JSON_FILE);
+		jsonFrames = ddbb.getParsedFrames().size();
+	});
+
+	double binary = measure([&]() {
+		J1939DataBase ddbb;
+		ddbb.parseBinaryFile(BINARY_FILE);
+		binaryFrames = ddbb.getParsedFrames().size();
+	});
+
+	//Only the frames that are looked up are touched
+	double mapped = measure([&]() {
+		BinaryDataBase ddbb;
+		ddbb.open(BINARY_FILE);
+		for(u32 i = 0; i < FRAMES; i += 100) {
+			mappedFrames += (ddbb.findFrame(0xF000 + i) != nullptr);
+		}
+	});
+
+	const std::vector<GenericFrame>& frames = database.getParsedFrames();
+
+	//Every registration publishes a new registry
+	double oneByOne = measure([&]() {
+		J1939Factory factory;
+		for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+			factory.registerFrame(*frame);
+		}
+	});
+
+	double batch = measure([&]() {
+		J1939Factory factory;
+		factory.registerFrames(frames.begin(), frames.end());
+	});
+
+	printf("Frames: %u, SPNs: %u\n", FRAMES, FRAMES * SPNS_PER_FRAME);
+	printf("parseJsonFile:                %10.2f ms (%zu frames)\n", json, jsonFrames);
+	printf("parseBinaryFile:              %10.2f ms (%zu frames)\n", binary, binaryFrames);
+	printf("BinaryDataBase open + lookup: %10.2f ms (%zu lookups)\n", mapped, mappedFrames);
+	printf("registerFrame one by one:     %10.2f ms\n", oneByOne);
+	printf("registerFrames:               %10.2f ms\n", batch);
+
+	remove(JSON_FILE);
+	remove(BINARY_FILE);
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * etpThroughput.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Transfers a message of 16 MB through ETPConnectionManager over a virtual bus, for several CTS window sizes. The
+ *  originator reads the message from memory while sending it and the responder checks it while receiving it, neither
+ *  keeps a copy. Reports the CPU cost of the transfer and the share of the bus capacity that becomes payload, compared
+ *  with the limit of sending only ETP.DT packets.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <Types.h>
+
+#include <J1939Factory.h>
+#include <Transport/ETP/ETPConnectionManager.h>
+
+
+#define MESSAGE_SIZE		(16 * 1024 * 1024)
+#define ORIGINATOR_ADDR		0x10
+#define RESPONDER_ADDR		0x80
+#define MESSAGE_PGN			0xEF00
+
+//Extended data frame with 8 bytes and the interframe space, without stuffing bits
+#define CAN_FRAME_BITS		131
+#define BUS_BITRATE			250000
+
+using namespace J1939;
+
+
+struct BusFrame {
+	u32 id;
+	u8 data[8];
+};
+
+struct Result {
+	double nsPerMB;
+	u64 frames;
+	bool ok;
+};
+
+static Result transfer(u8 windowSize, const std::vector<u8>& payload) {
+
+	std::deque<BusFrame> bus;
+
+	ETPConfig config;
+	config.windowSize = windowSize;
+
+	ETPConnectionManager originator, responder(config);
+
+	auto send = [&bus](u32 id, const u8* data, size_t length) {
+		BusFrame frame;
+		frame.id = id;
+		memcpy(frame.data, data, length);
+		bus.push_back(frame);
+	};
+
+	originator.setSendCallback(send);
+	responder.setSendCallback(send);
+	originator.addLocalAddress(ORIGINATOR_ADDR);
+	responder.addLocalAddress(RESPONDER_ADDR);
+
+	Result result = {0, 0, true};
+	u32 received = 0;
+
+	responder.setDataCallback([&](u8, u8, u32, u32 offset, const u8* data, size_t length, u32) {
+		result.ok = result.ok && offset == received && memcmp(payload.data() + offset, data, length) == 0;
+		received += length;
+	});
+
+	J1939Factory& factory = J1939Factory::getInstance();
+
+	//Nothing is lost, the timeouts never expire
+	u64 now = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	originator.send(MESSAGE_PGN, 7, ORIGINATOR_ADDR, RESPONDER_ADDR, payload.data(), payload.size(), now);
+
+	while(!bus.empty()) {
+
+		BusFrame frame = bus.front();
+		bus.pop_front();
+
+		++result.frames;
+
+		std::unique_ptr<J1939Frame> decoded = factory.getJ1939Frame(frame.id, frame.data, sizeof(frame.data));
+
+		originator.consumeFrame(*decoded, now);
+		responder.consumeFrame(*decoded, now);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	result.ok = result.ok && received == payload.size() && originator.getStats().messagesSent == 1;
+	result.nsPerMB = std::chrono::duration<double, std::nano>(end - start).count() * 1024 * 1024 / MESSAGE_SIZE;
+
+	return result;
+}
+
+int main(int argc, char **argv) {
+
+	std::vector<u8> payload(MESSAGE_SIZE);
+
+	for(size_t i = 0; i < payload.size(); ++i) {
+		payload[i] = i * 7 + (i >> 12);
+	}
+
+	u8 windows[] = {1, 16, 64, 255};
+
+	double packets = (MESSAGE_SIZE + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE;
+	double busBytesPerSecond = static_cast<double>(BUS_BITRATE) / CAN_FRAME_BITS * TP_DT_PACKET_SIZE;
+
+	printf("Message of %u bytes, bus at %u bit/s\n", MESSAGE_SIZE, BUS_BITRATE);
+	printf("ETP.DT only limit: %.0f bytes/s, %.0f s for the message\n\n", busBytesPerSecond, MESSAGE_SIZE / busBytesPerSecond);
+	printf("window  ms/MB (CPU)  MB/s (CPU)  frames/packet  bus payload bytes/s  of limit\n");
+
+	for(size_t i = 0; i < sizeof(windows); ++i) {
+
+		Result result = transfer(windows[i], payload);
+
+		if(!result.ok) {
+			printf("Transfer with window %u failed\n", windows[i]);
+		}
+
+		double payloadPerSecond = busBytesPerSecond * packets / result.frames;
+
+		printf("%6u  %11.2f  %10.2f  %13.3f  %19.0f  %7.1f%%\n", windows[i], result.nsPerMB / 1000000,
+				1000000000.0 / result.nsPerMB, result.frames / packets, payloadPerSecond, 100.0 * packets / result.frames);
+	}
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * factoryLookup.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the cost of finding the prototype of a frame from the CAN identifier, comparing the std::map
+ *  lookup that J1939Factory used to do with the PGNTable dispatch table. The traffic is dominated by unknown
+ *  identifiers, as it happens in a bus with proprietary frames.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <Types.h>
+
+#include <J1939Factory.h>
+#include <J1939Frame.h>
+#include <PGNTable.h>
+
+
+#define TRAFFIC_SIZE		(1 << 20)
+#define ITERATIONS			10
+#define KNOWN_RATIO			10			//1 of each 10 frames belongs to a registered PGN
+
+using namespace J1939;
+
+
+static u32 pgnToId(u32 pgn, u8 src) {
+	return (6 << J1939_PRIORITY_OFFSET) | (pgn << J1939_PGN_OFFSET) | src;
+}
+
+template<class Lookup>
+static double measure(const std::vector<u32>& traffic, Lookup lookup, size_t& hits) {
+
+	hits = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < ITERATIONS; ++i) {
+		for(auto id = traffic.begin(); id != traffic.end(); ++id) {
+			if(lookup(*id)) ++hits;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (traffic.size() * ITERATIONS);
+}
+
+static void runScenario(size_t registered, std::mt19937& rng) {
+
+	std::set<u32> pgns = J1939Factory::getInstance().getAllRegisteredPGNs();
+
+	std::uniform_int_distribution<u32> pgnDist(0, J1939_PGN_MASK);
+
+	//PGNs in PDU format 1 have no destination address in the PGN
+	while(pgns.size() < registered) {
+		u32 pgn = pgnDist(rng);
+		if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
+			pgn &= ~J1939_PDU_SPECIFIC_MASK;
+		}
+		pgns.insert(pgn);
+	}
+
+	//The pointers are never dereferenced, any non null value is valid
+	std::map<u32, J1939Frame*> map;
+	PGNTable<J1939Frame*> table;
+
+	for(auto pgn = pgns.begin(); pgn != pgns.end(); ++pgn) {
+		J1939Frame* dummy = reinterpret_cast<J1939Frame*>(static_cast<uintptr_t>(*pgn + 1) << 4);
+		map[*pgn] = dummy;
+		table.set(*pgn, dummy);
+	}
+
+	std::vector<u32> known(pgns.begin(), pgns.end());
+	std::vector<u32> traffic;
+	traffic.reserve(TRAFFIC_SIZE);
+
+	std::uniform_int_distribution<u32> knownDist(0, known.size() - 1);
+	std::uniform_int_distribution<u32> ratioDist(0, KNOWN_RATIO - 1);
+	std::uniform_int_distribution<u32> srcDist(0, 0xFD);
+
+	while(traffic.size() < TRAFFIC_SIZE) {
+		u32 pgn;
+		if(ratioDist(rng) == 0) {
+			pgn = known[knownDist(rng)];
+		} else {
+			do {
+				pgn = pgnDist(rng);
+				if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
+					pgn &= ~J1939_PDU_SPECIFIC_MASK;
+				}
+			} while(pgns.find(pgn) != pgns.end());
+		}
+		traffic.push_back(pgnToId(pgn, srcDist(rng)));
+	}
+
+	size_t mapHits, tableHits;
+
+	double mapNs = measure(traffic, [&map](u32 id) {
+		auto iter = map.find(getPGNFromId(id));
+		return iter != map.end() && iter->second != NULL;
+	}, mapHits);
+
+	double tableNs = measure(traffic, [&table](u32 id) {
+		return table.find(getPGNFromId(id)) != NULL;
+	}, tableHits);
+
+	printf("%6zu PGNs registered: std::map %6.2f ns/frame, PGNTable %6.2f ns/frame (x%.1f) hits %zu/%zu\n",
+			pgns.size(), mapNs, tableNs, mapNs / tableNs, mapHits, tableHits);
+
+}
+
+int main(int argc, char **argv) {
+
+	std::mt19937 rng(1939);
+
+	printf("Lookup of %u identifiers, %u%% of them registered\n", TRAFFIC_SIZE, 100 / KNOWN_RATIO);
+
+	runScenario(0, rng);		//Only the predefined frames of the factory (6 PGNs)
+	runScenario(5000, rng);
+
+	//End to end cost of the factory for frames that are not registered
+	{
+		J1939Factory& factory = J1939Factory::getInstance();
+		u8 data[J1939_MAX_SIZE] = {0};
+		size_t misses = 0;
+
+		auto start = std::chrono::steady_clock::now();
+
+		for(u32 i = 0; i < TRAFFIC_SIZE; ++i) {
+			if(!factory.getJ1939Frame(pgnToId(0xFF00 | (i & 0xFF), 0x10), data, sizeof(data))) ++misses;
+		}
+
+		auto end = std::chrono::steady_clock::now();
+
+		printf("J1939Factory::getJ1939Frame for unknown ids: %6.2f ns/frame (%zu misses)\n",
+				std::chrono::duration<double, std::nano>(end - start).count() / TRAFFIC_SIZE, misses);
+	}
+
+	return 0;
+}
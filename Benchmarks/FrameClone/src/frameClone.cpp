@@ -0,0 +1,102 @@
+/*
+ * frameClone.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures cloning, decoding and destroying a GenericFrame with new per SPN and in a single arena block,
+ *  with one and several threads.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <Types.h>
+
+#include <GenericFrame.h>
+#include <FrameArena.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define CLONES				(1 << 18)
+#define THREADS				4
+
+using namespace J1939;
+
+
+static void buildFrame(GenericFrame& frame) {
+
+	//Similar to EEC1 + CCVS, 1 and 2 byte numeric SPNs and status SPNs
+	frame.setName("Benchmark");
+	frame.setLength(8);
+
+	frame.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+	frame.registerSPN(SPNStatus(4154, "Actual Engine Percent Torque High Resolution", 0, 4, 4));
+	frame.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(513, "Actual Engine - Percent Torque", 2, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	frame.registerSPN(SPNNumeric(1483, "Source Address of Controlling Device", 5, 1, 0, 1, ""));
+	frame.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+	frame.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+}
+
+static const u8 payload[] = {0x10, 0x7D, 0x82, 0x40, 0x1F, 0x00, 0x03, 0x7D};
+
+static void cloneWithNew(const GenericFrame* prototype, size_t clones) {
+
+	for(size_t i = 0; i < clones; ++i) {
+		std::unique_ptr<J1939Frame> frame(prototype->clone());
+		frame->decode(0x0CF00400, payload, sizeof(payload));
+	}
+
+}
+
+static void cloneInArena(const GenericFrame* prototype, size_t clones) {
+
+	for(size_t i = 0; i < clones; ++i) {
+		ArenaFrame frame = prototype->cloneInArena();
+		frame->decode(0x0CF00400, payload, sizeof(payload));
+	}
+
+}
+
+static double measure(void (*clone)(const GenericFrame*, size_t), const GenericFrame* prototype, size_t threads) {
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+
+	for(size_t i = 0; i < threads; ++i) {
+		workers.push_back(std::thread(clone, prototype, CLONES / threads));
+	}
+
+	for(auto worker = workers.begin(); worker != workers.end(); ++worker) {
+		worker->join();
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / CLONES;
+}
+
+int main(int argc, char **argv) {
+
+	GenericFrame prototype(0xF004);
+	buildFrame(prototype);
+	prototype.compileLayout();
+
+	printf("Clone + decode + destroy, %u clones\n", CLONES);
+
+	for(size_t threads = 1; threads <= THREADS; threads *= 2) {
+		printf("%zu thread(s): new %8.2f ns/frame, arena %8.2f ns/frame\n", threads,
+				measure(cloneWithNew, &prototype, threads), measure(cloneInArena, &prototype, threads));
+	}
+
+	return 0;
+}
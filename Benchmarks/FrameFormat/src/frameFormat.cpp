@@ -0,0 +1,104 @@
+/*
+ * frameFormat.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the conversion of decoded frames to text, with toString against FrameFormatter writing TSV, CSV
+ *  and NDJSON into a reused buffer.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <Types.h>
+#include <Utils.h>
+
+#include <GenericFrame.h>
+#include <FrameFormatter.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define FRAMES				(1 << 17)
+
+using namespace J1939;
+
+
+static void buildFrame(GenericFrame& frame) {
+
+	SPNStatusSpec::DescMap descriptions;
+
+	descriptions[0] = "Low idle governor/no request (default mode)";
+	descriptions[1] = "Accelerator pedal/operator selection";
+	descriptions[2] = "Cruise control";
+	descriptions[3] = "PTO governor";
+
+	frame.setName("EEC1");
+	frame.setLength(8);
+
+	frame.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4, descriptions));
+	frame.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(513, "Actual Engine - Percent Torque", 2, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	frame.registerSPN(SPNNumeric(1483, "Source Address of Controlling Device", 5, 1, 0, 1, ""));
+	frame.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4, descriptions));
+	frame.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+}
+
+template<class Format>
+static double measure(GenericFrame& frame, Format format) {
+
+	u8 payload[] = {0xF1, 0x7D, 0x82, 0x40, 0x1F, 0x00, 0xF3, 0x7D};
+	size_t bytes = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u32 i = 0; i < FRAMES; ++i) {
+
+		payload[3] = i & 0xFF;
+		frame.decode(0x0CF00400, payload, sizeof(payload));
+
+		bytes += format(Utils::TimeStamp(i / 1000, (i % 1000) * 1000));
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if(bytes == 0)	printf(" ");		//Keep the formatting
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / FRAMES;
+}
+
+int main(int argc, char **argv) {
+
+	GenericFrame frame(0xF004);
+	buildFrame(frame);
+
+	double toString = measure(frame, [&](const Utils::TimeStamp&) {
+		return frame.toString().size();
+	});
+
+	printf("toString:           %8.2f ns/frame\n", toString);
+
+	const char* names[] = {"tsv", "csv", "ndjson"};
+	EFrameFormat formats[] = {FRAME_FORMAT_TSV, FRAME_FORMAT_CSV, FRAME_FORMAT_NDJSON};
+
+	std::vector<char> buffer;
+
+	for(size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); ++i) {
+
+		FrameFormatter formatter(formats[i]);
+
+		double formatted = measure(frame, [&](const Utils::TimeStamp& timestamp) {
+			return formatter.format(frame, timestamp, buffer);
+		});
+
+		printf("FrameFormatter %-6s %6.2f ns/frame\n", names[i], formatted);
+	}
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * genericDecode.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the decoding of a GenericFrame with the SPNs (virtual decode per SPN) and with the compiled FrameLayout.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <Types.h>
+
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define MESSAGES			(1 << 20)
+
+using namespace J1939;
+
+
+static void buildFrame(GenericFrame& frame) {
+
+	//Similar to EEC1 + CCVS, 1 and 2 byte numeric SPNs and status SPNs
+	frame.setName("Benchmark");
+	frame.setLength(8);
+
+	frame.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+	frame.registerSPN(SPNStatus(4154, "Actual Engine Percent Torque High Resolution", 0, 4, 4));
+	frame.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(513, "Actual Engine - Percent Torque", 2, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	frame.registerSPN(SPNNumeric(1483, "Source Address of Controlling Device", 5, 1, 0, 1, ""));
+	frame.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+	frame.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+}
+
+template<class Decode>
+static double measure(const std::vector<u8>& messages, Decode decode) {
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(size_t i = 0; i < MESSAGES; ++i) {
+		decode(&messages[i * 8]);
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / MESSAGES;
+}
+
+int main(int argc, char **argv) {
+
+	GenericFrame spnFrame(0xF004);
+	buildFrame(spnFrame);
+
+	std::unique_ptr<J1939Frame> clone(spnFrame.clone());
+	GenericFrame* compiledFrame = static_cast<GenericFrame*>(clone.get());
+	compiledFrame->compileLayout();
+
+	std::shared_ptr<const FrameLayout> layout = compiledFrame->getLayout();
+
+	std::vector<u8> messages(MESSAGES * 8);
+
+	u32 seed = 1939;
+	for(auto byte = messages.begin(); byte != messages.end(); ++byte) {
+		seed = seed * 1103515245 + 12345;
+		*byte = (seed >> 16) & 0xFF;
+	}
+
+	std::vector<double> values(layout->getSPNCount());
+	double checksum = 0;
+
+	double spnNs = measure(messages, [&](const u8* data) {
+		spnFrame.decode(0x0CF00400, data, 8);
+	});
+
+	double compiledNs = measure(messages, [&](const u8* data) {
+		compiledFrame->decode(0x0CF00400, data, 8);
+	});
+
+	double valuesNs = measure(messages, [&](const u8* data) {
+		layout->decodeValues(data, values.data());
+		for(auto value = values.begin(); value != values.end(); ++value) {
+			checksum += *value;
+		}
+	});
+
+	printf("Decoding %u messages of %zu SPNs\n", MESSAGES, values.size());
+	printf("GenericFrame::decode with SPNs:     %7.2f ns/message\n", spnNs);
+	printf("GenericFrame::decode with layout:   %7.2f ns/message (x%.1f)\n", compiledNs, spnNs / compiledNs);
+	printf("FrameLayout::decodeValues:          %7.2f ns/message (x%.1f)\n", valuesNs, spnNs / valuesNs);
+	printf("Checksum %f\n", checksum);
+
+	return 0;
+}
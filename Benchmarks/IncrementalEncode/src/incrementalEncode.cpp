@@ -0,0 +1,93 @@
+/*
+ * incrementalEncode.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the periodic encoding of a GenericFrame when only one SPN changes between encodes, as in a simulator
+ *  updating the speed of CCVS, against encoding all the SPNs again.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+
+#include <Types.h>
+
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define ENCODES				(1 << 20)
+
+using namespace J1939;
+
+
+static void buildFrame(GenericFrame& frame) {
+
+	//Similar to EEC1 + CCVS, 1 and 2 byte numeric SPNs and status SPNs
+	frame.setName("Benchmark");
+	frame.setLength(8);
+
+	frame.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+	frame.registerSPN(SPNStatus(4154, "Actual Engine Percent Torque High Resolution", 0, 4, 4));
+	frame.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(513, "Actual Engine - Percent Torque", 2, 1, -125, 1, "%"));
+	frame.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	frame.registerSPN(SPNNumeric(1483, "Source Address of Controlling Device", 5, 1, 0, 1, ""));
+	frame.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+	frame.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+}
+
+template<class Update>
+static double measure(GenericFrame& frame, Update update) {
+
+	u8 buffer[8];
+	u32 id, checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u32 i = 0; i < ENCODES; ++i) {
+
+		update(i);
+
+		size_t length = sizeof(buffer);
+		frame.encode(id, buffer, length);
+
+		checksum += buffer[3];
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if(checksum == 0xFFFFFFFF)	printf(" ");		//Keep the encodes
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / ENCODES;
+}
+
+int main(int argc, char **argv) {
+
+	GenericFrame frame(0xF004);
+	buildFrame(frame);
+	frame.compileLayout();
+
+	SPNNumeric* engineSpeed = static_cast<SPNNumeric*>(frame.getSPN(190));
+
+	u8 payload[] = {0x10, 0x7D, 0x82, 0x40, 0x1F, 0x00, 0x03, 0x7D};
+
+	//Decoding replaces all the values, so every SPN is encoded again
+	double full = measure(frame, [&](u32 i) {
+		payload[3] = i & 0xFF;
+		frame.decode(0x0CF00400, payload, sizeof(payload));
+	});
+
+	double incremental = measure(frame, [&](u32 i) {
+		engineSpeed->setValue(i & 0xFFFF);
+	});
+
+	printf("Full encode (after decode):      %8.2f ns/frame\n", full);
+	printf("Incremental encode (one setter): %8.2f ns/frame\n", incremental);
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * rtsctsThroughput.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Transfers messages of 1785 bytes from several originators to one responder through RTSCTSConnectionManager over
+ *  a virtual bus, for several CTS window sizes. Reports the CPU cost of the transfers and the share of the bus
+ *  capacity that becomes payload, compared with the limit of sending only TP.DT packets.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <Types.h>
+
+#include <J1939Factory.h>
+#include <GenericFrame.h>
+#include <Transport/RTSCTS/RTSCTSConnectionManager.h>
+
+
+#define ORIGINATORS			16
+#define MESSAGES			2048
+#define RESPONDER_ADDR		0x80
+#define MESSAGE_PGN			0xEF00
+
+//Extended data frame with 8 bytes and the interframe space, without stuffing bits
+#define CAN_FRAME_BITS		131
+#define BUS_BITRATE			250000
+
+using namespace J1939;
+
+
+struct BusFrame {
+	u32 id;
+	u8 data[8];
+};
+
+struct Result {
+	double nsPerMessage;
+	double framesPerMessage;
+};
+
+static Result transfer(u8 windowSize) {
+
+	std::deque<BusFrame> bus;
+
+	RTSCTSConfig config;
+	config.windowSize = windowSize;
+
+	RTSCTSConnectionManager originators, responder(config);
+
+	auto send = [&bus](u32 id, const u8* data, size_t length) {
+		BusFrame frame;
+		frame.id = id;
+		memcpy(frame.data, data, length);
+		bus.push_back(frame);
+	};
+
+	originators.setSendCallback(send);
+	responder.setSendCallback(send);
+	responder.addLocalAddress(RESPONDER_ADDR);
+
+	for(u8 addr = 0; addr < ORIGINATORS; ++addr) {
+		originators.addLocalAddress(addr);
+	}
+
+	std::vector<u8> payload(RTSCTS_MAX_MSG_SIZE, 0x5A);
+	u32 pending = MESSAGES, received = 0;
+	u64 frames = 0;
+
+	//Nothing is lost, the timeouts never expire
+	u64 now = 0;
+
+	//A new message is sent from an originator as soon as its previous one finishes
+	originators.setFinishedCallback([&](u8 originator, u8, u32, RTSCTSConnectionManager::ETransferResult, u8) {
+		if(pending > 0) {
+			--pending;
+			originators.send(MESSAGE_PGN, 7, originator, RESPONDER_ADDR, payload.data(), payload.size(), now);
+		}
+	});
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u8 addr = 0; addr < ORIGINATORS; ++addr) {
+		--pending;
+		originators.send(MESSAGE_PGN, 7, addr, RESPONDER_ADDR, payload.data(), payload.size(), now);
+	}
+
+	while(!bus.empty()) {
+
+		BusFrame frame = bus.front();
+		bus.pop_front();
+
+		++frames;
+
+		std::unique_ptr<J1939Frame> decoded = J1939Factory::getInstance().getJ1939Frame(frame.id, frame.data, sizeof(frame.data));
+
+		originators.consumeFrame(*decoded, now);
+		responder.consumeFrame(*decoded, now);
+
+		while(responder.reassembledFramesPending()) {
+			responder.dequeueReassembledFrame();
+			++received;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	if(received != MESSAGES) {
+		printf("Only %u messages of %u received\n", received, MESSAGES);
+	}
+
+	Result result;
+
+	result.nsPerMessage = std::chrono::duration<double, std::nano>(end - start).count() / MESSAGES;
+	result.framesPerMessage = static_cast<double>(frames) / MESSAGES;
+
+	return result;
+}
+
+int main(int argc, char **argv) {
+
+	GenericFrame message(MESSAGE_PGN);
+
+	message.setName("Proprietary A");
+	message.setLength(RTSCTS_MAX_MSG_SIZE);
+
+	J1939Factory::getInstance().registerFrame(message);
+
+	u8 windows[] = {1, 4, 16, 64, 255};
+
+	double packets = (RTSCTS_MAX_MSG_SIZE + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE;
+	double busBytesPerSecond = static_cast<double>(BUS_BITRATE) / CAN_FRAME_BITS * TP_DT_PACKET_SIZE;
+
+	printf("%u messages of %u bytes from %u originators, bus at %u bit/s\n", MESSAGES, RTSCTS_MAX_MSG_SIZE, ORIGINATORS, BUS_BITRATE);
+	printf("TP.DT only limit: %.0f bytes/s\n\n", busBytesPerSecond);
+	printf("window  us/message  MB/s (CPU)  frames/message  bus payload bytes/s  of limit\n");
+
+	for(size_t i = 0; i < sizeof(windows); ++i) {
+
+		Result result = transfer(windows[i]);
+
+		double payloadPerSecond = busBytesPerSecond * packets / result.framesPerMessage;
+
+		printf("%6u  %10.2f  %10.2f  %14.1f  %19.0f  %7.1f%%\n", windows[i], result.nsPerMessage / 1000,
+				RTSCTS_MAX_MSG_SIZE * 1000.0 / result.nsPerMessage, result.framesPerMessage, payloadPerSecond,
+				100.0 * packets / result.framesPerMessage);
+	}
+
+	J1939Factory::getInstance().unRegisterFrame(MESSAGE_PGN);
+
+	return 0;
+}
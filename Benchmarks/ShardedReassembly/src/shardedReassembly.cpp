@@ -0,0 +1,131 @@
+/*
+ * shardedReassembly.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Measures the BAM reassembly of a DM1 storm received from several interfaces by a single thread, with the packets
+ *  handed to ShardedReassembler with different numbers of workers. The reassembled DM1 are decoded by the workers.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <Types.h>
+
+#include <J1939Factory.h>
+#include <Diagnosis/Frames/DM1.h>
+#include <Transport/BAM/ShardedReassembler.h>
+#include <Transport/BAM/BamFragmenter.h>
+
+
+#define INTERFACES			4
+#define SOURCES				32
+#define ROUNDS				512
+#define DTCS				10		//Every DM1 is 46 bytes, 7 packets
+
+using namespace J1939;
+
+struct RawPacket {
+	u32 interface;
+	u32 id;
+	u8 data[J1939_MAX_SIZE];
+	size_t length;
+};
+
+static double measure(const std::vector<RawPacket>& packets, size_t workers, u64 messages) {
+
+	ShardedReassembler reassembler(workers);
+	u64 reassembled = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread consumer([&]() {
+
+		ShardedReassembler::Message message;
+
+		while(reassembled < messages) {
+			if(reassembler.pop(message)) {
+				++reassembled;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	for(u32 round = 0; round < ROUNDS; ++round) {
+
+		for(auto packet = packets.begin(); packet != packets.end(); ++packet) {
+
+			//Waits for the workers instead of dropping
+			while(!reassembler.push(packet->interface, packet->id, packet->data, packet->length, round)) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	consumer.join();
+
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / (ROUNDS * packets.size());
+}
+
+int main(int argc, char **argv) {
+
+	std::vector<RawPacket> packets;
+	std::vector<std::vector<RawPacket> > streams;
+
+	for(u32 iface = 0; iface < INTERFACES; ++iface) {
+		for(u32 src = 0; src < SOURCES; ++src) {
+
+			DM1 dm1;
+
+			for(u32 i = 0; i < DTCS; ++i) {
+				dm1.addDTC(DTC(100 + i, 3, 1));
+			}
+
+			dm1.setSrcAddr(src);
+
+			std::vector<RawPacket> stream;
+
+			BamFragmenter::fragment(dm1, [&](u32 id, const u8* data, size_t length) {
+
+				RawPacket packet;
+
+				packet.interface = iface;
+				packet.id = id;
+				packet.length = length;
+				memcpy(packet.data, data, length);
+
+				stream.push_back(packet);
+			});
+
+			streams.push_back(stream);
+		}
+	}
+
+	//Packets of all the sources interleaved as in the buses
+	for(size_t i = 0; i < streams[0].size(); ++i) {
+		for(auto stream = streams.begin(); stream != streams.end(); ++stream) {
+			packets.push_back((*stream)[i]);
+		}
+	}
+
+	u64 messages = static_cast<u64>(ROUNDS) * streams.size();
+
+	printf("DM1 of %zu packets interleaved from %u sources in %u interfaces, %u cores\n", streams[0].size(), SOURCES,
+			INTERFACES, std::thread::hardware_concurrency());
+
+	size_t workers[] = {1, 2, 4, 8};
+
+	for(size_t i = 0; i < sizeof(workers) / sizeof(workers[0]); ++i) {
+		printf("%zu workers: %8.2f ns/packet\n", workers[i], measure(packets, workers[i], messages));
+	}
+
+	return 0;
+}
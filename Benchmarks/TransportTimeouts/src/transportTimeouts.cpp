@@ -0,0 +1,133 @@
+/*
+ * transportTimeouts.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Keeps thousands of transport sessions alive with a packet every 50 ms and a T1 of 750 ms, some of them stalling,
+ *  and expires them with TimerWheel and with a scan of all the deadlines at every millisecond of the simulation.
+ *  Reports the cost per simulated millisecond.
+ */
+
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include <Types.h>
+
+#include <TimerWheel.h>
+
+
+#define PACKET_PERIOD		50
+#define TIMEOUT				750
+#define SIMULATED_TIME		10000
+#define STALL_EVERY			97			//One session out of this many stops sending
+
+using namespace J1939;
+
+
+struct Result {
+	double nsPerMs;
+	u64 expired;
+};
+
+/*
+ * The sessions send with offsets spread over the period, this is the first one sending at the time
+ */
+static size_t firstSending(u64 now) {
+	return (PACKET_PERIOD - now % PACKET_PERIOD) % PACKET_PERIOD;
+}
+
+static bool stalled(size_t session, u64 now) {
+	return session % STALL_EVERY == 0 && now > TIMEOUT;
+}
+
+static Result runWheel(size_t sessions) {
+
+	//The wheel goes out of scope before the timers linked in it
+	std::vector<TimerWheel::Timer> timers(sessions);
+	TimerWheel wheel;
+
+	Result result = {0, 0};
+
+	for(size_t i = 0; i < sessions; ++i) {
+		timers[i].key = i;
+		wheel.schedule(timers[i], TIMEOUT);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u64 now = 0; now < SIMULATED_TIME; ++now) {
+
+		for(size_t i = firstSending(now); i < sessions; i += PACKET_PERIOD) {
+			if(!stalled(i, now) && timers[i].isScheduled()) {
+				wheel.schedule(timers[i], now + TIMEOUT);
+			}
+		}
+
+		result.expired += wheel.advance(now, [](TimerWheel::Timer&) {});
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	result.nsPerMs = std::chrono::duration<double, std::nano>(end - start).count() / SIMULATED_TIME;
+
+	return result;
+}
+
+static Result runScan(size_t sessions) {
+
+	std::vector<u64> deadlines(sessions, TIMEOUT);
+	std::vector<bool> active(sessions, true);
+
+	Result result = {0, 0};
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(u64 now = 0; now < SIMULATED_TIME; ++now) {
+
+		for(size_t i = firstSending(now); i < sessions; i += PACKET_PERIOD) {
+			if(!stalled(i, now) && active[i]) {
+				deadlines[i] = now + TIMEOUT;
+			}
+		}
+
+		for(size_t i = 0; i < sessions; ++i) {
+			if(active[i] && deadlines[i] <= now) {
+				active[i] = false;
+				++result.expired;
+			}
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	result.nsPerMs = std::chrono::duration<double, std::nano>(end - start).count() / SIMULATED_TIME;
+
+	return result;
+}
+
+int main(int argc, char **argv) {
+
+	size_t counts[] = {256, 4096, 65536};
+
+	printf("Packet every %u ms, timeout %u ms, %u ms simulated\n\n", PACKET_PERIOD, TIMEOUT, SIMULATED_TIME);
+	printf("sessions  expired  wheel ns/ms  scan ns/ms  (including the refreshes of the sessions)\n");
+
+	for(size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+
+		Result wheel = runWheel(counts[i]);
+		Result scan = runScan(counts[i]);
+
+		if(wheel.expired != scan.expired) {
+			printf("Expired sessions differ: %llu and %llu\n", static_cast<unsigned long long>(wheel.expired),
+					static_cast<unsigned long long>(scan.expired));
+		}
+
+		printf("%8zu  %7llu  %11.0f  %10.0f\n", counts[i], static_cast<unsigned long long>(wheel.expired),
+				wheel.nsPerMs, scan.nsPerMs);
+	}
+
+	return 0;
+}
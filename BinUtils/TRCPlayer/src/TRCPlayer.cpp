@@ -28,6 +28,7 @@
 //J1939 includes
 #include <J1939Frame.h>
 #include <J1939Factory.h>
+#include <BinaryDataBase.h>
 #include <Transport/BAM/BamReassembler.h>
 
 
@@ -36,6 +37,10 @@
 
 #define SELECT_COLOR		1
 
+#ifndef BINARY_DATABASE_PATH
+#define BINARY_DATABASE_PATH	"/etc/j1939/frames.j1939db"
+#endif
+
 
 using namespace Can;
 using namespace Utils;
@@ -123,7 +128,11 @@ int main(int argc, char **argv) {
 
 	std::pair<u64, CanFrame> pairTStampFrame;
 
-	if(!J1939Factory::getInstance().registerDatabaseFrames(DATABASE_PATH)) {
+	//The precompiled database is mapped straight into the factory if it is installed
+	bool binaryLoaded = BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_PATH) &&
+			J1939Factory::getInstance().registerDatabaseFrames(BINARY_DATABASE_PATH);
+
+	if(!binaryLoaded && !J1939Factory::getInstance().registerDatabaseFrames(DATABASE_PATH)) {
 		std::cerr << "Database not found in " << DATABASE_PATH << std::endl;
 		return 4;
 	}
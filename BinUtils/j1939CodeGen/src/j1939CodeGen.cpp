@@ -0,0 +1,494 @@
+//============================================================================
+// Name        : j1939CodeGen.cpp
+// Author      : famez
+// Description : Generates a header with one typed struct per PGN of the
+//               database, with compile time offsets, masks and factors.
+//============================================================================
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <ctype.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <Types.h>
+#include <Utils.h>
+
+//J1939 libraries
+#include <J1939DataBase.h>
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+
+#define DEFAULT_NAMESPACE		"J1939Generated"
+#define INCLUDE_GUARD			"J1939_GENERATED_FRAMES_H_"
+
+using namespace J1939;
+
+
+//Names of the members generated in every frame struct and keywords, that the SPN members can not take
+static const std::set<std::string> RESERVED_MEMBERS = {
+		"pgn", "minLength", "length", "decode", "encode", "copyTo", "copyFrom",
+		"alignas", "alignof", "and", "asm", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+		"constexpr", "continue", "decltype", "default", "delete", "do", "double", "else", "enum", "explicit",
+		"export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+		"namespace", "new", "noexcept", "not", "nullptr", "operator", "or", "private", "protected", "public",
+		"register", "return", "short", "signed", "sizeof", "static", "struct", "switch", "template", "this",
+		"throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual",
+		"void", "volatile", "while", "xor"
+};
+
+
+/*
+ * Converts a name from the database into a valid C++ identifier. If capitalize is false the first letter is in lower case.
+ */
+std::string toIdentifier(const std::string& name, bool capitalize) {
+
+	std::string identifier;
+	bool upper = capitalize;
+
+	for(auto c = name.begin(); c != name.end(); ++c) {
+
+		if(!isalnum(static_cast<unsigned char>(*c))) {
+			upper = true;
+			continue;
+		}
+
+		if(identifier.empty()) {
+			identifier.push_back(capitalize ? toupper(*c) : tolower(*c));
+		} else {
+			identifier.push_back(upper ? toupper(*c) : *c);
+		}
+
+		upper = false;
+	}
+
+	if(identifier.empty() || isdigit(static_cast<unsigned char>(identifier[0]))) {
+		identifier = (capitalize ? "S" : "s") + identifier;
+	}
+
+	return identifier;
+}
+
+std::string toHex(u32 value) {
+
+	std::stringstream sstr;
+	sstr << "0x" << std::uppercase << std::hex << value;
+	return sstr.str();
+}
+
+std::string toDouble(double value) {
+
+	//Not representable as literals
+	if(std::isnan(value)) {
+		return "std::numeric_limits<double>::quiet_NaN()";
+	}
+
+	if(std::isinf(value)) {
+		return (value < 0 ? "-std::numeric_limits<double>::infinity()" : "std::numeric_limits<double>::infinity()");
+	}
+
+	std::stringstream sstr;
+	sstr << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+
+	std::string str = sstr.str();
+
+	if(str.find_first_of(".e") == std::string::npos) {
+		str += ".0";
+	}
+
+	return str;
+}
+
+/*
+ * Escapes a string from the database to be written inside a string literal
+ */
+std::string toStringLiteral(const std::string& str) {
+
+	std::stringstream sstr;
+
+	sstr << '"';
+
+	for(auto c = str.begin(); c != str.end(); ++c) {
+
+		unsigned char uc = static_cast<unsigned char>(*c);
+
+		if(uc == '"' || uc == '\\') {
+			sstr << '\\' << *c;
+		} else if(uc < 0x20 || uc >= 0x7F) {
+			//Octal escapes take at most 3 digits, so they do not swallow the characters after them as hexadecimal ones do
+			sstr << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<u32>(uc) << std::dec;
+		} else {
+			sstr << *c;
+		}
+	}
+
+	sstr << '"';
+
+	return sstr.str();
+}
+
+/*
+ * Makes a string from the database safe to be written inside a block or line comment. The end of a block comment is split,
+ * the control characters would end a line comment and a backslash at the end of the line would join the next line to it.
+ */
+std::string toComment(const std::string& str) {
+
+	std::string comment;
+
+	for(auto c = str.begin(); c != str.end(); ++c) {
+
+		if(static_cast<unsigned char>(*c) < 0x20 || *c == 0x7F) {
+			comment.push_back(' ');
+		} else if(*c == '/' && !comment.empty() && comment.back() == '*') {
+			comment += " /";
+		} else {
+			comment.push_back(*c);
+		}
+	}
+
+	while(!comment.empty() && (comment.back() == ' ' || comment.back() == '\\')) {
+		comment.pop_back();
+	}
+
+	return comment;
+}
+
+/*
+ * Returns an empty string if the SPNs of the frame have valid sizes or the reason otherwise
+ */
+std::string checkFrame(const GenericFrame& frame) {
+
+	std::set<u32> numbers = frame.getSPNNumbers();
+
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+
+		const SPN* spn = frame.getSPN(*number);
+
+		if(spn->getType() == SPN::SPN_NUMERIC) {
+
+			u32 byteSize = static_cast<const SPNNumeric*>(spn)->getByteSize();
+
+			if(byteSize == 0 || byteSize > SPN_NUMERIC_MAX_BYTE_SYZE) {
+				return "SPN " + std::to_string(*number) + " has a byte size of " + std::to_string(byteSize);
+			}
+
+		} else if(spn->getType() == SPN::SPN_STATUS) {
+
+			const SPNStatus* statSpn = static_cast<const SPNStatus*>(spn);
+
+			if(statSpn->getBitSize() == 0 || statSpn->getBitOffset() + statSpn->getBitSize() > 8) {
+				return "SPN " + std::to_string(*number) + " has " + std::to_string(statSpn->getBitSize()) +
+						" bits at bit offset " + std::to_string(statSpn->getBitOffset());
+			}
+		}
+	}
+
+	return "";
+}
+
+/*
+ * Returns false if the frame can not be generated (it contains SPNs of type string)
+ */
+bool generateFrame(std::ostream& out, const GenericFrame& frame, const std::string& structName) {
+
+	std::set<u32> numbers = frame.getSPNNumbers();
+
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+		if(frame.getSPN(*number)->getType() == SPN::SPN_STRING) {
+			return false;
+		}
+	}
+
+	//A nested struct can not have the name of the enclosing one
+	std::set<std::string> usedNames = {structName};
+	std::map<u32, std::string> specNames, memberNames;
+
+	size_t minLength = 0;
+
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+
+		const SPN* spn = frame.getSPN(*number);
+
+		std::string specName = toIdentifier(spn->getName(), true);
+
+		if(usedNames.find(specName) != usedNames.end() ||
+				RESERVED_MEMBERS.find(toIdentifier(specName, false)) != RESERVED_MEMBERS.end()) {
+			specName += "_" + std::to_string(*number);
+		}
+
+		usedNames.insert(specName);
+
+		specNames[*number] = specName;
+		memberNames[*number] = toIdentifier(specName, false);
+
+		minLength = J1939_MAX(minLength, spn->getOffset() + spn->getByteSize());
+	}
+
+	out << "/*" << std::endl;
+	out << " * " << toComment(frame.getName()) << std::endl;
+	out << " */" << std::endl;
+	out << "struct " << structName << " {" << std::endl << std::endl;
+	//Functions instead of static data members, which would need a definition out of the class to be bound to a reference in C++11
+	out << "\tstatic constexpr u32 pgn() { return " << toHex(frame.getPGN()) << "; }" << std::endl;
+	out << "\tstatic constexpr size_t minLength() { return " << minLength << "; }\t\t//Minimum length to decode all the SPNs" << std::endl;
+	out << "\tstatic constexpr size_t length() { return " << frame.getDataLength() << "; }\t\t//Length of the encoded frame" << std::endl;
+	out << std::endl;
+
+	//Specification of every SPN
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+
+		const SPN* spn = frame.getSPN(*number);
+
+		out << "\t/*" << std::endl;
+		out << "\t * SPN " << *number << ": " << toComment(spn->getName()) << std::endl;
+		out << "\t */" << std::endl;
+		out << "\tstruct " << specNames[*number] << " {" << std::endl;
+		out << "\t\tstatic constexpr u32 number() { return " << *number << "; }" << std::endl;
+		out << "\t\tstatic constexpr size_t byteOffset() { return " << spn->getOffset() << "; }" << std::endl;
+
+		if(spn->getType() == SPN::SPN_NUMERIC) {
+
+			const SPNNumeric* numSpn = static_cast<const SPNNumeric*>(spn);
+
+			u32 mask = 0xFFFFFFFF >> ((SPN_NUMERIC_MAX_BYTE_SYZE - numSpn->getByteSize()) * 8);
+
+			out << "\t\tstatic constexpr size_t byteSize() { return " << static_cast<u32>(numSpn->getByteSize()) << "; }" << std::endl;
+			out << "\t\tstatic constexpr u32 mask() { return " << toHex(mask) << "; }" << std::endl;
+			out << "\t\tstatic constexpr double gain() { return " << toDouble(numSpn->getFormatGain()) << "; }" << std::endl;
+			out << "\t\tstatic constexpr double offset() { return " << toDouble(numSpn->getFormatOffset()) << "; }" << std::endl;
+			out << "\t\tstatic constexpr const char* units() { return " << toStringLiteral(numSpn->getUnits()) << "; }" << std::endl;
+			out << "\t\tstatic constexpr double format(u32 raw) { return raw * gain() + offset(); }" << std::endl;
+			out << "\t\tstatic inline u32 extract(const u8* data) {" << std::endl;
+			out << "\t\t\tu32 raw = 0;" << std::endl;
+			out << "\t\t\tfor(size_t i = 0; i < byteSize(); ++i) raw |= (static_cast<u32>(data[byteOffset() + i]) << (i * 8));" << std::endl;
+			out << "\t\t\treturn raw;" << std::endl;
+			out << "\t\t}" << std::endl;
+			out << "\t\tstatic inline void insert(u8* data, u32 raw) {" << std::endl;
+			out << "\t\t\tfor(size_t i = 0; i < byteSize(); ++i) data[byteOffset() + i] = ((raw >> (i * 8)) & 0xFF);" << std::endl;
+			out << "\t\t}" << std::endl;
+
+		} else {
+
+			const SPNStatus* statSpn = static_cast<const SPNStatus*>(spn);
+
+			u32 mask = 0xFF >> (8 - statSpn->getBitSize());
+
+			out << "\t\tstatic constexpr u8 bitOffset() { return " << static_cast<u32>(statSpn->getBitOffset()) << "; }" << std::endl;
+			out << "\t\tstatic constexpr u8 bitSize() { return " << static_cast<u32>(statSpn->getBitSize()) << "; }" << std::endl;
+			out << "\t\tstatic constexpr u8 mask() { return " << toHex(mask) << "; }" << std::endl;
+			out << "\t\tstatic inline u8 extract(const u8* data) { return (data[byteOffset()] >> bitOffset()) & mask(); }" << std::endl;
+			out << "\t\tstatic inline void insert(u8* data, u8 raw) {" << std::endl;
+			out << "\t\t\tdata[byteOffset()] = (data[byteOffset()] & ~(mask() << bitOffset())) | ((raw & mask()) << bitOffset());" << std::endl;
+			out << "\t\t}" << std::endl;
+
+			const SPNStatus::DescMap& descriptions = statSpn->getValueDescriptionsMap();
+
+			if(!descriptions.empty()) {
+				out << "\t\tenum EValue {" << std::endl;
+				std::set<std::string> usedValues;
+				for(auto desc = descriptions.begin(); desc != descriptions.end(); ++desc) {
+					std::string valueName = "VALUE_" + toIdentifier(desc->second, true);
+					if(usedValues.find(valueName) != usedValues.end()) {
+						valueName += "_" + std::to_string(desc->first);
+					}
+					usedValues.insert(valueName);
+					out << "\t\t\t" << valueName << " = " << static_cast<u32>(desc->first) << ",\t\t//" << toComment(desc->second) << std::endl;
+				}
+				out << "\t\t};" << std::endl;
+			}
+		}
+
+		out << "\t};" << std::endl << std::endl;
+	}
+
+	//Raw values
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+		out << "\t" << (frame.getSPN(*number)->getType() == SPN::SPN_NUMERIC ? "u32 " : "u8 ") <<
+				memberNames[*number] << " = 0;" << std::endl;
+	}
+
+	out << std::endl;
+
+	//Decode
+	out << "\t/*" << std::endl;
+	out << "\t * Decodes the raw values of the SPNs. Returns false if the data is shorter than minLength()." << std::endl;
+	out << "\t */" << std::endl;
+	out << "\tinline bool decode(const u8* data, size_t size) {" << std::endl;
+	out << "\t\tif(size < minLength()) return false;" << std::endl;
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+		out << "\t\t" << memberNames[*number] << " = " << specNames[*number] << "::extract(data);" << std::endl;
+	}
+	out << "\t\treturn true;" << std::endl;
+	out << "\t}" << std::endl << std::endl;
+
+	//Encode
+	out << "\t/*" << std::endl;
+	out << "\t * Encodes the SPNs in length() bytes, setting to 1 the bits not used by any SPN. Returns false if the buffer is shorter than length()." << std::endl;
+	out << "\t */" << std::endl;
+	out << "\tinline bool encode(u8* data, size_t size) const {" << std::endl;
+	out << "\t\tif(size < length()) return false;" << std::endl;
+	out << "\t\tmemset(data, 0xFF, length());" << std::endl;
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+		out << "\t\t" << specNames[*number] << "::insert(data, " << memberNames[*number] << ");" << std::endl;
+	}
+	out << "\t\treturn true;" << std::endl;
+	out << "\t}" << std::endl << std::endl;
+
+	//Interoperability with the generic frames of the factory
+	out << "\t/*" << std::endl;
+	out << "\t * Copies the values to/from a GenericFrame of the same PGN, like the ones built by J1939Factory." << std::endl;
+	out << "\t */" << std::endl;
+	out << "\tinline bool copyTo(J1939::GenericFrame& frame) const {" << std::endl;
+	out << "\t\tif(frame.getPGN() != pgn()) return false;" << std::endl;
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+		const char* spnClass = (frame.getSPN(*number)->getType() == SPN::SPN_NUMERIC ? "J1939::SPNNumeric" : "J1939::SPNStatus");
+		out << "\t\tif(J1939::SPN* spn = frame.getSPN(" << specNames[*number] << "::number())) static_cast<" << spnClass <<
+				"*>(spn)->setValue(" << memberNames[*number] << ");" << std::endl;
+	}
+	out << "\t\treturn true;" << std::endl;
+	out << "\t}" << std::endl << std::endl;
+
+	out << "\tinline bool copyFrom(const J1939::GenericFrame& frame) {" << std::endl;
+	out << "\t\tif(frame.getPGN() != pgn()) return false;" << std::endl;
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+		const char* spnClass = (frame.getSPN(*number)->getType() == SPN::SPN_NUMERIC ? "J1939::SPNNumeric" : "J1939::SPNStatus");
+		out << "\t\tif(const J1939::SPN* spn = frame.getSPN(" << specNames[*number] << "::number())) " << memberNames[*number] <<
+				" = static_cast<const " << spnClass << "*>(spn)->getValue();" << std::endl;
+	}
+	out << "\t\treturn true;" << std::endl;
+	out << "\t}" << std::endl << std::endl;
+
+	out << "};" << std::endl << std::endl;
+
+	return true;
+}
+
+
+int
+main (int argc, char **argv)
+{
+	int c;
+
+	std::string input = DATABASE_PATH, output, nameSpace = DEFAULT_NAMESPACE;
+
+	static struct option long_options[] =
+		{
+			{"input", required_argument, NULL, 'i'},
+			{"output", required_argument, NULL, 'o'},
+			{"namespace", required_argument, NULL, 'n'},
+			{NULL, 0, NULL, 0}
+		};
+
+
+	while (1)
+	{
+
+		c = getopt_long (argc, argv, "i:o:n:",
+				   long_options, NULL);
+
+		/* Detect the end of the options. */
+		if (c == -1)
+			break;
+
+		switch (c)
+		{
+		case 'i':
+			input = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'n':
+			nameSpace = optarg;
+			break;
+		}
+	}
+
+	if(output.empty()) {
+		std::cerr << "Output file not specified" << std::endl;
+		exit(1);
+	}
+
+	J1939DataBase database;
+
+	if(!database.parseJsonFile(input)) {
+		std::cerr << "Database could not be parsed from " << input << ". Error code: " << database.getLastError() << std::endl;
+		exit(2);
+	}
+
+	std::stringstream out;
+
+	out << "/*" << std::endl;
+	out << " * Generated by j1939CodeGen from " << toComment(input.substr(input.find_last_of('/') + 1)) << ". Do not edit." << std::endl;
+	out << " */" << std::endl << std::endl;
+	out << "#ifndef " << INCLUDE_GUARD << std::endl;
+	out << "#define " << INCLUDE_GUARD << std::endl << std::endl;
+	out << "#include <string.h>" << std::endl << std::endl;
+	out << "#include <limits>" << std::endl << std::endl;
+	out << "#include <Types.h>" << std::endl << std::endl;
+	out << "#include <GenericFrame.h>" << std::endl;
+	out << "#include <SPN/SPNNumeric.h>" << std::endl;
+	out << "#include <SPN/SPNStatus.h>" << std::endl << std::endl;
+	out << "namespace " << nameSpace << " {" << std::endl << std::endl;
+
+	std::set<u32> pgns;
+	std::set<std::string> structNames;
+
+	const std::vector<GenericFrame>& frames = database.getParsedFrames();
+
+	for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+
+		//As in J1939Factory, the first definition of a PGN is the one that counts
+		if(pgns.find(frame->getPGN()) != pgns.end()) {
+			out << "//" << toComment(frame->getName()) << " (" << toHex(frame->getPGN()) << ") skipped: PGN already defined" << std::endl << std::endl;
+			continue;
+		}
+
+		std::string error = checkFrame(*frame);
+
+		if(!error.empty()) {
+			std::cerr << "Frame " << frame->getName() << " (" << toHex(frame->getPGN()) << ") can not be generated: " << error << std::endl;
+			exit(4);
+		}
+
+		std::string structName = toIdentifier(frame->getName(), true);
+
+		if(frame->getName().empty() || structNames.find(structName) != structNames.end()) {
+			structName = "PGN_" + toHex(frame->getPGN()).substr(2);
+		}
+
+		if(!generateFrame(out, *frame, structName)) {
+			out << "//" << toComment(frame->getName()) << " (" << toHex(frame->getPGN()) << ") skipped: SPNs of type string have variable offsets" << std::endl << std::endl;
+			continue;
+		}
+
+		pgns.insert(frame->getPGN());
+		structNames.insert(structName);
+	}
+
+	out << "} /* namespace " << nameSpace << " */" << std::endl << std::endl;
+	out << "#endif /* " << INCLUDE_GUARD << " */" << std::endl;
+
+	std::ofstream ofs(output.c_str(), std::ofstream::out | std::ofstream::trunc);
+
+	if(!ofs.is_open()) {
+		std::cerr << "Output file " << output << " could not be opened" << std::endl;
+		exit(3);
+	}
+
+	ofs << out.str();
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+//============================================================================
+// Name        : j1939DBCompiler.cpp
+// Author      : famez
+// Description : Compiles the json database into the binary format that is
+//               mapped in memory by BinaryDataBase.
+//============================================================================
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <iostream>
+#include <string>
+
+//J1939 libraries
+#include <J1939DataBase.h>
+#include <BinaryDataBase.h>
+
+
+using namespace J1939;
+
+
+int
+main (int argc, char **argv)
+{
+	int c;
+
+	std::string input = DATABASE_PATH, output;
+
+	static struct option long_options[] =
+		{
+			{"input", required_argument, NULL, 'i'},
+			{"output", required_argument, NULL, 'o'},
+			{NULL, 0, NULL, 0}
+		};
+
+
+	while (1)
+	{
+
+		c = getopt_long (argc, argv, "i:o:",
+				   long_options, NULL);
+
+		/* Detect the end of the options. */
+		if (c == -1)
+			break;
+
+		switch (c)
+		{
+		case 'i':
+			input = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		}
+	}
+
+	if(output.empty()) {
+		std::cerr << "Output file not specified" << std::endl;
+		exit(1);
+	}
+
+	J1939DataBase database;
+
+	if(!database.parseJsonFile(input)) {
+		std::cerr << "Database could not be parsed from " << input << ". Error code: " << database.getLastError() << std::endl;
+		exit(2);
+	}
+
+	if(!database.writeBinaryFile(output)) {
+		std::cerr << "Output file " << output << " could not be written" << std::endl;
+		exit(3);
+	}
+
+	//Check that the written file can be mapped back
+	BinaryDataBase binary;
+
+	if(!binary.open(output)) {
+		std::cerr << "Output file " << output << " could not be verified. Error code: " << binary.getLastError() << std::endl;
+		exit(4);
+	}
+
+	std::cout << "Compiled " << binary.getFrameCount() << " frames into " << output << std::endl;
+
+	return 0;
+}
@@ -26,8 +26,10 @@
 
 //J1939 libraries
 #include <J1939DataBase.h>
+#include <BinaryDataBase.h>
 #include <J1939Factory.h>
 #include <GenericFrame.h>
+#include <FrameFormatter.h>
 
 #include <Transport/BAM/BamReassembler.h>
 
@@ -36,6 +38,10 @@
 #define DATABASE_PATH		"/etc/j1939/frames.json"
 #endif
 
+#ifndef BINARY_DATABASE_PATH
+#define BINARY_DATABASE_PATH	"/etc/j1939/frames.j1939db"
+#endif
+
 
 using namespace J1939;
 
@@ -130,12 +136,13 @@ main (int argc, char **argv)
 	//In case of BAM decoding
 	BamReassembler reassembler;
 
-	std::string id, data;
+	std::string id, data, format;
 
 	static struct option long_options[] =
 		{
 			{"id", required_argument, NULL, 'i'},
 			{"data", required_argument, NULL, 'd'},
+			{"format", required_argument, NULL, 'f'},
 			{NULL, 0, NULL, 0}
 		};
 
@@ -143,7 +150,7 @@ main (int argc, char **argv)
 	while (1)
 	{
 
-		c = getopt_long (argc, argv, "i:d:",
+		c = getopt_long (argc, argv, "i:d:f:",
 				   long_options, NULL);
 
 		/* Detect the end of the options. */
@@ -158,6 +165,9 @@ main (int argc, char **argv)
 		case 'd':
 			data = optarg;
 			break;
+		case 'f':
+			format = optarg;
+			break;
 		}
 	}
 
@@ -166,6 +176,13 @@ main (int argc, char **argv)
 		exit(1);
 	}
 
+	EFrameFormat frameFormat = FRAME_FORMAT_TSV;
+
+	if(!format.empty() && format != "text" && !FrameFormatter::parseFormat(format, frameFormat)) {
+		std::cerr << "Unknown format " << format << ", expected text, tsv, csv or ndjson" << std::endl;
+		exit(1);
+	}
+
 
 	//At this point we have the options, we build regular expressions to validate them
 
@@ -173,7 +190,11 @@ main (int argc, char **argv)
 
 	std::basic_string<u8> formattedData = decodeData(data);
 
-	if(!J1939Factory::getInstance().registerDatabaseFrames(DATABASE_PATH)) {
+	//The precompiled database is mapped straight into the factory if it is installed
+	bool binaryLoaded = BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_PATH) &&
+			J1939Factory::getInstance().registerDatabaseFrames(BINARY_DATABASE_PATH);
+
+	if(!binaryLoaded && !J1939Factory::getInstance().registerDatabaseFrames(DATABASE_PATH)) {
 		std::cerr << "Database not found in " << DATABASE_PATH << std::endl;
 		exit(4);
 	}
@@ -247,7 +268,22 @@ main (int argc, char **argv)
 	}
 
 
-	std::cout << frame->toString();
+	if(format.empty() || format == "text") {
+
+		std::cout << frame->toString();
+
+	} else {
+
+		FrameFormatter formatter(frameFormat);
+		std::vector<char> buffer(1024);
+
+		size_t length = formatter.formatHeader(buffer.data(), buffer.size());
+		fwrite(buffer.data(), 1, length, stdout);
+
+		length = formatter.format(*frame, Utils::TimeStamp(), buffer);
+		fwrite(buffer.data(), 1, length, stdout);
+
+	}
 
 	exit (0);
 }
@@ -25,6 +25,7 @@
 //J1939 includes
 #include <J1939Factory.h>
 #include <J1939DataBase.h>
+#include <BinaryDataBase.h>
 #include <GenericFrame.h>
 #include <SPN/SPNNumeric.h>
 #include <SPN/SPNStatus.h>
@@ -99,6 +100,10 @@
 #define DATABASE_PATH		"/etc/j1939/frames.json"
 #endif
 
+#ifndef BINARY_DATABASE_PATH
+#define BINARY_DATABASE_PATH	"/etc/j1939/frames.j1939db"
+#endif
+
 
 
 
@@ -258,9 +263,12 @@ int main(int argc, char **argv) {
 	//Register possible commands to execute by the user
 	registerCommands();
 
-	//Load database
+	//Load database, the precompiled one is mapped straight into the factory if it is installed
 	J1939DataBase ddbb;
-	if(!ddbb.parseJsonFile(DATABASE_PATH)) {
+	bool binaryLoaded = BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_PATH) &&
+			J1939Factory::getInstance().registerDatabaseFrames(BINARY_DATABASE_PATH);
+
+	if(!binaryLoaded && !ddbb.parseJsonFile(DATABASE_PATH)) {
 
 		switch (ddbb.getLastError()) {
 			case J1939DataBase::ERROR_FILE_NOT_FOUND:
@@ -286,13 +294,11 @@ int main(int argc, char **argv) {
 		return -1;
 	}
 
-	//Register frames in the factory
+	//Register frames in the factory, none if the precompiled database was loaded
 
 	const std::vector<GenericFrame>& frames = ddbb.getParsedFrames();
 
-	for(auto iter = frames.begin(); iter != frames.end(); ++iter) {
-		J1939Factory::getInstance().registerFrame(*iter);
-	}
+	J1939Factory::getInstance().registerFrames(frames.begin(), frames.end());
 
 	//Generate frames for the TTSs
 	fms1Frames.push_back(FMS1Frame(0));
@@ -16,7 +16,9 @@
 #include <Transport/BAM/BamReassembler.h>
 #include <J1939Factory.h>
 #include <J1939DataBase.h>
+#include <BinaryDataBase.h>
 #include <GenericFrame.h>
+#include <FrameFormatter.h>
 #include <Transport/TPCMFrame.h>
 #include <Transport/TPDTFrame.h>
 
@@ -28,10 +30,18 @@
 //Bitrate for J1939 protocol
 #define BAUD_250K			250000
 
+//Buffer of stdout when the frames are written in a text format, so that the writes are done in big blocks
+#define OUTPUT_BUFFER_SIZE	(1 << 16)
+#define FORMAT_BUFFER_SIZE	4096
+
 #ifndef DATABASE_PATH
 #define DATABASE_PATH		"/etc/j1939/frames.json"
 #endif
 
+#ifndef BINARY_DATABASE_PATH
+#define BINARY_DATABASE_PATH	"/etc/j1939/frames.j1939db"
+#endif
+
 using namespace Can;
 using namespace Utils;
 using namespace J1939;
@@ -41,6 +51,7 @@ using namespace J1939;
 BamReassembler reassembler;
 
 void onRcv(const Can::CanFrame& frame, const TimeStamp&, const std::string& interface, void*);
+void onRcvBatch(const Can::CanFrame* frames, const TimeStamp* timestamps, size_t count, const std::string& interface, void*);
 bool onTimeout();
 
 u32 pgn;
@@ -48,6 +59,10 @@ u32 spn;
 std::string interface, title;
 u8 source;
 
+//Set if the frames are written to stdout in a text format instead of shown with ncurses
+std::unique_ptr<FrameFormatter> formatter;
+std::vector<char> formatBuffer;
+
 
 int main (int argc, char **argv)
 {
@@ -57,7 +72,7 @@ int main (int argc, char **argv)
 	pgn = 0;
 	spn = 0;
 	source = J1939_INVALID_ADDRESS;
-	std::string pgnStr, spnStr, sourceStr;
+	std::string pgnStr, spnStr, sourceStr, formatStr;
 
 	static struct option long_options[] =
 		{
@@ -66,6 +81,7 @@ int main (int argc, char **argv)
 			{"interface", required_argument, NULL, 'i'},
 			{"title", required_argument, NULL, 't'},
 			{"source", required_argument, NULL, 'o'},
+			{"format", required_argument, NULL, 'f'},
 			{NULL, 0, NULL, 0}
 		};
 
@@ -73,7 +89,7 @@ int main (int argc, char **argv)
 	while (1)
 	{
 
-		c = getopt_long (argc, argv, "p:s:i:t:",
+		c = getopt_long (argc, argv, "p:s:i:t:f:",
 				   long_options, NULL);
 
 		/* Detect the end of the options. */
@@ -97,6 +113,9 @@ int main (int argc, char **argv)
 		case 'o':
 			sourceStr = optarg;
 			break;
+		case 'f':
+			formatStr = optarg;
+			break;
 		default:
 			break;
 		}
@@ -121,7 +140,21 @@ int main (int argc, char **argv)
 		}
 	}
 
-	if(pgnStr.empty() && title.empty()) {
+	if(!formatStr.empty()) {
+
+		EFrameFormat format;
+
+		if(!FrameFormatter::parseFormat(formatStr, format)) {
+			std::cerr << "The parameter format must be tsv, csv or ndjson..." << std::endl;
+			return 1;
+		}
+
+		formatter.reset(new FrameFormatter(format));
+
+	}
+
+	//All the frames of the bus are written if no pgn nor title are given with a text format
+	if(pgnStr.empty() && title.empty() && !formatter) {
 
 		std::cerr << "The parameter pgn or title are not specified..." << std::endl;
 		return 1;
@@ -170,9 +203,12 @@ int main (int argc, char **argv)
 	}
 
 
-	//Load database
+	//Load database, the precompiled one is mapped straight into the factory if it is installed
 	J1939DataBase ddbb;
-	if(!ddbb.parseJsonFile(DATABASE_PATH)) {
+	bool binaryLoaded = BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_PATH) &&
+			J1939Factory::getInstance().registerDatabaseFrames(BINARY_DATABASE_PATH);
+
+	if(!binaryLoaded && !ddbb.parseJsonFile(DATABASE_PATH)) {
 
 		switch (ddbb.getLastError()) {
 			case J1939DataBase::ERROR_FILE_NOT_FOUND:
@@ -197,13 +233,11 @@ int main (int argc, char **argv)
 		return 4;
 	}
 
-	//Register frames in the factory
+	//Register frames in the factory, none if the precompiled database was loaded
 
 	const std::vector<GenericFrame>& frames = ddbb.getParsedFrames();
 
-	for(auto iter = frames.begin(); iter != frames.end(); ++iter) {
-		J1939Factory::getInstance().registerFrame(*iter);
-	}
+	J1939Factory::getInstance().registerFrames(frames.begin(), frames.end());
 
 
 	//Search the frame in the database by the given pgn
@@ -220,7 +254,7 @@ int main (int argc, char **argv)
 	}
 
 
-	if(!frame) {
+	if(!frame && (pgn != 0 || !title.empty())) {
 		std::cerr << "The frame given by the pgn or title is not defined..." << std::endl;
 		return 5;
 	}
@@ -228,6 +262,11 @@ int main (int argc, char **argv)
 
 	if(spn != 0) {		//Spn has been defined
 
+		if(!frame) {
+			std::cerr << "The parameter spn requires the pgn or title..." << std::endl;
+			return 6;
+		}
+
 		if(!frame->isGenericFrame()) {
 			std::cerr << "The frame given by the pgn does not have SPNs associated..." << std::endl;
 			return 6;
@@ -251,6 +290,30 @@ int main (int argc, char **argv)
 		return 8;
 	}
 
+	//The frames queued in the interfaces are received together
+	sniffer.setOnRecvBatch(onRcvBatch);
+
+	if(formatter) {
+
+		setvbuf(stdout, nullptr, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+		formatBuffer.resize(FORMAT_BUFFER_SIZE);
+
+		size_t length = formatter->formatHeader(formatBuffer.data(), formatBuffer.size());
+		fwrite(formatBuffer.data(), 1, length, stdout);
+
+	}
+
+	if(!frame) {		//Text format without pgn nor title, nothing to filter
+
+		sniffer.sniff(1000);
+
+		fflush(stdout);
+
+		return 0;
+
+	}
+
 	std::set<CanFilter> filters;
 
 	//Install filter to get only the frame whose pgn is equals to the specified as argument.
@@ -277,6 +340,15 @@ int main (int argc, char **argv)
 
 	sniffer.setFilters(filters);
 
+	if(formatter) {
+
+		sniffer.sniff(1000);
+
+		fflush(stdout);
+
+		return 0;
+
+	}
 
 	//Initialize ncurses
 	initscr();
@@ -290,16 +362,25 @@ int main (int argc, char **argv)
 
 
 
-void onRcv(const Can::CanFrame& frame, const TimeStamp&, const std::string& interface, void*) {
+void onRcvBatch(const Can::CanFrame* frames, const TimeStamp* timestamps, size_t count, const std::string& interface, void* data) {
+
+	for(size_t i = 0; i < count; ++i) {
+		onRcv(frames[i], timestamps[i], interface, data);
+	}
 
-	std::unique_ptr<J1939Frame> j1939Frame = J1939Factory::getInstance().
-			getJ1939Frame(frame.getId(), (const u8*)(frame.getData().c_str()), frame.getData().size());
+}
 
-	if(!j1939Frame)		return;						//Frame not registered in the factory. Should never happen
+void onRcv(const Can::CanFrame& frame, const TimeStamp& timestamp, const std::string& interface, void*) {
 
-	if(reassembler.toBeHandled(*j1939Frame)) {				//Check if the frame is part of a fragmented frame (BAM protocol)
-		//Actually it is, reassembler will handle it.
-		reassembler.handleFrame(*j1939Frame);
+	const u8* data = frame.getData().data();
+	std::unique_ptr<J1939Frame> j1939Frame;
+
+	//Time of the frame in milliseconds, for the reassembler to expire the stalled BAM sessions
+	u64 now = static_cast<u64>(timestamp.getSeconds()) * 1000 + timestamp.getMicroSec() / 1000;
+
+	if(reassembler.toBeHandled(frame.getId(), data, frame.getData().size())) {	//Check if the frame is part of a fragmented frame (BAM protocol)
+		//Actually it is, reassembler will handle it straight from the payload.
+		reassembler.handleFrame(frame.getId(), data, frame.getData().size(), now);
 
 		if(reassembler.reassembledFramesPending()) {
 
@@ -309,6 +390,17 @@ void onRcv(const Can::CanFrame& frame, const TimeStamp&, const std::string& inte
 			return;				//Frame handled by reassembler but the original frame to be reassembled is not complete.
 		}
 
+	} else {
+
+		reassembler.tick(now);
+
+		//Every frame of the bus may be decoded, the malformed ones are skipped instead of ending the capture
+		ECodecStatus status;
+
+		j1939Frame = J1939Factory::getInstance().getJ1939Frame(frame.getId(), data, frame.getData().size(), status);
+
+		if(!j1939Frame)		return;						//Frame not registered in the factory or malformed
+
 	}
 
 
@@ -317,6 +409,32 @@ void onRcv(const Can::CanFrame& frame, const TimeStamp&, const std::string& inte
 	//Necesary to check again if pgn is the same even if the filters are supposed to do the work, because maybe,
 	//we have reassembled another frame than the expected one. Check the title also.
 
+	if(formatter) {
+
+		if(pgn == 0 && title.empty()) {		//All the frames
+
+			size_t length = formatter->format(*j1939Frame, timestamp, formatBuffer);
+			fwrite(formatBuffer.data(), 1, length, stdout);
+
+		} else if(pgn == j1939Frame->getPGN() || title == j1939Frame->getName()) {
+
+			size_t length = 0;
+
+			if(spn == 0) {
+				length = formatter->format(*j1939Frame, timestamp, formatBuffer);
+			} else if(j1939Frame->isGenericFrame() && static_cast<GenericFrame*>(j1939Frame.get())->hasSPN(spn)) {
+				length = formatter->formatSPN(*j1939Frame, *(static_cast<GenericFrame*>(j1939Frame.get())->getSPN(spn)),
+						timestamp, formatBuffer);
+			}
+
+			fwrite(formatBuffer.data(), 1, length, stdout);
+
+		}
+
+		return;
+
+	}
+
 	if(pgn == j1939Frame->getPGN() || title == j1939Frame->getName()) {
 
 		std::string toPrint;
@@ -351,6 +469,10 @@ void onRcv(const Can::CanFrame& frame, const TimeStamp&, const std::string& inte
 
 bool onTimeout() {
 
+	if(formatter) {		//Do not keep the frames in the buffer when the bus is idle
+		fflush(stdout);
+	}
+
 	return true;
 
 }
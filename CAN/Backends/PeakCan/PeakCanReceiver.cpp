@@ -36,11 +36,7 @@ bool PeakCanReceiver::receive(CanFrame& frame, TimeStamp& timestamp) {
 		return false;
 	}
 
-	//Set data
-	std::string data;
-	data.append((char*)message.DATA, message.LEN);
-
-	frame = CanFrame(message.MSGTYPE == PCAN_MESSAGE_EXTENDED, message.ID, data);
+	frame = CanFrame(message.MSGTYPE == PCAN_MESSAGE_EXTENDED, message.ID, message.DATA, message.LEN);
 
 	timestamp = TimeStamp(tmStamp.millis / 1000, (tmStamp.millis % 1000) * 1000 + tmStamp.micros);
 
@@ -49,6 +45,37 @@ bool PeakCanReceiver::receive(CanFrame& frame, TimeStamp& timestamp) {
 }
 
 
+size_t PeakCanReceiver::drain(CanFrame* frames, TimeStamp* timestamps, size_t count) {
+
+	size_t received = 0;
+
+	while(received < count) {
+
+		TPCANMsg message;
+		TPCANTimestamp tmStamp;
+
+		TPCANStatus status = PeakCanSymbols::getInstance().CAN_Read(mCurrentHandle, &message, &tmStamp);
+
+		if(status != PCAN_ERROR_OK) {
+			break;			//Empty queue or error
+		}
+
+		if(message.LEN > MAX_CAN_DATA_SIZE || (message.MSGTYPE != PCAN_MESSAGE_STANDARD &&
+				message.MSGTYPE != PCAN_MESSAGE_EXTENDED)) {
+			continue;
+		}
+
+		frames[received] = CanFrame(message.MSGTYPE == PCAN_MESSAGE_EXTENDED, message.ID, message.DATA, message.LEN);
+
+		timestamps[received] = TimeStamp(tmStamp.millis / 1000, (tmStamp.millis % 1000) * 1000 + tmStamp.micros);
+
+		++received;
+	}
+
+	return received;
+
+}
+
 int PeakCanReceiver::getFD() {
 
 	return mReadFd;
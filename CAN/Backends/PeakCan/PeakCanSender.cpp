@@ -39,7 +39,7 @@ void PeakCanSender::_sendFrame(const CanFrame& frame) const {
 	frameToSend.ID = frame.getId();
 	frameToSend.LEN = frame.getData().size();
 
-	memcpy(frameToSend.DATA, frame.getData().c_str(), frameToSend.LEN);
+	memcpy(frameToSend.DATA, frame.getData().data(), frameToSend.LEN);
 
 	status = PeakCanSymbols::getInstance().CAN_Write(mCurrentHandle, &frameToSend);
 
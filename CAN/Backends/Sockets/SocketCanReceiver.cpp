@@ -34,6 +34,18 @@ SocketCanReceiver::SocketCanReceiver(int sock, bool timeStamp) : mSock(sock), mT
 	msg.msg_iovlen = 1;
 	msg.msg_control = &ctrlmsg;
 
+	memset(mBatchHdrs, 0, sizeof(mBatchHdrs));
+
+	for(size_t i = 0; i < CAN_RECEIVE_BATCH_SIZE; ++i) {
+
+		mBatch[i].iov.iov_base = &mBatch[i].frame;
+
+		mBatchHdrs[i].msg_hdr.msg_name = &mBatch[i].addr;
+		mBatchHdrs[i].msg_hdr.msg_iov = &mBatch[i].iov;
+		mBatchHdrs[i].msg_hdr.msg_iovlen = 1;
+		mBatchHdrs[i].msg_hdr.msg_control = mBatch[i].ctrlmsg;
+	}
+
 }
 
 SocketCanReceiver::~SocketCanReceiver() {
@@ -87,9 +99,48 @@ bool SocketCanReceiver::setFilters(std::set<CanFilter> filters) {
 
 }
 
-bool SocketCanReceiver::receive(CanFrame& canFrame, TimeStamp& timestamp) {
+void SocketCanReceiver::extractTimeStamp(msghdr& hdr, TimeStamp& timestamp) const {
 
 	cmsghdr *cmsg;
+
+	if(!mTimeStamp)		return;			//Timestamp option is disabled
+
+	//Extract timestamp
+	for (cmsg = CMSG_FIRSTHDR(&hdr);
+		 cmsg && (cmsg->cmsg_level == SOL_SOCKET);
+		 cmsg = CMSG_NXTHDR(&hdr,cmsg)) {
+		if (cmsg->cmsg_type == SO_TIMESTAMP) {
+
+			timeval *stamp = (timeval*)(CMSG_DATA(cmsg));
+
+			timestamp.setMicroSec(stamp->tv_usec);
+			timestamp.setSeconds(stamp->tv_sec);
+
+		} else if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+
+			timespec *stamp = (struct timespec *)CMSG_DATA(cmsg);
+
+			//Take timestamp from software
+
+			timestamp.setSeconds(stamp[0].tv_sec);
+			timestamp.setMicroSec(stamp[0].tv_nsec/1000);
+
+		}
+	}
+
+}
+
+void SocketCanReceiver::copyFrame(const canfd_frame& frame, CanFrame& canFrame) {
+
+	canFrame.setExtendedFormat(frame.can_id & CAN_EFF_FLAG);
+	canFrame.setId(frame.can_id & ~CAN_EFF_FLAG);
+
+	canFrame.setData(frame.data, frame.len);
+
+}
+
+bool SocketCanReceiver::receive(CanFrame& canFrame, TimeStamp& timestamp) {
+
 	int nbytes;
 
 	iov.iov_len = sizeof(frame);
@@ -102,48 +153,59 @@ bool SocketCanReceiver::receive(CanFrame& canFrame, TimeStamp& timestamp) {
 
 	if(nbytes >= 0) {
 
-		if(mTimeStamp) {			//Timestamp option is enabled
+		extractTimeStamp(msg, timestamp);
 
-			//Extract timestamp
-			for (cmsg = CMSG_FIRSTHDR(&msg);
-				 cmsg && (cmsg->cmsg_level == SOL_SOCKET);
-				 cmsg = CMSG_NXTHDR(&msg,cmsg)) {
-				if (cmsg->cmsg_type == SO_TIMESTAMP) {
+		//Copy Frame
+		copyFrame(frame, canFrame);
 
-					timeval *stamp = (timeval*)(CMSG_DATA(cmsg));
+	}
 
-					timestamp.setMicroSec(stamp->tv_usec);
-					timestamp.setSeconds(stamp->tv_sec);
+	return true;
 
-				} else if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+}
 
-					timespec *stamp = (struct timespec *)CMSG_DATA(cmsg);
+size_t SocketCanReceiver::receive(CanFrame* frames, TimeStamp* timestamps, size_t count) {
 
-					//Take timestamp from software
+	//Blocks until the first frame, the rest are the ones already queued in the socket
+	return receiveBatch(frames, timestamps, count, MSG_WAITFORONE);
 
-					timestamp.setSeconds(stamp[0].tv_sec);
-					timestamp.setMicroSec(stamp[0].tv_nsec/1000);
+}
 
-				}
-			}
+size_t SocketCanReceiver::drain(CanFrame* frames, TimeStamp* timestamps, size_t count) {
 
-		}
+	return receiveBatch(frames, timestamps, count, MSG_DONTWAIT);
 
+}
 
-		//Copy Frame
-		canFrame.setExtendedFormat(frame.can_id & CAN_EFF_FLAG);
-		canFrame.setId(frame.can_id & ~CAN_EFF_FLAG);
+size_t SocketCanReceiver::receiveBatch(CanFrame* frames, TimeStamp* timestamps, size_t count, int flags) {
+
+	if(count > CAN_RECEIVE_BATCH_SIZE) {
+		count = CAN_RECEIVE_BATCH_SIZE;
+	}
 
-		std::string data;
-		data.append((char*)(frame.data), frame.len);
+	//The lengths are overwritten by every call
+	for(size_t i = 0; i < count; ++i) {
 
+		msghdr& hdr = mBatchHdrs[i].msg_hdr;
 
-		canFrame.setData(data);
+		hdr.msg_namelen = sizeof(mBatch[i].addr);
+		hdr.msg_controllen = sizeof(mBatch[i].ctrlmsg);
+		hdr.msg_flags = 0;
+		mBatch[i].iov.iov_len = sizeof(mBatch[i].frame);
+	}
 
+	int received = recvmmsg(mSock, mBatchHdrs, count, flags, nullptr);
 
+	if(received <= 0) {
+		return 0;
 	}
 
-	return true;
+	for(int i = 0; i < received; ++i) {
+		extractTimeStamp(mBatchHdrs[i].msg_hdr, timestamps[i]);
+		copyFrame(mBatch[i].frame, frames[i]);
+	}
+
+	return received;
 
 }
 
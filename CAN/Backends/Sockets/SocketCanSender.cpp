@@ -7,7 +7,7 @@
 
 
 
-#include <stdio.h>
+#include <errno.h>
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -23,18 +23,35 @@
 namespace Can {
 namespace Sockets {
 
-SocketCanSender::SocketCanSender(int sock) : mSock(sock) {
+SocketCanSender::SocketCanSender(int sock) : mSock(sock), mTxHead(0), mBackoff(0), mRetryTime({0, 0}) {
+
+	mTxQueue.reserve(SOCKET_TX_QUEUE_SIZE);
+
+	memset(mTxHdrs, 0, sizeof(mTxHdrs));
+
+	for(size_t i = 0; i < SOCKET_TX_BATCH_SIZE; ++i) {
+		mTxIovs[i].iov_len = sizeof(can_frame);
+		mTxHdrs[i].msg_hdr.msg_iov = &mTxIovs[i];
+		mTxHdrs[i].msg_hdr.msg_iovlen = 1;
+	}
 
 }
 
 SocketCanSender::~SocketCanSender() {
+
 	finalize();
+
+	std::lock_guard<std::mutex> lock(mTxLock);
+
+	//Last attempt for the frames still queued, even if backing off. The ones that do not fit are dropped
+	writePending();
+
+	mStats.droppedFrames += mTxQueue.size() - mTxHead;
+
 }
 
 void SocketCanSender::_sendFrame(const CanFrame& frame) const {
 
-	int retval;
-
 	can_frame frameToSend;
 	memset(&frameToSend, 0, sizeof(can_frame));
 
@@ -42,14 +59,114 @@ void SocketCanSender::_sendFrame(const CanFrame& frame) const {
 	frameToSend.can_id |= (frame.isExtendedFormat() ? CAN_EFF_FLAG : 0);
 	frameToSend.can_dlc = frame.getData().size();
 
-	memcpy(frameToSend.data, frame.getData().c_str(), frameToSend.can_dlc);
+	memcpy(frameToSend.data, frame.getData().data(), frameToSend.can_dlc);
+
+	std::lock_guard<std::mutex> lock(mTxLock);
 
-	retval = write(mSock, &frameToSend, sizeof(struct can_frame));
-	if (retval != sizeof(struct can_frame))
-	{
-		printf("[SocketCanSender::_sendFrame] retval: %d, error: %s\n", retval, strerror(errno));
+	if(mTxQueue.size() - mTxHead >= SOCKET_TX_QUEUE_SIZE) {
+		++mStats.droppedFrames;
+		return;
 	}
 
+	//The frames already written are removed instead of growing the queue
+	if(mTxQueue.size() == mTxQueue.capacity() && mTxHead > 0) {
+		mTxQueue.erase(mTxQueue.begin(), mTxQueue.begin() + mTxHead);
+		mTxHead = 0;
+	}
+
+	mTxQueue.push_back(frameToSend);
+
+}
+
+void SocketCanSender::_flushFrames() const {
+
+	std::lock_guard<std::mutex> lock(mTxLock);
+
+	if(mTxHead == mTxQueue.size())		return;
+
+	if(mBackoff != 0) {
+
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		if(now.tv_sec < mRetryTime.tv_sec || (now.tv_sec == mRetryTime.tv_sec && now.tv_nsec < mRetryTime.tv_nsec)) {
+			requestFlush();			//Still backing off
+			return;
+		}
+	}
+
+	writePending();
+
+}
+
+void SocketCanSender::writePending() const {
+
+	while(mTxHead < mTxQueue.size()) {
+
+		size_t count = J1939_MIN(mTxQueue.size() - mTxHead, SOCKET_TX_BATCH_SIZE);
+
+		for(size_t i = 0; i < count; ++i) {
+			mTxIovs[i].iov_base = &mTxQueue[mTxHead + i];
+		}
+
+		int retval = sendmmsg(mSock, mTxHdrs, count, MSG_DONTWAIT);
+
+		++mStats.writeCalls;
+
+		if(retval < 0) {
+
+			if(errno == ENOBUFS || errno == EAGAIN || errno == EWOULDBLOCK) {
+
+				//No room in the interface, the frames are retried later waiting twice as long every time
+				++mStats.noBufferErrors;
+
+				mBackoff = (mBackoff == 0 ? SOCKET_TX_MIN_BACKOFF : J1939_MIN(mBackoff * 2, SOCKET_TX_MAX_BACKOFF));
+
+				timespec now;
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				mRetryTime = Utils::addMillis(&now, mBackoff);
+
+				requestFlush();
+				return;
+			}
+
+			++mStats.writeErrors;
+			mStats.droppedFrames += count;
+			mTxHead += count;
+			continue;
+		}
+
+		mTxHead += retval;
+		mStats.framesSent += retval;
+		mBackoff = 0;
+
+		//The rest of the batch did not fit, tried again in the next iteration
+		if(static_cast<size_t>(retval) < count) {
+			++mStats.shortWrites;
+			requestFlush();
+			return;
+		}
+	}
+
+	mTxQueue.clear();
+	mTxHead = 0;
+
+}
+
+size_t SocketCanSender::getPendingFrames() const {
+
+	std::lock_guard<std::mutex> lock(mTxLock);
+
+	return mTxQueue.size() - mTxHead;
+
+}
+
+SocketTxStats SocketCanSender::getTxStats() const {
+
+	std::lock_guard<std::mutex> lock(mTxLock);
+
+	return mStats;
+
 }
 
 } /* namespace Sockets */
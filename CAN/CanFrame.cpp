@@ -12,19 +12,12 @@
 
 namespace Can {
 
-CanFrame::CanFrame() : mId (0) {
-
-}
-
-CanFrame::~CanFrame() {
-}
-
 std::string CanFrame::hexDump() const {
 	
 	std::stringstream sstr;
 
-	for(auto c = mData.begin(); c != mData.end(); ++c) {
-		sstr << std::setfill('0') << std::setw(2) << std::hex << (static_cast<u32>(*c) & 0xFF) << " ";
+	for(u8 i = 0; i < mLength; ++i) {
+		sstr << std::setfill('0') << std::setw(2) << std::hex << static_cast<u32>(mData[i]) << " ";
 	}
 	
 	return sstr.str();
@@ -5,6 +5,11 @@
  *      Author: fernado
  */
 
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
 #include <CanSniffer.h>
 #include <Assert.h>
 
@@ -12,7 +17,17 @@ using namespace Utils;
 
 namespace Can {
 
-CanSniffer::CanSniffer(OnReceiveFramePtr recvCB, OnTimeoutPtr timeoutCB, void* data) : mRcvCB(recvCB), mTimeoutCB(timeoutCB), mData(data) {
+CanSniffer::CanSniffer() : mRunning(true) {
+
+	mEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+}
+
+CanSniffer::CanSniffer(OnReceiveFramePtr recvCB, OnTimeoutPtr timeoutCB, void* data) : CanSniffer() {
+
+	mRcvCB = recvCB;
+	mTimeoutCB = timeoutCB;
+	mData = data;
 
 }
 
@@ -22,6 +37,23 @@ CanSniffer::~CanSniffer() {
 		delete *receiver;
 	}
 
+	if(mEventFd != -1) {
+		close(mEventFd);
+	}
+
+}
+
+void CanSniffer::finish() {
+
+	mRunning = false;
+
+	//Wakes up sniff. The write only fails if the counter is full, in which case it is already awake.
+	u64 value = 1;
+
+	if(mEventFd != -1 && write(mEventFd, &value, sizeof(value)) < 0) {
+		return;
+	}
+
 }
 
 void CanSniffer::setFilters(std::set<CanFilter> filters) {
@@ -33,64 +65,134 @@ void CanSniffer::setFilters(std::set<CanFilter> filters) {
 }
 
 
-void CanSniffer::sniff(u32 timeout) const {
+void CanSniffer::deliver(CommonCanReceiver* receiver, CanFrame* frames, TimeStamp* timestamps, size_t count) const {
+
+	if(mBatchCB) {
+
+		size_t filtered = 0;
+
+		//Filtered in place
+		for(size_t i = 0; i < count; ++i) {
+			if(receiver->filter(frames[i].getId())) {
+				if(filtered != i) {
+					frames[filtered] = frames[i];
+					timestamps[filtered] = timestamps[i];
+				}
+				++filtered;
+			}
+		}
 
-	int result;
-	fd_set rdfs;
-	timeval tv;
+		if(filtered > 0) {
+			(mBatchCB)(frames, timestamps, filtered, receiver->getInterface(), mData);
+		}
 
-	CanFrame canFrame;
-	TimeStamp timestamp;
+	} else {
+
+		for(size_t i = 0; i < count; ++i) {
+			if(receiver->filter(frames[i].getId())) {
+				(mRcvCB)(frames[i], timestamps[i], receiver->getInterface(), mData);
+			}
+		}
+
+	}
+
+}
+
+void CanSniffer::sniff(u32 timeout) const {
 
 	ASSERT(!mReceivers.empty());
-	ASSERT(mRcvCB != nullptr);
+	ASSERT(mRcvCB != nullptr || mBatchCB != nullptr);
 	ASSERT(mTimeoutCB != nullptr);
 
-	do {
+	int epollFd = epoll_create1(EPOLL_CLOEXEC);
 
-		tv.tv_sec = timeout / 1000;
-		tv.tv_usec = (timeout % 1000) / 1000000;
+	if(epollFd == -1)	return;
 
-		do {
+	epoll_event event;
+	size_t watched = 0;
 
-			int maxFd = -1;
-			FD_ZERO(&rdfs);
-			for(auto receiver = mReceivers.begin(); receiver != mReceivers.end(); ++receiver) {
+	//The finish event has no receiver
+	event.events = EPOLLIN;
+	event.data.ptr = nullptr;
 
-				if((*receiver)->getFD() > maxFd){
-					maxFd = (*receiver)->getFD();
-				}
+	if(mEventFd != -1) {
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, mEventFd, &event);
+	}
 
-				FD_SET((*receiver)->getFD(), &rdfs);
-			}
+	//The receivers able to drain their queue are only notified when new frames arrive, the rest while they have frames
+	for(auto receiver = mReceivers.begin(); receiver != mReceivers.end(); ++receiver) {
 
-			if(maxFd == -1)		return;
+		if((*receiver)->getFD() == -1)		continue;
 
-			result = select(maxFd + 1, &rdfs, NULL, NULL, &tv);
+		event.events = EPOLLIN;
 
-		} while (result == -1 && errno == EINTR);
+		if((*receiver)->supportsDrain()) {
+			event.events |= EPOLLET;
+		}
 
-		if (result > 0) {
+		event.data.ptr = *receiver;
 
-			for(auto receiver = mReceivers.begin(); receiver != mReceivers.end(); ++receiver) {
-				if (FD_ISSET((*receiver)->getFD(), &rdfs)) {		//Frame available from interface
+		if(epoll_ctl(epollFd, EPOLL_CTL_ADD, (*receiver)->getFD(), &event) == 0) {
+			++watched;
+		}
+	}
 
+	if(watched == 0) {
+		close(epollFd);
+		return;
+	}
 
-					if((*receiver)->receive(canFrame, timestamp) && (*receiver)->filter(canFrame.getId())) {
+	std::vector<epoll_event> events(mReceivers.size() + 1);
 
-						(mRcvCB)(canFrame, timestamp, (*receiver)->getInterface(), mData);
+	size_t batchSize = (mBatchCB ? mBatchSize : CAN_RECEIVE_BATCH_SIZE);
+	std::vector<CanFrame> frames(batchSize);
+	std::vector<TimeStamp> timestamps(batchSize);
 
-					}
-				}
-			}
+	while(mRunning) {
+
+		int result = epoll_wait(epollFd, events.data(), events.size(), timeout);
+
+		if(result == -1) {
+
+			if(errno == EINTR)		continue;
 
-		} else if (result == 0) {		//Timeout expired
+			break;
+		}
+
+		if(result == 0) {		//Timeout expired
 			(mTimeoutCB)();
+			continue;
 		}
 
-	} while (mRunning);
+		for(int i = 0; i < result && mRunning; ++i) {
+
+			CommonCanReceiver* receiver = static_cast<CommonCanReceiver*>(events[i].data.ptr);
+
+			if(!receiver) {			//Finished, the counter is cleared for the next sniff
+				u64 value;
+				while(read(mEventFd, &value, sizeof(value)) > 0);
+				continue;
+			}
+
+			if(receiver->supportsDrain()) {
+
+				size_t count;
 
+				//Edge triggered, no notification until new frames arrive after the queue is empty
+				while(mRunning && (count = receiver->drain(frames.data(), timestamps.data(), frames.size())) > 0) {
+					deliver(receiver, frames.data(), timestamps.data(), count);
+				}
+
+			} else {
+
+				size_t count = receiver->receive(frames.data(), timestamps.data(), frames.size());
+
+				deliver(receiver, frames.data(), timestamps.data(), count);
+			}
+		}
+	}
 
+	close(epollFd);
 
 }
 
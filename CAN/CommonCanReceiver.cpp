@@ -20,6 +20,14 @@ bool CommonCanReceiver::setFilters(std::set<CanFilter> filters) {
 }
 
 
+size_t CommonCanReceiver::receive(CanFrame* frames, Utils::TimeStamp* timestamps, size_t count) {
+
+	if(count == 0)		return 0;
+
+	return receive(frames[0], timestamps[0]) ? 1 : 0;
+
+}
+
 bool CommonCanReceiver::filter(u32 id) {
 
 	bool filtered = false;
@@ -13,6 +13,20 @@
 
 namespace Can {
 
+namespace {
+
+/*
+ * Nanosecond precision, the milliseconds of Utils::getElapsedMillis may be rounded up
+ */
+bool hasElapsed(const timespec& start, const timespec& now, u32 millis) {
+
+	int64_t elapsed = static_cast<int64_t>(now.tv_sec - start.tv_sec) * 1000000000 + (now.tv_nsec - start.tv_nsec);
+
+	return elapsed >= static_cast<int64_t>(millis) * 1000000;
+}
+
+}
+
 void CommonCanSender::CanFrameRing::setFrames(const std::vector<CanFrame>& frames) {
 
 	mFrames = frames;
@@ -52,7 +66,7 @@ u32 CommonCanSender::CanFrameRing::getCurrentPeriod() const {
 	return period;
 }
 
-CommonCanSender::CommonCanSender() : mFinished(false) {
+CommonCanSender::CommonCanSender() : mFinished(false), mFlushRequested(false) {
 	initialize();
 }
 
@@ -149,11 +163,14 @@ void CommonCanSender::run() {
 
 	timespec now, current;
 	u32 elapsed;
+	bool sent;
 
 	while(!mFinished) {
 
 		clock_gettime(CLOCK_MONOTONIC, &now);
 
+		sent = false;
+
 		mFramesLock.lock();
 
 		for(auto ring = mFrameRings.begin(); ring != mFrameRings.end(); ++ring) {
@@ -172,6 +189,7 @@ void CommonCanSender::run() {
 				}
 
 				_sendFrame(toSend);		//Backend in charge of sending the frame
+				sent = true;
 				ring->shift();		//Move to the next frame
 
 				current = Utils::addMillis(&start, ring->getCurrentPeriod());		//Calculate the time in which the frame should have been sent
@@ -189,6 +207,39 @@ void CommonCanSender::run() {
 			}
 		}
 
+		for(auto queue = mSequenceQueues.begin(); queue != mSequenceQueues.end();) {
+
+			CanFrameSequence& sequence = queue->second.sequences.front();
+			timespec& last = queue->second.txTimestamp;
+
+			//Measured from the frame actually sent, the delays of the thread never shorten the interval
+			if((last.tv_sec == 0 && last.tv_nsec == 0) || hasElapsed(last, now, sequence.getInterval())) {
+
+				_sendFrame(sequence.getCurrentFrame());
+				sent = true;
+				sequence.shift();
+
+				//Taken after the frame is given to the backend, the time spent with the previous ones is not counted
+				clock_gettime(CLOCK_MONOTONIC, &last);
+
+				//The next sequence with the same key waits the interval after the last frame of this one
+				if(sequence.isFinished()) {
+					queue->second.sequences.pop_front();
+				}
+			}
+
+			if(queue->second.sequences.empty()) {
+				queue = mSequenceQueues.erase(queue);
+			} else {
+				++queue;
+			}
+		}
+
+		//Frames of the iteration written together by the backend
+		if(mFlushRequested.exchange(false) || sent) {
+			_flushFrames();
+		}
+
 		mFramesLock.unlock();
 
 		usleep(1000);
@@ -261,4 +312,32 @@ bool CommonCanSender::isSent(u32 id) {
 
 }
 
+bool CommonCanSender::sendSequence(u32 key, std::vector<CanFrame> frames, u32 interval) {
+
+	if(frames.empty())	return false;
+
+	std::lock_guard<std::mutex> lock(mFramesLock);
+
+	mSequenceQueues[key].sequences.emplace_back(std::move(frames), interval);
+
+	return true;
+
+}
+
+void CommonCanSender::unSendSequences(u32 key) {
+
+	std::lock_guard<std::mutex> lock(mFramesLock);
+
+	mSequenceQueues.erase(key);
+
+}
+
+bool CommonCanSender::isSequenceSent(u32 key) {
+
+	std::lock_guard<std::mutex> lock(mFramesLock);
+
+	return mSequenceQueues.find(key) != mSequenceQueues.end();
+
+}
+
 } /* namespace Can */
@@ -27,7 +27,17 @@ public:
 
 	int getFD() override;
 
+	//Batches of a single frame from CommonCanReceiver
+	using CommonCanReceiver::receive;
+
 	bool receive(CanFrame&, Utils::TimeStamp&) override;
+
+	bool supportsDrain() const override { return true; }
+
+	/*
+	 * Reads the queue of the channel until it is empty, skipping the status messages
+	 */
+	size_t drain(CanFrame* frames, Utils::TimeStamp* timestamps, size_t count) override;
 };
 
 } /* namespace PeakCan */
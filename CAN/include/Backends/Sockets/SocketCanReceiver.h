@@ -27,6 +27,26 @@ private:
 	sockaddr_can addr;
 	char ctrlmsg[CMSG_SPACE(sizeof(timeval) + 3*sizeof(timespec) + sizeof(u32))];
 
+	//Buffers of the batch receive, one message per frame filled by a single recvmmsg
+	struct BatchMsg {
+		canfd_frame frame;
+		sockaddr_can addr;
+		iovec iov;
+		char ctrlmsg[CMSG_SPACE(sizeof(timeval) + 3*sizeof(timespec) + sizeof(u32))];
+	};
+
+	BatchMsg mBatch[CAN_RECEIVE_BATCH_SIZE];
+	mmsghdr mBatchHdrs[CAN_RECEIVE_BATCH_SIZE];
+
+	/*
+	 * Takes the timestamp of the ancillary data of a received message
+	 */
+	void extractTimeStamp(msghdr& hdr, Utils::TimeStamp& timestamp) const;
+
+	static void copyFrame(const canfd_frame& frame, CanFrame& canFrame);
+
+	size_t receiveBatch(CanFrame* frames, Utils::TimeStamp* timestamps, size_t count, int flags);
+
 public:
 	SocketCanReceiver(int sock, bool timeStamp);
 	virtual ~SocketCanReceiver();
@@ -39,6 +59,18 @@ public:
 
 	bool receive(CanFrame&, Utils::TimeStamp&) override;
 
+	/*
+	 * Up to CAN_RECEIVE_BATCH_SIZE frames with a single recvmmsg
+	 */
+	size_t receive(CanFrame* frames, Utils::TimeStamp* timestamps, size_t count) override;
+
+	bool supportsDrain() const override { return true; }
+
+	/*
+	 * Same as the batch receive but without waiting for the first frame
+	 */
+	size_t drain(CanFrame* frames, Utils::TimeStamp* timestamps, size_t count) override;
+
 	int getFD() override;
 
 
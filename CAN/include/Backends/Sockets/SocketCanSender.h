@@ -4,17 +4,47 @@
  *  Created on: Apr 1, 2018
  *      Author: famez
  *      Implementation of can sender for the linux sockets layer
+ *
+ *      The frames are queued and written together with sendmmsg, once per iteration of the sender thread or per call
+ *      to sendFrameOnce. If the interface has no room left (ENOBUFS, EAGAIN) they stay queued and are retried with an
+ *      increasing backoff, they are only dropped if the queue is full or the socket fails. Everything is counted.
+ *      On destruction the pending frames are written once more without waiting, the ones left are dropped.
  */
 
 #ifndef BACKENDS_SOCKETS_SOCKETCANSENDER_H_
 #define BACKENDS_SOCKETS_SOCKETCANSENDER_H_
 
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include <time.h>
+
+#include <mutex>
+#include <vector>
+
 #include "../../CommonCanSender.h"
 
+//Frames waiting to be written, the ones beyond are dropped
+#define SOCKET_TX_QUEUE_SIZE		1024
+
+//Frames written by a single sendmmsg
+#define SOCKET_TX_BATCH_SIZE		64
+
+//Time waited before retrying when the interface has no room, doubled up to the maximum, in milliseconds
+#define SOCKET_TX_MIN_BACKOFF		1
+#define SOCKET_TX_MAX_BACKOFF		64
+
 namespace Can {
 namespace Sockets {
 
-
+struct SocketTxStats {
+	u64 framesSent = 0;
+	u64 writeCalls = 0;				//sendmmsg calls
+	u64 shortWrites = 0;			//Calls that wrote only part of the frames
+	u64 noBufferErrors = 0;			//Calls without room in the interface (ENOBUFS or EAGAIN), retried
+	u64 writeErrors = 0;			//Other errors, the frames of the call are dropped
+	u64 droppedFrames = 0;			//Because of write errors or a full queue
+};
 
 class SocketCanSender : public CommonCanSender {
 private:
@@ -23,12 +53,41 @@ private:
 	 */
 	int mSock;
 
+	mutable std::mutex mTxLock;
+
+	//Frames from mTxHead on are pending
+	mutable std::vector<can_frame> mTxQueue;
+	mutable size_t mTxHead;
+
+	mutable mmsghdr mTxHdrs[SOCKET_TX_BATCH_SIZE];
+	mutable iovec mTxIovs[SOCKET_TX_BATCH_SIZE];
+
+	//No retry before mRetryTime while backing off
+	mutable u32 mBackoff;
+	mutable timespec mRetryTime;
+
+	mutable SocketTxStats mStats;
+
+	/*
+	 * Writes the pending frames, the lock must be held
+	 */
+	void writePending() const;
+
 protected:
 	void _sendFrame(const CanFrame& frame) const override;
+	void _flushFrames() const override;
+
 public:
 	SocketCanSender(int sock);
 	virtual ~SocketCanSender();
 
+	/*
+	 * Frames queued and not written yet
+	 */
+	size_t getPendingFrames() const;
+
+	SocketTxStats getTxStats() const;
+
 };
 
 } /* namespace Sockets */
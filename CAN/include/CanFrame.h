@@ -8,38 +8,98 @@
 #ifndef CANFRAME_H_
 #define CANFRAME_H_
 
+#include <string.h>
+
 #include <string>
+#include <type_traits>
+
 #include <Types.h>
 
 #define MAX_CAN_DATA_SIZE		8
 
 namespace Can {
 
+/*
+ * Read only view of the payload of a frame, valid while the frame is. It has the members of std::string used by the
+ * callers of the former getData, which returned one, and converts to std::string when a copy is needed.
+ */
+class CanDataView {
+private:
+	const u8* mData;
+	size_t mLength;
+
+public:
+	CanDataView(const u8* data, size_t length) : mData(data), mLength(length) {}
+
+	const u8* data() const { return mData; }
+
+	/*
+	 * Same pointer as data, not null terminated
+	 */
+	const char* c_str() const { return reinterpret_cast<const char*>(mData); }
+
+	size_t size() const { return mLength; }
+	size_t length() const { return mLength; }
+	bool empty() const { return mLength == 0; }
+
+	u8 operator[](size_t index) const { return mData[index]; }
+
+	const u8* begin() const { return mData; }
+	const u8* end() const { return mData + mLength; }
+
+	operator std::string() const { return std::string(c_str(), mLength); }
+
+	bool operator==(const CanDataView& other) const { return mLength == other.mLength && memcmp(mData, other.mData, mLength) == 0; }
+	bool operator!=(const CanDataView& other) const { return !(*this == other); }
+
+	bool operator==(const std::string& other) const { return *this == CanDataView(reinterpret_cast<const u8*>(other.data()), other.size()); }
+	bool operator!=(const std::string& other) const { return !(*this == other); }
+
+};
+
+/*
+ * Trivially copyable, the payload is stored inline. Frames can be kept in flat vectors and ring buffers and copied
+ * with no allocations.
+ */
 class CanFrame {
 private:
 
-	bool mExtendedFormat;
 	u32 mId;
-	std::string mData;
+	bool mExtendedFormat;
+	u8 mLength;
+	u8 mData[MAX_CAN_DATA_SIZE];
 
 public:
-	CanFrame();
-	CanFrame(bool extFormat, u32 id) : mExtendedFormat(extFormat), mId(id) {}
-	CanFrame(bool extFormat, u32 id, const std::string& data) : mExtendedFormat(extFormat), mId(id) { setData(data); }
-	virtual ~CanFrame();
+	CanFrame() : mId(0), mExtendedFormat(false), mLength(0) {}
+	CanFrame(bool extFormat, u32 id) : mId(id), mExtendedFormat(extFormat), mLength(0) {}
+	CanFrame(bool extFormat, u32 id, const u8* data, size_t length) : mId(id), mExtendedFormat(extFormat), mLength(0) { setData(data, length); }
+	CanFrame(bool extFormat, u32 id, const std::string& data) : mId(id), mExtendedFormat(extFormat), mLength(0) { setData(data); }
 
-	const std::string& getData() const {
-		return mData;
+	CanDataView getData() const {
+		return CanDataView(mData, mLength);
 	}
 
-	bool setData(const std::string& data) {
+	/*
+	 * Returns false, keeping the current payload, if it is longer than MAX_CAN_DATA_SIZE
+	 */
+	bool setData(const u8* data, size_t length) {
 
-		if(data.size() > MAX_CAN_DATA_SIZE)
+		if(length > MAX_CAN_DATA_SIZE)
 			return false;
-		mData = data;
+
+		memcpy(mData, data, length);
+		mLength = length;
 		return true;
 	}
 
+	bool setData(const std::string& data) {
+		return setData(reinterpret_cast<const u8*>(data.data()), data.size());
+	}
+
+	bool setData(const CanDataView& data) {
+		return setData(data.data(), data.size());
+	}
+
 	u32 getId() const {
 		return mId;
 	}
@@ -48,7 +108,7 @@ public:
 		mId = id;
 	}
 
-	void clear() { mId = 0; mData.clear(); }
+	void clear() { mId = 0; mLength = 0; }
 
 	bool isExtendedFormat() const {
 		return mExtendedFormat;
@@ -65,6 +125,8 @@ public:
 	
 };
 
+static_assert(std::is_trivially_copyable<CanFrame>::value, "CanFrame must be trivially copyable");
+
 } /* namespace Can */
 
 #endif /* CANFRAME_H_ */
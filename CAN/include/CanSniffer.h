@@ -8,6 +8,7 @@
 #ifndef CANSNIFFER_H_
 #define CANSNIFFER_H_
 
+#include <atomic>
 #include <vector>
 
 #include "CommonCanReceiver.h"
@@ -16,18 +17,34 @@
 typedef void (*OnReceiveFramePtr)(const Can::CanFrame& frame, const Utils::TimeStamp& tStamp, const std::string& interface, void* data);
 typedef bool (*OnTimeoutPtr)();
 
+/*
+ * Frames received together from an interface, already filtered, with their timestamps
+ */
+typedef void (*OnReceiveBatchPtr)(const Can::CanFrame* frames, const Utils::TimeStamp* tStamps, size_t count,
+		const std::string& interface, void* data);
+
 namespace Can {
 
 class CanSniffer {
 private:
 	OnReceiveFramePtr mRcvCB = nullptr;
 	OnTimeoutPtr mTimeoutCB = nullptr;
+	OnReceiveBatchPtr mBatchCB = nullptr;
+	size_t mBatchSize = CAN_RECEIVE_BATCH_SIZE;
 	void* mData = nullptr;		//Data to be passed to the OnReceiveFramePtr callback
 	std::vector<CommonCanReceiver*> mReceivers;
-	bool mRunning = true;
+	std::atomic<bool> mRunning;
+
+	//Wakes up the loop of sniff when finish is called
+	int mEventFd = -1;
+
+	/*
+	 * Gives the received frames that pass the filters of the receiver to the callbacks
+	 */
+	void deliver(CommonCanReceiver* receiver, CanFrame* frames, Utils::TimeStamp* timestamps, size_t count) const;
 
 public:
-	CanSniffer() {}
+	CanSniffer();
 	CanSniffer(OnReceiveFramePtr recvCB, OnTimeoutPtr timeoutCB, void* data = nullptr);
 	CanSniffer(const CanFilter &other) = delete;
 	CanSniffer(CanFilter &&other) = delete;
@@ -40,13 +57,32 @@ public:
 	 * Add a receiver from where to receive the frames. CanSniffer becomes the owner and will deallocate the receiver.
 	 */
 	void addReceiver(CommonCanReceiver *receiver) { mReceivers.push_back(receiver); }
+	/*
+	 * Receives from all the receivers until finish is called. The timeout callback is called every time no frame is
+	 * received during timeout milliseconds. The receivers that support it are drained edge triggered.
+	 */
 	void sniff(u32 timeout) const;
 	void setFilters(std::set<CanFilter> filters);
 	int getNumberOfReceivers() const { return mReceivers.size(); }
 	void reset() { mRunning = true; }
-	void finish() { mRunning = false; }
+	/*
+	 * Makes sniff return, it can be called from any thread or from the callbacks
+	 */
+	void finish();
 	void setOnRecv(OnReceiveFramePtr recvCB) { mRcvCB = recvCB; }
 	void setOnTimeout(OnTimeoutPtr timeoutCB) { mTimeoutCB = timeoutCB; }
+
+	/*
+	 * Batch mode: the frames available in an interface are received at once, with a single system call in the
+	 * backends that support it, and given together to the batch callback instead of the receive callback.
+	 * Null goes back to a frame at a time.
+	 */
+	void setOnRecvBatch(OnReceiveBatchPtr batchCB) { mBatchCB = batchCB; }
+
+	/*
+	 * Maximum frames of a batch, CAN_RECEIVE_BATCH_SIZE by default
+	 */
+	void setBatchSize(size_t batchSize) { mBatchSize = (batchSize > 0 ? batchSize : 1); }
 	void setData(void* data) { mData = data; }
 
 };
@@ -15,6 +15,9 @@
 #include <CanFilter.h>
 #include <CanFrame.h>
 
+//Frames taken at most by a batch receive of the backends that support it
+#define CAN_RECEIVE_BATCH_SIZE		64
+
 namespace Can {
 
 class CommonCanReceiver {
@@ -40,6 +43,24 @@ public:
 
 	virtual bool receive(CanFrame&, Utils::TimeStamp&) = 0;
 
+	/*
+	 * Receives up to count frames with their timestamps, waiting only for the first one. Returns the number of frames
+	 * received. The default implementation receives a single frame, the backends that can take several frames from
+	 * the driver at once override it.
+	 */
+	virtual size_t receive(CanFrame* frames, Utils::TimeStamp* timestamps, size_t count);
+
+	/*
+	 * Backends able to receive without waiting, which can be watched edge triggered and drained
+	 */
+	virtual bool supportsDrain() const { return false; }
+
+	/*
+	 * Receives up to count frames already queued in the backend without waiting. Returns 0 once there is none left,
+	 * even if some frames were skipped. Only called if supportsDrain returns true.
+	 */
+	virtual size_t drain(CanFrame* /*frames*/, Utils::TimeStamp* /*timestamps*/, size_t /*count*/) { return 0; }
+
 	virtual bool filter(u32 id);
 
 	const std::string& getInterface() const { return mInterface; }
@@ -11,10 +11,13 @@
 
 
 #include <vector>
+#include <deque>
+#include <map>
 #include <memory>
 
 #include <thread>
 #include <mutex>
+#include <atomic>
 
 #include <time.h>
 
@@ -58,14 +61,51 @@ private:
 
 	};
 
+	class CanFrameSequence {
+	private:
+		std::vector<CanFrame> mFrames;
+		u32 mInterval;
+		size_t mCurrentpos;
+	public:
+		CanFrameSequence(std::vector<CanFrame>&& frames, u32 interval) : mFrames(std::move(frames)), mInterval(interval), mCurrentpos(0) {}
+
+		bool isFinished() const { return mCurrentpos >= mFrames.size(); }
+		const CanFrame& getCurrentFrame() const { return mFrames[mCurrentpos]; }
+		void shift() { ++mCurrentpos; }
+		u32 getInterval() const { return mInterval; }
+
+	};
+
+	/*
+	 * Sequences with the same key, only the first one is being sent
+	 */
+	struct SequenceQueue {
+		std::deque<CanFrameSequence> sequences;
+		timespec txTimestamp = {0, 0};			//Last frame sent with the key
+	};
+
 	mutable std::mutex mFramesLock;
 	std::vector<CanFrameRing> mFrameRings;
-	bool mFinished;
+	std::map<u32, SequenceQueue> mSequenceQueues;
+	std::atomic<bool> mFinished;
+	mutable std::atomic<bool> mFlushRequested;
 	std::unique_ptr<std::thread> mThread = nullptr;
 
 protected:
 	virtual void _sendFrame(const CanFrame& frame) const = 0;
 
+	/*
+	 * Called once the frames due in an iteration of the sender thread, or the one of sendFrameOnce, have been given to
+	 * _sendFrame, for the backends that queue them to write them together
+	 */
+	virtual void _flushFrames() const {}
+
+	/*
+	 * Makes the sender thread call _flushFrames in its next iteration even if there is nothing to send, for the
+	 * backends that could not write all their queued frames
+	 */
+	void requestFlush() const { mFlushRequested = true; }
+
 public:
 	CommonCanSender();
 	virtual ~CommonCanSender();
@@ -79,11 +119,14 @@ public:
 	/*
 	 * Sends the frame given as argument to the CAN network only once.
 	 */
-	void sendFrameOnce(const CanFrame& frame) override { _sendFrame(frame); }
+	void sendFrameOnce(const CanFrame& frame) override { _sendFrame(frame); _flushFrames(); }
 	void unSendFrame(u32 id);
 	void unSendFrames(const std::vector<u32>& ids);
 	bool isSent(const std::vector<u32>& ids);
 	bool isSent(u32 id);
+	bool sendSequence(u32 key, std::vector<CanFrame> frames, u32 interval) override;
+	void unSendSequences(u32 key) override;
+	bool isSequenceSent(u32 key) override;
 
 	void run();
 
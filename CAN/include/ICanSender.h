@@ -61,6 +61,23 @@ public:
 	 */
 	virtual bool isSent(u32 id) = 0;
 
+	/*
+	 * Sends the frames only once, in the order defined in the vector, waiting at least the given interval in
+	 * milliseconds between two frames. Sequences with the same key are sent one after the other, sequences with
+	 * different keys are interleaved.
+	 */
+	virtual bool sendSequence(u32 key, std::vector<CanFrame> frames, u32 interval) = 0;
+
+	/*
+	 * Drops the sequences with the given key that have not been completely sent
+	 */
+	virtual void unSendSequences(u32 key) = 0;
+
+	/*
+	 * Returns true while there are frames of sequences with the given key to be sent
+	 */
+	virtual bool isSequenceSent(u32 key) = 0;
+
 };
 
 } /* namespace Can */
@@ -9,9 +9,22 @@
 #define ICLONEABLE_H_
 
 
+#include <stddef.h>
+#include <new>
+
+
 #define IMPLEMENT_CLONEABLE(CLASS, SUBCLASS)		\
 	virtual CLASS* clone() const {								\
 		return new SUBCLASS(*this);				\
+	}											\
+	virtual CLASS* cloneAt(void* buffer) const {				\
+		return new (buffer) SUBCLASS(*this);	\
+	}											\
+	virtual size_t getCloneSize() const {						\
+		return sizeof(SUBCLASS);				\
+	}											\
+	virtual size_t getCloneAlignment() const {					\
+		return alignof(SUBCLASS);				\
 	}
 
 template<class T>
@@ -22,6 +35,15 @@ public:
 
 	virtual T* clone() const = 0;
 
+	/*
+	 * Copy constructs the object in the given buffer, which must have getCloneSize() bytes aligned to getCloneAlignment()
+	 */
+	virtual T* cloneAt(void* buffer) const = 0;
+
+	virtual size_t getCloneSize() const = 0;
+
+	virtual size_t getCloneAlignment() const = 0;
+
 };
 
 #endif /* ICLONEABLE_H_ */
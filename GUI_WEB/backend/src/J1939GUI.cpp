@@ -19,10 +19,14 @@ extern "C" {
 
 //J1939 libraries
 #include <J1939DataBase.h>
+#include <BinaryDataBase.h>
 #include <J1939Factory.h>
 #include <GenericFrame.h>
 #include <Transport/BAM/BamFragmenter.h>
 #include <Transport/BAM/BamReassembler.h>
+#include <Transport/TPCMFrame.h>
+#include <Transport/TPDTFrame.h>
+#include <ChangeDetector.h>
 #include <Diagnosis/Frames/DM1.h>
 #include <SPN/SPNNumeric.h>
 #include <SPN/SPNStatus.h>
@@ -40,6 +44,10 @@ extern "C" {
 #define DATABASE_PATH		"/etc/j1939/frames.json"
 #endif
 
+#ifndef BINARY_DATABASE_PATH
+#define BINARY_DATABASE_PATH	"/etc/j1939/frames.j1939db"
+#endif
+
 
 #define J1939_RX_BUFFER_BYTES (1024)
 
@@ -121,8 +129,8 @@ BamReassembler reassembler;
 std::unique_ptr<std::thread> rxThread = nullptr;
 std::mutex rxLock;
 
-//Cached received frames to avoid processing frames that did not change
-std::map<u32/*Can ID*/, CanFrame> rcvFramesCache;
+//Last payload of the received frames to avoid processing frames that did not change
+ChangeDetector changeDetector;
 
 //To track how many frames have been received
 std::map<u32/*Can ID*/, u32/*Count*/> rcvFramesCount;
@@ -597,10 +605,12 @@ int main(int argc, char *argv[]) {
 
 	//Initialization of J1939 Framework
 
-	//Read database if available
+	//Read database if available, the precompiled one is mapped straight into the factory if it is installed
 	J1939DataBase database;
+	bool binaryLoaded = BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_PATH) &&
+			J1939Factory::getInstance().registerDatabaseFrames(BINARY_DATABASE_PATH);
 
-	if(!database.parseJsonFile(DATABASE_PATH)) {
+	if(!binaryLoaded && !database.parseJsonFile(DATABASE_PATH)) {
 		std::cerr << "Database not found in " << DATABASE_PATH << std::endl;
 		return 1;
 	}
@@ -608,9 +618,7 @@ int main(int argc, char *argv[]) {
 	const std::vector<GenericFrame>& ddbbFrames = database.getParsedFrames();
 
 	//Register all the frames listed in the database
-	for(auto iter = ddbbFrames.begin(); iter != ddbbFrames.end(); ++iter) {
-		J1939Factory::getInstance().registerFrame(*iter);
-	}
+	J1939Factory::getInstance().registerFrames(ddbbFrames.begin(), ddbbFrames.end());
 
 
 	//Initialize can
@@ -880,8 +888,19 @@ void onRcv(const CanFrame& frame, const TimeStamp& ts, const std::string& interf
 	rxFrames["rx"][std::to_string(frame.getId())]["count"] = ++rcvFramesCount[frame.getId()];
 	rxLock.unlock();
 	
-	if(rcvFramesCache.find(frame.getId()) != rcvFramesCache.end() && 
-			frame.getData() == rcvFramesCache[frame.getId()].getData()) {
+	ChangeResult change;
+	u32 pgn = getPGNFromId(frame.getId());
+
+	//Frames of the transport protocol are not filtered, the reassembler needs all of them
+	if(pgn == TP_CM_PGN || pgn == TP_DT_PGN) {
+		change.status = FRAME_NOT_TRACKED;
+		change.changedSPNs = 0;
+		change.layout = nullptr;
+	} else {
+		change = changeDetector.update(frame.getId(), (const u8*)(frame.getData().c_str()), frame.getData().size());
+	}
+
+	if(change.status == FRAME_UNCHANGED) {
 		
 		//The raw data is exactly the same.
 		return;
@@ -897,7 +916,8 @@ void onRcv(const CanFrame& frame, const TimeStamp& ts, const std::string& interf
 		if(showRaw) {
 			std::unique_lock<std::mutex> lock(rxLock);
 			rxFrames["rx"][std::to_string(frame.getId())]["raw"] = frame.hexDump();
-			rcvFramesCache[frame.getId()] = frame;
+		} else {
+			changeDetector.erase(frame.getId());		//Not shown, to be processed again if the raw frames are enabled
 		}
 		
 		
@@ -928,16 +948,22 @@ void onRcv(const CanFrame& frame, const TimeStamp& ts, const std::string& interf
 		if(j1939Frame->isGenericFrame()) {
 			GenericFrame *genFrame = static_cast<GenericFrame *>(j1939Frame.get());
 
-			std::set<SPN*> spns = genFrame->compare(frame.getData(), rcvFramesCache[frame.getId()].getData());
+			if(change.layout) {
+				//Only the SPNs whose bits changed
+				ChangeDetector::forEachChangedSPN(change, [&](size_t, const SPNExtractOp& op) {
+					const SPN* spn = genFrame->getSPN(op.spnNumber);
+					if(spn) {
+						saveToHistory(j1939Frame->getIdentifier(), *spn, ts);
+					}
+				});
+			} else {
+				std::set<u32> spnNumbers = genFrame->getSPNNumbers();
 
-			for(auto iter = spns.begin(); iter != spns.end(); ++iter) {
-				saveToHistory(j1939Frame->getIdentifier(), **iter, ts);
+				for(auto iter = spnNumbers.begin(); iter != spnNumbers.end(); ++iter) {
+					saveToHistory(j1939Frame->getIdentifier(), *genFrame->getSPN(*iter), ts);
+				}
 			}
 		}
-
-		//Only save in cache unfragmented frames to avoid filtering frames that are part of BAM protocol. 
-		//Frames whose length is bigger than 8 bytes are not cached, because the TX rate is usually several seconds. 
-		rcvFramesCache[frame.getId()] = frame;
 	}
 	
 	//At this point we have either a simple frame or a reassembled frame.
@@ -1006,7 +1032,7 @@ Json::Value frameToJson(const J1939Frame* frame) {
 
 				jsonVal["spns"][j]["value"] = spnStat->getValue();
 
-				SPNStatus::DescMap descriptions = spnStat->getValueDescriptionsMap();
+				const SPNStatus::DescMap& descriptions = spnStat->getValueDescriptionsMap();
 
 				for(auto desc = descriptions.begin(); desc != descriptions.end(); ++desc) {
 
@@ -1071,7 +1097,7 @@ void resetReceiver() {
 		sniffer.finish();
 		rxThread->join();
 
-		rcvFramesCache.clear();
+		changeDetector.clear();
 		rcvFramesCount.clear();
 
 	}
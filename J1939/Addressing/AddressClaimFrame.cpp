@@ -32,9 +32,19 @@ AddressClaimFrame::~AddressClaimFrame() {
 
 void AddressClaimFrame::decodeData(const u8* buffer, size_t length) {
 
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[AddressClaimFrame::decodeData] ") + getCodecStatusDescription(status) +
+				". Buffer length: " + std::to_string(length));
+	}
+
+}
+
+ECodecStatus AddressClaimFrame::tryDecodeData(const u8* buffer, size_t length) {
+
 	if(length != ADDRESS_FRAME_LENGTH) {		//Check the length first
-		throw  J1939DecodeException("[AdressClaimFrame::decodeData] Buffer length does "
-				"not match the expected length. Buffer length:" + std::to_string(length) + ". Expected length: " + std::to_string(ADDRESS_FRAME_LENGTH));
+		return CODEC_INVALID_LENGTH;
 	}
 
 	u32 idNumber = ( buffer[0] |
@@ -64,6 +74,8 @@ void AddressClaimFrame::decodeData(const u8* buffer, size_t length) {
 	mEcuName = EcuName(idNumber, manufacturerCode, ecuInstance, functionInstance, function,
 			vehicleSystem, vehicleSystemInstance, industryGroup, arbitraryAddressCapable);
 
+	return CODEC_OK;
+
 }
 
 
@@ -0,0 +1,83 @@
+/*
+ * AddressTable.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <Addressing/AddressTable.h>
+
+namespace J1939 {
+
+void AddressTable::update(const AddressClaimFrame& claim) {
+
+	const EcuName& name = claim.getEcuName();
+	u8 previous;
+
+	//The ECU moved to another address or lost it
+	if(getAddress(name, previous) && previous != claim.getSrcAddr()) {
+		release(previous);
+	}
+
+	if(claim.getSrcAddr() >= J1939_INVALID_ADDRESS) {		//Cannot claim address or broadcast
+		return;
+	}
+
+	Entry& entry = mEntries[claim.getSrcAddr()];
+
+	if(!entry.claimed) {
+		entry.claimed = true;
+		++mCount;
+	}
+
+	entry.name = name;
+
+}
+
+bool AddressTable::getName(u8 address, EcuName& name) const {
+
+	if(!mEntries[address].claimed) {
+		return false;
+	}
+
+	name = mEntries[address].name;
+
+	return true;
+
+}
+
+bool AddressTable::getAddress(const EcuName& name, u8& address) const {
+
+	u64 value = name.getValue();
+
+	for(u32 i = 0; i < ADDRESS_TABLE_SIZE && mCount > 0; ++i) {
+		if(mEntries[i].claimed && mEntries[i].name.getValue() == value) {
+			address = i;
+			return true;
+		}
+	}
+
+	return false;
+
+}
+
+void AddressTable::release(u8 address) {
+
+	if(mEntries[address].claimed) {
+		mEntries[address].claimed = false;
+		--mCount;
+	}
+
+}
+
+void AddressTable::clear() {
+
+	for(u32 i = 0; i < ADDRESS_TABLE_SIZE; ++i) {
+		mEntries[i].claimed = false;
+	}
+
+	mCount = 0;
+
+}
+
+} /* namespace J1939 */
@@ -0,0 +1,284 @@
+/*
+ * BatchDecoder.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <BatchDecoder.h>
+#include <J1939Factory.h>
+#include <SPN/SPN.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BATCH_DECODER_X86
+#include <immintrin.h>
+#endif
+
+
+/*
+ * Values up to 2^52 can be converted from integer to double by setting them as the mantissa of 2^52 and subtracting 2^52.
+ * The masks of the SPNs are 32 bits at most.
+ */
+#define DOUBLE_MAGIC_BITS		0x4330000000000000ULL
+#define DOUBLE_MAGIC			4503599627370496.0
+
+
+namespace J1939 {
+
+namespace {
+
+void scalarKernel(const u64* payloads, size_t count, u32 bitShift, u64 mask, double gain, double offset, double* out) {
+
+	for(size_t i = 0; i < count; ++i) {
+		out[i] = static_cast<double>((payloads[i] >> bitShift) & mask) * gain + offset;
+	}
+
+}
+
+#ifdef BATCH_DECODER_X86
+
+__attribute__((target("sse2")))
+void sse2Kernel(const u64* payloads, size_t count, u32 bitShift, u64 mask, double gain, double offset, double* out) {
+
+	const __m128i shift = _mm_cvtsi32_si128(bitShift);
+	const __m128i maskVec = _mm_set1_epi64x(mask);
+	const __m128i magicBits = _mm_set1_epi64x(DOUBLE_MAGIC_BITS);
+	const __m128d magic = _mm_set1_pd(DOUBLE_MAGIC);
+	const __m128d gainVec = _mm_set1_pd(gain);
+	const __m128d offsetVec = _mm_set1_pd(offset);
+
+	size_t i = 0;
+
+	for(; i + 2 <= count; i += 2) {
+
+		__m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(payloads + i));
+
+		raw = _mm_and_si128(_mm_srl_epi64(raw, shift), maskVec);
+
+		__m128d value = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(raw, magicBits)), magic);
+
+		_mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(value, gainVec), offsetVec));
+	}
+
+	scalarKernel(payloads + i, count - i, bitShift, mask, gain, offset, out + i);
+
+}
+
+__attribute__((target("avx2")))
+void avx2Kernel(const u64* payloads, size_t count, u32 bitShift, u64 mask, double gain, double offset, double* out) {
+
+	const __m128i shift = _mm_cvtsi32_si128(bitShift);
+	const __m256i maskVec = _mm256_set1_epi64x(mask);
+	const __m256i magicBits = _mm256_set1_epi64x(DOUBLE_MAGIC_BITS);
+	const __m256d magic = _mm256_set1_pd(DOUBLE_MAGIC);
+	const __m256d gainVec = _mm256_set1_pd(gain);
+	const __m256d offsetVec = _mm256_set1_pd(offset);
+
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4) {
+
+		__m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(payloads + i));
+
+		raw = _mm256_and_si256(_mm256_srl_epi64(raw, shift), maskVec);
+
+		__m256d value = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(raw, magicBits)), magic);
+
+		//Multiplication and addition are not fused to get the same results as the scalar kernel
+		_mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(value, gainVec), offsetVec));
+	}
+
+	scalarKernel(payloads + i, count - i, bitShift, mask, gain, offset, out + i);
+
+}
+
+#endif
+
+}
+
+
+PGNColumns::PGNColumns(u32 pgn, std::shared_ptr<const FrameLayout> layout) : mPgn(pgn), mLayout(layout),
+		mColumns(layout->getSPNCount()) {
+}
+
+const std::vector<double>* PGNColumns::getSPNColumn(u32 spnNumber) const {
+
+	int index = mLayout->getSPNIndex(spnNumber);
+
+	return (index < 0 ? nullptr : &(mColumns[index]));
+}
+
+void PGNColumns::clear() {
+
+	mPayloads.clear();
+	mTimestamps.clear();
+	mSrcAddrs.clear();
+
+	for(auto column = mColumns.begin(); column != mColumns.end(); ++column) {
+		column->clear();
+	}
+
+}
+
+
+BatchDecoder::BatchDecoder(EBatchKernel kernel, J1939Factory* factory) : mKernel(scalarKernel), mKernelType(BATCH_KERNEL_SCALAR),
+		mFactory(factory ? factory : &J1939Factory::getInstance()), mDecodedFrames(0), mSkippedFrames(0) {
+
+	setKernel(kernel);
+
+}
+
+bool BatchDecoder::isKernelSupported(EBatchKernel kernel) {
+
+	switch(kernel) {
+	case BATCH_KERNEL_AUTO:
+	case BATCH_KERNEL_SCALAR:
+		return true;
+#ifdef BATCH_DECODER_X86
+	case BATCH_KERNEL_SSE2:
+		return __builtin_cpu_supports("sse2");
+	case BATCH_KERNEL_AVX2:
+		return __builtin_cpu_supports("avx2");
+#endif
+	default:
+		return false;
+	}
+
+}
+
+bool BatchDecoder::setKernel(EBatchKernel kernel) {
+
+	if(!isKernelSupported(kernel)) {
+		return false;
+	}
+
+	if(kernel == BATCH_KERNEL_AUTO) {
+		if(isKernelSupported(BATCH_KERNEL_AVX2)) {
+			kernel = BATCH_KERNEL_AVX2;
+		} else if(isKernelSupported(BATCH_KERNEL_SSE2)) {
+			kernel = BATCH_KERNEL_SSE2;
+		} else {
+			kernel = BATCH_KERNEL_SCALAR;
+		}
+	}
+
+	switch(kernel) {
+#ifdef BATCH_DECODER_X86
+	case BATCH_KERNEL_SSE2:
+		mKernel = sse2Kernel;
+		break;
+	case BATCH_KERNEL_AVX2:
+		mKernel = avx2Kernel;
+		break;
+#endif
+	default:
+		mKernel = scalarKernel;
+		break;
+	}
+
+	mKernelType = kernel;
+
+	return true;
+
+}
+
+PGNColumns* BatchDecoder::getGroup(u32 pgn) {
+
+	PGNColumns* group = mGroupTable.find(pgn);
+
+	if(group) {
+		return group;
+	}
+
+	std::shared_ptr<const FrameLayout> layout = mFactory->getFrameLayout(pgn);
+
+	//Only the frames that fit in a single CAN frame can be decoded in batch
+	if(!layout || layout->getMinLength() > J1939_MAX_SIZE) {
+		return nullptr;
+	}
+
+	group = &(mGroups.insert(std::make_pair(pgn, PGNColumns(pgn, layout))).first->second);
+
+	mGroupTable.set(pgn, group);
+
+	return group;
+
+}
+
+size_t BatchDecoder::decode(const RawFrame* frames, size_t count) {
+
+	size_t decoded = 0;
+
+	//First pass, group the payloads by PGN
+	for(const RawFrame* frame = frames; frame != frames + count; ++frame) {
+
+		PGNColumns* group = getGroup(getPGNFromId(frame->id));
+
+		if(!group || frame->length < group->mLayout->getMinLength() || frame->length > J1939_MAX_SIZE) {
+			++mSkippedFrames;
+			continue;
+		}
+
+		u64 payload = 0;
+
+		for(u8 i = 0; i < frame->length; ++i) {
+			payload |= (static_cast<u64>(frame->data[i]) << (i * 8));
+		}
+
+		group->mPayloads.push_back(payload);
+		group->mTimestamps.push_back(frame->timestamp);
+		group->mSrcAddrs.push_back(frame->id & J1939_SRC_ADDR_MASK);
+
+		++decoded;
+	}
+
+	//Second pass, extract the new rows of every group column by column
+	for(auto iter = mGroups.begin(); iter != mGroups.end(); ++iter) {
+
+		PGNColumns& group = iter->second;
+
+		size_t first = (group.mColumns.empty() ? group.mPayloads.size() : group.mColumns[0].size());
+		size_t rows = group.mPayloads.size() - first;
+
+		if(rows == 0) {
+			continue;
+		}
+
+		const u64* payloads = group.mPayloads.data() + first;
+
+		for(size_t index = 0; index < group.mColumns.size(); ++index) {
+
+			const SPNExtractOp& op = group.mLayout->getOp(index);
+			std::vector<double>& column = group.mColumns[index];
+
+			column.resize(first + rows);
+
+			mKernel(payloads, rows, op.offset * 8 + op.shift, op.mask, op.gain, op.formatOffset, column.data() + first);
+		}
+
+	}
+
+	mDecodedFrames += decoded;
+
+	return decoded;
+
+}
+
+const PGNColumns* BatchDecoder::getColumns(u32 pgn) const {
+
+	return mGroupTable.find(pgn);
+
+}
+
+void BatchDecoder::clear() {
+
+	for(auto iter = mGroups.begin(); iter != mGroups.end(); ++iter) {
+		iter->second.clear();
+	}
+
+	mDecodedFrames = 0;
+	mSkippedFrames = 0;
+
+}
+
+} /* namespace J1939 */
@@ -0,0 +1,494 @@
+/*
+ * BinaryDataBase.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <BinaryDataBase.h>
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+#include <GenericFrame.h>
+#include <FrameLayout.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+#include <SPN/SPNString.h>
+
+
+namespace J1939 {
+
+namespace {
+
+/*
+ * String table where every string is stored only once
+ */
+class StringTable {
+
+private:
+	std::string mData;
+	std::map<std::string, u32> mOffsets;
+
+public:
+	u32 add(const std::string& str) {
+
+		auto iter = mOffsets.find(str);
+
+		if(iter != mOffsets.end()) {
+			return iter->second;
+		}
+
+		u32 offset = mData.size();
+
+		mData.append(str.c_str(), str.size() + 1);
+		mOffsets[str] = offset;
+
+		return offset;
+	}
+
+	const std::string& getData() const { return mData; }
+
+};
+
+template<class T>
+void writeRecords(std::ofstream& ofs, const std::vector<T>& records) {
+
+	if(!records.empty()) {
+		ofs.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+	}
+
+}
+
+}
+
+
+BinaryDataBase::BinaryDataBase() : mData(nullptr), mSize(0), mHeader(nullptr), mFrames(nullptr), mSPNs(nullptr),
+		mDescs(nullptr), mStrings(nullptr), mErrorCode(ERROR_OK) {
+
+}
+
+BinaryDataBase::~BinaryDataBase() {
+
+	close();
+
+}
+
+bool BinaryDataBase::compile(const std::vector<GenericFrame>& frames, const std::string& file) {
+
+	std::vector<BinaryFrameRecord> frameRecords;
+	std::vector<BinarySPNRecord> spnRecords;
+	std::vector<BinaryDescRecord> descRecords;
+	StringTable strings;
+
+	//Stable sort to keep the first definition of every PGN first, as J1939Factory does when registering the frames
+	std::vector<const GenericFrame*> sorted;
+
+	for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+		sorted.push_back(&(*frame));
+	}
+
+	std::stable_sort(sorted.begin(), sorted.end(), [](const GenericFrame* a, const GenericFrame* b) { return a->getPGN() < b->getPGN(); });
+
+	for(auto frame = sorted.begin(); frame != sorted.end(); ++frame) {
+
+		BinaryFrameRecord frameRecord;
+		memset(&frameRecord, 0, sizeof(frameRecord));
+
+		frameRecord.pgn = (*frame)->getPGN();
+		frameRecord.name = strings.add((*frame)->getName());
+		frameRecord.length = (*frame)->mLength;
+		frameRecord.firstSPN = spnRecords.size();
+
+		std::set<u32> numbers = (*frame)->getSPNNumbers();
+
+		for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+
+			const SPN* spn = (*frame)->getSPN(*number);
+
+			BinarySPNRecord spnRecord;
+			memset(&spnRecord, 0, sizeof(spnRecord));
+
+			spnRecord.number = spn->getSpnNumber();
+			spnRecord.name = strings.add(spn->getName());
+			spnRecord.type = spn->getType();
+			spnRecord.units = strings.add("");
+
+			switch(spn->getType()) {
+			case SPN::SPN_NUMERIC: {
+				const SPNNumeric* spnNum = static_cast<const SPNNumeric*>(spn);
+
+				spnRecord.offset = spnNum->getOffset();
+				spnRecord.byteSize = spnNum->getByteSize();
+				spnRecord.formatGain = spnNum->getFormatGain();
+				spnRecord.formatOffset = spnNum->getFormatOffset();
+				spnRecord.units = strings.add(spnNum->getUnits());
+			}	break;
+			case SPN::SPN_STATUS: {
+				const SPNStatus* spnStat = static_cast<const SPNStatus*>(spn);
+
+				spnRecord.offset = spnStat->getOffset();
+				spnRecord.bitOffset = spnStat->getBitOffset();
+				spnRecord.bitSize = spnStat->getBitSize();
+				spnRecord.firstDesc = descRecords.size();
+
+				const SPNStatus::DescMap& descriptions = spnStat->getValueDescriptionsMap();
+
+				for(auto desc = descriptions.begin(); desc != descriptions.end(); ++desc) {
+
+					BinaryDescRecord descRecord;
+
+					descRecord.value = desc->first;
+					descRecord.description = strings.add(desc->second);
+
+					descRecords.push_back(descRecord);
+				}
+
+				spnRecord.descCount = descriptions.size();
+			}	break;
+			default:		//String SPNs have variable offsets, only the number and the name are stored
+				break;
+			}
+
+			spnRecords.push_back(spnRecord);
+		}
+
+		frameRecord.spnCount = numbers.size();
+
+		frameRecords.push_back(frameRecord);
+	}
+
+	BinaryDataBaseHeader header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, BINARY_DATABASE_MAGIC, sizeof(BINARY_DATABASE_MAGIC));
+	header.version = BINARY_DATABASE_VERSION;
+	header.byteOrder = BINARY_DATABASE_BYTE_ORDER;
+	header.frameCount = frameRecords.size();
+	header.framesOffset = sizeof(BinaryDataBaseHeader);
+	header.spnCount = spnRecords.size();
+	header.spnsOffset = header.framesOffset + frameRecords.size() * sizeof(BinaryFrameRecord);
+	header.descCount = descRecords.size();
+	header.descsOffset = header.spnsOffset + spnRecords.size() * sizeof(BinarySPNRecord);
+	header.stringsSize = strings.getData().size();
+	header.stringsOffset = header.descsOffset + descRecords.size() * sizeof(BinaryDescRecord);
+	header.fileSize = header.stringsOffset + header.stringsSize;
+
+	std::ofstream ofs(file.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+	if(!ofs.is_open()) {
+		return false;
+	}
+
+	ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeRecords(ofs, frameRecords);
+	writeRecords(ofs, spnRecords);
+	writeRecords(ofs, descRecords);
+	ofs.write(strings.getData().data(), strings.getData().size());
+
+	return ofs.good();
+
+}
+
+bool BinaryDataBase::isBinaryDataBase(const std::string& file) {
+
+	char magic[BINARY_DATABASE_MAGIC_SIZE];
+
+	std::ifstream ifs(file.c_str(), std::ifstream::in | std::ifstream::binary);
+
+	if(!ifs.read(magic, sizeof(magic))) {
+		return false;
+	}
+
+	return memcmp(magic, BINARY_DATABASE_MAGIC, sizeof(BINARY_DATABASE_MAGIC)) == 0;
+
+}
+
+bool BinaryDataBase::open(const std::string& file) {
+
+	close();
+
+	int fd = ::open(file.c_str(), O_RDONLY);
+
+	if(fd < 0) {
+		mErrorCode = ERROR_FILE_NOT_FOUND;
+		return false;
+	}
+
+	struct stat fileStat;
+
+	if(fstat(fd, &fileStat) < 0 || fileStat.st_size < static_cast<off_t>(sizeof(BinaryDataBaseHeader))) {
+		::close(fd);
+		mErrorCode = ERROR_INVALID_FORMAT;
+		return false;
+	}
+
+	void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	//The mapping keeps its own reference to the file
+	::close(fd);
+
+	if(data == MAP_FAILED) {
+		mErrorCode = ERROR_MAP_FAILED;
+		return false;
+	}
+
+	mData = static_cast<const u8*>(data);
+	mSize = fileStat.st_size;
+
+	if(!validate()) {
+		close();		//Keeps the error code set in validate
+		return false;
+	}
+
+	mBinaryFrames.reset(new BinaryFrame[mHeader->frameCount]);
+
+	for(u32 i = 0; i < mHeader->frameCount; ++i) {
+		mBinaryFrames[i].mDataBase = this;
+		mBinaryFrames[i].mRecord = &mFrames[i];
+	}
+
+	mErrorCode = ERROR_OK;
+
+	return true;
+
+}
+
+bool BinaryDataBase::validate() {
+
+	mHeader = reinterpret_cast<const BinaryDataBaseHeader*>(mData);
+
+	mErrorCode = ERROR_INVALID_FORMAT;
+
+	if(memcmp(mHeader->magic, BINARY_DATABASE_MAGIC, sizeof(BINARY_DATABASE_MAGIC)) != 0) {
+		return false;
+	}
+
+	if(mHeader->version != BINARY_DATABASE_VERSION || mHeader->byteOrder != BINARY_DATABASE_BYTE_ORDER) {
+		mErrorCode = ERROR_VERSION_MISMATCH;
+		return false;
+	}
+
+	//The sections must be laid out one after the other as written by compile
+	u64 framesEnd = static_cast<u64>(mHeader->framesOffset) + static_cast<u64>(mHeader->frameCount) * sizeof(BinaryFrameRecord);
+	u64 spnsEnd = static_cast<u64>(mHeader->spnsOffset) + static_cast<u64>(mHeader->spnCount) * sizeof(BinarySPNRecord);
+	u64 descsEnd = static_cast<u64>(mHeader->descsOffset) + static_cast<u64>(mHeader->descCount) * sizeof(BinaryDescRecord);
+	u64 stringsEnd = static_cast<u64>(mHeader->stringsOffset) + mHeader->stringsSize;
+
+	if(mHeader->fileSize != mSize || mHeader->framesOffset != sizeof(BinaryDataBaseHeader) || mHeader->spnsOffset != framesEnd ||
+			mHeader->descsOffset != spnsEnd || mHeader->stringsOffset != descsEnd || stringsEnd != mSize) {
+		return false;
+	}
+
+	mFrames = reinterpret_cast<const BinaryFrameRecord*>(mData + mHeader->framesOffset);
+	mSPNs = reinterpret_cast<const BinarySPNRecord*>(mData + mHeader->spnsOffset);
+	mDescs = reinterpret_cast<const BinaryDescRecord*>(mData + mHeader->descsOffset);
+	mStrings = reinterpret_cast<const char*>(mData + mHeader->stringsOffset);
+
+	//Every string must be terminated inside the string table
+	if(mHeader->stringsSize == 0 || mStrings[mHeader->stringsSize - 1] != '\0') {
+		return false;
+	}
+
+	for(u32 i = 0; i < mHeader->frameCount; ++i) {
+
+		const BinaryFrameRecord& frame = mFrames[i];
+
+		if((i > 0 && mFrames[i - 1].pgn > frame.pgn) || frame.name >= mHeader->stringsSize ||
+				static_cast<u64>(frame.firstSPN) + frame.spnCount > mHeader->spnCount) {
+			return false;
+		}
+
+		//The PGNs of PDU format 1 leave the destination address to the identifier
+		if(frame.pgn > J1939_PGN_MASK || (((frame.pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER &&
+				(frame.pgn & J1939_DST_ADDR_MASK) != 0)) {
+			return false;
+		}
+
+		const BinarySPNRecord* spns = getSPNs(frame);
+		u32 strings = 0;
+
+		for(u32 j = 0; j < frame.spnCount; ++j) {
+
+			const BinarySPNRecord& spn = spns[j];
+
+			if((j > 0 && spns[j - 1].number >= spn.number) || spn.name >= mHeader->stringsSize || spn.units >= mHeader->stringsSize) {
+				return false;
+			}
+
+			switch(spn.type) {
+			case SPN::SPN_NUMERIC:
+				if(spn.byteSize == 0 || spn.byteSize > SPN_NUMERIC_MAX_BYTE_SYZE) {
+					return false;
+				}
+				break;
+			case SPN::SPN_STATUS:
+				if(spn.bitSize == 0 || spn.bitSize + spn.bitOffset > 8 ||
+						static_cast<u64>(spn.firstDesc) + spn.descCount > mHeader->descCount) {
+					return false;
+				}
+				break;
+			case SPN::SPN_STRING:
+				++strings;
+				break;
+			default:
+				return false;
+			}
+		}
+
+		//A frame is made either of strings or of fixed size SPNs
+		if(strings != 0 && strings != frame.spnCount) {
+			return false;
+		}
+	}
+
+	for(u32 i = 0; i < mHeader->descCount; ++i) {
+		if(mDescs[i].description >= mHeader->stringsSize || mDescs[i].value > 0xFF) {
+			return false;
+		}
+	}
+
+	return true;
+
+}
+
+void BinaryDataBase::close() {
+
+	mBinaryFrames.reset();
+
+	if(mData) {
+		munmap(const_cast<u8*>(mData), mSize);
+	}
+
+	mData = nullptr;
+	mSize = 0;
+	mHeader = nullptr;
+	mFrames = nullptr;
+	mSPNs = nullptr;
+	mDescs = nullptr;
+	mStrings = nullptr;
+
+}
+
+const BinaryFrameRecord* BinaryDataBase::findFrame(u32 pgn) const {
+
+	const BinaryFrameRecord* end = mFrames + getFrameCount();
+
+	const BinaryFrameRecord* frame = std::lower_bound(mFrames, end, pgn,
+			[](const BinaryFrameRecord& record, u32 pgn) { return record.pgn < pgn; });
+
+	return (frame != end && frame->pgn == pgn ? frame : nullptr);
+
+}
+
+const BinarySPNRecord* BinaryDataBase::findSPN(const BinaryFrameRecord& frame, u32 spnNumber) const {
+
+	const BinarySPNRecord* begin = getSPNs(frame);
+	const BinarySPNRecord* end = begin + frame.spnCount;
+
+	const BinarySPNRecord* spn = std::lower_bound(begin, end, spnNumber,
+			[](const BinarySPNRecord& record, u32 number) { return record.number < number; });
+
+	return (spn != end && spn->number == spnNumber ? spn : nullptr);
+
+}
+
+void BinaryDataBase::toGenericFrame(const BinaryFrameRecord& record, GenericFrame& frame) const {
+
+	frame.setName(getString(record.name));
+	frame.setLength(record.length);
+
+	const BinarySPNRecord* spns = getSPNs(record);
+
+	for(u32 i = 0; i < record.spnCount; ++i) {
+
+		const BinarySPNRecord& spn = spns[i];
+
+		switch(spn.type) {
+		case SPN::SPN_NUMERIC:
+			frame.registerSPN(SPNNumeric(spn.number, getString(spn.name), spn.offset, spn.formatGain, spn.formatOffset,
+					spn.byteSize, getString(spn.units)));
+			break;
+		case SPN::SPN_STATUS: {
+
+			SPNStatusSpec::DescMap valueToDesc;
+
+			const BinaryDescRecord* descs = getDescriptions(spn);
+
+			for(u32 j = 0; j < spn.descCount; ++j) {
+				valueToDesc[descs[j].value] = getString(descs[j].description);
+			}
+
+			frame.registerSPN(SPNStatus(spn.number, getString(spn.name), spn.offset, spn.bitOffset, spn.bitSize, valueToDesc));
+		}	break;
+		case SPN::SPN_STRING:
+			frame.registerSPN(SPNString(spn.number, getString(spn.name)));
+			break;
+		default:
+			break;
+		}
+	}
+
+}
+
+BinaryFrame::BinaryFrame() : mDataBase(nullptr), mRecord(nullptr) {
+}
+
+BinaryFrame::~BinaryFrame() {
+}
+
+const char* BinaryFrame::getName() const {
+
+	return mDataBase->getString(mRecord->name);
+
+}
+
+const GenericFrame& BinaryFrame::getPrototype() const {
+
+	std::call_once(mPrototypeFlag, [this]() {
+
+		std::unique_ptr<GenericFrame> frame(new GenericFrame(mRecord->pgn));
+
+		mDataBase->toGenericFrame(*mRecord, *frame);
+
+		//Shared with the frames cloned from the prototype
+		frame->mLayout = getLayout();
+
+		mPrototype = std::move(frame);
+	});
+
+	return *mPrototype;
+
+}
+
+std::shared_ptr<const FrameLayout> BinaryFrame::getLayout() const {
+
+	std::call_once(mLayoutFlag, [this]() {
+		mLayout = FrameLayout::compile(*mDataBase, *mRecord);
+	});
+
+	return mLayout;
+
+}
+
+void BinaryDataBase::getFrames(std::vector<GenericFrame>& frames) const {
+
+	frames.reserve(frames.size() + getFrameCount());
+
+	for(u32 i = 0; i < getFrameCount(); ++i) {
+
+		frames.emplace_back(mFrames[i].pgn);
+
+		toGenericFrame(mFrames[i], frames.back());
+	}
+
+}
+
+} /* namespace J1939 */
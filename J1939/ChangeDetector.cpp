@@ -0,0 +1,244 @@
+/*
+ * ChangeDetector.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <ChangeDetector.h>
+#include <J1939Factory.h>
+
+#include <Utils.h>
+
+#define CHANGE_DETECTOR_MAX_SPNS		64
+#define FIBONACCI_HASH_MULTIPLIER		2654435761u
+
+
+namespace J1939 {
+
+namespace {
+
+/*
+ * Mask of the first n bytes of a payload
+ */
+u64 getBytesMask(size_t n) {
+	return (n >= sizeof(u64) ? ~0ULL : ((1ULL << (n * 8)) - 1));
+}
+
+}
+
+
+ChangeDetector::ChangeDetector(size_t initialCapacity, J1939Factory* factory) :
+		mFactory(factory ? factory : &J1939Factory::getInstance()), mCount(0), mShift(32) {
+
+	size_t capacity = 2;
+
+	while(capacity < initialCapacity) {
+		capacity <<= 1;
+	}
+
+	for(size_t i = capacity; i > 1; i >>= 1) {
+		--mShift;
+	}
+
+	mEntries.resize(capacity, Entry());
+}
+
+ChangeDetector::Entry* ChangeDetector::findSlot(std::vector<Entry>& entries, u32 shift, u32 id) const {
+
+	size_t mask = entries.size() - 1;
+	size_t index = static_cast<u32>(id * FIBONACCI_HASH_MULTIPLIER) >> shift;
+
+	//The table is never more than half full, an empty slot is always found
+	while(entries[index].length != 0 && entries[index].id != id) {
+		index = (index + 1) & mask;
+	}
+
+	return &(entries[index]);
+}
+
+void ChangeDetector::grow() {
+
+	std::vector<Entry> entries(mEntries.size() * 2, Entry());
+	u32 shift = mShift - 1;
+
+	for(auto entry = mEntries.begin(); entry != mEntries.end(); ++entry) {
+		if(entry->length != 0) {
+			*findSlot(entries, shift, entry->id) = *entry;
+		}
+	}
+
+	mEntries.swap(entries);
+	mShift = shift;
+
+}
+
+const ChangeDetector::PGNMasks* ChangeDetector::getMasks(u32 pgn) {
+
+	const PGNMasks* masks = mMasksTable.find(pgn);
+
+	if(masks) {
+		return masks;
+	}
+
+	PGNMasks& newMasks = mMasks[pgn];
+
+	newMasks.allSPNs = 0;
+	newMasks.layout = mFactory->getFrameLayout(pgn);
+
+	//Only the SPNs of frames that fit in a CAN frame can be tracked
+	if(newMasks.layout && newMasks.layout->getMinLength() <= J1939_MAX_SIZE &&
+			newMasks.layout->getSPNCount() <= CHANGE_DETECTOR_MAX_SPNS) {
+
+		for(size_t i = 0; i < newMasks.layout->getSPNCount(); ++i) {
+
+			const SPNExtractOp& op = newMasks.layout->getOp(i);
+
+			newMasks.spnMasks.push_back(static_cast<u64>(op.mask) << (op.offset * 8 + op.shift));
+			newMasks.allSPNs |= (1ULL << i);
+		}
+
+	} else {
+		newMasks.layout.reset();
+	}
+
+	mMasksTable.set(pgn, &newMasks);
+
+	return &newMasks;
+
+}
+
+ChangeResult ChangeDetector::update(u32 id, const u8* data, size_t length) {
+
+	ChangeResult result;
+
+	if(length > J1939_MAX_SIZE) {
+		result.status = FRAME_NOT_TRACKED;
+		result.changedSPNs = 0;
+		result.layout = nullptr;
+		return result;
+	}
+
+	u64 payload = 0;
+
+	for(size_t i = 0; i < length; ++i) {
+		payload |= (static_cast<u64>(data[i]) << (i * 8));
+	}
+
+	Entry* entry = findSlot(mEntries, mShift, id);
+
+	if(entry->length == 0) {
+
+		if((mCount + 1) * 2 > mEntries.size()) {
+			grow();
+			entry = findSlot(mEntries, mShift, id);
+		}
+
+		entry->id = id;
+		entry->length = length + 1;
+		entry->payload = payload;
+		entry->masks = getMasks(getPGNFromId(id));
+
+		++mCount;
+
+		result.status = FRAME_NEW;
+		result.changedSPNs = entry->masks->allSPNs;
+		result.layout = entry->masks->layout.get();
+
+		return result;
+	}
+
+	u64 diff = entry->payload ^ payload;
+	size_t oldLength = entry->length - 1;
+
+	//The bytes only present in one of the payloads are considered changed
+	if(oldLength != length) {
+		diff |= getBytesMask(J1939_MAX(oldLength, length)) & ~getBytesMask(J1939_MIN(oldLength, length));
+	}
+
+	if(diff == 0) {
+		result.status = FRAME_UNCHANGED;
+		result.changedSPNs = 0;
+		result.layout = nullptr;
+		return result;
+	}
+
+	entry->length = length + 1;
+	entry->payload = payload;
+
+	if(!entry->masks) {		//Discarded by clearMasks
+		entry->masks = getMasks(getPGNFromId(id));
+	}
+
+	const PGNMasks* masks = entry->masks;
+
+	result.status = FRAME_CHANGED;
+	result.changedSPNs = 0;
+	result.layout = masks->layout.get();
+
+	for(size_t i = 0; i < masks->spnMasks.size(); ++i) {
+		if(diff & masks->spnMasks[i]) {
+			result.changedSPNs |= (1ULL << i);
+		}
+	}
+
+	return result;
+
+}
+
+void ChangeDetector::erase(u32 id) {
+
+	Entry* entry = findSlot(mEntries, mShift, id);
+
+	if(entry->length == 0) {
+		return;
+	}
+
+	//Backward shift deletion, the entries after the erased one are moved to keep the probe sequences unbroken
+	size_t mask = mEntries.size() - 1;
+	size_t hole = entry - mEntries.data();
+	size_t index = hole;
+
+	while(true) {
+
+		index = (index + 1) & mask;
+
+		if(mEntries[index].length == 0) {
+			break;
+		}
+
+		size_t home = static_cast<u32>(mEntries[index].id * FIBONACCI_HASH_MULTIPLIER) >> mShift;
+
+		//The entry can be moved to the hole if its home is not between the hole and its position
+		if(((index - home) & mask) >= ((index - hole) & mask)) {
+			mEntries[hole] = mEntries[index];
+			hole = index;
+		}
+	}
+
+	mEntries[hole] = Entry();
+
+	--mCount;
+
+}
+
+void ChangeDetector::clear() {
+
+	std::fill(mEntries.begin(), mEntries.end(), Entry());
+
+	mCount = 0;
+
+}
+
+void ChangeDetector::clearMasks() {
+
+	for(auto entry = mEntries.begin(); entry != mEntries.end(); ++entry) {
+		entry->masks = nullptr;
+	}
+
+	mMasks.clear();
+	mMasksTable.clear();
+
+}
+
+} /* namespace J1939 */
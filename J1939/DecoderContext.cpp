@@ -0,0 +1,61 @@
+/*
+ * DecoderContext.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <DecoderContext.h>
+
+namespace J1939 {
+
+DecoderContext::DecoderContext() : mOwnedFactory(new J1939Factory), mFactory(mOwnedFactory.get()), mReassembler(mFactory) {
+
+}
+
+DecoderContext::DecoderContext(J1939Factory& factory) : mFactory(&factory), mReassembler(mFactory) {
+
+}
+
+std::unique_ptr<J1939Frame> DecoderContext::decode(u32 id, const u8* data, size_t length, u64 now) {
+
+	std::unique_ptr<J1939Frame> frame;
+
+	//The packets of the BAM protocol are reassembled without being decoded, only the complete message is
+	if(mReassembler.toBeHandled(id, data, length)) {
+
+		mReassembler.handleFrame(id, data, length, now);
+
+		if(!mReassembler.reassembledFramesPending()) {
+			return frame;
+		}
+
+		frame = mReassembler.dequeueReassembledFrame();
+
+	} else {
+
+		mReassembler.tick(now);
+
+		frame = mFactory->getJ1939Frame(id, data, length);
+
+		if(!frame) {
+			return frame;
+		}
+	}
+
+	if(frame->getPGN() == ADDRESS_CLAIM_PGN) {
+		mAddressTable.update(*static_cast<const AddressClaimFrame*>(frame.get()));
+	}
+
+	return frame;
+
+}
+
+void DecoderContext::reset() {
+
+	mReassembler.clear();
+	mAddressTable.clear();
+
+}
+
+} /* namespace J1939 */
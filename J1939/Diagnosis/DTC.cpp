@@ -26,10 +26,18 @@ DTC::~DTC() {
 
 void DTC::decode(const u8* buffer) {
 
-	if(buffer[3] & DTC_CM_MASK) {
+	if(tryDecode(buffer) != CODEC_OK) {
 		throw J1939DecodeException("Unknown conversion method");
 	}
 
+}
+
+ECodecStatus DTC::tryDecode(const u8* buffer) {
+
+	if(buffer[3] & DTC_CM_MASK) {
+		return CODEC_UNKNOWN_CONVERSION_METHOD;
+	}
+
 	mSPN = buffer[0];
 	mSPN |= (buffer[1] << 8);
 	mSPN |= ((buffer[2] & (~DTC_FMI_MASK)) << 11);
@@ -38,6 +46,8 @@ void DTC::decode(const u8* buffer) {
 
 	mOC = (buffer[3] & DTC_OC_MASK);
 
+	return CODEC_OK;
+
 }
 
 void DTC::encode(u8* buffer) const {
@@ -67,19 +67,40 @@ DM1::~DM1() {
 
 void DM1::decodeData(const u8* buffer, size_t length) {
 
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[DM1::decodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus DM1::tryDecodeData(const u8* buffer, size_t length) {
+
 
 	size_t lampStatLength = GenericFrame::getDataLength();
 
-	//Decode Lamp Status (SPNs)
-	GenericFrame::decodeData(buffer, lampStatLength);
+	//Decode Lamp Status (SPNs). Short frames are detected by GenericFrame.
+	ECodecStatus status = GenericFrame::tryDecodeData(buffer, J1939_MIN(lampStatLength, length));
+
+	if(status != CODEC_OK) {
+		return status;
+	}
 
 	size_t offset = lampStatLength;
 
+	//The frame can be reused to decode several messages, the capacity of the vector is kept
+	mDtcs.clear();
+
 	DTC dtc;
 
 	while(offset + DTC_SIZE <= length) {
 
-		dtc.decode(buffer + offset);
+		status = dtc.tryDecode(buffer + offset);
+
+		if(status != CODEC_OK) {
+			return status;
+		}
 
 		//To avoid adding a DTC when there are no faults (a DTC set all to 0s is sent which is not a valid DTC)
 		if(dtc.getSpn() != 0) {
@@ -89,20 +110,38 @@ void DM1::decodeData(const u8* buffer, size_t length) {
 		offset += DTC_SIZE;
 	}
 
+	return CODEC_OK;
+
 }
 
 void DM1::encodeData(u8* buffer, size_t length) const {
 
+	ECodecStatus status = tryEncodeData(buffer, length);
+
+	if(status == CODEC_INCONSISTENT_FRAME) {
+		throw J1939EncodeException("[DM1::encodeData] SPNs are not expected to fit within "
+				"more than 2 bytes");
+	} else if(status != CODEC_OK) {
+		throw J1939EncodeException(std::string("[DM1::encodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus DM1::tryEncodeData(u8* buffer, size_t length) const {
+
 	//Encode SPNs for bytes 0-1
 	size_t lampStatLength = GenericFrame::getDataLength();
 
-	GenericFrame::encodeData(buffer, lampStatLength);
+	ECodecStatus status = GenericFrame::tryEncodeData(buffer, lampStatLength);
+
+	if(status != CODEC_OK) {
+		return status;
+	}
 
 	size_t offset = lampStatLength;	//Must be 2
 
 	if(lampStatLength != 2) {
-		throw J1939EncodeException("[DM1::encodeData] SPNs are not expected to fit within "
-				"more than 2 bytes");
+		return CODEC_INCONSISTENT_FRAME;
 	}
 
 	for(auto dtc = mDtcs.begin(); dtc != mDtcs.end(); ++dtc) {
@@ -119,6 +158,8 @@ void DM1::encodeData(u8* buffer, size_t length) const {
 		memset(buffer + offset + 4, 0xFF, 2);
 	}
 
+	return CODEC_OK;
+
 }
 
 size_t DM1::getDataLength() const {
@@ -40,15 +40,25 @@ FMS1Frame::~FMS1Frame() {
 
 void FMS1Frame::decodeData(const u8* buffer, size_t length) {
 
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[FMS1Frame::decodeData] ") + getCodecStatusDescription(status) +
+				". Buffer length: " + std::to_string(length));
+	}
+
+}
+
+ECodecStatus FMS1Frame::tryDecodeData(const u8* buffer, size_t length) {
+
 	if(length != FMS1_FRAME_LENGTH) {		//Check the length first
-		throw J1939DecodeException("[FMS1Frame::decodeData] Buffer length does "
-				"not match the expected length. Buffer length:" + std::to_string(length) + ". Expected length: " + std::to_string(FMS1_FRAME_LENGTH));
+		return CODEC_INVALID_LENGTH;
 	}
 
 	u8 blockID = buffer[0] & BLOCKID_MASK;
 
-	if(blockID >= NUMBER_OF_BLOCKS) {
-		throw J1939DecodeException(std::string("[FMS1Frame::decodeData] Block ID higher than the maximum permitted. Max: ") + std::to_string(NUMBER_OF_BLOCKS -1));
+	if(blockID >= NUMBER_OF_BLOCKS) {		//Block ID higher than the maximum permitted
+		return CODEC_VALUE_OUT_OF_RANGE;
 	}
 
 	//If block ID changes, clear mTTSs to not accumulate the previous decoded TTSs
@@ -76,19 +86,31 @@ void FMS1Frame::decodeData(const u8* buffer, size_t length) {
 
 	}
 
+	return CODEC_OK;
+
 }
 
 void FMS1Frame::encodeData(u8* buffer, size_t length) const {
 
+	ECodecStatus status = tryEncodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939EncodeException(std::string("[FMS1Frame::encodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus FMS1Frame::tryEncodeData(u8* buffer, size_t length) const {
+
 	//Not necessary to check length if getDataLength() returns the proper value as the base class will already do the check
 
 	if(mTTSs.size() != TTSS_PER_BLOCK) {		//Check if we have the right number of TTSs.
-		throw  J1939EncodeException("[FMS1Frame::encodeData] There are not " + std::to_string(TTSS_PER_BLOCK) + " defined");
+		return CODEC_INCONSISTENT_FRAME;
 	}
 
 	//Check if the number for every TTS is the right one.
 	if(mTTSs.begin()->first <= mBlockID * TTSS_PER_BLOCK || mTTSs.rbegin()->first > (mBlockID + 1) * TTSS_PER_BLOCK) {
-		throw  J1939EncodeException("[FMS1Frame::encodeData] TTS numbers are not the proper ones for this block");
+		return CODEC_INCONSISTENT_FRAME;
 	}
 
 	u8 tts1Number = TTSS_PER_BLOCK * mBlockID + 1;
@@ -103,6 +125,8 @@ void FMS1Frame::encodeData(u8* buffer, size_t length) const {
 				((mTTSs.at(ttsHighPartNumber).getStatus() | TTS_ENCODING_MASK) << TTS_HIGH_PART_SHIFT);
 	}
 
+	return CODEC_OK;
+
 }
 
 std::string FMS1Frame::toString() const {
@@ -0,0 +1,45 @@
+/*
+ * FrameArena.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <FrameArena.h>
+#include <GenericFrame.h>
+
+namespace J1939 {
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+
+	size_t offset = (mUsed + alignment - 1) & ~(alignment - 1);
+
+	if(offset + size > mSize) {
+		return nullptr;
+	}
+
+	mUsed = offset + size;
+
+	return mBegin + offset;
+
+}
+
+void ArenaFrameDeleter::operator()(J1939Frame* frame) const {
+
+	if(frame->isGenericFrame() && static_cast<GenericFrame*>(frame)->mArena) {
+
+		FrameArena* arena = static_cast<GenericFrame*>(frame)->mArena;
+
+		//The arena is at the beginning of the block, see GenericFrame::cloneInArena
+		frame->~J1939Frame();
+		arena->~FrameArena();
+
+		::operator delete(arena);
+
+	} else {
+		delete frame;
+	}
+
+}
+
+} /* namespace J1939 */
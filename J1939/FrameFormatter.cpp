@@ -0,0 +1,594 @@
+/*
+ * FrameFormatter.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <FrameFormatter.h>
+
+#include <string.h>
+
+#include <GenericFrame.h>
+#include <Diagnosis/Frames/DM1.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+#include <SPN/SPNString.h>
+
+#define FORMATTER_DECIMALS			6
+#define FORMATTER_DECIMALS_SCALE	1000000.0
+#define FORMATTER_MAX_FIXED			1e15		//Bigger values do not fit in a u64 once scaled
+
+#define DTC_SPN_NAME				"DTC"
+
+#define FORMATTER_INITIAL_BUFFER_SIZE	4096
+
+
+namespace J1939 {
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/*
+ * Writes the fields into the buffer of the caller. Once the buffer is full nothing else is written.
+ */
+class LineWriter {
+
+private:
+	char* mBegin;
+	char* mPos;
+	char* mEnd;
+	EFrameFormat mFormat;
+	bool mOverflow;
+
+public:
+	LineWriter(char* buffer, size_t size, EFrameFormat format) : mBegin(buffer), mPos(buffer), mEnd(buffer + size),
+		mFormat(format), mOverflow(false) {}
+
+	size_t getLength() const { return (mOverflow ? 0 : mPos - mBegin); }
+
+	void put(char c) {
+		if(mPos < mEnd) {
+			*(mPos++) = c;
+		} else {
+			mOverflow = true;
+		}
+	}
+
+	void write(const char* str, size_t length) {
+		if(static_cast<size_t>(mEnd - mPos) >= length) {
+			memcpy(mPos, str, length);
+			mPos += length;
+		} else {
+			mOverflow = true;
+		}
+	}
+
+	template<size_t N>
+	void writeLiteral(const char (&str)[N]) { write(str, N - 1); }
+
+	void writeUnsigned(u64 value) {
+
+		char digits[20];
+		size_t count = 0;
+
+		do {
+			digits[count++] = '0' + (value % 10);
+			value /= 10;
+		} while(value != 0);
+
+		while(count > 0) {
+			put(digits[--count]);
+		}
+	}
+
+	void writeHex(u32 value, size_t minDigits) {
+
+		char digits[8];
+		size_t count = 0;
+
+		do {
+			digits[count++] = HEX_DIGITS[value & 0xF];
+			value >>= 4;
+		} while(value != 0 || count < minDigits);
+
+		while(count > 0) {
+			put(digits[--count]);
+		}
+	}
+
+	/*
+	 * Fixed notation with FORMATTER_DECIMALS decimals at most, the trailing zeros are removed
+	 */
+	void writeDouble(double value) {
+
+		if(value != value || value - value != 0) {		//NaN or infinite
+			if(mFormat == FRAME_FORMAT_NDJSON) {
+				writeLiteral("null");
+			} else {
+				writeLiteral("nan");
+			}
+			return;
+		}
+
+		bool negative = value < 0;
+
+		if(negative) {
+			value = -value;
+		}
+
+		if(value >= FORMATTER_MAX_FIXED) {
+			if(negative) put('-');
+			writeUnsigned(static_cast<u64>(value));
+			return;
+		}
+
+		u64 scaled = static_cast<u64>(value * FORMATTER_DECIMALS_SCALE + 0.5);
+		u64 scale = static_cast<u64>(FORMATTER_DECIMALS_SCALE);
+
+		if(negative && scaled != 0) {
+			put('-');
+		}
+
+		writeUnsigned(scaled / scale);
+
+		u32 decimals = scaled % scale;
+
+		if(decimals != 0) {
+
+			char digits[FORMATTER_DECIMALS];
+
+			for(int i = FORMATTER_DECIMALS - 1; i >= 0; --i) {
+				digits[i] = '0' + (decimals % 10);
+				decimals /= 10;
+			}
+
+			size_t length = FORMATTER_DECIMALS;
+
+			while(digits[length - 1] == '0') {
+				--length;
+			}
+
+			put('.');
+			write(digits, length);
+		}
+	}
+
+	void writeTimeStamp(const Utils::TimeStamp& timestamp) {
+
+		u32 micros = timestamp.getMicroSec();
+
+		writeUnsigned(timestamp.getSeconds());
+		put('.');
+
+		for(u32 div = 100000; div != 0; div /= 10) {
+			put('0' + (micros / div) % 10);
+		}
+	}
+
+	/*
+	 * Writes a text field escaped as required by the format. Strings are quoted in CSV only if needed.
+	 */
+	void writeText(const char* str, size_t length) {
+
+		switch(mFormat) {
+		case FRAME_FORMAT_TSV:
+			for(size_t i = 0; i < length; ++i) {
+				put((str[i] == '\t' || str[i] == '\n' || str[i] == '\r') ? ' ' : str[i]);
+			}
+			break;
+		case FRAME_FORMAT_CSV:
+			if(!needsQuotes(str, length)) {
+				write(str, length);
+			} else {
+				put('"');
+				for(size_t i = 0; i < length; ++i) {
+					if(str[i] == '"') put('"');
+					put(str[i]);
+				}
+				put('"');
+			}
+			break;
+		case FRAME_FORMAT_NDJSON:
+			put('"');
+			for(size_t i = 0; i < length; ++i) {
+
+				u8 c = static_cast<u8>(str[i]);
+
+				if(c == '"' || c == '\\') {
+					put('\\');
+					put(c);
+				} else if(c < 0x20) {
+					writeLiteral("\\u00");
+					put(HEX_DIGITS[c >> 4]);
+					put(HEX_DIGITS[c & 0xF]);
+				} else if(c < 0x80) {
+					put(c);
+				} else if(size_t sequence = utf8SequenceLength(reinterpret_cast<const u8*>(str + i), length - i)) {
+					write(str + i, sequence);
+					i += sequence - 1;
+				} else {
+					//Not UTF-8, as the raw bytes of SPNString (0xFF padding), the byte is escaped as a Latin-1 character
+					writeLiteral("\\u00");
+					put(HEX_DIGITS[c >> 4]);
+					put(HEX_DIGITS[c & 0xF]);
+				}
+			}
+			put('"');
+			break;
+		default:
+			break;
+		}
+	}
+
+	void writeText(const std::string& str) { writeText(str.c_str(), str.size()); }
+
+	/*
+	 * Length of the well formed UTF-8 sequence at the beginning of str, 0 if it is not well formed
+	 */
+	static size_t utf8SequenceLength(const u8* str, size_t length) {
+
+		size_t sequence;
+		u8 min = 0x80, max = 0xBF;		//Range of the second byte
+
+		if(str[0] >= 0xC2 && str[0] <= 0xDF) {
+			sequence = 2;
+		} else if(str[0] >= 0xE0 && str[0] <= 0xEF) {
+			sequence = 3;
+			if(str[0] == 0xE0) min = 0xA0;			//Overlong
+			if(str[0] == 0xED) max = 0x9F;			//Surrogates
+		} else if(str[0] >= 0xF0 && str[0] <= 0xF4) {
+			sequence = 4;
+			if(str[0] == 0xF0) min = 0x90;			//Overlong
+			if(str[0] == 0xF4) max = 0x8F;			//Over U+10FFFF
+		} else {
+			return 0;
+		}
+
+		if(length < sequence || str[1] < min || str[1] > max) {
+			return 0;
+		}
+
+		for(size_t i = 2; i < sequence; ++i) {
+			if(str[i] < 0x80 || str[i] > 0xBF) {
+				return 0;
+			}
+		}
+
+		return sequence;
+	}
+
+	static bool needsQuotes(const char* str, size_t length) {
+		for(size_t i = 0; i < length; ++i) {
+			if(str[i] == ',' || str[i] == '"' || str[i] == '\r' || str[i] == '\n') {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void separator() { put(mFormat == FRAME_FORMAT_TSV ? '\t' : ','); }
+
+};
+
+/*
+ * Frame columns of TSV and CSV, including the separator after the last one
+ */
+void writeFrameColumns(LineWriter& writer, const J1939Frame& frame, const Utils::TimeStamp& timestamp) {
+
+	writer.writeTimeStamp(timestamp);
+	writer.separator();
+	writer.writeHex(frame.getIdentifier(), 8);
+	writer.separator();
+	writer.writeHex(frame.getPGN(), 4);
+	writer.separator();
+	writer.writeText(frame.getName());
+	writer.separator();
+	writer.writeUnsigned(frame.getSrcAddr());
+	writer.separator();
+	if(frame.getPDUFormatGroup() == PDU_FORMAT_1) {
+		writer.writeUnsigned(frame.getDstAddr());
+	}
+	writer.separator();
+	writer.writeUnsigned(frame.getPriority());
+	writer.separator();
+
+}
+
+/*
+ * SPN columns of TSV and CSV
+ */
+void writeSPNColumns(LineWriter& writer, const SPN& spn) {
+
+	writer.writeUnsigned(spn.getSpnNumber());
+	writer.separator();
+	writer.writeText(spn.getName());
+	writer.separator();
+
+	switch(spn.getType()) {
+	case SPN::SPN_NUMERIC: {
+		const SPNNumeric& spnNum = static_cast<const SPNNumeric&>(spn);
+
+		writer.writeDouble(spnNum.getFormattedValue());
+		writer.separator();
+		writer.writeText(spnNum.getUnits());
+		writer.separator();
+	}	break;
+	case SPN::SPN_STATUS: {
+		const SPNStatus& spnStat = static_cast<const SPNStatus&>(spn);
+		const std::string* desc = spnStat.findValueDescription(spnStat.getValue());
+
+		writer.writeUnsigned(spnStat.getValue());
+		writer.separator();
+		writer.separator();
+		if(desc) {
+			writer.writeText(*desc);
+		}
+	}	break;
+	case SPN::SPN_STRING:
+		writer.writeText(static_cast<const SPNString&>(spn).getValue());
+		writer.separator();
+		writer.separator();
+		break;
+	default:
+		writer.separator();
+		writer.separator();
+		break;
+	}
+
+	writer.put('\n');
+
+}
+
+/*
+ * Opens the object of the frame and writes the fields of the frame
+ */
+void writeJsonFrameFields(LineWriter& writer, const J1939Frame& frame, const Utils::TimeStamp& timestamp) {
+
+	writer.writeLiteral("{\"timestamp\":");
+	writer.writeTimeStamp(timestamp);
+	writer.writeLiteral(",\"id\":\"");
+	writer.writeHex(frame.getIdentifier(), 8);
+	writer.writeLiteral("\",\"pgn\":\"");
+	writer.writeHex(frame.getPGN(), 4);
+	writer.writeLiteral("\",\"name\":");
+	writer.writeText(frame.getName());
+	writer.writeLiteral(",\"source\":");
+	writer.writeUnsigned(frame.getSrcAddr());
+	if(frame.getPDUFormatGroup() == PDU_FORMAT_1) {
+		writer.writeLiteral(",\"destination\":");
+		writer.writeUnsigned(frame.getDstAddr());
+	}
+	writer.writeLiteral(",\"priority\":");
+	writer.writeUnsigned(frame.getPriority());
+
+}
+
+void writeJsonSPN(LineWriter& writer, const SPN& spn) {
+
+	writer.writeLiteral("{\"spn\":");
+	writer.writeUnsigned(spn.getSpnNumber());
+	writer.writeLiteral(",\"name\":");
+	writer.writeText(spn.getName());
+	writer.writeLiteral(",\"value\":");
+
+	switch(spn.getType()) {
+	case SPN::SPN_NUMERIC: {
+		const SPNNumeric& spnNum = static_cast<const SPNNumeric&>(spn);
+
+		writer.writeDouble(spnNum.getFormattedValue());
+		writer.writeLiteral(",\"units\":");
+		writer.writeText(spnNum.getUnits());
+	}	break;
+	case SPN::SPN_STATUS: {
+		const SPNStatus& spnStat = static_cast<const SPNStatus&>(spn);
+		const std::string* desc = spnStat.findValueDescription(spnStat.getValue());
+
+		writer.writeUnsigned(spnStat.getValue());
+		writer.writeLiteral(",\"description\":");
+		if(desc) {
+			writer.writeText(*desc);
+		} else {
+			writer.writeLiteral("\"\"");
+		}
+	}	break;
+	case SPN::SPN_STRING:
+		writer.writeText(static_cast<const SPNString&>(spn).getValue());
+		break;
+	default:
+		writer.writeLiteral("null");
+		break;
+	}
+
+	writer.put('}');
+
+}
+
+/*
+ * Calls the formatting function doubling the size of the buffer until the lines fit
+ */
+template<class Format>
+size_t formatGrowing(std::vector<char>& buffer, Format format) {
+
+	if(buffer.empty()) {
+		buffer.resize(FORMATTER_INITIAL_BUFFER_SIZE);
+	}
+
+	size_t length;
+
+	while((length = format(buffer.data(), buffer.size())) == 0) {
+		buffer.resize(buffer.size() * 2);
+	}
+
+	return length;
+
+}
+
+}
+
+bool FrameFormatter::parseFormat(const std::string& name, EFrameFormat& format) {
+
+	if(name == "tsv") {
+		format = FRAME_FORMAT_TSV;
+	} else if(name == "csv") {
+		format = FRAME_FORMAT_CSV;
+	} else if(name == "ndjson") {
+		format = FRAME_FORMAT_NDJSON;
+	} else {
+		return false;
+	}
+
+	return true;
+
+}
+
+size_t FrameFormatter::formatHeader(char* buffer, size_t size) const {
+
+	static const char* const columns[] = {"timestamp", "id", "pgn", "name", "source", "destination", "priority",
+			"spn", "spn_name", "value", "units", "description"};
+
+	if(mFormat == FRAME_FORMAT_NDJSON) {
+		return 0;
+	}
+
+	LineWriter writer(buffer, size, mFormat);
+
+	for(size_t i = 0; i < sizeof(columns)/sizeof(columns[0]); ++i) {
+		if(i > 0) {
+			writer.separator();
+		}
+		writer.write(columns[i], strlen(columns[i]));
+	}
+
+	writer.put('\n');
+
+	return writer.getLength();
+
+}
+
+size_t FrameFormatter::format(const J1939Frame& frame, const Utils::TimeStamp& timestamp, char* buffer, size_t size) const {
+
+	LineWriter writer(buffer, size, mFormat);
+
+	const GenericFrame* genFrame = (frame.isGenericFrame() ? static_cast<const GenericFrame*>(&frame) : nullptr);
+	//A GenericFrame may be registered with the PGN of DM1, it is written as any other generic frame
+	const DM1* dm1 = (frame.getPGN() == DM1_PGN ? dynamic_cast<const DM1*>(&frame) : nullptr);
+
+	if(mFormat == FRAME_FORMAT_NDJSON) {
+
+		writeJsonFrameFields(writer, frame, timestamp);
+		writer.writeLiteral(",\"spns\":[");
+
+		if(genFrame) {
+			for(auto iter = genFrame->mSPNs.begin(); iter != genFrame->mSPNs.end(); ++iter) {
+				if(iter != genFrame->mSPNs.begin()) {
+					writer.put(',');
+				}
+				writeJsonSPN(writer, *(iter->second));
+			}
+		}
+
+		writer.put(']');
+
+		if(dm1) {
+
+			writer.writeLiteral(",\"dtcs\":[");
+
+			const std::vector<DTC>& dtcs = dm1->getDTCs();
+
+			for(auto dtc = dtcs.begin(); dtc != dtcs.end(); ++dtc) {
+				if(dtc != dtcs.begin()) {
+					writer.put(',');
+				}
+				writer.writeLiteral("{\"spn\":");
+				writer.writeUnsigned(dtc->getSpn());
+				writer.writeLiteral(",\"fmi\":");
+				writer.writeUnsigned(dtc->getFmi());
+				writer.writeLiteral(",\"oc\":");
+				writer.writeUnsigned(dtc->getOc());
+				writer.put('}');
+			}
+
+			writer.put(']');
+		}
+
+		writer.writeLiteral("}\n");
+
+		return writer.getLength();
+	}
+
+	size_t rows = 0;
+
+	if(genFrame) {
+		for(auto iter = genFrame->mSPNs.begin(); iter != genFrame->mSPNs.end(); ++iter, ++rows) {
+			writeFrameColumns(writer, frame, timestamp);
+			writeSPNColumns(writer, *(iter->second));
+		}
+	}
+
+	if(dm1) {
+
+		const std::vector<DTC>& dtcs = dm1->getDTCs();
+
+		for(auto dtc = dtcs.begin(); dtc != dtcs.end(); ++dtc, ++rows) {
+			writeFrameColumns(writer, frame, timestamp);
+			writer.writeUnsigned(dtc->getSpn());
+			writer.separator();
+			writer.writeLiteral(DTC_SPN_NAME);
+			writer.separator();
+			writer.writeUnsigned(dtc->getFmi());
+			writer.separator();
+			writer.separator();
+			writer.writeUnsigned(dtc->getOc());
+			writer.put('\n');
+		}
+	}
+
+	if(rows == 0) {		//Only the columns of the frame
+		writeFrameColumns(writer, frame, timestamp);
+		for(size_t i = 0; i < 4; ++i) {
+			writer.separator();
+		}
+		writer.put('\n');
+	}
+
+	return writer.getLength();
+
+}
+
+size_t FrameFormatter::formatSPN(const J1939Frame& frame, const SPN& spn, const Utils::TimeStamp& timestamp, char* buffer, size_t size) const {
+
+	LineWriter writer(buffer, size, mFormat);
+
+	if(mFormat == FRAME_FORMAT_NDJSON) {
+
+		writeJsonFrameFields(writer, frame, timestamp);
+		writer.writeLiteral(",\"spns\":[");
+		writeJsonSPN(writer, spn);
+		writer.writeLiteral("]}\n");
+
+	} else {
+
+		writeFrameColumns(writer, frame, timestamp);
+		writeSPNColumns(writer, spn);
+
+	}
+
+	return writer.getLength();
+
+}
+
+size_t FrameFormatter::format(const J1939Frame& frame, const Utils::TimeStamp& timestamp, std::vector<char>& buffer) const {
+
+	return formatGrowing(buffer, [&](char* data, size_t size) { return format(frame, timestamp, data, size); });
+
+}
+
+size_t FrameFormatter::formatSPN(const J1939Frame& frame, const SPN& spn, const Utils::TimeStamp& timestamp, std::vector<char>& buffer) const {
+
+	return formatGrowing(buffer, [&](char* data, size_t size) { return formatSPN(frame, spn, timestamp, data, size); });
+
+}
+
+} /* namespace J1939 */
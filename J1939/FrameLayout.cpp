@@ -0,0 +1,220 @@
+/*
+ * FrameLayout.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <FrameLayout.h>
+#include <GenericFrame.h>
+#include <BinaryDataBase.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+#include <Utils.h>
+
+namespace J1939 {
+
+std::shared_ptr<const FrameLayout> FrameLayout::compile(const GenericFrame& frame) {
+
+	std::shared_ptr<FrameLayout> layout(new FrameLayout);
+
+	std::set<u32> numbers = frame.getSPNNumbers();
+
+	layout->mOps.reserve(numbers.size());
+
+	for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+
+		const SPN* spn = frame.getSPN(*number);
+
+		bool compiled = false;
+
+		switch(spn->getType()) {
+		case SPN::SPN_NUMERIC: {
+
+			const SPNNumeric* numSpn = static_cast<const SPNNumeric*>(spn);
+
+			compiled = layout->addNumeric(*number, spn->getOffset(), numSpn->getByteSize(), numSpn->getFormatGain(), numSpn->getFormatOffset());
+
+		}	break;
+		case SPN::SPN_STATUS: {
+
+			const SPNStatus* statSpn = static_cast<const SPNStatus*>(spn);
+
+			compiled = layout->addStatus(*number, spn->getOffset(), statSpn->getBitOffset(), statSpn->getBitSize());
+
+		}	break;
+		default:
+			break;			//Strings have variable offsets
+		}
+
+		if(!compiled) {
+			return nullptr;
+		}
+	}
+
+	layout->buildLuts();
+
+	return layout;
+
+}
+
+std::shared_ptr<const FrameLayout> FrameLayout::compile(const BinaryDataBase& database, const BinaryFrameRecord& record) {
+
+	std::shared_ptr<FrameLayout> layout(new FrameLayout);
+
+	layout->mOps.reserve(record.spnCount);
+
+	//The records are sorted by SPN number, as the SPNs of GenericFrame
+	const BinarySPNRecord* spn = database.getSPNs(record);
+	const BinarySPNRecord* end = spn + record.spnCount;
+
+	for(; spn != end; ++spn) {
+
+		bool compiled = false;
+
+		switch(spn->type) {
+		case SPN::SPN_NUMERIC:
+			compiled = layout->addNumeric(spn->number, spn->offset, spn->byteSize, spn->formatGain, spn->formatOffset);
+			break;
+		case SPN::SPN_STATUS:
+			compiled = layout->addStatus(spn->number, spn->offset, spn->bitOffset, spn->bitSize);
+			break;
+		default:
+			break;			//Strings have variable offsets
+		}
+
+		if(!compiled) {
+			return nullptr;
+		}
+	}
+
+	layout->buildLuts();
+
+	return layout;
+
+}
+
+bool FrameLayout::addNumeric(u32 number, size_t offset, u8 byteSize, double gain, double formatOffset) {
+
+	if(offset > 0xFF || byteSize == 0 || byteSize > SPN_NUMERIC_MAX_BYTE_SYZE) {
+		return false;
+	}
+
+	SPNExtractOp op;
+
+	op.spnNumber = number;
+	op.type = SPN::SPN_NUMERIC;
+	op.offset = offset;
+	op.width = byteSize;
+	op.shift = 0;
+	op.mask = 0xFFFFFFFF >> ((SPN_NUMERIC_MAX_BYTE_SYZE - op.width) * 8);
+	op.gain = gain;
+	op.formatOffset = formatOffset;
+	op.lut = nullptr;
+
+	mMinLength = J1939_MAX(mMinLength, static_cast<size_t>(op.offset + op.width));
+	mOps.push_back(op);
+
+	return true;
+
+}
+
+bool FrameLayout::addStatus(u32 number, size_t offset, u8 bitOffset, u8 bitSize) {
+
+	if(offset > 0xFF || bitOffset > 7 || bitSize > 8 || bitOffset + bitSize > 8) {
+		return false;
+	}
+
+	SPNExtractOp op;
+
+	op.spnNumber = number;
+	op.type = SPN::SPN_STATUS;
+	op.offset = offset;
+	op.width = 1;
+	op.shift = bitOffset;
+	op.mask = 0xFF >> (8 - bitSize);
+	op.gain = 1;
+	op.formatOffset = 0;
+	op.lut = nullptr;
+
+	mMinLength = J1939_MAX(mMinLength, static_cast<size_t>(op.offset + op.width));
+	mOps.push_back(op);
+
+	return true;
+
+}
+
+void FrameLayout::buildLuts() {
+
+	size_t luts = 0;
+
+	for(auto op = mOps.begin(); op != mOps.end(); ++op) {
+		if(op->type == SPN::SPN_NUMERIC && op->width == 1)	++luts;
+	}
+
+	//The lookup tables are assigned once the vector will not be reallocated anymore
+	mLuts.resize(luts * FRAME_LAYOUT_LUT_SIZE);
+
+	double* lut = mLuts.data();
+
+	for(auto op = mOps.begin(); op != mOps.end(); ++op) {
+
+		if(op->type != SPN::SPN_NUMERIC || op->width != 1)	continue;
+
+		for(u32 raw = 0; raw < FRAME_LAYOUT_LUT_SIZE; ++raw) {
+			lut[raw] = raw * op->gain + op->formatOffset;
+		}
+
+		op->lut = lut;
+		lut += FRAME_LAYOUT_LUT_SIZE;
+	}
+
+}
+
+int FrameLayout::getSPNIndex(u32 spnNumber) const {
+
+	//Operations are sorted by SPN number
+	size_t low = 0, high = mOps.size();
+
+	while(low < high) {
+
+		size_t mid = (low + high) / 2;
+
+		if(mOps[mid].spnNumber < spnNumber) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if(low < mOps.size() && mOps[low].spnNumber == spnNumber) {
+		return low;
+	}
+
+	return -1;
+}
+
+void FrameLayout::decodeRaw(const u8* data, u32* raw) const {
+
+	const SPNExtractOp* op = mOps.data();
+	const SPNExtractOp* end = op + mOps.size();
+
+	for(; op != end; ++op, ++raw) {
+		*raw = extractRaw(*op, data);
+	}
+
+}
+
+void FrameLayout::decodeValues(const u8* data, double* values) const {
+
+	const SPNExtractOp* op = mOps.data();
+	const SPNExtractOp* end = op + mOps.size();
+
+	for(; op != end; ++op, ++values) {
+		*values = extractValue(*op, data);
+	}
+
+}
+
+} /* namespace J1939 */
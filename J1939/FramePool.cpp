@@ -0,0 +1,143 @@
+/*
+ * FramePool.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <FramePool.h>
+#include <J1939Factory.h>
+#include <J1939Frame.h>
+#include <Utils.h>
+
+namespace J1939 {
+
+void FrameRecycler::operator()(J1939Frame* frame) const {
+
+	if(mPool) {
+		mPool->release(frame);
+	} else {
+		delete frame;
+	}
+
+}
+
+FramePool::FramePool(size_t maxFramesPerPGN, J1939Factory* factory) : mMaxFramesPerPGN(maxFramesPerPGN),
+		mFactory(factory ? factory : &J1939Factory::getInstance()) {
+}
+
+FramePool::~FramePool() {
+	clear();
+}
+
+FramePool::FreeList* FramePool::getFreeList(u32 pgn) {
+
+	FreeList* freeList = mFreeListTable.find(pgn);
+
+	if(!freeList) {
+		freeList = &(mFreeLists[pgn]);
+		freeList->reserve(mMaxFramesPerPGN);		//Releasing a frame will never need to allocate memory
+		mFreeListTable.set(pgn, freeList);
+	}
+
+	return freeList;
+}
+
+PooledFrame FramePool::acquire(u32 pgn) {
+
+	if(!mFactory->isRegistered(pgn)) {
+		return PooledFrame(nullptr, FrameRecycler(this));
+	}
+
+	FreeList* freeList = getFreeList(pgn);
+
+	if(!freeList->empty()) {
+		J1939Frame* frame = freeList->back();
+		freeList->pop_back();
+		return PooledFrame(frame, FrameRecycler(this));
+	}
+
+	return PooledFrame(mFactory->getJ1939Frame(pgn).release(), FrameRecycler(this));
+}
+
+PooledFrame FramePool::decode(u32 id, const u8* data, size_t length) {
+
+	PooledFrame frame = acquire(getPGNFromId(id));
+
+	if(frame) {
+		mFactory->decodeInto(id, data, length, *frame);
+	}
+
+	return frame;
+}
+
+PooledFrame FramePool::decode(u32 id, const u8* data, size_t length, ECodecStatus& status) {
+
+	PooledFrame frame = acquire(getPGNFromId(id));
+
+	if(!frame) {
+		status = CODEC_UNKNOWN_PGN;
+		return frame;
+	}
+
+	status = mFactory->tryDecodeInto(id, data, length, *frame);
+
+	if(status != CODEC_OK) {
+		frame.reset();
+	}
+
+	return frame;
+}
+
+bool FramePool::reserve(u32 pgn, size_t count) {
+
+	if(!mFactory->isRegistered(pgn)) {
+		return false;
+	}
+
+	FreeList* freeList = getFreeList(pgn);
+
+	while(freeList->size() < J1939_MIN(count, mMaxFramesPerPGN)) {
+		freeList->push_back(mFactory->getJ1939Frame(pgn).release());
+	}
+
+	return true;
+}
+
+void FramePool::release(J1939Frame* frame) {
+
+	if(!frame) {
+		return;
+	}
+
+	FreeList* freeList = getFreeList(frame->getPGN());
+
+	if(freeList->size() < mMaxFramesPerPGN) {
+		freeList->push_back(frame);
+	} else {
+		delete frame;
+	}
+
+}
+
+size_t FramePool::getFreeFrames(u32 pgn) const {
+
+	FreeList* freeList = mFreeListTable.find(pgn);
+
+	return (freeList ? freeList->size() : 0);
+}
+
+void FramePool::clear() {
+
+	for(auto freeList = mFreeLists.begin(); freeList != mFreeLists.end(); ++freeList) {
+		for(auto frame = freeList->second.begin(); frame != freeList->second.end(); ++frame) {
+			delete *frame;
+		}
+	}
+
+	mFreeLists.clear();
+	mFreeListTable.clear();
+
+}
+
+} /* namespace J1939 */
@@ -31,9 +31,19 @@ RequestFrame::~RequestFrame() {
 
 void RequestFrame::decodeData(const u8* buffer, size_t length) {
 
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[RequestFrame::decodeData] ") + getCodecStatusDescription(status) +
+				". Buffer length: " + std::to_string(length));
+	}
+
+}
+
+ECodecStatus RequestFrame::tryDecodeData(const u8* buffer, size_t length) {
+
 	if(length != REQUEST_FRAME_LENGTH) {		//Check the length first
-		throw  J1939DecodeException("[RequestFrame::decodeData] Buffer length does "
-				"not match the expected length. Buffer length:" + std::to_string(length) + ". Expected length: " + std::to_string(REQUEST_FRAME_LENGTH));
+		return CODEC_INVALID_LENGTH;
 	}
 
 	mRequestPGN = buffer[0];
@@ -41,6 +51,8 @@ void RequestFrame::decodeData(const u8* buffer, size_t length) {
 	mRequestPGN |= (buffer[2] << 16);
 	mRequestPGN &= J1939_PGN_MASK;
 
+	return CODEC_OK;
+
 }
 
 
@@ -57,10 +69,19 @@ std::string RequestFrame::toString() const {
 	std::string retVal = J1939Frame::toString();
 	std::stringstream sstr;
 
-	//Try to get information related to the PGN.
-	std::unique_ptr<J1939Frame> frame = J1939Factory::getInstance().getJ1939Frame(mRequestPGN);
+	std::string name;
+
+	//Try to get information related to the PGN from the factory that built the frame
+	if(std::shared_ptr<J1939Factory> factory = mFactory.lock()) {
+
+		std::unique_ptr<J1939Frame> frame = factory->getJ1939Frame(mRequestPGN);
+
+		if(frame.get()) {
+			name = frame->getName();
+		}
+	}
 
-	sstr << "Request PGN: " << std::hex << mRequestPGN << " " << (frame.get() ? frame->getName() : "") << std::endl;
+	sstr << "Request PGN: " << std::hex << mRequestPGN << " " << name << std::endl;
 
 	return retVal + sstr.str();
 
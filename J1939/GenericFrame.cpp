@@ -6,25 +6,46 @@
  */
 
 #include <string.h>
+#include <stddef.h>
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <typeinfo>
 
 #include <Utils.h>
 #include <Assert.h>
 
 #include "GenericFrame.h"
+#include "SPN/SPNNumeric.h"
+#include "SPN/SPNStatus.h"
 
 namespace J1939 {
 
 
 
-GenericFrame::GenericFrame(u32 pgn) : J1939Frame(pgn), mLength(0) {
+/*
+ * Upper bound of the size of a node of the SPN map, a red black tree node has a color and three pointers besides the value.
+ * If it falls short, the nodes that do not fit are allocated with new.
+ */
+#define SPN_MAP_NODE_SIZE		(sizeof(std::pair<const u32, SPN*>) + 4 * sizeof(void*))
+
+
+namespace {
+
+size_t alignUp(size_t size, size_t alignment) {
+	return (size + alignment - 1) & ~(alignment - 1);
+}
 
 }
 
 
-GenericFrame::GenericFrame(const GenericFrame& other) : J1939Frame(other), mLength(other.mLength) {
+GenericFrame::GenericFrame(u32 pgn) : J1939Frame(pgn), mLength(0), mArena(nullptr), mEncodedValid(false) {
+
+}
+
+
+GenericFrame::GenericFrame(const GenericFrame& other) : J1939Frame(other), mLength(other.mLength), mArena(nullptr), mLayout(other.mLayout),
+		mEncodedValid(false) {
 
     for(auto spn = other.mSPNs.begin(); spn != other.mSPNs.end(); ++spn) {
 		mSPNs[spn->first] = spn->second->clone();
@@ -32,18 +53,76 @@ GenericFrame::GenericFrame(const GenericFrame& other) : J1939Frame(other), mLeng
 	}
 }
 
+GenericFrame::GenericFrame(const GenericFrame& other, FrameArena* arena) : J1939Frame(other), mLength(other.mLength),
+		mSPNs(SPNMap::allocator_type(arena)), mArena(arena), mLayout(other.mLayout), mEncodedValid(false) {
+
+	for(auto spn = other.mSPNs.begin(); spn != other.mSPNs.end(); ++spn) {
+
+		void* buffer = arena->allocate(spn->second->getCloneSize(), spn->second->getCloneAlignment());
+
+		SPN* clone = (buffer ? spn->second->cloneAt(buffer) : spn->second->clone());
+
+		clone->setOwner(this);
+
+		//Hint at the end, the SPNs are inserted in order
+		mSPNs.insert(mSPNs.end(), std::make_pair(spn->first, clone));
+	}
+}
+
 GenericFrame::~GenericFrame() {
 
     for(auto spn = mSPNs.begin(); spn != mSPNs.end(); ++spn) {
 
-		delete spn->second;
+		releaseSPN(spn->second);
+
+	}
+
+}
+
+void GenericFrame::releaseSPN(SPN* spn) {
+
+	if(mArena && mArena->contains(spn)) {
+		spn->~SPN();		//The memory is released with the arena
+	} else {
+		delete spn;
+	}
+
+}
+
+ArenaFrame GenericFrame::cloneInArena() const {
+
+	//Only plain generic frames are copied into the arena, the subclasses would be sliced by the copy constructor
+	if(typeid(*this) != typeid(GenericFrame)) {
+		return ArenaFrame(clone());
+	}
+
+	const size_t maxAlign = alignof(max_align_t);
 
+	//The arena itself is placed at the beginning of the block, then the frame, the SPNs and the map nodes
+	size_t size = alignUp(sizeof(FrameArena), maxAlign) + alignUp(sizeof(GenericFrame), maxAlign);
+
+	for(auto spn = mSPNs.begin(); spn != mSPNs.end(); ++spn) {
+		size += alignUp(spn->second->getCloneSize(), maxAlign);
 	}
 
+	size += mSPNs.size() * alignUp(SPN_MAP_NODE_SIZE, maxAlign);
+
+	void* block = ::operator new(size);
+
+	size_t arenaOffset = alignUp(sizeof(FrameArena), maxAlign);
+
+	FrameArena* arena = new (block) FrameArena(static_cast<u8*>(block) + arenaOffset, size - arenaOffset);
+
+	GenericFrame* frame = new (arena->allocate(sizeof(GenericFrame), alignof(GenericFrame))) GenericFrame(*this, arena);
+
+	return ArenaFrame(frame);
+
 }
 
 void GenericFrame::recalculateStringOffsets() {
 
+	invalidateEncoded();
+
 	for(auto spn = mSPNs.begin(); spn != mSPNs.end(); ++spn) {
 
 		auto nextSpn = spn;
@@ -58,47 +137,160 @@ void GenericFrame::recalculateStringOffsets() {
 
 void GenericFrame::decodeData(const u8* buffer, size_t length) {
 
-	const u8* spnBuf;
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[GenericFrame::decodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus GenericFrame::tryDecodeData(const u8* buffer, size_t length) {
+
 	size_t offset;
 
+	//All the SPNs change, the payload is encoded again from scratch
+	invalidateEncoded();
+
+	//Fast path, all the SPNs fit in the data and the checks were done when compiling the layout
+	if(mLayout && length >= mLayout->getMinLength()) {
+
+		const SPNExtractOp* op = mLayout->getOps();
+
+		for(auto spn = mSPNs.begin(); spn != mSPNs.end(); ++spn, ++op) {
+
+			u32 raw = FrameLayout::extractRaw(*op, buffer);
+
+			if(op->type == SPN::SPN_NUMERIC) {
+				static_cast<SPNNumeric*>(spn->second)->setValue(raw);
+			} else {
+				static_cast<SPNStatus*>(spn->second)->mValue = raw;
+			}
+		}
+
+		return CODEC_OK;
+	}
+
     for(auto spn = mSPNs.begin(); spn != mSPNs.end(); ++spn) {
 
     	offset = spn->second->getOffset();
 
-    	if(offset >= length) {
-			throw J1939DecodeException("[GenericFrame::decodeData] Offset of spn is higher than frame length");
+    	if(offset >= length) {		//Offset of spn is higher than frame length
+			return CODEC_BUFFER_TOO_SHORT;
 		}
 
-        spnBuf = buffer + offset;
-        spn->second->decode(spnBuf, length - offset);
+        ECodecStatus status = spn->second->tryDecode(buffer + offset, length - offset);
+
+        if(status != CODEC_OK) {
+        	return status;
+        }
 	}
 
+    return CODEC_OK;
+
 }
 
 
 void GenericFrame::encodeData(u8* buffer, size_t length) const {
 
-    u8* spnBuf;
-	size_t offset;
+	ECodecStatus status = tryEncodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939EncodeException(std::string("[GenericFrame::encodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus GenericFrame::tryEncodeData(u8* buffer, size_t length) const {
+
+	ECodecStatus status = updateEncoded();
+
+	if(status != CODEC_OK) {
+		return status;
+	}
+
+	if(length < mEncoded.size()) {
+		return CODEC_BUFFER_TOO_SHORT;
+	}
+
+	memcpy(buffer, mEncoded.data(), mEncoded.size());
+
+    return CODEC_OK;
+
+}
+
+ECodecStatus GenericFrame::updateEncoded() const {
+
+	ECodecStatus status;
+
+	if(mEncodedValid) {
+
+		//Only the SPNs modified since the last encode
+		for(auto spn = mDirtySPNs.begin(); spn != mDirtySPNs.end(); ++spn) {
+
+			(*spn)->clearDirty();
+
+			if((status = encodeSPN(*spn)) != CODEC_OK) {
+				mEncodedValid = false;
+				return status;
+			}
+		}
+
+		mDirtySPNs.clear();
+
+		return CODEC_OK;
+	}
+
+	//Only the SPNs, derived frames as DM1 append their own data
+	mEncoded.assign(GenericFrame::getDataLength(), 0xFF);
+
+	//Every SPN can be modified once before the next encode, so the list never grows beyond this
+	mDirtySPNs.clear();
+	mDirtySPNs.reserve(mSPNs.size());
 
     for(auto spn = mSPNs.begin(); spn != mSPNs.end(); ++spn) {
 
-    	offset = spn->second->getOffset();
+    	spn->second->clearDirty();
 
-        if(offset >= length) {
-            throw J1939EncodeException("[GenericFrame::encodeData] Offset of spn is higher than frame length: SPN number: " + std::to_string(spn->second->getSpnNumber()) +
-            		" offset: " + std::to_string(offset) + " length: " + std::to_string(length));
+    	if((status = encodeSPN(spn->second)) != CODEC_OK) {
+        	return status;
         }
 
-        spnBuf = buffer + offset;
-        spn->second->encode(spnBuf, length - offset);
+	}
+
+    mEncodedValid = true;
+
+    return CODEC_OK;
+
+}
+
+ECodecStatus GenericFrame::encodeSPN(SPN* spn) const {
+
+	size_t offset = spn->getOffset();
 
+	if(offset >= mEncoded.size()) {		//Offset of spn is higher than frame length
+		return CODEC_BUFFER_TOO_SHORT;
+	}
+
+	return spn->tryEncode(mEncoded.data() + offset, mEncoded.size() - offset);
+
+}
+
+void GenericFrame::onSPNModified(SPN* spn) {
+
+	//Without a valid payload, everything is encoded in the next encode
+	if(mEncodedValid) {
+		mDirtySPNs.push_back(spn);
 	}
 
 }
 
 size_t GenericFrame::getDataLength() const {
 
+	if(mEncodedValid) {
+		return mEncoded.size();
+	}
+
 	size_t maxOffset = 0;
 	size_t sizeLastSpn = 1;
 
@@ -130,6 +322,8 @@ SPN *GenericFrame::registerSPN(const SPN& spn) {
     		(spn.getType() == SPN::SPN_STRING)));
 
     if(spnIter == mSPNs.end()) {
+        mLayout.reset();
+        invalidateEncoded();
         retVal = spn.clone();
         retVal->setOwner(this);
         mSPNs[spn.getSpnNumber()] = retVal;
@@ -189,7 +383,9 @@ bool GenericFrame::deleteSPN(u32 number) {
 
     auto iter = mSPNs.find(number);
     if(iter != mSPNs.end()) {
-        delete iter->second;
+        mLayout.reset();
+        invalidateEncoded();
+        releaseSPN(iter->second);
         mSPNs.erase(iter);
         return true;
     }
@@ -206,7 +402,7 @@ std::string GenericFrame::toString() const {
 	return retVal;
 }
 
-std::set<SPN*> GenericFrame::compare(const std::string& newData, const std::string oldData) {
+std::set<SPN*> GenericFrame::compare(const std::string& newData, const std::string& oldData) {
 
 	std::set<SPN*> retVal;
 
@@ -214,7 +410,7 @@ std::set<SPN*> GenericFrame::compare(const std::string& newData, const std::stri
 
 		size_t maxLength = iter->second->getOffset() + iter->second->getByteSize();
 
-		if(newData.size() >= maxLength || oldData.size() >= maxLength) {
+		if(newData.size() >= maxLength && oldData.size() >= maxLength) {
 
 			if(memcmp(newData.c_str() + iter->second->getOffset(), oldData.c_str() + iter->second->getOffset(),
 					iter->second->getByteSize()) != 0) {		//SPNs differ
@@ -244,6 +440,8 @@ void GenericFrame::copy(const J1939Frame& other) {
 
 	const GenericFrame *genOther = static_cast<const GenericFrame*>(&other);
 
+	invalidateEncoded();
+
 	auto otherIter = genOther->mSPNs.begin();
 
 	for(auto iter = mSPNs.begin(); iter != mSPNs.end(); ++iter) {
@@ -260,4 +458,24 @@ void GenericFrame::copy(const J1939Frame& other) {
 
 }
 
+bool GenericFrame::compileLayout() {
+
+	mLayout = FrameLayout::compile(*this);
+
+	return (mLayout != nullptr);
+
+}
+
+bool GenericFrame::decodeValues(const u8* buffer, size_t length, double* values) const {
+
+	if(!mLayout || length < mLayout->getMinLength()) {
+		return false;
+	}
+
+	mLayout->decodeValues(buffer, values);
+
+	return true;
+
+}
+
 } /* namespace J1939 */
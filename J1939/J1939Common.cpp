@@ -1 +1,27 @@
 #include "J1939Common.h"
+
+namespace J1939 {
+
+const char* getCodecStatusDescription(ECodecStatus status) {
+
+	switch(status) {
+	case CODEC_OK:							return "Ok";
+	case CODEC_PGN_MISMATCH:				return "Pgn does not match";
+	case CODEC_UNKNOWN_PGN:					return "Pgn not registered";
+	case CODEC_BUFFER_TOO_SHORT:			return "Length smaller than expected";
+	case CODEC_INVALID_LENGTH:				return "Buffer length does not match the expected length";
+	case CODEC_INVALID_PRIORITY:			return "Priority exceeded its range";
+	case CODEC_INVALID_SPN_FORMAT:			return "Format incorrect to decode/encode properly the spn";
+	case CODEC_VALUE_OUT_OF_RANGE:			return "Value out of range";
+	case CODEC_STRING_NOT_TERMINATED:		return "'*' terminator not found";
+	case CODEC_STRING_NOT_ASCII:			return "String is not ASCII";
+	case CODEC_UNKNOWN_CTRL_TYPE:			return "Unknown Ctrl type";
+	case CODEC_UNKNOWN_CONVERSION_METHOD:	return "Unknown conversion method";
+	case CODEC_INCONSISTENT_FRAME:			return "Content of the frame is not consistent";
+	case CODEC_EXCEPTION:					return "Exception thrown";
+	default:								return "Unknown status";
+	}
+
+}
+
+}
@@ -14,6 +14,7 @@
 #include <Diagnosis/Frames/DM1.h>
 
 #include "GenericFrame.h"
+#include "BinaryDataBase.h"
 #include "SPN/SPNNumeric.h"
 #include "SPN/SPNStatus.h"
 #include "SPN/SPNString.h"
@@ -252,6 +253,31 @@ bool J1939DataBase::writeJsonFile(const std::string& file) {
 }
 
 
+bool J1939DataBase::parseBinaryFile(const std::string& file) {
+
+	BinaryDataBase database;
+
+	if(!database.open(file)) {
+		mErrorCode = (database.getLastError() == BinaryDataBase::ERROR_FILE_NOT_FOUND ? ERROR_FILE_NOT_FOUND : ERROR_INVALID_BINARY);
+		return false;
+	}
+
+	database.getFrames(mFrames);
+
+	mErrorCode = ERROR_OK;
+
+	return true;
+
+}
+
+
+bool J1939DataBase::writeBinaryFile(const std::string& file) {
+
+	return BinaryDataBase::compile(mFrames, file);
+
+}
+
+
 const std::vector<GenericFrame>& J1939DataBase::getParsedFrames() const {
 	return mFrames;
 }
@@ -371,7 +397,7 @@ void J1939DataBase::writeSPNStatus(const SPN* spn, Json::Value& jsonSpn) {
 	jsonSpn[STAT_BIT_SIZE_KEY] = spnStat->getBitSize();
 
     //Check if there are descriptions defined for the different status numbers
-    SPNStatus::DescMap descriptions = spnStat->getValueDescriptionsMap();
+    const SPNStatus::DescMap& descriptions = spnStat->getValueDescriptionsMap();
 
     if(descriptions.empty()) {
         return;
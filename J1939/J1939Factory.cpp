@@ -8,9 +8,14 @@
 #include <J1939Factory.h>
 #include <J1939Frame.h>
 #include <J1939DataBase.h>
+#include <BinaryDataBase.h>
+#include <GenericFrame.h>
+#include <RCU.h>
 
 #include <Transport/TPCMFrame.h>
 #include <Transport/TPDTFrame.h>
+#include <Transport/ETP/ETPCMFrame.h>
+#include <Transport/ETP/ETPDTFrame.h>
 #include <Diagnosis/Frames/DM1.h>
 #include <Addressing/AddressClaimFrame.h>
 #include <Frames/RequestFrame.h>
@@ -23,60 +28,179 @@
 namespace J1939 {
 
 
-J1939Factory::J1939Factory() {
-	registerPredefinedFrames();
+J1939Factory::J1939Factory() : mSelf(this, [](J1939Factory*) {}) {
+
+	Registry* registry = new Registry;
+
+	registerPredefinedFrames(*registry);
+
+	mRegistry.store(registry);
+
 }
 
 
 J1939Factory::~J1939Factory() {
 
-    unregisterAllFrames();
+	mSelf.reset();
+
+	//No thread can be reading when the singleton is released
+	delete mRegistry.load();
+
+}
+
+const J1939Frame* J1939Factory::Registry::find(u32 pgn) const {
+
+	J1939Frame* frame = dispatchTable.find(pgn);
+
+	if(frame != nullptr) {
+		return frame;
+	}
+
+	//Unknown PGNs are discarded here as well by the negative cache of the table
+	const BinaryFrame* binaryFrame = databaseTable.find(pgn);
+
+	return (binaryFrame ? &binaryFrame->getPrototype() : nullptr);
+
+}
+
+std::shared_ptr<const FrameLayout> J1939Factory::Registry::findLayout(u32 pgn) const {
+
+	J1939Frame* frame = dispatchTable.find(pgn);
+
+	if(frame != nullptr) {
+		return (frame->isGenericFrame() ? static_cast<GenericFrame*>(frame)->getLayout() : nullptr);
+	}
+
+	//Compiled from the records, the GenericFrame is not built
+	const BinaryFrame* binaryFrame = databaseTable.find(pgn);
+
+	return (binaryFrame ? binaryFrame->getLayout() : nullptr);
+
+}
+
+void J1939Factory::publish(const Registry* registry) {
+
+	const Registry* old = mRegistry.exchange(registry, std::memory_order_seq_cst);
+
+	RCU::synchronize();
+
+	delete old;
 
 }
 
 void J1939Factory::unregisterAllFrames() {
-    for(std::map<u32, J1939Frame*>::const_iterator iter = mFrames.begin(); iter != mFrames.end(); iter++) {
-        if(iter->second)
-            delete iter->second;
-    }
-    mFrames.clear();
+
+	std::lock_guard<std::mutex> lock(mWriteLock);
+
+	publish(new Registry);
+
 }
 
 std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(u32 id, const u8* data, size_t length) {
 
-	J1939Frame* frame = NULL, *retFrame = NULL;
+	const J1939Frame* frame = NULL;
+	J1939Frame* retFrame = NULL;
 
-	u32 pgn = ((id >> J1939_PGN_OFFSET) & J1939_PGN_MASK);
+	{
+		RCUReadGuard guard;
+
+		//Unknown PGNs are discarded by the negative cache of the dispatch tables
+		if((frame = mRegistry.load(std::memory_order_acquire)->find(getPGNFromId(id))) == NULL) {
+			return std::unique_ptr<J1939Frame>(nullptr);
+		}
 
-	//Check if PDU format belongs to the first group
-	if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
-		pgn &= (J1939_PDU_FMT_MASK << J1939_PDU_FMT_OFFSET);
+		retFrame = frame->clone();
 	}
 
-	std::map<u32, J1939Frame*>::iterator iter = mFrames.find(pgn);
+	std::unique_ptr<J1939Frame> ptr(retFrame);
 
-	if(iter == mFrames.end() || ((frame = iter->second) == NULL)) {
-        return std::unique_ptr<J1939Frame>(nullptr);
+	if(ptr) {
+		ptr->decode(id, data, length);
 	}
+    return ptr;
 
-	retFrame = frame->clone();
+}
+
+
+std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(u32 id, const u8* data, size_t length, ECodecStatus& status) {
+
+	const J1939Frame* frame = NULL;
+	std::unique_ptr<J1939Frame> retFrame;
+
+	{
+		RCUReadGuard guard;
 
-	if(retFrame) {
-		retFrame->decode(id, data, length);
+		if((frame = mRegistry.load(std::memory_order_acquire)->find(getPGNFromId(id))) == NULL) {
+			status = CODEC_UNKNOWN_PGN;
+			return std::unique_ptr<J1939Frame>(nullptr);
+		}
+
+		retFrame.reset(frame->clone());
+	}
+
+	status = retFrame->tryDecode(id, data, length);
+
+	if(status != CODEC_OK) {
+		retFrame.reset();
 	}
-    return std::unique_ptr<J1939Frame>(retFrame);
+
+    return retFrame;
 
 }
 
+ArenaFrame J1939Factory::getArenaFrame(u32 id, const u8* data, size_t length) {
 
-std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(u32 pgn) {
+	ArenaFrame retFrame;
+
+	{
+		RCUReadGuard guard;
+
+		const J1939Frame* frame = mRegistry.load(std::memory_order_acquire)->find(getPGNFromId(id));
+
+		if(frame == nullptr) {
+			return ArenaFrame(nullptr);
+		}
+
+		retFrame = (frame->isGenericFrame() ? static_cast<const GenericFrame*>(frame)->cloneInArena() : ArenaFrame(frame->clone()));
+	}
+
+	retFrame->decode(id, data, length);
+
+	return retFrame;
+
+}
+
+ECodecStatus J1939Factory::tryDecodeInto(u32 id, const u8* data, size_t length, J1939Frame& frame) const {
+
+	if(getPGNFromId(id) != frame.getPGN()) {
+		return CODEC_PGN_MISMATCH;
+	}
+
+	return frame.tryDecode(id, data, length);
+
+}
+
+bool J1939Factory::decodeInto(u32 id, const u8* data, size_t length, J1939Frame& frame) const {
+
+	if(getPGNFromId(id) != frame.getPGN()) {
+		return false;
+	}
+
+	frame.decode(id, data, length);
+
+	return true;
+
+}
 
 
-	J1939Frame* frame = nullptr, *retFrame = nullptr;
+std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(u32 pgn) {
+
+	RCUReadGuard guard;
 
-	std::map<u32, J1939Frame*>::iterator iter = mFrames.find(pgn);
+	const J1939Frame* frame = nullptr;
+	J1939Frame* retFrame = nullptr;
 
-	if(iter == mFrames.end() || ((frame = iter->second) == NULL)) {
+	if((frame = mRegistry.load(std::memory_order_acquire)->find(pgn)) == nullptr) {
 		//printf("Pgn: %u not found", pgn);
 		return std::unique_ptr<J1939Frame>(nullptr);
 	}
@@ -89,8 +213,11 @@ std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(u32 pgn) {
 
 std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(const std::string& name) {
 
+	RCUReadGuard guard;
 
-	for(auto iter = mFrames.begin(); iter != mFrames.end(); ++iter) {
+	const Registry* registry = mRegistry.load(std::memory_order_acquire);
+
+	for(auto iter = registry->frames.begin(); iter != registry->frames.end(); ++iter) {
 		if(iter->second != nullptr && iter->second->getName() == name) {
 
 			return std::unique_ptr<J1939Frame>(iter->second->clone());
@@ -98,14 +225,53 @@ std::unique_ptr<J1939Frame> J1939Factory::getJ1939Frame(const std::string& name)
 		}
 	}
 
+	//The names of the binary databases are compared in the mapped string table
+	for(auto database = registry->databases.begin(); database != registry->databases.end(); ++database) {
+		for(u32 i = 0; i < (*database)->getFrameCount(); ++i) {
+
+			const BinaryFrame& binaryFrame = (*database)->getBinaryFrame(i);
+
+			if(registry->databaseTable.find(binaryFrame.getPGN()) == &binaryFrame && name == binaryFrame.getName()) {
+				return std::unique_ptr<J1939Frame>(binaryFrame.getPrototype().clone());
+			}
+		}
+	}
+
 	return std::unique_ptr<J1939Frame>(nullptr);
 }
 
 
 bool J1939Factory::registerFrame(const J1939Frame& frame) {
 
-	if(mFrames.find(frame.getPGN()) == mFrames.end()) {
-		mFrames[frame.getPGN()] = frame.clone();
+	std::lock_guard<std::mutex> lock(mWriteLock);
+
+	const Registry* current = mRegistry.load(std::memory_order_relaxed);
+
+	if(current->contains(frame.getPGN())) {
+		return false;
+	}
+
+	Registry* registry = new Registry(*current);
+
+	registerFrame(*registry, frame);
+
+	publish(registry);
+
+	return true;
+
+}
+
+bool J1939Factory::registerFrame(Registry& registry, const J1939Frame& frame) {
+
+	if(!registry.contains(frame.getPGN())) {
+		J1939Frame* prototype = frame.clone();
+
+		//The layout is shared by all the frames cloned from the prototype
+		if(prototype->isGenericFrame()) {
+			static_cast<GenericFrame*>(prototype)->compileLayout();
+		}
+		registry.frames[frame.getPGN()] = std::shared_ptr<J1939Frame>(prototype);
+		registry.dispatchTable.set(frame.getPGN(), prototype);
         return true;
     } else {
         return false;
@@ -114,69 +280,184 @@ bool J1939Factory::registerFrame(const J1939Frame& frame) {
 
 
 
-void J1939Factory::registerPredefinedFrames() {
+void J1939Factory::registerPredefinedFrames(Registry& registry) const {
 
 	{
 		TPCMFrame frame;
-		registerFrame(frame);
+		registerFrame(registry, frame);
 	}
 
 	{
 		TPDTFrame frame;
-		registerFrame(frame);
+		registerFrame(registry, frame);
+	}
+
+	{
+		ETPCMFrame frame;
+		registerFrame(registry, frame);
+	}
+
+	{
+		ETPDTFrame frame;
+		registerFrame(registry, frame);
 	}
 
     {
     	FMS1Frame frame;
-    	registerFrame(frame);
+    	registerFrame(registry, frame);
     }
 
 
 	{
 		DM1 frame;
-		registerFrame(frame);
+		registerFrame(registry, frame);
 	}
 
 	{
 		AddressClaimFrame frame;
-		registerFrame(frame);
+		registerFrame(registry, frame);
 	}
 
 	{
 		RequestFrame frame;
-		registerFrame(frame);
+		frame.setFactory(mSelf);
+		registerFrame(registry, frame);
 	}
 
 }
 
 std::set<u32> J1939Factory::getAllRegisteredPGNs() const {
 
+	RCUReadGuard guard;
+
+	const Registry* registry = mRegistry.load(std::memory_order_acquire);
+
 	std::set<u32> pgns;
 
 
-	for(std::map<u32, J1939Frame*>::const_iterator iter = mFrames.begin(); iter != mFrames.end(); iter++) {
+	for(auto iter = registry->frames.begin(); iter != registry->frames.end(); iter++) {
 		pgns.insert(iter->first);
 	}
 
+	for(auto database = registry->databases.begin(); database != registry->databases.end(); ++database) {
+		for(u32 i = 0; i < (*database)->getFrameCount(); ++i) {
+
+			const BinaryFrame& binaryFrame = (*database)->getBinaryFrame(i);
+
+			if(registry->databaseTable.find(binaryFrame.getPGN()) == &binaryFrame) {
+				pgns.insert(binaryFrame.getPGN());
+			}
+		}
+	}
+
 	return pgns;
 
 }
 
-void J1939Factory::unRegisterFrame(u32 pgn) {
+bool J1939Factory::isRegistered(u32 pgn) const {
+
+	RCUReadGuard guard;
 
-	auto iter = mFrames.find(pgn);
+	return mRegistry.load(std::memory_order_acquire)->contains(pgn);
 
-	if(iter != mFrames.end()) {
+}
+
+std::shared_ptr<const FrameLayout> J1939Factory::getFrameLayout(u32 pgn) const {
+
+	RCUReadGuard guard;
+
+	return mRegistry.load(std::memory_order_acquire)->findLayout(pgn);
+}
 
-		delete iter->second;
-		mFrames.erase(iter);
+FrameView J1939Factory::getFrameView(u32 id, const u8* data, size_t length) const {
+
+	RCUReadGuard guard;
+
+	return FrameView(id, data, length, mRegistry.load(std::memory_order_acquire)->findLayout(getPGNFromId(id)));
+}
+
+void J1939Factory::unRegisterFrame(u32 pgn) {
 
+	std::lock_guard<std::mutex> lock(mWriteLock);
+
+	const Registry* current = mRegistry.load(std::memory_order_relaxed);
+
+	if(!current->contains(pgn)) {
+		return;
 	}
 
+	Registry* registry = new Registry(*current);
+
+	registry->dispatchTable.erase(pgn);
+	registry->frames.erase(pgn);
+	registry->databaseTable.erase(pgn);
+
+	publish(registry);
+
 }
 
 bool J1939Factory::registerDatabaseFrames(const std::string& file) {
 
+	std::lock_guard<std::mutex> lock(mWriteLock);
+
+	std::unique_ptr<Registry> registry(new Registry(*mRegistry.load(std::memory_order_relaxed)));
+
+	if(!registerDatabaseFrames(*registry, file)) {
+		return false;
+	}
+
+	publish(registry.release());
+
+	return true;
+
+}
+
+bool J1939Factory::reloadDatabaseFrames(const std::string& file) {
+
+	//Built before taking the lock, the file is read without stopping other writers
+	std::unique_ptr<Registry> registry(new Registry);
+
+	registerPredefinedFrames(*registry);
+
+	if(!registerDatabaseFrames(*registry, file)) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mWriteLock);
+
+	publish(registry.release());
+
+	return true;
+
+}
+
+bool J1939Factory::registerDatabaseFrames(Registry& registry, const std::string& file) {
+
+	//Precompiled databases stay mapped, their frames are only built when they are requested
+	if(BinaryDataBase::isBinaryDataBase(file)) {
+
+		std::shared_ptr<BinaryDataBase> database(new BinaryDataBase);
+
+		if(!database->open(file)) {
+			return false;
+		}
+
+		for(u32 i = 0; i < database->getFrameCount(); ++i) {
+
+			const BinaryFrame& frame = database->getBinaryFrame(i);
+
+			if(registry.contains(frame.getPGN())) {		//The first definition of the PGN is the one registered
+				continue;
+			}
+
+			registry.databaseTable.set(frame.getPGN(), &frame);
+		}
+
+		registry.databases.push_back(database);
+
+		return true;
+	}
+
 	//Read database if available
 	J1939DataBase database;
 
@@ -188,7 +469,7 @@ bool J1939Factory::registerDatabaseFrames(const std::string& file) {
 
 	//Register all the frames listed in the database
 	for(auto iter = ddbbFrames.begin(); iter != ddbbFrames.end(); ++iter) {
-		registerFrame(*iter);
+		registerFrame(registry, *iter);
 	}
 
 	return true;
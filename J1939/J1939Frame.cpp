@@ -38,7 +38,7 @@ J1939Frame::~J1939Frame() {
 
 
 
-void J1939Frame::decode(u32 identifier, const u8* buffer, size_t length) {
+ECodecStatus J1939Frame::decodeIdentifier(u32 identifier) {
 
 	u32 pgn = ((identifier >> J1939_PGN_OFFSET) & J1939_PGN_MASK);
 
@@ -46,12 +46,12 @@ void J1939Frame::decode(u32 identifier, const u8* buffer, size_t length) {
 	if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
 
 		mDstAddr = ((pgn >> J1939_DST_ADDR_OFFSET) & J1939_DST_ADDR_MASK);
-		pgn &= (J1939_PDU_FMT_MASK << J1939_PDU_FMT_OFFSET);
+		pgn &= ~J1939_PDU_SPECIFIC_MASK;
 	}
 
 	if(pgn != mPgn)
 	{
-        throw J1939DecodeException("[J1939Frame::decode] Pgn does not match");
+		return CODEC_PGN_MISMATCH;
 	}
 
 	mSrcAddr = identifier & J1939_SRC_ADDR_MASK;
@@ -59,34 +59,57 @@ void J1939Frame::decode(u32 identifier, const u8* buffer, size_t length) {
 
 	mPriority = identifier & J1939_PRIORITY_MASK;
 
+	return CODEC_OK;
+}
+
+void J1939Frame::decode(u32 identifier, const u8* buffer, size_t length) {
+
+	if(decodeIdentifier(identifier) != CODEC_OK) {
+        throw J1939DecodeException("[J1939Frame::decode] Pgn does not match");
+	}
 
 	//Leave data decoding to inherited class
 	decodeData(buffer, length);
 
 }
-void J1939Frame::encode(u32& identifier, u8* buffer, size_t& length) const {
 
-	u8 prio = (mPriority & J1939_PRIORITY_MASK);
+ECodecStatus J1939Frame::tryDecode(u32 identifier, const u8* buffer, size_t length) {
 
-	if(prio != mPriority) {
-        throw J1939EncodeException("[J1939Frame::encode] Priority exceeded its range");
+	ECodecStatus status = decodeIdentifier(identifier);
+
+	if(status != CODEC_OK) {
+		return status;
+	}
+
+	return tryDecodeData(buffer, length);
+
+}
+
+ECodecStatus J1939Frame::checkEncode(size_t length) const {
+
+	if((mPriority & J1939_PRIORITY_MASK) != mPriority) {
+		return CODEC_INVALID_PRIORITY;
 	}
 
 	if(length < getDataLength()) {
-        throw J1939EncodeException("[J1939Frame::encode] Length smaller than expected");
+		return CODEC_BUFFER_TOO_SHORT;
 	}
 
-	identifier = mSrcAddr;
+	return CODEC_OK;
+}
 
-	u32 aux = mPgn;
+void J1939Frame::encode(u32& identifier, u8* buffer, size_t& length) const {
 
-	if(getPDUFormatGroup() == PDU_FORMAT_1) {							//Group 1
-		aux = mPgn | ((mDstAddr & J1939_DST_ADDR_MASK) << J1939_DST_ADDR_OFFSET);
+	switch(checkEncode(length)) {
+	case CODEC_INVALID_PRIORITY:
+        throw J1939EncodeException("[J1939Frame::encode] Priority exceeded its range");
+	case CODEC_BUFFER_TOO_SHORT:
+        throw J1939EncodeException("[J1939Frame::encode] Length smaller than expected");
+	default:
+		break;
 	}
 
-	identifier |= ((aux & J1939_PGN_MASK) << J1939_PGN_OFFSET);
-
-	identifier |= (prio << J1939_PRIORITY_OFFSET);
+	identifier = getIdentifier();
 
 	memset(buffer, 0xFF, length);
 
@@ -96,6 +119,52 @@ void J1939Frame::encode(u32& identifier, u8* buffer, size_t& length) const {
 
 }
 
+ECodecStatus J1939Frame::tryEncode(u32& identifier, u8* buffer, size_t& length) const {
+
+	ECodecStatus status = checkEncode(length);
+
+	if(status != CODEC_OK) {
+		return status;
+	}
+
+	identifier = getIdentifier();
+
+	memset(buffer, 0xFF, length);
+
+	status = tryEncodeData(buffer, length);
+
+	if(status == CODEC_OK) {
+		length = getDataLength();
+	}
+
+	return status;
+
+}
+
+ECodecStatus J1939Frame::tryDecodeData(const u8* buffer, size_t length) {
+
+	try {
+		decodeData(buffer, length);
+	} catch(J1939DecodeException&) {
+		return CODEC_EXCEPTION;
+	}
+
+	return CODEC_OK;
+}
+
+ECodecStatus J1939Frame::tryEncodeData(u8* buffer, size_t length) const {
+
+	try {
+		encodeData(buffer, length);
+	} catch(J1939EncodeException&) {
+		return CODEC_EXCEPTION;
+	} catch(J1939DecodeException&) {
+		return CODEC_EXCEPTION;
+	}
+
+	return CODEC_OK;
+}
+
 u32 J1939Frame::getIdentifier() const {
 
 	u32 identifier;
@@ -0,0 +1,127 @@
+/*
+ * RCU.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <RCU.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+
+namespace J1939 {
+
+namespace {
+
+/*
+ * Epoch in which the thread owning the slot entered its critical section, 0 when it is outside.
+ * The slots are never freed, the slot of a finished thread is reused by the next thread that reads.
+ */
+struct ReaderSlot {
+	std::atomic<u64> epoch;
+	std::atomic<bool> inUse;
+	ReaderSlot* next;
+};
+
+std::atomic<u64> gEpoch(1);
+std::atomic<ReaderSlot*> gSlots(nullptr);
+
+//Writers are serialized, readers never take it
+std::mutex gSynchronizeLock;
+
+ReaderSlot* acquireSlot() {
+
+	for(ReaderSlot* slot = gSlots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+
+		bool expected = false;
+
+		if(!slot->inUse.load(std::memory_order_relaxed) && slot->inUse.compare_exchange_strong(expected, true)) {
+			return slot;
+		}
+	}
+
+	ReaderSlot* slot = new ReaderSlot;
+
+	slot->epoch.store(0);
+	slot->inUse.store(true);
+	slot->next = gSlots.load(std::memory_order_relaxed);
+
+	while(!gSlots.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed));
+
+	return slot;
+
+}
+
+struct ThreadReader {
+
+	ReaderSlot* slot = nullptr;
+	u32 nesting = 0;
+
+	~ThreadReader() {
+		if(slot) {
+			slot->epoch.store(0, std::memory_order_release);
+			slot->inUse.store(false, std::memory_order_release);
+		}
+	}
+};
+
+thread_local ThreadReader tReader;
+
+}
+
+
+void RCU::readLock() {
+
+	ThreadReader& reader = tReader;
+
+	if(reader.nesting++ != 0) {
+		return;
+	}
+
+	if(!reader.slot) {
+		reader.slot = acquireSlot();
+	}
+
+	//Sequentially consistent so that either synchronize sees the slot or the reader sees the structures published before it
+	reader.slot->epoch.store(gEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+}
+
+void RCU::readUnlock() {
+
+	ThreadReader& reader = tReader;
+
+	if(--reader.nesting == 0) {
+		reader.slot->epoch.store(0, std::memory_order_release);
+	}
+
+}
+
+void RCU::synchronize() {
+
+	std::lock_guard<std::mutex> lock(gSynchronizeLock);
+
+	u64 epoch = gEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+	//The readers that entered with an older epoch may still see the old structures
+	for(ReaderSlot* slot = gSlots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next) {
+
+		while(true) {
+
+			u64 readerEpoch = slot->epoch.load(std::memory_order_seq_cst);
+
+			if(readerEpoch == 0 || readerEpoch >= epoch) {
+				break;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+
+}
+
+} /* namespace J1939 */
@@ -15,6 +15,7 @@
 
 
 #include <J1939Common.h>
+#include <GenericFrame.h>
 #include <SPN/SPN.h>
 
 
@@ -32,10 +33,50 @@ SPN::SPN(u32 number, const std::string& name, size_t offset) {
 			);
 }
 
+SPN::SPN(const SPN& other) : ICloneable<SPN>(other), mSpec(other.mSpec), mDirty(true), mOwner(nullptr) {
+
+}
+
+SPN& SPN::operator=(const SPN& other) {
+
+	mSpec = other.mSpec;
+
+	setDirty();
+
+	return *this;
+}
+
 SPN::~SPN() {
 
 }
 
+void SPN::decode(const u8* buffer, size_t length) {
+
+	ECodecStatus status = tryDecode(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException("[SPN::decode] SPN " + std::to_string(getSpnNumber()) + ": " + getCodecStatusDescription(status));
+	}
+}
+
+void SPN::encode(u8* buffer, size_t length) const {
+
+	ECodecStatus status = tryEncode(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939EncodeException("[SPN::encode] SPN " + std::to_string(getSpnNumber()) + ": " + getCodecStatusDescription(status));
+	}
+}
+
+void SPN::notifyDirty() {
+
+	mDirty = true;
+
+	if(mOwner) {
+		mOwner->onSPNModified(this);
+	}
+}
+
 std::string SPN::toString() const {
 
 	std::stringstream sstr;
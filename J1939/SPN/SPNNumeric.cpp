@@ -35,28 +35,43 @@ SPNNumeric::~SPNNumeric() {
 }
 
 
-void SPNNumeric::decode(const u8* buffer, size_t length) {
+ECodecStatus SPNNumeric::tryDecode(const u8* buffer, size_t length) {
 
-    if(getByteSize() > length || getByteSize() > SPN_NUMERIC_MAX_BYTE_SYZE) {       //mValue can hold only 4 bytes cause it is of type u32
-        throw J1939DecodeException("[SPNNumeric::decode] Spn length is bigger than expected");
+    if(getByteSize() > SPN_NUMERIC_MAX_BYTE_SYZE) {       //mValue can hold only 4 bytes cause it is of type u32
+        return CODEC_INVALID_SPN_FORMAT;
     }
+
+    if(getByteSize() > length) {
+        return CODEC_BUFFER_TOO_SHORT;
+    }
+
 	mValue = 0;
     for(int i = 0; i < getByteSize(); ++i) {
 		mValue |= (buffer[i] << (i * 8));
 	}
+
+    setDirty();
+
+    return CODEC_OK;
 }
 
 
-void SPNNumeric::encode(u8* buffer, size_t length) const {
+ECodecStatus SPNNumeric::tryEncode(u8* buffer, size_t length) const {
 
-    if(getByteSize() > length || getByteSize() > SPN_NUMERIC_MAX_BYTE_SYZE) {       //mValue can hold only 4 bytes cause it is of type u32
-        throw J1939EncodeException("[SPNNumeric::encode] Spn length is bigger than expected");
+    if(getByteSize() > SPN_NUMERIC_MAX_BYTE_SYZE) {       //mValue can hold only 4 bytes cause it is of type u32
+        return CODEC_INVALID_SPN_FORMAT;
+    }
+
+    if(getByteSize() > length) {
+        return CODEC_BUFFER_TOO_SHORT;
     }
 
     for(int i = 0; i < getByteSize(); ++i) {
         buffer[i] = ((mValue >> (i * 8)) & 0xFF);
     }
 
+    return CODEC_OK;
+
 }
 
 double SPNNumeric::getFormattedValue() const {
@@ -74,6 +89,7 @@ bool SPNNumeric::setFormattedValue(double value) {
 
 	if(aux >= 0 && (aux < threshold)) {
 		mValue = static_cast<u32>(aux);
+		setDirty();
 		return true;
 	}
 	return false;
@@ -98,6 +114,8 @@ void SPNNumeric::copy(const SPN& other) {
 
 	mValue = numOther->mValue;
 
+	setDirty();
+
 }
 
 } /* namespace J1939 */
@@ -59,8 +59,15 @@ void SPNStatusSpec::clearValueDescriptions() {
 }
 
 
-SPNStatusSpec::DescMap SPNStatusSpec::getValueDescriptionsMap() const {
+const SPNStatusSpec::DescMap& SPNStatusSpec::getValueDescriptionsMap() const {
     return mValueToDesc;
 }
 
+const std::string* SPNStatusSpec::findValueDescription(u8 value) const {
+
+    auto iter = mValueToDesc.find(value);
+
+    return (iter != mValueToDesc.end() ? &(iter->second) : nullptr);
+}
+
 } /* namespace J1939 */
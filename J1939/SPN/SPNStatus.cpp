@@ -33,28 +33,40 @@ SPNStatus::~SPNStatus() {
 }
 
 
-void SPNStatus::decode(const u8* buffer, size_t) {
+ECodecStatus SPNStatus::tryDecode(const u8* buffer, size_t length) {
 
     if(getBitOffset() > 7 || getBitSize() > 8 || getBitOffset() + getBitSize() > 8) {
-        throw J1939DecodeException("[SPNStatus::decode] Format incorrect to decode properly this spn");
+        return CODEC_INVALID_SPN_FORMAT;
+    }
+
+    if(length < 1) {
+        return CODEC_BUFFER_TOO_SHORT;
     }
 
 	u8 mask = 0xFF >> (8 - getBitSize());
 	mValue = ((*buffer >> getBitOffset()) & mask);
+
+	setDirty();
+
+	return CODEC_OK;
 }
 
 
-void SPNStatus::encode(u8* buffer, size_t) const {
+ECodecStatus SPNStatus::tryEncode(u8* buffer, size_t length) const {
 
     if(getBitOffset() > 7 || getBitSize() > 8 || getBitOffset() + getBitSize() > 8) {
-        throw J1939EncodeException("[SPNStatus::encode] Format incorrect to encode properly this spn");
+        return CODEC_INVALID_SPN_FORMAT;
+    }
+
+    if(length < 1) {
+        return CODEC_BUFFER_TOO_SHORT;
     }
 
     u8 mask = (0xFF >> (8 - getBitSize())) << getBitOffset();
     u8 value = mValue << getBitOffset();
 
     if((value & mask) != value) {
-        throw J1939EncodeException("[SPNStatus::encode] Value to encode is bigger than expected");
+        return CODEC_VALUE_OUT_OF_RANGE;
     }
 
     //Clear the bits from the buffer
@@ -63,6 +75,8 @@ void SPNStatus::encode(u8* buffer, size_t) const {
     //Set the new value
     *buffer = *buffer | value;
 
+    return CODEC_OK;
+
 }
 
 
@@ -72,9 +86,9 @@ std::string SPNStatus::toString() const {
 
 	std::stringstream sstr;
 
-	SPNStatusSpec::DescMap valueToDesc = getValueDescriptionsMap();
+	const std::string* desc = findValueDescription(mValue);
 
-	sstr << " -> Status: " << ((valueToDesc.find(mValue) != valueToDesc.end()) ? valueToDesc[mValue] : "") <<
+	sstr << " -> Status: " << (desc ? *desc : "") <<
 			" (" << static_cast<u32>(mValue) << ")" << std::endl;
 
 	retval += sstr.str();
@@ -86,6 +100,7 @@ bool SPNStatus::setValue(u8 value) {
 
 	if(value < (1 << getBitSize())) {
 		mValue = value;
+		setDirty();
 		return true;
 	}
 	return false;
@@ -97,6 +112,8 @@ void SPNStatus::copy(const SPN& other) {
 
 	mValue = numOther->mValue;
 
+	setDirty();
+
 }
 
 } /* namespace J1939 */
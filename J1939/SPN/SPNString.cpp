@@ -41,19 +41,19 @@ void SPNString::setValue(std::string value)
 	}
 }
 
-void SPNString::decode(const u8* buffer, size_t length) {
+ECodecStatus SPNString::tryDecode(const u8* buffer, size_t length) {
 
 	char *terminator = (char*) memchr(buffer, J1939_STR_TERMINATOR, length);
 
 	mValue.clear();
 
 	if(!terminator) {
-		throw J1939DecodeException("[SPNString::decode] '*' terminator not found");
+		return CODEC_STRING_NOT_TERMINATED;
 	}
 
 	for(const char *c = (const char*)(buffer); c != terminator; ++c) {
 		if(*c & 0x80) {
-			throw J1939DecodeException("[SPNString::decode] String is not ASCII");
+			return CODEC_STRING_NOT_ASCII;
 		}
 	}
 
@@ -65,12 +65,14 @@ void SPNString::decode(const u8* buffer, size_t length) {
 		mOwner->recalculateStringOffsets();
 	}
 
+	return CODEC_OK;
+
 }
 
-void SPNString::encode(u8* buffer, size_t length) const {
+ECodecStatus SPNString::tryEncode(u8* buffer, size_t length) const {
 
 	if(mValue.size() >= length) {
-		throw J1939EncodeException("[SPNString::encode] Not enough length to encode the string");
+		return CODEC_BUFFER_TOO_SHORT;
 	}
 
 	//Copy string to the buffer
@@ -79,6 +81,8 @@ void SPNString::encode(u8* buffer, size_t length) const {
 	//Add string terminator to need of the string
 	buffer[mValue.size()] = J1939_STR_TERMINATOR;
 
+	return CODEC_OK;
+
 }
 
 
@@ -102,6 +106,10 @@ void SPNString::copy(const SPN& other) {
 
 	mValue = numOther->mValue;
 
+	if(mOwner) {		//The offsets for SPN of type string may have changed.
+		mOwner->recalculateStringOffsets();
+	}
+
 }
 
 } /* namespace J1939 */
@@ -0,0 +1,120 @@
+/*
+ * TimerWheel.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <TimerWheel.h>
+
+#include <Utils.h>
+
+
+namespace J1939 {
+
+namespace {
+
+size_t roundUpPowerOfTwo(size_t value) {
+
+	size_t power = 1;
+
+	while(power < value) {
+		power <<= 1;
+	}
+
+	return power;
+}
+
+}
+
+
+TimerWheel::TimerWheel(u32 resolution, size_t slots) : mSlots(roundUpPowerOfTwo(J1939_MAX(slots, 1))),
+		mMask(mSlots.size() - 1), mResolution(J1939_MAX(resolution, 1)), mTime(0), mCount(0) {
+
+	for(auto slot = mSlots.begin(); slot != mSlots.end(); ++slot) {
+		slot->mPrev = slot->mNext = &(*slot);
+	}
+
+}
+
+TimerWheel::~TimerWheel() {
+	clear();
+}
+
+void TimerWheel::link(Timer& head, Timer& timer) {
+
+	timer.mPrev = head.mPrev;
+	timer.mNext = &head;
+
+	head.mPrev->mNext = &timer;
+	head.mPrev = &timer;
+
+}
+
+void TimerWheel::unlink(Timer& timer) {
+
+	timer.mPrev->mNext = timer.mNext;
+	timer.mNext->mPrev = timer.mPrev;
+
+	timer.mPrev = timer.mNext = nullptr;
+
+}
+
+void TimerWheel::schedule(Timer& timer, u64 deadline) {
+
+	if(timer.isScheduled()) {
+		unlink(timer);
+	} else {
+		++mCount;
+	}
+
+	timer.deadline = deadline;
+
+	//Already elapsed deadlines go to the current slot, visited in the next advance
+	u64 tick = J1939_MAX(deadline, mTime) / mResolution;
+
+	link(mSlots[tick & mMask], timer);
+
+}
+
+void TimerWheel::cancel(Timer& timer) {
+
+	if(timer.isScheduled()) {
+		unlink(timer);
+		--mCount;
+	}
+
+}
+
+void TimerWheel::collect(Timer& slot, Timer& expired) {
+
+	Timer* timer = slot.mNext;
+
+	while(timer != &slot) {
+
+		Timer* next = timer->mNext;
+
+		//The timers of later turns stay
+		if(timer->deadline <= mTime) {
+			unlink(*timer);
+			link(expired, *timer);
+		}
+
+		timer = next;
+	}
+
+}
+
+void TimerWheel::clear() {
+
+	for(auto slot = mSlots.begin(); slot != mSlots.end(); ++slot) {
+		while(slot->mNext != &(*slot)) {
+			unlink(*slot->mNext);
+		}
+	}
+
+	mCount = 0;
+
+}
+
+} /* namespace J1939 */
@@ -5,6 +5,8 @@
  *      Author: fernado
  */
 
+#include <string.h>
+
 #include <Utils.h>
 #include <Transport/BAM/BamFragmenter.h>
 
@@ -23,7 +25,7 @@ bool BamFragmenter::fragment(const J1939Frame& frame) {
 
 	size_t length = frame.getDataLength();
 
-	if(length <= J1939_MAX_SIZE) {			//Not necessary to fragment the frame
+	if(length <= J1939_MAX_SIZE || length > TP_MAX_MSG_SIZE) {			//Not necessary or not possible to fragment the frame
 		return false;
 	}
 
@@ -31,64 +33,75 @@ bool BamFragmenter::fragment(const J1939Frame& frame) {
 	//Clear previous fragmented frames
 	clear();
 
+	mDTFrames.reserve((length + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE);
 
-	//Bam type
-	mCMFrame.setCtrlType(CTRL_TPCM_BAM);
-
+	bool connection = true;
 
-	//Same source and priority as the original frame
-	mCMFrame.setPriority(frame.getPriority());
-	mCMFrame.setSrcAddr(frame.getSrcAddr());
+	//The packets are encoded only by the static version, the first one is the connection frame
+	return fragment(frame, [this, &connection](u32 id, const u8* packet, size_t size) {
 
+		if(connection) {
+			mCMFrame.decode(id, packet, size);
+			connection = false;
+		} else {
+			TPDTFrame dataFrame;
+			dataFrame.decode(id, packet, size);
+			mDTFrames.push_back(dataFrame);
+		}
 
-	//Encoded pgn
-	mCMFrame.setDataPgn(frame.getPGN());
+	});
+}
 
-	//Always broadcast
-	mCMFrame.setDstAddr(J1939_BROADCAST_ADDRESS);
+bool BamFragmenter::fragment(const J1939Frame& frame, const PacketCallback& callback) {
 
-	size_t sq = 0;
+	size_t length = frame.getDataLength();
 
-	u8* data = new u8[length];
+	if(length <= J1939_MAX_SIZE || length > TP_MAX_MSG_SIZE) {
+		return false;
+	}
 
+	u8 data[TP_MAX_MSG_SIZE];
 	u32 unused;
 
 	frame.encode(unused, data, length);
 
-	for(size_t offset = 0 ; offset < length; offset += TP_DT_PACKET_SIZE) {
+	size_t packets = (length + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE;
 
-		TPDTFrame dataFrame(++sq, data + offset, J1939_MIN(TP_DT_PACKET_SIZE, length - offset));
+	TPCMFrame connFrame;
 
-		//Same source and priority as the original frame
-		dataFrame.setPriority(frame.getPriority());
-		dataFrame.setSrcAddr(frame.getSrcAddr());
+	connFrame.setCtrlType(CTRL_TPCM_BAM);
+	connFrame.setPriority(frame.getPriority());
+	connFrame.setSrcAddr(frame.getSrcAddr());
+	connFrame.setDstAddr(J1939_BROADCAST_ADDRESS);
+	connFrame.setDataPgn(frame.getPGN());
+	connFrame.setTotalPackets(packets);
+	connFrame.setTotalMsgSize(length);
 
-		//Always broadcast
-		dataFrame.setDstAddr(J1939_BROADCAST_ADDRESS);
+	u8 packet[J1939_MAX_SIZE];
+	size_t size = sizeof(packet);
+	u32 id;
 
-		mDTFrames[sq] = dataFrame;
+	connFrame.encode(id, packet, size);
 
-	}
+	callback(id, packet, size);
 
-	delete[] data;
+	//The data packets are built in place
+	id = ((frame.getPriority() & J1939_PRIORITY_MASK) << J1939_PRIORITY_OFFSET) |
+			((TP_DT_PGN | J1939_BROADCAST_ADDRESS) << J1939_PGN_OFFSET) | (frame.getSrcAddr() & J1939_SRC_ADDR_MASK);
 
-	mCMFrame.setTotalPackets(mDTFrames.size());
+	for(size_t sq = 1; sq <= packets; ++sq) {
 
-	mCMFrame.setTotalMsgSize(length);
+		size_t offset = (sq - 1) * TP_DT_PACKET_SIZE;
+		size = J1939_MIN(TP_DT_PACKET_SIZE, length - offset);
 
-	return true;
-}
-
-std::vector<TPDTFrame> BamFragmenter::getDataFrames() const {
+		packet[0] = sq;
+		memcpy(packet + 1, data + offset, size);
+		memset(packet + 1 + size, 0xFF, TP_DT_PACKET_SIZE - size);
 
-	std::vector<TPDTFrame> frames;
-
-	for(auto iter = mDTFrames.begin(); iter != mDTFrames.end(); ++iter) {
-		frames.push_back(iter->second);
+		callback(id, packet, sizeof(packet));
 	}
 
-	return frames;
-
+	return true;
 }
 
 } /* namespace J1939 */
@@ -17,20 +17,20 @@
 
 namespace J1939 {
 
-u8 BamReassembler::BAMFragments::getLastSQ() const{
-
-	if(mDTFrames.empty())
-	{
-		return 0;
-	}
-
-	return mDTFrames.back().getSq();
-
-}
+BamReassembler::BamReassembler(J1939Factory* factory, size_t slots) : mFactory(factory ? factory : &J1939Factory::getInstance()),
+		mSlotCount(J1939_MIN(J1939_MAX(slots, 1), J1939_BROADCAST_ADDRESS + 1)), mLastError(BAM_ERROR_OK),
+		mTimeout(BAM_TIMEOUT_T1), mExpiredSessions(0), mEvictedSessions(0) {
 
+	//No more sessions than sources
+	mBuffer.resize(mSlotCount * TP_MAX_MSG_SIZE);
+	mSessions.reset(new Session[mSlotCount]);
+	mFreeSlots.reserve(mSlotCount);
 
+	for(size_t i = 0; i < mSlotCount; ++i) {
+		mSessions[i].data = mBuffer.data() + i * TP_MAX_MSG_SIZE;
+	}
 
-BamReassembler::BamReassembler() : mLastError(BAM_ERROR_OK) {
+	clear();
 
 }
 
@@ -38,23 +38,6 @@ BamReassembler::~BamReassembler() {
 	clear();
 }
 
-void BamReassembler::reassemble(const BAMFragments& fragments, u8** data, size_t& length) {
-
-	size_t offset = 0;
-
-	length = fragments.getCmFrame().getTotalMsgSize();
-	*data = new u8[length];
-
-	for(std::vector<TPDTFrame>::const_iterator iter = fragments.getDtFrames().begin(); iter != fragments.getDtFrames().end(); iter++) {
-		memcpy((void*)(*data + offset), (void*)iter->getData(), J1939_MIN(length - offset, TP_DT_PACKET_SIZE));
-		offset += TP_DT_PACKET_SIZE;
-		if(offset >= length)
-		{
-			break;
-		}
-	}
-}
-
 bool BamReassembler::toBeHandled(const J1939Frame& frame) const {
 
 	const TPCMFrame* conn;
@@ -83,15 +66,37 @@ bool BamReassembler::toBeHandled(const J1939Frame& frame) const {
 }
 
 
-size_t BamReassembler::handleFrame(const J1939Frame& frame) {
+bool BamReassembler::toBeHandled(u32 id, const u8* data, size_t length) {
 
-	const TPDTFrame* data = NULL;
-	const TPCMFrame* conn = NULL;
+	if(!isTransportId(id)) {
+		return false;
+	}
+
+	if(((id >> J1939_PGN_OFFSET) & J1939_PGN_MASK) == (TP_DT_PGN | J1939_BROADCAST_ADDRESS)) {
+		return length == BAM_DT_SIZE;
+	}
+
+	return length == TP_CM_SIZE && data[0] == CTRL_TPCM_BAM;
+
+}
+
+size_t BamReassembler::handleFrame(const J1939Frame& frame, u64 now) {
 
-	size_t expectedSize = 0;
+	tick(now);
 
-	u8 srcAddr = frame.getSrcAddr();
+	return handleFrame(frame);
 
+}
+
+void BamReassembler::tick(u64 now) {
+
+	mExpiredSessions += mWheel.advance(now, [this](TimerWheel::Timer& timer) {
+		releaseSlot(timer.key);
+	});
+
+}
+
+size_t BamReassembler::handleFrame(const J1939Frame& frame) {
 
 	if(frame.getDstAddr() != J1939_BROADCAST_ADDRESS) {		//The frame does not have a broadcast address
 		setError(BAM_ERROR_NOT_BCAST_ADDR);
@@ -101,88 +106,207 @@ size_t BamReassembler::handleFrame(const J1939Frame& frame) {
 	switch(frame.getPGN()) {
 	case TP_CM_PGN:					//Conn management reception
 	{
-		conn = static_cast<const TPCMFrame*>(&frame);
+		const TPCMFrame* conn = static_cast<const TPCMFrame*>(&frame);
 
 		//Not the right Connection Manager frame...
 		if(conn->getCtrlType() != CTRL_TPCM_BAM) {
-
 			setError(BAM_ERROR_UNEXPECTED_FRAME);
-			break;
-		}
-
-		//New TP.CM frame but not all previous TP.DT frames were received
-		if(mFragments.find(srcAddr) != mFragments.end()) {
-			mFragments.erase(srcAddr);
-			setError(BAM_ERROR_INCOMPLETE_FRAME);
-		} else {
-			setError(BAM_ERROR_OK);
+			return 0;
 		}
 
-		mFragments[srcAddr].setCmFrame(*conn);
+		return handleConnection(conn->getSrcAddr(), conn->getPriority(), conn->getDataPgn(), conn->getTotalMsgSize(),
+				conn->getTotalPackets());
+	}
 
-		expectedSize = conn->getTotalMsgSize();
+	case TP_DT_PGN:					//Data reception
+	{
+		const TPDTFrame* data = static_cast<const TPDTFrame*>(&frame);
 
-	}	break;
+		return handleData(data->getSrcAddr(), data->getSq(), data->getData());
+	}
 
-	case TP_DT_PGN:					//Data reception
+	default:
 	{
+		//Not a frame for BAM protocol
+		setError(BAM_ERROR_UNEXPECTED_FRAME);
+		return 0;
+	}
 
-		if(mFragments.find(srcAddr) == mFragments.end()) {
-			setError(BAM_ERROR_UNEXPECTED_FRAME);
-			break;
-		}
+	}
 
-		data = static_cast<const TPDTFrame*>(&frame);
+}
 
-		u8 sq = data->getSq();
+size_t BamReassembler::handleFrame(u32 id, const u8* data, size_t length, u64 now) {
 
-		const TPCMFrame& connFrame = mFragments[srcAddr].getCmFrame();
+	tick(now);
 
-		expectedSize = connFrame.getTotalMsgSize();
+	return handleFrame(id, data, length);
 
-		if((connFrame.getTotalPackets() >= sq) && (mFragments[srcAddr].getLastSQ() + 1 == sq) ) {
-			mFragments[srcAddr].addDtFrame(*data);
-		} else {
-			setError(BAM_ERROR_UNEXPECTED_FRAME);
-			break;
-		}
+}
 
-		if(sq == connFrame.getTotalPackets()) {		//Time to reassemble the packet
+size_t BamReassembler::handleFrame(u32 id, const u8* data, size_t length) {
 
-			u8* fullData;
-			size_t length;
-			reassemble(mFragments[srcAddr], &fullData, length);
-			u32 newId = (((connFrame.getPriority() & J1939_PRIORITY_MASK) << J1939_PRIORITY_OFFSET) |
-					(connFrame.getDataPgn() << J1939_PGN_OFFSET) | (connFrame.getSrcAddr() & J1939_SRC_ADDR_MASK));
+	u32 pgn = ((id >> J1939_PGN_OFFSET) & J1939_PGN_MASK);
+	u8 srcAddr = id & J1939_SRC_ADDR_MASK;
 
-			std::unique_ptr<J1939Frame> decodedFrame = J1939Factory::getInstance().getJ1939Frame(newId, fullData, length);
-			delete[] fullData;
+	if((pgn & J1939_DST_ADDR_MASK) != J1939_BROADCAST_ADDRESS) {		//The frame does not have a broadcast address
+		setError(BAM_ERROR_NOT_BCAST_ADDR);
+		return 0;
+	}
 
-			//Fragments reassembled, we can destroy the fragments
-			mFragments.erase(srcAddr);
+	switch(pgn & ~J1939_DST_ADDR_MASK) {
+	case TP_CM_PGN:					//Conn management reception, same layout as decoded by TPCMFrame
+	{
+		if(length != TP_CM_SIZE || data[0] != CTRL_TPCM_BAM) {
+			setError(BAM_ERROR_UNEXPECTED_FRAME);
+			return 0;
+		}
 
-			if(decodedFrame.get()) {
-				mReassembledFrames.push(decodedFrame.release());
-			} else {
-				setError(BAM_ERROR_DECODING);
-				return 0;
-			}
+		return handleConnection(srcAddr, (id >> J1939_PRIORITY_OFFSET) & J1939_PRIORITY_MASK,
+				data[5] | (data[6] << 8) | (data[7] << 16), data[1] | (data[2] << 8), data[3]);
+	}
 
-			setError(BAM_ERROR_OK);
+	case TP_DT_PGN:					//Data reception
+	{
+		if(length != BAM_DT_SIZE) {
+			setError(BAM_ERROR_UNEXPECTED_FRAME);
+			return 0;
 		}
 
-	}	break;
+		return handleData(srcAddr, data[0], data + 1);
+	}
 
 	default:
 	{
 		//Not a frame for BAM protocol
 		setError(BAM_ERROR_UNEXPECTED_FRAME);
+		return 0;
+	}
 
-	}	break;
+	}
 
+}
+
+size_t BamReassembler::handleConnection(u8 srcAddr, u8 priority, u32 pgn, u16 totalSize, u8 totalPackets) {
+
+	//New TP.CM frame but not all previous TP.DT frames were received
+	if(mSlotBySource[srcAddr] != BAM_NO_SLOT) {
+		releaseSlot(srcAddr);
+		setError(BAM_ERROR_INCOMPLETE_FRAME);
+	} else {
+		setError(BAM_ERROR_OK);
 	}
 
-	return expectedSize;
+	//The message does not fit in a slot or the packets do not cover it
+	if(totalSize > TP_MAX_MSG_SIZE || static_cast<size_t>(totalPackets) * TP_DT_PACKET_SIZE < totalSize) {
+		setError(BAM_ERROR_UNEXPECTED_FRAME);
+		return 0;
+	}
+
+	//A source that went silent must not keep the others from being reassembled
+	if(mFreeSlots.empty()) {
+		evictOldest();
+		setError(BAM_ERROR_NO_SLOT);
+	}
+
+	u16 slot = mFreeSlots.back();
+	mFreeSlots.pop_back();
+
+	mSlotBySource[srcAddr] = slot;
+
+	Session& session = mSessions[slot];
+
+	session.pgn = pgn;
+	session.priority = priority;
+	session.totalSize = totalSize;
+	session.totalPackets = totalPackets;
+	session.lastSQ = 0;
+	session.timer.key = srcAddr;
+
+	mWheel.schedule(session.timer, mWheel.getTime() + mTimeout);
+
+	return totalSize;
+
+}
+
+size_t BamReassembler::handleData(u8 srcAddr, u8 sq, const u8* data) {
+
+	u16 slot = mSlotBySource[srcAddr];
+
+	if(slot == BAM_NO_SLOT) {
+		setError(BAM_ERROR_UNEXPECTED_FRAME);
+		return 0;
+	}
+
+	Session& session = mSessions[slot];
+
+	if(sq > session.totalPackets || sq != session.lastSQ + 1) {
+		setError(BAM_ERROR_UNEXPECTED_FRAME);
+		return session.totalSize;
+	}
+
+	size_t offset = (sq - 1) * TP_DT_PACKET_SIZE;
+
+	//Packets beyond the message size only carry padding
+	if(offset < session.totalSize) {
+		memcpy(session.data + offset, data, J1939_MIN(TP_DT_PACKET_SIZE, session.totalSize - offset));
+	}
+
+	session.lastSQ = sq;
+
+	if(sq != session.totalPackets) {
+		mWheel.schedule(session.timer, mWheel.getTime() + mTimeout);
+		return session.totalSize;
+	}
+
+	//Time to decode the message, straight from the slot
+	size_t length = session.totalSize;
+
+	u32 newId = (((session.priority & J1939_PRIORITY_MASK) << J1939_PRIORITY_OFFSET) |
+			(session.pgn << J1939_PGN_OFFSET) | (srcAddr & J1939_SRC_ADDR_MASK));
+
+	ECodecStatus status;
+	std::unique_ptr<J1939Frame> decodedFrame = mFactory->getJ1939Frame(newId, session.data, length, status);
+
+	releaseSlot(srcAddr);
+
+	if(!decodedFrame.get()) {
+		setError(BAM_ERROR_DECODING);
+		return 0;
+	}
+
+	mReassembledFrames.push(decodedFrame.release());
+
+	setError(BAM_ERROR_OK);
+
+	return length;
+
+}
+
+void BamReassembler::releaseSlot(u8 srcAddr) {
+
+	mWheel.cancel(mSessions[mSlotBySource[srcAddr]].timer);
+
+	mFreeSlots.push_back(mSlotBySource[srcAddr]);
+	mSlotBySource[srcAddr] = BAM_NO_SLOT;
+
+}
+
+void BamReassembler::evictOldest() {
+
+	Session* oldest = nullptr;
+
+	//The slots in use are always scheduled, the earliest deadline is the one of the last packet received first
+	for(size_t i = 0; i < mSlotCount; ++i) {
+		if(mSessions[i].timer.isScheduled() && (!oldest || mSessions[i].timer.deadline < oldest->timer.deadline)) {
+			oldest = &mSessions[i];
+		}
+	}
+
+	if(oldest) {
+		releaseSlot(oldest->timer.key);
+		++mEvictedSessions;
+	}
 
 }
 
@@ -201,7 +325,20 @@ std::unique_ptr<J1939Frame> BamReassembler::dequeueReassembledFrame() {
 
 void BamReassembler::clear() {
 
-	mFragments.clear();
+	for(size_t i = 0; i <= J1939_BROADCAST_ADDRESS; ++i) {
+		mSlotBySource[i] = BAM_NO_SLOT;
+	}
+
+	//Taken from the back, the first slots are used first
+	mFreeSlots.clear();
+	mWheel.clear();
+
+	mExpiredSessions = 0;
+	mEvictedSessions = 0;
+
+	for(size_t i = mSlotCount; i > 0; --i) {
+		mFreeSlots.push_back(i - 1);
+	}
 
 	mLastError = BAM_ERROR_OK;
 
@@ -0,0 +1,161 @@
+/*
+ * ShardedReassembler.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <string.h>
+
+#include <chrono>
+
+//Common
+#include <Utils.h>
+
+//J1939
+#include <J1939Factory.h>
+#include <Transport/BAM/ShardedReassembler.h>
+
+//Empty polls of a worker before sleeping, and sleep between polls afterwards
+#define SHARDED_IDLE_SPINS				64
+#define SHARDED_IDLE_SLEEP_US			100
+
+namespace J1939 {
+
+ShardedReassembler::ShardedReassembler(size_t workers, J1939Factory* factory, size_t queueSize) :
+		mFactory(factory ? factory : &J1939Factory::getInstance()), mMessages(queueSize), mFinished(false),
+		mDroppedPackets(0) {
+
+	if(workers == 0) {
+		workers = J1939_MAX(std::thread::hardware_concurrency(), 1);
+	}
+
+	for(size_t i = 0; i < workers; ++i) {
+		mWorkers.push_back(std::unique_ptr<Worker>(new Worker(queueSize)));
+	}
+
+	//Started once all the workers exist
+	for(auto worker = mWorkers.begin(); worker != mWorkers.end(); ++worker) {
+		Worker* current = worker->get();
+		current->thread = std::thread([this, current]() { run(*current); });
+	}
+
+}
+
+ShardedReassembler::~ShardedReassembler() {
+
+	mFinished = true;
+
+	for(auto worker = mWorkers.begin(); worker != mWorkers.end(); ++worker) {
+		(*worker)->thread.join();
+	}
+
+}
+
+size_t ShardedReassembler::getWorker(u32 interface, u8 srcAddr) const {
+
+	//Fibonacci hashing, the sources of an interface are consecutive keys
+	u32 key = ((interface << 8) | srcAddr) * 0x9E3779B1u;
+
+	return (key >> 16) % mWorkers.size();
+
+}
+
+bool ShardedReassembler::push(u32 interface, u32 id, const u8* data, size_t length, u64 timestamp) {
+
+	Worker& worker = *mWorkers[getWorker(interface, id & J1939_SRC_ADDR_MASK)];
+
+	Packet packet;
+
+	packet.interface = interface;
+	packet.id = id;
+	packet.length = J1939_MIN(length, J1939_MAX_SIZE);
+	packet.timestamp = timestamp;
+
+	memcpy(packet.data, data, packet.length);
+
+	if(!worker.packets.push(packet)) {
+		mDroppedPackets.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	//Counted only once queued, so flush never waits for a packet that was dropped. The worker may count it as
+	//processed first, which only lets a concurrent flush return without waiting for it
+	worker.pushed.fetch_add(1, std::memory_order_relaxed);
+
+	return true;
+
+}
+
+void ShardedReassembler::flush() {
+
+	for(auto worker = mWorkers.begin(); worker != mWorkers.end(); ++worker) {
+
+		u64 pushed = (*worker)->pushed.load(std::memory_order_relaxed);
+
+		while((*worker)->processed.load(std::memory_order_acquire) < pushed) {
+			std::this_thread::yield();
+		}
+	}
+
+}
+
+void ShardedReassembler::run(Worker& worker) {
+
+	Packet packet;
+	u32 idle = 0;
+
+	while(!mFinished) {
+
+		if(!worker.packets.pop(packet)) {
+
+			if(++idle < SHARDED_IDLE_SPINS) {
+				std::this_thread::yield();
+			} else {
+				std::this_thread::sleep_for(std::chrono::microseconds(SHARDED_IDLE_SLEEP_US));
+			}
+
+			continue;
+		}
+
+		idle = 0;
+
+		process(worker, packet);
+
+		worker.processed.fetch_add(1, std::memory_order_release);
+	}
+
+}
+
+void ShardedReassembler::process(Worker& worker, const Packet& packet) {
+
+	std::unique_ptr<BamReassembler>& reassembler = worker.reassemblers[packet.interface];
+
+	if(!reassembler) {
+		reassembler.reset(new BamReassembler(mFactory));
+	}
+
+	reassembler->handleFrame(packet.id, packet.data, packet.length, packet.timestamp);
+
+	while(reassembler->reassembledFramesPending()) {
+
+		Message message;
+
+		message.frame = reassembler->dequeueReassembledFrame();
+		message.interface = packet.interface;
+		message.timestamp = packet.timestamp;
+
+		//Waits for the consumer, the messages of the worker keep their order
+		while(!mMessages.push(std::move(message))) {
+
+			if(mFinished) {
+				return;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+
+}
+
+} /* namespace J1939 */
@@ -0,0 +1,159 @@
+/*
+ * ETPCMFrame.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <string.h>
+
+#include <Transport/ETP/ETPCMFrame.h>
+
+
+#define ETPCM_NAME       "Extended Transport Connection Management"
+
+
+namespace J1939 {
+
+namespace {
+
+u32 decode24(const u8* buffer) {
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16);
+}
+
+void encode24(u8* buffer, u32 value) {
+	buffer[0] = value & 0xFF;
+	buffer[1] = (value >> 8) & 0xFF;
+	buffer[2] = (value >> 16) & 0xFF;
+}
+
+u32 decode32(const u8* buffer) {
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<u32>(buffer[3]) << 24);
+}
+
+void encode32(u8* buffer, u32 value) {
+	encode24(buffer, value);
+	buffer[3] = (value >> 24) & 0xFF;
+}
+
+}
+
+ETPCMFrame::ETPCMFrame() : J1939Frame(ETP_CM_PGN), mCtrlType(0), mTotalMsgSize(0), mPacketsToTx(0), mNextPacket(0),
+		mPacketOffset(0), mAbortReason(0), mDataPgn(0) {
+
+	mName = ETPCM_NAME;
+
+}
+
+ETPCMFrame::~ETPCMFrame() {
+
+}
+
+void ETPCMFrame::decodeData(const u8* buffer, size_t length) {
+
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[ETPCMFrame::decodeData] ") + getCodecStatusDescription(status) +
+				". Buffer length: " + std::to_string(length));
+	}
+
+}
+
+ECodecStatus ETPCMFrame::tryDecodeData(const u8* buffer, size_t length) {
+
+	if(length != ETP_CM_SIZE) {
+		return CODEC_INVALID_LENGTH;
+	}
+
+	mCtrlType = buffer[0];
+
+	switch(mCtrlType) {
+	case CTRL_ETPCM_RTS:
+	case CTRL_ETPCM_ACK:
+		mTotalMsgSize = decode32(buffer + 1);
+		break;
+	case CTRL_ETPCM_CTS:
+		mPacketsToTx = buffer[1];
+		mNextPacket = decode24(buffer + 2);
+		break;
+	case CTRL_ETPCM_DPO:
+		mPacketsToTx = buffer[1];
+		mPacketOffset = decode24(buffer + 2);
+		break;
+	case CTRL_ETPCM_ABORT:
+		mAbortReason = buffer[1];
+		break;
+	default:
+		return CODEC_UNKNOWN_CTRL_TYPE;
+	}
+
+	mDataPgn = decode24(buffer + 5);
+
+	return CODEC_OK;
+
+}
+
+void ETPCMFrame::encodeData(u8* buffer, size_t length) const {
+
+	ECodecStatus status = tryEncodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939EncodeException(std::string("[ETPCMFrame::encodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus ETPCMFrame::tryEncodeData(u8* buffer, size_t) const {
+
+	/*
+	 * If reserved, set to 0xFF
+	 */
+	memset(buffer, 0xFF, ETP_CM_SIZE);
+
+	buffer[0] = mCtrlType;
+
+	switch(mCtrlType) {
+	case CTRL_ETPCM_RTS:
+	case CTRL_ETPCM_ACK:
+		encode32(buffer + 1, mTotalMsgSize);
+		break;
+	case CTRL_ETPCM_CTS:
+		buffer[1] = mPacketsToTx;
+		encode24(buffer + 2, mNextPacket);
+		break;
+	case CTRL_ETPCM_DPO:
+		buffer[1] = mPacketsToTx;
+		encode24(buffer + 2, mPacketOffset);
+		break;
+	case CTRL_ETPCM_ABORT:
+		buffer[1] = mAbortReason;
+		break;
+	default:
+		return CODEC_UNKNOWN_CTRL_TYPE;
+	}
+
+	encode24(buffer + 5, mDataPgn);
+
+	return CODEC_OK;
+
+}
+
+void ETPCMFrame::clear() {
+
+	mCtrlType = 0;
+	mTotalMsgSize = 0;
+	mPacketsToTx = 0;
+	mNextPacket = 0;
+	mPacketOffset = 0;
+	mAbortReason = 0;
+
+	mDataPgn = 0;
+
+	setPriority(0);
+	setSrcAddr(0);
+	setDstAddr(J1939_BROADCAST_ADDRESS);
+
+}
+
+} /* namespace J1939 */
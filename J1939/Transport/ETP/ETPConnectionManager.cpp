@@ -0,0 +1,594 @@
+/*
+ * ETPConnectionManager.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <string.h>
+
+//Common
+#include <Utils.h>
+
+//J1939
+#include <Transport/ETP/ETPConnectionManager.h>
+
+namespace J1939 {
+
+namespace {
+
+u16 getSessionKey(u8 originator, u8 responder) {
+	return (static_cast<u16>(originator) << 8) | responder;
+}
+
+u8 getOriginator(u16 key) {
+	return key >> 8;
+}
+
+u8 getResponder(u16 key) {
+	return key & J1939_DST_ADDR_MASK;
+}
+
+}
+
+
+ETPConnectionManager::ETPConnectionManager(const ETPConfig& config) : mConfig(config),
+		mReadBuffer(ETP_MAX_WINDOW * TP_DT_PACKET_SIZE) {
+
+}
+
+ETPConnectionManager::~ETPConnectionManager() {
+	clear();
+}
+
+void ETPConnectionManager::removeLocalAddress(u8 address) {
+
+	mLocalAddresses.reset(address);
+
+	//The sessions of the address cannot continue
+	for(auto iter = mSessions.begin(); iter != mSessions.end();) {
+
+		if(getOriginator(iter->first) == address || getResponder(iter->first) == address) {
+			iter = eraseSession(iter);
+		} else {
+			++iter;
+		}
+	}
+
+}
+
+bool ETPConnectionManager::toBeHandled(const J1939Frame& frame) const {
+
+	if(frame.getDstAddr() == J1939_BROADCAST_ADDRESS || !mLocalAddresses.test(frame.getDstAddr())) {
+		return false;
+	}
+
+	return frame.getPGN() == ETP_CM_PGN || frame.getPGN() == ETP_DT_PGN;
+
+}
+
+void ETPConnectionManager::consumeFrame(const J1939Frame& frame, u64 now) {
+
+	if(!toBeHandled(frame)) {
+		return;
+	}
+
+	tick(now);
+
+	if(frame.getPGN() == ETP_DT_PGN) {
+		handleData(static_cast<const ETPDTFrame&>(frame), now);
+		return;
+	}
+
+	const ETPCMFrame& conn = static_cast<const ETPCMFrame&>(frame);
+
+	switch(conn.getCtrlType()) {
+	case CTRL_ETPCM_RTS:
+		handleRTS(conn, now);
+		break;
+	case CTRL_ETPCM_CTS:
+		handleCTS(conn, now);
+		break;
+	case CTRL_ETPCM_DPO:
+		handleDPO(conn, now);
+		break;
+	case CTRL_ETPCM_ACK:
+		handleAck(conn);
+		break;
+	case CTRL_ETPCM_ABORT:
+		handleAbort(conn);
+		break;
+	default:
+		break;
+	}
+
+}
+
+void ETPConnectionManager::handleRTS(const ETPCMFrame& conn, u64 now) {
+
+	u8 originator = conn.getSrcAddr();
+	u8 responder = conn.getDstAddr();
+	u16 key = getSessionKey(originator, responder);
+
+	SessionMap::iterator iter = mSessions.find(key);
+
+	if(iter != mSessions.end()) {
+
+		//Only one connection between two nodes in each direction
+		if(iter->second.originator || iter->second.pgn != conn.getDataPgn()) {
+			sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_NOT_SUPPORTED);
+			return;
+		}
+
+		//The most recent RTS for the same PGN is acted on and the previous one abandoned without abort
+		eraseSession(iter);
+	}
+
+	u32 totalSize = conn.getTotalMsgSize();
+
+	if(totalSize < ETP_MIN_MSG_SIZE || totalSize > ETP_MAX_MSG_SIZE) {
+		sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_OTHER);
+		return;
+	}
+
+	if(totalSize > mConfig.maxMsgSize || mSessions.size() >= mConfig.maxSessions ||
+			(mAcceptCallback && !mAcceptCallback(originator, responder, conn.getDataPgn(), totalSize))) {
+		sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_NOT_SUPPORTED);
+		return;
+	}
+
+	Session& session = mSessions[key];
+
+	session.originator = false;
+	session.timer.key = key;
+	session.priority = conn.getPriority();
+	session.pgn = conn.getDataPgn();
+	session.totalSize = totalSize;
+	session.totalPackets = (totalSize + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE;
+	session.retransmits = 0;
+	session.window.resize(J1939_MAX(mConfig.windowSize, 1) * TP_DT_PACKET_SIZE);
+
+	requestWindow(key, session, 1, now);
+
+}
+
+void ETPConnectionManager::requestWindow(u16 key, Session& session, u32 firstPacket, u64 now) {
+
+	u32 count = session.totalPackets - firstPacket + 1;
+
+	count = J1939_MIN(count, session.window.size() / TP_DT_PACKET_SIZE);
+
+	session.windowStart = firstPacket;
+	session.windowCount = count;
+	session.windowStarted = false;
+	session.received.reset();
+	session.state = STATE_WAIT_DPO;
+	mWheel.schedule(session.timer, now + mConfig.t2);
+
+	sendCM(CTRL_ETPCM_CTS, key, session, count, firstPacket);
+
+}
+
+void ETPConnectionManager::handleDPO(const ETPCMFrame& conn, u64 now) {
+
+	SessionMap::iterator iter = mSessions.find(getSessionKey(conn.getSrcAddr(), conn.getDstAddr()));
+
+	if(iter == mSessions.end() || iter->second.originator || iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	Session& session = iter->second;
+
+	if(session.state != STATE_WAIT_DPO) {
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_UNEXPECTED_DPO);
+		return;
+	}
+
+	if(conn.getPacketsToTx() == 0 || conn.getPacketsToTx() > session.windowCount) {
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_DPO_PACKETS);
+		return;
+	}
+
+	if(conn.getPacketOffset() != session.windowStart - 1) {
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_BAD_DPO_OFFSET);
+		return;
+	}
+
+	//The originator may send less packets than cleared
+	session.windowCount = conn.getPacketsToTx();
+	session.state = STATE_RECEIVING;
+	mWheel.schedule(session.timer, now + mConfig.t2);
+
+}
+
+void ETPConnectionManager::handleData(const ETPDTFrame& data, u64 now) {
+
+	u16 key = getSessionKey(data.getSrcAddr(), data.getDstAddr());
+
+	SessionMap::iterator iter = mSessions.find(key);
+
+	if(iter == mSessions.end() || iter->second.state != STATE_RECEIVING) {
+		return;
+	}
+
+	Session& session = iter->second;
+	u8 sq = data.getSq();
+
+	//Out of the window announced by the DPO
+	if(sq == 0 || sq > session.windowCount) {
+		return;
+	}
+
+	++mStats.packetsReceived;
+
+	if(!session.received.test(sq)) {
+
+		size_t offset = (static_cast<size_t>(session.windowStart) + sq - 2) * TP_DT_PACKET_SIZE;
+
+		memcpy(session.window.data() + (sq - 1) * TP_DT_PACKET_SIZE, data.getData(),
+				J1939_MIN(TP_DT_PACKET_SIZE, session.totalSize - offset));
+		session.received.set(sq);
+	}
+
+	session.windowStarted = true;
+	mWheel.schedule(session.timer, now + mConfig.t1);
+
+	if(sq == session.windowCount) {
+		endOfWindow(iter, now);
+	}
+
+}
+
+void ETPConnectionManager::endOfWindow(SessionMap::iterator iter, u64 now) {
+
+	Session& session = iter->second;
+
+	u32 missing = 1;
+
+	while(missing <= session.windowCount && session.received.test(missing)) {
+		++missing;
+	}
+
+	//The packets received in order are not requested again
+	deliver(iter->first, session, missing - 1);
+
+	if(missing <= session.windowCount) {
+
+		if(session.retransmits >= mConfig.maxRetransmits) {
+			finish(iter, TRANSFER_ABORTED, CONN_ABORT_RTX_LIMIT);
+			return;
+		}
+
+		++session.retransmits;
+		++mStats.retransmitRequests;
+
+		requestWindow(iter->first, session, session.windowStart + missing - 1, now);
+		return;
+	}
+
+	//The limit applies per window, the losses of a long transfer do not add up
+	session.retransmits = 0;
+
+	u32 nextPacket = session.windowStart + session.windowCount;
+
+	if(nextPacket <= session.totalPackets) {
+		requestWindow(iter->first, session, nextPacket, now);
+		return;
+	}
+
+	sendCM(CTRL_ETPCM_ACK, iter->first, session);
+
+	++mStats.messagesReceived;
+
+	finish(iter, TRANSFER_COMPLETED, 0);
+
+}
+
+void ETPConnectionManager::deliver(u16 key, const Session& session, u32 packets) {
+
+	if(packets == 0) {
+		return;
+	}
+
+	u32 offset = (session.windowStart - 1) * TP_DT_PACKET_SIZE;
+	u32 length = J1939_MIN(packets * TP_DT_PACKET_SIZE, session.totalSize - offset);
+
+	mStats.bytesReceived += length;
+
+	if(mDataCallback) {
+		mDataCallback(getOriginator(key), getResponder(key), session.pgn, offset, session.window.data(), length,
+				session.totalSize);
+	}
+
+}
+
+void ETPConnectionManager::handleCTS(const ETPCMFrame& conn, u64 now) {
+
+	u16 key = getSessionKey(conn.getDstAddr(), conn.getSrcAddr());
+
+	SessionMap::iterator iter = mSessions.find(key);
+
+	//A CTS without connection is ignored
+	if(iter == mSessions.end() || !iter->second.originator || iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	Session& session = iter->second;
+
+	if(conn.getPacketsToTx() == 0) {
+		session.state = STATE_HELD;
+		mWheel.schedule(session.timer, now + mConfig.t4);
+		return;
+	}
+
+	u32 nextPacket = conn.getNextPacket();
+
+	if(nextPacket == 0 || nextPacket > session.totalPackets ||
+			conn.getPacketsToTx() > session.totalPackets - nextPacket + 1) {
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_BAD_CTS);
+		return;
+	}
+
+	sendWindow(key, session, nextPacket, conn.getPacketsToTx());
+
+	session.state = (nextPacket + conn.getPacketsToTx() - 1 == session.totalPackets ? STATE_WAIT_ACK : STATE_WAIT_CTS);
+	mWheel.schedule(session.timer, now + mConfig.t3);
+
+}
+
+void ETPConnectionManager::handleAck(const ETPCMFrame& conn) {
+
+	SessionMap::iterator iter = mSessions.find(getSessionKey(conn.getDstAddr(), conn.getSrcAddr()));
+
+	//Ignored if received before the last data packet was sent
+	if(iter == mSessions.end() || !iter->second.originator || iter->second.state != STATE_WAIT_ACK ||
+			iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	++mStats.messagesSent;
+	mStats.bytesSent += iter->second.totalSize;
+
+	finish(iter, TRANSFER_COMPLETED, 0);
+
+}
+
+void ETPConnectionManager::handleAbort(const ETPCMFrame& conn) {
+
+	//The peer can be the originator or the responder
+	SessionMap::iterator iter = mSessions.find(getSessionKey(conn.getSrcAddr(), conn.getDstAddr()));
+
+	if(iter == mSessions.end() || iter->second.originator) {
+		iter = mSessions.find(getSessionKey(conn.getDstAddr(), conn.getSrcAddr()));
+
+		if(iter != mSessions.end() && !iter->second.originator) {
+			iter = mSessions.end();
+		}
+	}
+
+	if(iter == mSessions.end() || iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	++mStats.abortsReceived;
+
+	finish(iter, TRANSFER_ABORTED_BY_PEER, conn.getAbortReason());
+
+}
+
+bool ETPConnectionManager::send(u32 pgn, u8 priority, u8 srcAddr, u8 dstAddr, const u8* data, u32 length, u64 now) {
+
+	return send(pgn, priority, srcAddr, dstAddr, length, [data](u32 offset, u8* buffer, size_t size) {
+		memcpy(buffer, data + offset, size);
+	}, now);
+
+}
+
+bool ETPConnectionManager::send(u32 pgn, u8 priority, u8 srcAddr, u8 dstAddr, u32 length, ReadCallback read, u64 now) {
+
+	if(length < ETP_MIN_MSG_SIZE || length > ETP_MAX_MSG_SIZE || !read || dstAddr >= J1939_INVALID_ADDRESS ||
+			!mLocalAddresses.test(srcAddr) || mSessions.size() >= mConfig.maxSessions) {
+		return false;
+	}
+
+	u16 key = getSessionKey(srcAddr, dstAddr);
+
+	if(mSessions.find(key) != mSessions.end()) {
+		return false;
+	}
+
+	Session& session = mSessions[key];
+
+	//The destination goes in the ETP.CM frames, not in the PGN
+	if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
+		pgn &= ~J1939_PDU_SPECIFIC_MASK;
+	}
+
+	session.state = STATE_WAIT_CTS;
+	session.originator = true;
+	session.timer.key = key;
+	session.priority = priority;
+	session.pgn = pgn;
+	session.totalSize = length;
+	session.totalPackets = (length + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE;
+	session.retransmits = 0;
+	session.read = read;
+	mWheel.schedule(session.timer, now + mConfig.t3);
+
+	sendCM(CTRL_ETPCM_RTS, key, session);
+
+	return true;
+
+}
+
+void ETPConnectionManager::sendWindow(u16 key, Session& session, u32 firstPacket, u8 count) {
+
+	u32 offset = (firstPacket - 1) * TP_DT_PACKET_SIZE;
+	u32 length = J1939_MIN(static_cast<u32>(count) * TP_DT_PACKET_SIZE, session.totalSize - offset);
+
+	//Only the window is read, the message is never buffered whole
+	session.read(offset, mReadBuffer.data(), length);
+
+	sendCM(CTRL_ETPCM_DPO, key, session, count, firstPacket - 1);
+
+	u8 buffer[BAM_DT_SIZE];
+
+	u32 id = ((session.priority & J1939_PRIORITY_MASK) << J1939_PRIORITY_OFFSET) |
+			((ETP_DT_PGN | getResponder(key)) << J1939_PGN_OFFSET) | getOriginator(key);
+
+	//Built in place, the data packets are most of the traffic
+	for(u32 sq = 1; sq <= count; ++sq) {
+
+		u32 packetOffset = (sq - 1) * TP_DT_PACKET_SIZE;
+		u32 size = J1939_MIN(TP_DT_PACKET_SIZE, length - packetOffset);
+
+		buffer[0] = sq;
+		memcpy(buffer + 1, mReadBuffer.data() + packetOffset, size);
+		memset(buffer + 1 + size, 0xFF, TP_DT_PACKET_SIZE - size);
+
+		if(mSendCallback) {
+			mSendCallback(id, buffer, sizeof(buffer));
+		}
+	}
+
+	mStats.packetsSent += count;
+
+}
+
+void ETPConnectionManager::transmit(const J1939Frame& frame) {
+
+	u8 buffer[J1939_MAX_SIZE];
+	size_t length = sizeof(buffer);
+	u32 id;
+
+	frame.encode(id, buffer, length);
+
+	if(mSendCallback) {
+		mSendCallback(id, buffer, length);
+	}
+
+}
+
+void ETPConnectionManager::sendCM(u8 ctrlType, u16 key, const Session& session, u8 packets, u32 packetNumber) {
+
+	mCMFrame.clear();
+
+	mCMFrame.setCtrlType(ctrlType);
+	mCMFrame.setPriority(session.priority);
+	mCMFrame.setDataPgn(session.pgn);
+	mCMFrame.setTotalMsgSize(session.totalSize);
+	mCMFrame.setPacketsToTx(packets);
+	mCMFrame.setNextPacket(packetNumber);
+	mCMFrame.setPacketOffset(packetNumber);
+
+	//The RTS and the DPO go from the originator to the responder
+	if(ctrlType == CTRL_ETPCM_RTS || ctrlType == CTRL_ETPCM_DPO) {
+		mCMFrame.setSrcAddr(getOriginator(key));
+		mCMFrame.setDstAddr(getResponder(key));
+	} else {
+		mCMFrame.setSrcAddr(getResponder(key));
+		mCMFrame.setDstAddr(getOriginator(key));
+	}
+
+	transmit(mCMFrame);
+
+}
+
+void ETPConnectionManager::sendAbort(u8 srcAddr, u8 dstAddr, u32 pgn, u8 priority, u8 reason) {
+
+	mCMFrame.clear();
+
+	mCMFrame.setCtrlType(CTRL_ETPCM_ABORT);
+	mCMFrame.setPriority(priority);
+	mCMFrame.setSrcAddr(srcAddr);
+	mCMFrame.setDstAddr(dstAddr);
+	mCMFrame.setDataPgn(pgn);
+	mCMFrame.setAbortReason(reason);
+
+	transmit(mCMFrame);
+
+	++mStats.abortsSent;
+
+}
+
+void ETPConnectionManager::finish(SessionMap::iterator iter, ETransferResult result, u8 abortReason) {
+
+	u8 originator = getOriginator(iter->first);
+	u8 responder = getResponder(iter->first);
+	u32 pgn = iter->second.pgn;
+
+	if(result == TRANSFER_ABORTED) {
+
+		if(iter->second.originator) {
+			sendAbort(originator, responder, pgn, iter->second.priority, abortReason);
+		} else {
+			sendAbort(responder, originator, pgn, iter->second.priority, abortReason);
+		}
+	}
+
+	//Removed before notifying, the callback may open a new session
+	eraseSession(iter);
+
+	if(mFinishedCallback) {
+		mFinishedCallback(originator, responder, pgn, result, abortReason);
+	}
+
+}
+
+void ETPConnectionManager::abort(u8 originator, u8 responder, u8 reason) {
+
+	SessionMap::iterator iter = mSessions.find(getSessionKey(originator, responder));
+
+	if(iter != mSessions.end()) {
+		finish(iter, TRANSFER_ABORTED, reason);
+	}
+
+}
+
+void ETPConnectionManager::expire(SessionMap::iterator iter, u64 now) {
+
+	Session& session = iter->second;
+
+	//T1, packets of the window lost. The missing ones are requested again if the retransmissions allow it.
+	if(session.state == STATE_RECEIVING && session.windowStarted) {
+		endOfWindow(iter, now);
+		return;
+	}
+
+	//T2, T3 or T4
+	++mStats.timeouts;
+	finish(iter, TRANSFER_ABORTED, CONN_ABORT_TIMEOUT);
+
+}
+
+void ETPConnectionManager::tick(u64 now) {
+
+	mWheel.advance(now, [this, now](TimerWheel::Timer& timer) {
+
+		SessionMap::iterator iter = mSessions.find(timer.key);
+
+		if(iter != mSessions.end()) {
+			expire(iter, now);
+		}
+	});
+
+}
+
+ETPConnectionManager::SessionMap::iterator ETPConnectionManager::eraseSession(SessionMap::iterator iter) {
+
+	mWheel.cancel(iter->second.timer);
+
+	return mSessions.erase(iter);
+
+}
+
+void ETPConnectionManager::clear() {
+
+	//The timers are cancelled one by one, those already expired in a tick that calls the finished callback included
+	for(auto iter = mSessions.begin(); iter != mSessions.end();) {
+		iter = eraseSession(iter);
+	}
+
+}
+
+} /* namespace J1939 */
@@ -0,0 +1,21 @@
+/*
+ * ETPDTFrame.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#include <Transport/ETP/ETPDTFrame.h>
+
+
+#define ETPDT_NAME      "Extended Transport Data"
+
+namespace J1939 {
+
+ETPDTFrame::ETPDTFrame() : TPDTFrame(ETP_DT_PGN, ETPDT_NAME) {
+}
+
+ETPDTFrame::~ETPDTFrame() {
+}
+
+} /* namespace J1939 */
@@ -5,21 +5,643 @@
  *      Author: famez
  */
 
-#include "RTSCTSConnectionManager.h"
+#include <string.h>
+
+//Common
+#include <Utils.h>
+
+//J1939
+#include <J1939Factory.h>
+#include <Transport/RTSCTS/RTSCTSConnectionManager.h>
 
 namespace J1939 {
 
-RTSCTSConnectionManager::RTSCTSConnectionManager() {
-	// TODO Auto-generated constructor stub
+namespace {
+
+u16 getSessionKey(u8 originator, u8 responder) {
+	return (static_cast<u16>(originator) << 8) | responder;
+}
+
+u8 getOriginator(u16 key) {
+	return key >> 8;
+}
+
+u8 getResponder(u16 key) {
+	return key & J1939_DST_ADDR_MASK;
+}
+
+}
+
+
+RTSCTSConnectionManager::RTSCTSConnectionManager(const RTSCTSConfig& config, J1939Factory* factory) : mConfig(config),
+		mFactory(factory ? factory : &J1939Factory::getInstance()) {
 
 }
 
 RTSCTSConnectionManager::~RTSCTSConnectionManager() {
-	// TODO Auto-generated destructor stub
+	clear();
+}
+
+void RTSCTSConnectionManager::removeLocalAddress(u8 address) {
+
+	mLocalAddresses.reset(address);
+
+	//The sessions of the address cannot continue
+	for(auto iter = mSessions.begin(); iter != mSessions.end();) {
+
+		if(getOriginator(iter->first) == address || getResponder(iter->first) == address) {
+			iter = eraseSession(iter);
+		} else {
+			++iter;
+		}
+	}
+
+}
+
+bool RTSCTSConnectionManager::toBeHandled(const J1939Frame& frame) const {
+
+	if(frame.getDstAddr() == J1939_BROADCAST_ADDRESS || !mLocalAddresses.test(frame.getDstAddr())) {
+		return false;
+	}
+
+	switch(frame.getPGN()) {
+	case TP_CM_PGN:
+		return (static_cast<const TPCMFrame&>(frame).getCtrlType() != CTRL_TPCM_BAM);
+	case TP_DT_PGN:
+		return true;
+	default:
+		return false;
+	}
+
+}
+
+void RTSCTSConnectionManager::consumeFrame(const J1939Frame& frame, u64 now) {
+
+	if(!toBeHandled(frame)) {
+		return;
+	}
+
+	tick(now);
+
+	if(frame.getPGN() == TP_DT_PGN) {
+		handleData(static_cast<const TPDTFrame&>(frame), now);
+		return;
+	}
+
+	const TPCMFrame& conn = static_cast<const TPCMFrame&>(frame);
+
+	switch(conn.getCtrlType()) {
+	case CTRL_TPCM_RTS:
+		handleRTS(conn, now);
+		break;
+	case CTRL_TPCM_CTS:
+		handleCTS(conn, now);
+		break;
+	case CTRL_TPCM_ACK:
+		handleAck(conn);
+		break;
+	case CTRL_TPCM_ABORT:
+		handleAbort(conn);
+		break;
+	default:
+		break;
+	}
+
+}
+
+void RTSCTSConnectionManager::handleRTS(const TPCMFrame& conn, u64 now) {
+
+	u8 originator = conn.getSrcAddr();
+	u8 responder = conn.getDstAddr();
+	u16 key = getSessionKey(originator, responder);
+
+	SessionMap::iterator iter = mSessions.find(key);
+
+	if(iter != mSessions.end()) {
+
+		//Only one connection between two nodes in each direction
+		if(iter->second.originator || iter->second.pgn != conn.getDataPgn()) {
+			sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_NOT_SUPPORTED);
+			return;
+		}
+
+		//The most recent RTS for the same PGN is acted on and the previous one abandoned without abort
+		eraseSession(iter);
+	}
+
+	u16 totalSize = conn.getTotalMsgSize();
+
+	if(totalSize > RTSCTS_MAX_MSG_SIZE) {
+		sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_MSG_TOO_LONG);
+		return;
+	}
+
+	if(totalSize <= J1939_MAX_SIZE || conn.getTotalPackets() != (totalSize + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE) {
+		sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_OTHER);
+		return;
+	}
+
+	if(mSessions.size() >= mConfig.maxSessions) {
+		sendAbort(responder, originator, conn.getDataPgn(), conn.getPriority(), CONN_ABORT_NOT_SUPPORTED);
+		return;
+	}
+
+	Session& session = mSessions[key];
+
+	session.originator = false;
+	session.timer.key = key;
+	session.priority = conn.getPriority();
+	session.pgn = conn.getDataPgn();
+	session.totalSize = totalSize;
+	session.totalPackets = conn.getTotalPackets();
+	session.maxPacketsPerCTS = (conn.getMaxPackets() == 0 ? RTSCTS_NO_LIMIT : conn.getMaxPackets());
+	session.retransmits = 0;
+	session.lastHold = now;
+	session.received.reset();
+	session.data.resize(totalSize);
+
+	requestWindow(key, session, 1, now);
+
+}
+
+void RTSCTSConnectionManager::requestWindow(u16 key, Session& session, u8 firstPacket, u64 now) {
+
+	session.windowStart = firstPacket;
+	session.windowStarted = false;
+
+	//The application does not keep up with the reassembled frames
+	if(mConfig.maxPendingFrames != 0 && getPendingFrames() >= mConfig.maxPendingFrames) {
+
+		if(session.state != STATE_HOLDING || now >= session.lastHold + mConfig.th) {
+			sendCM(CTRL_TPCM_CTS, key, session, 0, 0xFF);
+			session.lastHold = now;
+		}
+
+		session.state = STATE_HOLDING;
+		mWheel.schedule(session.timer, now + mConfig.tr);
+		return;
+	}
+
+	u32 count = session.totalPackets - firstPacket + 1;
+
+	count = J1939_MIN(count, J1939_MAX(mConfig.windowSize, 1));
+	count = J1939_MIN(count, session.maxPacketsPerCTS);
+
+	session.windowEnd = firstPacket + count - 1;
+	session.state = STATE_RECEIVING;
+	mWheel.schedule(session.timer, now + mConfig.t2);
+
+	sendCM(CTRL_TPCM_CTS, key, session, count, firstPacket);
+
+}
+
+void RTSCTSConnectionManager::handleData(const TPDTFrame& data, u64 now) {
+
+	u16 key = getSessionKey(data.getSrcAddr(), data.getDstAddr());
+
+	SessionMap::iterator iter = mSessions.find(key);
+
+	if(iter == mSessions.end() || iter->second.state != STATE_RECEIVING) {
+		return;
+	}
+
+	Session& session = iter->second;
+	u8 sq = data.getSq();
+
+	//Out of the window cleared to send
+	if(sq < session.windowStart || sq > session.windowEnd) {
+		return;
+	}
+
+	++mStats.packetsReceived;
+
+	if(!session.received.test(sq)) {
+
+		size_t offset = (sq - 1) * TP_DT_PACKET_SIZE;
+
+		memcpy(session.data.data() + offset, data.getData(), J1939_MIN(TP_DT_PACKET_SIZE, session.totalSize - offset));
+		session.received.set(sq);
+	}
+
+	session.windowStarted = true;
+	mWheel.schedule(session.timer, now + mConfig.t1);
+
+	if(sq == session.windowEnd) {
+		endOfWindow(iter, now);
+	}
+
+}
+
+void RTSCTSConnectionManager::endOfWindow(SessionMap::iterator iter, u64 now) {
+
+	Session& session = iter->second;
+
+	u32 missing = session.windowStart;
+
+	while(missing <= session.windowEnd && session.received.test(missing)) {
+		++missing;
+	}
+
+	if(missing <= session.windowEnd) {
+
+		if(session.retransmits >= mConfig.maxRetransmits) {
+			finish(iter, TRANSFER_ABORTED, CONN_ABORT_RTX_LIMIT);
+			return;
+		}
+
+		++session.retransmits;
+		++mStats.retransmitRequests;
+
+		requestWindow(iter->first, session, missing, now);
+		return;
+	}
+
+	//The limit applies per window, the losses of a long transfer do not add up
+	session.retransmits = 0;
+
+	if(session.windowEnd == session.totalPackets) {
+		complete(iter);
+		return;
+	}
+
+	requestWindow(iter->first, session, session.windowEnd + 1, now);
+
 }
 
+void RTSCTSConnectionManager::complete(SessionMap::iterator iter) {
+
+	Session& session = iter->second;
+	u8 originator = getOriginator(iter->first);
+	u8 responder = getResponder(iter->first);
+
+	sendCM(CTRL_TPCM_ACK, iter->first, session);
+
+	//The destination of PDU1 messages is the responder
+	u32 pgn = session.pgn;
+
+	if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
+		pgn |= responder;
+	}
+
+	u32 id = ((session.priority & J1939_PRIORITY_MASK) << J1939_PRIORITY_OFFSET) | (pgn << J1939_PGN_OFFSET) |
+			(originator & J1939_SRC_ADDR_MASK);
+
+	ECodecStatus status;
+	std::unique_ptr<J1939Frame> frame = mFactory->getJ1939Frame(id, session.data.data(), session.totalSize, status);
+
+	if(frame.get()) {
+		mReassembledFrames.push(frame.release());
+		++mStats.messagesReceived;
+	} else {
+		++mStats.decodeErrors;
+	}
+
+	finish(iter, TRANSFER_COMPLETED, 0);
+
+}
+
+void RTSCTSConnectionManager::handleCTS(const TPCMFrame& conn, u64 now) {
+
+	u16 key = getSessionKey(conn.getDstAddr(), conn.getSrcAddr());
+
+	SessionMap::iterator iter = mSessions.find(key);
+
+	//A CTS without connection is ignored
+	if(iter == mSessions.end() || !iter->second.originator || iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	Session& session = iter->second;
+
+	if(conn.getPacketsToTx() == 0) {
+		session.state = STATE_HELD;
+		mWheel.schedule(session.timer, now + mConfig.t4);
+		return;
+	}
+
+	u8 nextPacket = conn.getNextPacket();
+
+	if(nextPacket == 0 || nextPacket > session.totalPackets) {
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_OTHER);
+		return;
+	}
+
+	u32 count = J1939_MIN(conn.getPacketsToTx(), session.totalPackets - nextPacket + 1);
+
+	count = J1939_MIN(count, session.maxPacketsPerCTS);
+
+	sendPackets(key, session, nextPacket, count);
+
+	session.state = (nextPacket + count - 1 == session.totalPackets ? STATE_WAIT_ACK : STATE_WAIT_CTS);
+	mWheel.schedule(session.timer, now + mConfig.t3);
+
+}
+
+void RTSCTSConnectionManager::handleAck(const TPCMFrame& conn) {
+
+	SessionMap::iterator iter = mSessions.find(getSessionKey(conn.getDstAddr(), conn.getSrcAddr()));
+
+	//Ignored if received before the last data packet was sent
+	if(iter == mSessions.end() || !iter->second.originator || iter->second.state != STATE_WAIT_ACK ||
+			iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	++mStats.messagesSent;
+
+	finish(iter, TRANSFER_COMPLETED, 0);
+
+}
+
+void RTSCTSConnectionManager::handleAbort(const TPCMFrame& conn) {
+
+	//The peer can be the originator or the responder
+	SessionMap::iterator iter = mSessions.find(getSessionKey(conn.getSrcAddr(), conn.getDstAddr()));
+
+	if(iter == mSessions.end() || iter->second.originator) {
+		iter = mSessions.find(getSessionKey(conn.getDstAddr(), conn.getSrcAddr()));
+
+		if(iter != mSessions.end() && !iter->second.originator) {
+			iter = mSessions.end();
+		}
+	}
+
+	if(iter == mSessions.end() || iter->second.pgn != conn.getDataPgn()) {
+		return;
+	}
+
+	++mStats.abortsReceived;
+
+	finish(iter, TRANSFER_ABORTED_BY_PEER, conn.getAbortReason());
+
+}
+
+bool RTSCTSConnectionManager::send(const J1939Frame& frame, u64 now) {
+
+	size_t length = frame.getDataLength();
+	u32 id;
+
+	if(length <= J1939_MAX_SIZE || length > RTSCTS_MAX_MSG_SIZE) {
+		return false;
+	}
+
+	mEncodeBuffer.resize(length);
+
+	if(frame.tryEncode(id, mEncodeBuffer.data(), length) != CODEC_OK) {
+		return false;
+	}
+
+	return send(frame.getPGN(), frame.getPriority(), frame.getSrcAddr(), frame.getDstAddr(), mEncodeBuffer.data(), length, now);
+
+}
+
+bool RTSCTSConnectionManager::send(u32 pgn, u8 priority, u8 srcAddr, u8 dstAddr, const u8* data, size_t length, u64 now) {
+
+	if(length <= J1939_MAX_SIZE || length > RTSCTS_MAX_MSG_SIZE || dstAddr >= J1939_INVALID_ADDRESS ||
+			!mLocalAddresses.test(srcAddr) || mSessions.size() >= mConfig.maxSessions) {
+		return false;
+	}
+
+	u16 key = getSessionKey(srcAddr, dstAddr);
+
+	if(mSessions.find(key) != mSessions.end()) {
+		return false;
+	}
+
+	Session& session = mSessions[key];
+
+	//The destination goes in the TP.CM frames, not in the PGN
+	if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
+		pgn &= ~J1939_PDU_SPECIFIC_MASK;
+	}
+
+	session.state = STATE_WAIT_CTS;
+	session.originator = true;
+	session.timer.key = key;
+	session.priority = priority;
+	session.pgn = pgn;
+	session.totalSize = length;
+	session.totalPackets = (length + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE;
+	session.maxPacketsPerCTS = mConfig.maxPacketsPerCTS;
+	session.retransmits = 0;
+	mWheel.schedule(session.timer, now + mConfig.t3);
+	session.data.assign(data, data + length);
+
+	sendCM(CTRL_TPCM_RTS, key, session);
+
+	return true;
+
+}
+
+void RTSCTSConnectionManager::sendPackets(u16 key, const Session& session, u8 firstPacket, u8 count) {
+
+	u8 buffer[BAM_DT_SIZE];
+
+	u32 id = ((session.priority & J1939_PRIORITY_MASK) << J1939_PRIORITY_OFFSET) |
+			((TP_DT_PGN | getResponder(key)) << J1939_PGN_OFFSET) | getOriginator(key);
+
+	//Built in place, the data packets are most of the traffic
+	for(u32 sq = firstPacket; sq < static_cast<u32>(firstPacket) + count; ++sq) {
+
+		size_t offset = (sq - 1) * TP_DT_PACKET_SIZE;
+		size_t length = J1939_MIN(TP_DT_PACKET_SIZE, session.totalSize - offset);
+
+		buffer[0] = sq;
+		memcpy(buffer + 1, session.data.data() + offset, length);
+		memset(buffer + 1 + length, 0xFF, TP_DT_PACKET_SIZE - length);
+
+		if(mSendCallback) {
+			mSendCallback(id, buffer, sizeof(buffer));
+		}
+	}
+
+	mStats.packetsSent += count;
+
+}
+
+void RTSCTSConnectionManager::transmit(const J1939Frame& frame) {
+
+	u8 buffer[J1939_MAX_SIZE];
+	size_t length = sizeof(buffer);
+	u32 id;
+
+	frame.encode(id, buffer, length);
+
+	if(mSendCallback) {
+		mSendCallback(id, buffer, length);
+	}
+
+}
+
+void RTSCTSConnectionManager::sendCM(u8 ctrlType, u16 key, const Session& session, u8 packets, u8 nextPacket) {
+
+	mCMFrame.clear();
+
+	mCMFrame.setCtrlType(ctrlType);
+	mCMFrame.setPriority(session.priority);
+	mCMFrame.setDataPgn(session.pgn);
+	mCMFrame.setTotalMsgSize(session.totalSize);
+	mCMFrame.setTotalPackets(session.totalPackets);
+	mCMFrame.setMaxPackets(session.maxPacketsPerCTS);
+	mCMFrame.setPacketsToTx(packets);
+	mCMFrame.setNextPacket(nextPacket);
+
+	//Only the RTS goes from the originator to the responder
+	if(ctrlType == CTRL_TPCM_RTS) {
+		mCMFrame.setSrcAddr(getOriginator(key));
+		mCMFrame.setDstAddr(getResponder(key));
+	} else {
+		mCMFrame.setSrcAddr(getResponder(key));
+		mCMFrame.setDstAddr(getOriginator(key));
+	}
+
+	transmit(mCMFrame);
+
+}
+
+void RTSCTSConnectionManager::sendAbort(u8 srcAddr, u8 dstAddr, u32 pgn, u8 priority, u8 reason) {
+
+	mCMFrame.clear();
+
+	mCMFrame.setCtrlType(CTRL_TPCM_ABORT);
+	mCMFrame.setPriority(priority);
+	mCMFrame.setSrcAddr(srcAddr);
+	mCMFrame.setDstAddr(dstAddr);
+	mCMFrame.setDataPgn(pgn);
+	mCMFrame.setAbortReason(reason);
+
+	transmit(mCMFrame);
+
+	++mStats.abortsSent;
+
+}
+
+void RTSCTSConnectionManager::finish(SessionMap::iterator iter, ETransferResult result, u8 abortReason) {
+
+	u8 originator = getOriginator(iter->first);
+	u8 responder = getResponder(iter->first);
+	u32 pgn = iter->second.pgn;
+
+	if(result == TRANSFER_ABORTED) {
+
+		if(iter->second.originator) {
+			sendAbort(originator, responder, pgn, iter->second.priority, abortReason);
+		} else {
+			sendAbort(responder, originator, pgn, iter->second.priority, abortReason);
+		}
+	}
+
+	//Removed before notifying, the callback may open a new session
+	eraseSession(iter);
+
+	if(mFinishedCallback) {
+		mFinishedCallback(originator, responder, pgn, result, abortReason);
+	}
+
+}
+
+void RTSCTSConnectionManager::abort(u8 originator, u8 responder, u8 reason) {
+
+	SessionMap::iterator iter = mSessions.find(getSessionKey(originator, responder));
+
+	if(iter != mSessions.end()) {
+		finish(iter, TRANSFER_ABORTED, reason);
+	}
+
+}
+
+void RTSCTSConnectionManager::expire(SessionMap::iterator iter, u64 now) {
+
+	Session& session = iter->second;
+
+	switch(session.state) {
+	case STATE_HOLDING:
+
+		//Tr elapsed, the CTS is sent if there is room for more frames, the hold is repeated otherwise
+		requestWindow(iter->first, session, session.windowStart, now);
+		break;
+
+	case STATE_RECEIVING:
+
+		//T1, packets of the window lost. The missing ones are requested again if the retransmissions allow it.
+		if(session.windowStarted) {
+			endOfWindow(iter, now);
+			break;
+		}
+
+		//T2, no data after the CTS
+		++mStats.timeouts;
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_TIMEOUT);
+		break;
+
+	default:
+
+		//T3 or T4
+		++mStats.timeouts;
+		finish(iter, TRANSFER_ABORTED, CONN_ABORT_TIMEOUT);
+		break;
+	}
+
+}
+
+void RTSCTSConnectionManager::tick(u64 now) {
+
+	mWheel.advance(now, [this, now](TimerWheel::Timer& timer) {
+
+		SessionMap::iterator iter = mSessions.find(timer.key);
+
+		if(iter != mSessions.end()) {
+			expire(iter, now);
+		}
+	});
+
+}
+
+bool RTSCTSConnectionManager::getNextDeadline(u64& deadline) const {
+
+	if(mSessions.empty()) {
+		return false;
+	}
+
+	deadline = mSessions.begin()->second.timer.deadline;
+
+	for(auto iter = mSessions.begin(); iter != mSessions.end(); ++iter) {
+		deadline = J1939_MIN(deadline, iter->second.timer.deadline);
+	}
+
+	return true;
+
+}
+
+RTSCTSConnectionManager::SessionMap::iterator RTSCTSConnectionManager::eraseSession(SessionMap::iterator iter) {
+
+	mWheel.cancel(iter->second.timer);
+
+	return mSessions.erase(iter);
+
+}
+
+std::unique_ptr<J1939Frame> RTSCTSConnectionManager::dequeueReassembledFrame() {
+
+	J1939Frame* retVal = mReassembledFrames.front();
+
+	mReassembledFrames.pop();
+
+	return std::unique_ptr<J1939Frame>(retVal);
+
+}
+
+void RTSCTSConnectionManager::clear() {
+
+	//The timers are cancelled one by one, those already expired in a tick that calls the finished callback included
+	for(auto iter = mSessions.begin(); iter != mSessions.end();) {
+		iter = eraseSession(iter);
+	}
 
-void RTSCTSConnectionManager::consumeFrame(const J1939Frame&) {
+	while(!mReassembledFrames.empty()) {
+		delete mReassembledFrames.front();
+		mReassembledFrames.pop();
+	}
 
 }
 
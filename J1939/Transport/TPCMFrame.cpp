@@ -29,10 +29,20 @@ TPCMFrame::~TPCMFrame() {
 
 void TPCMFrame::decodeData(const u8* buffer, size_t length) {
 
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[TPCMFrame::decodeData] ") + getCodecStatusDescription(status) +
+				". Buffer length: " + std::to_string(length));
+	}
+
+}
+
+ECodecStatus TPCMFrame::tryDecodeData(const u8* buffer, size_t length) {
+
 
 	if(length != TP_CM_SIZE) {
-		throw J1939DecodeException("[TPCMFrame::decodeData] Buffer length does not match the expected "
-				"length. Buffer length:" + std::to_string(length) + ". Expected length: " + std::to_string(TP_CM_SIZE));
+		return CODEC_INVALID_LENGTH;
 	}
 
 	mCtrlType = buffer[0];
@@ -57,17 +67,27 @@ void TPCMFrame::decodeData(const u8* buffer, size_t length) {
 		decodeBAM(buffer + 1);
 		break;
 	default:
-        throw J1939DecodeException("[TPCMFrame::decodeData] Unknown Ctrl type");
-		break;
+		return CODEC_UNKNOWN_CTRL_TYPE;
 	}
 
 
 	mDataPgn = buffer[5] | (buffer[6] << 8) | (buffer[7] << 16);
 
+	return CODEC_OK;
 
 }
 
-void TPCMFrame::encodeData(u8* buffer, size_t ) const {
+void TPCMFrame::encodeData(u8* buffer, size_t length) const {
+
+	ECodecStatus status = tryEncodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939EncodeException(std::string("[TPCMFrame::encodeData] ") + getCodecStatusDescription(status));
+	}
+
+}
+
+ECodecStatus TPCMFrame::tryEncodeData(u8* buffer, size_t) const {
 
 	/*
 	 * If reserved, set to 0xFF
@@ -95,8 +115,7 @@ void TPCMFrame::encodeData(u8* buffer, size_t ) const {
 		encodeBAM(buffer + 1);
 		break;
 	default:
-        throw J1939DecodeException("[TPCMFrame::encodeData] Unknown Ctrl Type");
-		break;
+		return CODEC_UNKNOWN_CTRL_TYPE;
 	}
 
 
@@ -104,6 +123,8 @@ void TPCMFrame::encodeData(u8* buffer, size_t ) const {
 	buffer[6] = (mDataPgn >> 8) & 0xFF;
 	buffer[7] = (mDataPgn >> 16) & 0xFF;
 
+	return CODEC_OK;
+
 }
 
 void TPCMFrame::clear() {
@@ -15,9 +15,12 @@
 
 namespace J1939 {
 
-TPDTFrame::TPDTFrame() : J1939Frame(TP_DT_PGN), mSQ(0) {
+TPDTFrame::TPDTFrame() : TPDTFrame(TP_DT_PGN, TPDT_NAME) {
+}
+
+TPDTFrame::TPDTFrame(u32 pgn, const std::string& name) : J1939Frame(pgn), mSQ(0) {
 	memset(mData, 0xFF, TP_DT_PACKET_SIZE);
-    mName = TPDT_NAME;
+    mName = name;
 }
 
 
@@ -31,14 +34,26 @@ TPDTFrame::~TPDTFrame() {
 
 void TPDTFrame::decodeData(const u8* buffer, size_t length) {
 
+	ECodecStatus status = tryDecodeData(buffer, length);
+
+	if(status != CODEC_OK) {
+		throw J1939DecodeException(std::string("[TPDTFrame::decodeData] ") + getCodecStatusDescription(status) +
+				". Buffer length: " + std::to_string(length));
+	}
+
+}
+
+ECodecStatus TPDTFrame::tryDecodeData(const u8* buffer, size_t length) {
+
 	if(length != BAM_DT_SIZE) {
-		throw J1939DecodeException("[TPDTFrame::decodeData] Buffer length does not match the expected length. Buffer length:" + std::to_string(length)
-		+ ". Expected length: " + std::to_string(TP_DT_PACKET_SIZE));
+		return CODEC_INVALID_LENGTH;
 	}
 	mSQ = *buffer++;
 
 	memcpy(mData, buffer, TP_DT_PACKET_SIZE);
 
+	return CODEC_OK;
+
 }
 void TPDTFrame::encodeData(u8* buffer, size_t) const {
 
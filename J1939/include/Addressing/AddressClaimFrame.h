@@ -168,6 +168,7 @@ private:
 protected:
 
 	void decodeData(const u8* buffer, size_t length);
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
 	void encodeData(u8* buffer, size_t length) const;
 
 public:
@@ -177,7 +178,7 @@ public:
 
 	size_t getDataLength() const override { return ADDRESS_FRAME_LENGTH; }
 
-	const EcuName& getEcuName() { return mEcuName; }
+	const EcuName& getEcuName() const { return mEcuName; }
 
 	std::string toString() const;
 
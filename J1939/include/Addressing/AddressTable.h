@@ -0,0 +1,65 @@
+/*
+ * AddressTable.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Source addresses claimed in a bus and the NAME of the ECU that claimed each of them, kept up to date from the
+ *  address claim frames received in the bus.
+ */
+
+#ifndef ADDRESSING_ADDRESSTABLE_H_
+#define ADDRESSING_ADDRESSTABLE_H_
+
+#include <Types.h>
+
+#include "AddressClaimFrame.h"
+
+#define ADDRESS_TABLE_SIZE		(J1939_BROADCAST_ADDRESS + 1)
+
+namespace J1939 {
+
+class AddressTable {
+
+private:
+	struct Entry {
+		EcuName name;
+		bool claimed = false;
+	};
+
+	Entry mEntries[ADDRESS_TABLE_SIZE];
+	size_t mCount;
+
+public:
+	AddressTable() : mCount(0) {}
+	virtual ~AddressTable() {}
+
+	/*
+	 * Updates the table with the given address claim. The previous address of the same ECU is released.
+	 * A claim from the null address means that the ECU could not claim any address.
+	 */
+	void update(const AddressClaimFrame& claim);
+
+	/*
+	 * Returns false if nobody claimed the address
+	 */
+	bool getName(u8 address, EcuName& name) const;
+
+	/*
+	 * Returns false if the ECU has not claimed any address
+	 */
+	bool getAddress(const EcuName& name, u8& address) const;
+
+	bool isClaimed(u8 address) const { return mEntries[address].claimed; }
+
+	void release(u8 address);
+
+	void clear();
+
+	size_t size() const { return mCount; }
+
+};
+
+} /* namespace J1939 */
+
+#endif /* ADDRESSING_ADDRESSTABLE_H_ */
@@ -0,0 +1,155 @@
+/*
+ * BatchDecoder.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Decoder for big amounts of raw frames, as the ones coming from captures. The frames are grouped by PGN and the
+ *  numeric and status SPNs of each group are extracted column by column (structure of arrays) using the compiled
+ *  FrameLayout of the frames registered in J1939Factory. The extraction kernels use AVX2 or SSE2 when available.
+ */
+
+#ifndef BATCHDECODER_H_
+#define BATCHDECODER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <Types.h>
+
+#include "J1939Common.h"
+#include "FrameLayout.h"
+#include "PGNTable.h"
+
+namespace J1939 {
+
+struct RawFrame {
+	u32 id;
+	u8 data[J1939_MAX_SIZE];
+	u8 length;
+	u64 timestamp;
+};
+
+enum EBatchKernel {
+	BATCH_KERNEL_AUTO,
+	BATCH_KERNEL_SCALAR,
+	BATCH_KERNEL_SSE2,
+	BATCH_KERNEL_AVX2,
+};
+
+/*
+ * Decoded values of all the frames of one PGN. Row i of every column corresponds to the i-th decoded frame of the PGN.
+ */
+class J1939Factory;
+
+class PGNColumns {
+
+	friend class BatchDecoder;
+
+private:
+	u32 mPgn;
+	std::shared_ptr<const FrameLayout> mLayout;
+
+	std::vector<u64> mPayloads;			//Payload of each row in little endian, used as input for the kernels
+	std::vector<u64> mTimestamps;
+	std::vector<u8> mSrcAddrs;
+	std::vector<std::vector<double> > mColumns;
+
+public:
+	PGNColumns(u32 pgn, std::shared_ptr<const FrameLayout> layout);
+	virtual ~PGNColumns() {}
+
+	u32 getPGN() const { return mPgn; }
+
+	std::shared_ptr<const FrameLayout> getLayout() const { return mLayout; }
+
+	size_t getRows() const { return mTimestamps.size(); }
+
+	const std::vector<u64>& getTimestamps() const { return mTimestamps; }
+
+	const std::vector<u8>& getSrcAddrs() const { return mSrcAddrs; }
+
+	/*
+	 * Returns the formatted values of the SPN with the given index in the layout
+	 */
+	const std::vector<double>& getColumn(size_t index) const { return mColumns[index]; }
+
+	/*
+	 * Returns the formatted values of the given SPN or null if the SPN does not belong to the PGN
+	 */
+	const std::vector<double>* getSPNColumn(u32 spnNumber) const;
+
+	void clear();
+
+};
+
+class BatchDecoder {
+
+private:
+	typedef void (*Kernel)(const u64* payloads, size_t count, u32 bitShift, u64 mask, double gain, double offset, double* out);
+
+	Kernel mKernel;
+	EBatchKernel mKernelType;
+
+	//Factory where the layouts of the PGNs are taken from
+	J1939Factory* mFactory;
+
+	std::map<u32, PGNColumns> mGroups;
+	PGNTable<PGNColumns*> mGroupTable;
+
+	size_t mDecodedFrames;
+	size_t mSkippedFrames;
+
+	PGNColumns* getGroup(u32 pgn);
+
+public:
+	/*
+	 * The layouts are taken from the given factory, the default instance if null
+	 */
+	BatchDecoder(EBatchKernel kernel = BATCH_KERNEL_AUTO, J1939Factory* factory = nullptr);
+	virtual ~BatchDecoder() {}
+
+	BatchDecoder(const BatchDecoder&) = delete;
+	BatchDecoder& operator=(const BatchDecoder&) = delete;
+
+	/*
+	 * Returns true if the given kernel can run in this CPU
+	 */
+	static bool isKernelSupported(EBatchKernel kernel);
+
+	/*
+	 * Selects the kernel. Returns false if it is not supported, in which case the current one is kept.
+	 */
+	bool setKernel(EBatchKernel kernel);
+
+	EBatchKernel getKernel() const { return mKernelType; }
+
+	/*
+	 * Decodes the given frames, appending the values to the columns of their PGNs.
+	 * Frames whose PGN is not registered as a compiled generic frame, or which are too short, are skipped.
+	 * Returns the number of decoded frames.
+	 */
+	size_t decode(const RawFrame* frames, size_t count);
+
+	/*
+	 * Returns the columns of the given PGN or null if no frame of that PGN has been decoded
+	 */
+	const PGNColumns* getColumns(u32 pgn) const;
+
+	const std::map<u32, PGNColumns>& getAllColumns() const { return mGroups; }
+
+	size_t getDecodedFrames() const { return mDecodedFrames; }
+
+	size_t getSkippedFrames() const { return mSkippedFrames; }
+
+	/*
+	 * Removes the decoded values keeping the allocated memory for the next batches
+	 */
+	void clear();
+
+};
+
+} /* namespace J1939 */
+
+#endif /* BATCHDECODER_H_ */
@@ -0,0 +1,226 @@
+/*
+ * BinaryDataBase.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Precompiled database of frames. The frames parsed from the json database are compiled into a versioned binary
+ *  file made of fixed size records which is mapped read only in memory. Lookups index directly into the mapped
+ *  file, nothing is parsed nor copied when it is opened, and the pages are shared by all the processes that open
+ *  the same file. J1939Factory keeps the file mapped and only builds the GenericFrame of a PGN (see BinaryFrame)
+ *  the first time a frame of that PGN is requested.
+ *
+ *  Layout of the file (native byte order, all the offsets are relative to the beginning of the file):
+ *
+ *  	BinaryDataBaseHeader
+ *  	BinaryFrameRecord[frameCount]		Sorted by PGN. Frames with the same PGN keep the order of the json file.
+ *  	BinarySPNRecord[spnCount]			SPNs of every frame sorted by number
+ *  	BinaryDescRecord[descCount]			Descriptions of the status SPNs sorted by value
+ *  	char strings[stringsSize]			Null terminated strings referenced by offset in the string table
+ */
+
+#ifndef BINARYDATABASE_H_
+#define BINARYDATABASE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Types.h>
+
+namespace J1939 {
+
+class GenericFrame;
+class FrameLayout;
+class BinaryDataBase;
+
+#define BINARY_DATABASE_MAGIC			"J1939DB"
+#define BINARY_DATABASE_MAGIC_SIZE		8
+#define BINARY_DATABASE_VERSION			1
+#define BINARY_DATABASE_BYTE_ORDER		0x01020304		//Detects files compiled in a machine with different endianness
+
+struct BinaryDataBaseHeader {
+	char magic[BINARY_DATABASE_MAGIC_SIZE];
+	u32 version;
+	u32 byteOrder;
+	u32 fileSize;
+	u32 frameCount;
+	u32 framesOffset;
+	u32 spnCount;
+	u32 spnsOffset;
+	u32 descCount;
+	u32 descsOffset;
+	u32 stringsSize;
+	u32 stringsOffset;
+	u32 reserved;
+};
+
+struct BinaryFrameRecord {
+	u32 pgn;
+	u32 name;				//Offset in the string table
+	u32 length;
+	u32 firstSPN;			//Index of the first SPN of the frame
+	u32 spnCount;
+	u32 reserved;
+};
+
+struct BinarySPNRecord {
+	u32 number;
+	u32 name;				//Offset in the string table
+	u32 offset;
+	u8 type;				//SPN::EType
+	u8 byteSize;			//Numeric SPNs
+	u8 bitOffset;			//Status SPNs
+	u8 bitSize;				//Status SPNs
+	double formatGain;		//Numeric SPNs
+	double formatOffset;	//Numeric SPNs
+	u32 units;				//Numeric SPNs, offset in the string table
+	u32 firstDesc;			//Status SPNs, index of the first description
+	u32 descCount;			//Status SPNs
+	u32 reserved;
+};
+
+struct BinaryDescRecord {
+	u32 value;
+	u32 description;		//Offset in the string table
+};
+
+/*
+ * Frame of an opened binary database. The GenericFrame and the layout are built from the record the first time
+ * they are requested, from any thread, and kept until the database is closed.
+ */
+class BinaryFrame {
+
+private:
+	friend class BinaryDataBase;
+
+	const BinaryDataBase* mDataBase;
+	const BinaryFrameRecord* mRecord;
+
+	mutable std::once_flag mPrototypeFlag;
+	mutable std::unique_ptr<GenericFrame> mPrototype;
+
+	mutable std::once_flag mLayoutFlag;
+	mutable std::shared_ptr<const FrameLayout> mLayout;
+
+public:
+	BinaryFrame();
+	virtual ~BinaryFrame();
+
+	BinaryFrame(const BinaryFrame&) = delete;
+	BinaryFrame& operator=(const BinaryFrame&) = delete;
+
+	const BinaryFrameRecord& getRecord() const { return *mRecord; }
+
+	u32 getPGN() const { return mRecord->pgn; }
+
+	const char* getName() const;
+
+	/*
+	 * Returns the GenericFrame of the record, with the same layout returned by getLayout
+	 */
+	const GenericFrame& getPrototype() const;
+
+	/*
+	 * Returns the layout compiled from the records, without building the GenericFrame, or null if the frame has
+	 * SPNs of type string
+	 */
+	std::shared_ptr<const FrameLayout> getLayout() const;
+
+};
+
+class BinaryDataBase {
+
+public:
+	enum EErrorCode {
+		ERROR_OK,					//Everything ok
+		ERROR_FILE_NOT_FOUND,		//The file is not found in the path or cannot be opened
+		ERROR_MAP_FAILED,			//The file could not be mapped in memory
+		ERROR_INVALID_FORMAT,		//The file is not a binary database or it is corrupted
+		ERROR_VERSION_MISMATCH,		//The file was compiled with another version of the format or in a machine with another byte order
+	};
+
+private:
+	const u8* mData;
+	size_t mSize;
+
+	const BinaryDataBaseHeader* mHeader;
+	const BinaryFrameRecord* mFrames;
+	const BinarySPNRecord* mSPNs;
+	const BinaryDescRecord* mDescs;
+	const char* mStrings;
+
+	//One per frame record
+	std::unique_ptr<BinaryFrame[]> mBinaryFrames;
+
+	EErrorCode mErrorCode;
+
+	bool validate();
+
+public:
+	BinaryDataBase();
+	virtual ~BinaryDataBase();
+
+	BinaryDataBase(const BinaryDataBase&) = delete;
+	BinaryDataBase& operator=(const BinaryDataBase&) = delete;
+
+	/*
+	 * Compiles the given frames into a binary database. Returns false if the file could not be written.
+	 */
+	static bool compile(const std::vector<GenericFrame>& frames, const std::string& file);
+
+	/*
+	 * Returns true if the file starts with the magic of a binary database
+	 */
+	static bool isBinaryDataBase(const std::string& file);
+
+	/*
+	 * Maps the file read only and validates the records, so that the lookups do not need to check anything.
+	 * Any previously opened file is closed.
+	 */
+	bool open(const std::string& file);
+
+	void close();
+
+	bool isOpen() const { return mData != nullptr; }
+
+	EErrorCode getLastError() const { return mErrorCode; }
+
+	u32 getFrameCount() const { return mHeader ? mHeader->frameCount : 0; }
+
+	const BinaryFrameRecord& getFrame(u32 index) const { return mFrames[index]; }
+
+	const BinaryFrame& getBinaryFrame(u32 index) const { return mBinaryFrames[index]; }
+
+	/*
+	 * Returns the first definition of the PGN in the database or null if it is not defined. Binary search over the frame records.
+	 */
+	const BinaryFrameRecord* findFrame(u32 pgn) const;
+
+	const BinarySPNRecord* getSPNs(const BinaryFrameRecord& frame) const { return mSPNs + frame.firstSPN; }
+
+	/*
+	 * Returns the SPN of the frame with the given number or null if the SPN does not belong to the frame
+	 */
+	const BinarySPNRecord* findSPN(const BinaryFrameRecord& frame, u32 spnNumber) const;
+
+	const BinaryDescRecord* getDescriptions(const BinarySPNRecord& spn) const { return mDescs + spn.firstDesc; }
+
+	const char* getString(u32 offset) const { return mStrings + offset; }
+
+	/*
+	 * Builds the GenericFrame of the given record, to be registered in J1939Factory
+	 */
+	void toGenericFrame(const BinaryFrameRecord& record, GenericFrame& frame) const;
+
+	/*
+	 * Builds the GenericFrames of all the records, in the order of the file
+	 */
+	void getFrames(std::vector<GenericFrame>& frames) const;
+
+};
+
+} /* namespace J1939 */
+
+#endif /* BINARYDATABASE_H_ */
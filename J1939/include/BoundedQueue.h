@@ -0,0 +1,181 @@
+/*
+ * BoundedQueue.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Lock free queue of fixed capacity for the handoff of items between threads, with any number of producers and
+ *  consumers (Vyukov's bounded queue). Every cell carries a sequence number telling whether it is ready to be written
+ *  or read in the current turn, so push and pop are a compare and swap of the position in the common case and never
+ *  allocate. Nothing blocks: push fails if the queue is full and pop if it is empty.
+ *
+ *  	BoundedQueue<Packet> queue(1024);
+ *  	queue.push(packet);				//Producer threads
+ *  	...
+ *  	Packet packet;
+ *  	while(queue.pop(packet)) { ... }	//Consumer threads
+ *
+ *  The items pushed by one thread are popped in the same order.
+ */
+
+#ifndef BOUNDEDQUEUE_H_
+#define BOUNDEDQUEUE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include <Types.h>
+
+#define BOUNDED_QUEUE_CACHE_LINE		64
+
+namespace J1939 {
+
+template<class T>
+class BoundedQueue {
+
+private:
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	std::unique_ptr<Cell[]> mCells;
+	size_t mMask;
+
+	//The positions are written by different threads, each one in its own cache line
+	char mPad0[BOUNDED_QUEUE_CACHE_LINE];
+	std::atomic<size_t> mEnqueuePos;
+	char mPad1[BOUNDED_QUEUE_CACHE_LINE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> mDequeuePos;
+	char mPad2[BOUNDED_QUEUE_CACHE_LINE - sizeof(std::atomic<size_t>)];
+
+	template<class U>
+	bool doPush(U&& value);
+
+public:
+
+	/*
+	 * The capacity is rounded up to a power of two, two items at least
+	 */
+	BoundedQueue(size_t capacity);
+	virtual ~BoundedQueue() {}
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+	/*
+	 * Return false if the queue is full
+	 */
+	bool push(const T& value) { return doPush(value); }
+	bool push(T&& value) { return doPush(std::move(value)); }
+
+	/*
+	 * Returns false if the queue is empty
+	 */
+	bool pop(T& value);
+
+	size_t capacity() const { return mMask + 1; }
+
+	/*
+	 * Items in the queue, only exact if no other thread is using it
+	 */
+	size_t size() const {
+		size_t dequeuePos = mDequeuePos.load(std::memory_order_relaxed);
+		size_t enqueuePos = mEnqueuePos.load(std::memory_order_relaxed);
+		return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+};
+
+template<class T>
+BoundedQueue<T>::BoundedQueue(size_t capacity) : mEnqueuePos(0), mDequeuePos(0) {
+
+	size_t cells = 2;
+
+	while(cells < capacity) {
+		cells <<= 1;
+	}
+
+	mCells.reset(new Cell[cells]);
+	mMask = cells - 1;
+
+	for(size_t i = 0; i < cells; ++i) {
+		mCells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+}
+
+template<class T>
+template<class U>
+bool BoundedQueue<T>::doPush(U&& value) {
+
+	Cell* cell;
+	size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+
+	for(;;) {
+
+		cell = &mCells[pos & mMask];
+
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+		if(diff == 0) {
+			//The cell is free in this turn, claim it
+			if(mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if(diff < 0) {
+			return false;			//Not read yet in the previous turn, full
+		} else {
+			pos = mEnqueuePos.load(std::memory_order_relaxed);			//Claimed by another producer
+		}
+	}
+
+	cell->data = std::forward<U>(value);
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+
+}
+
+template<class T>
+bool BoundedQueue<T>::pop(T& value) {
+
+	Cell* cell;
+	size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+
+	for(;;) {
+
+		cell = &mCells[pos & mMask];
+
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+		if(diff == 0) {
+			if(mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if(diff < 0) {
+			return false;			//Not written yet, empty
+		} else {
+			pos = mDequeuePos.load(std::memory_order_relaxed);			//Taken by another consumer
+		}
+	}
+
+	value = std::move(cell->data);
+
+	//Free for the next turn
+	cell->sequence.store(pos + mMask + 1, std::memory_order_release);
+
+	return true;
+
+}
+
+} /* namespace J1939 */
+
+#endif /* BOUNDEDQUEUE_H_ */
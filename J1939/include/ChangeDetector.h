@@ -0,0 +1,135 @@
+/*
+ * ChangeDetector.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Detects which SPNs changed between consecutive frames with the same CAN identifier, without decoding them.
+ *  The last payload of every identifier is kept as a 64 bit word in a flat open addressing table. A new payload
+ *  is XORed with the previous one and the changed bits are matched against precomputed masks of the SPNs of the
+ *  PGN, built from the compiled FrameLayout of the frames registered in J1939Factory.
+ *
+ *  Most of the periodic traffic repeats, so the frames that did not change can be discarded before decoding:
+ *
+ *  	ChangeResult change = detector.update(frame.getId(), data, length);
+ *  	if(change.status == FRAME_UNCHANGED) return;
+ *  	ChangeDetector::forEachChangedSPN(change, [](size_t index, const SPNExtractOp& op) { ... });
+ */
+
+#ifndef CHANGEDETECTOR_H_
+#define CHANGEDETECTOR_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <Types.h>
+
+#include "J1939Common.h"
+#include "FrameLayout.h"
+#include "PGNTable.h"
+
+namespace J1939 {
+
+class J1939Factory;
+
+enum EFrameChange {
+	FRAME_UNCHANGED,		//Same payload as the previous frame with the same identifier
+	FRAME_CHANGED,			//The payload changed, the changed SPNs are given in the mask
+	FRAME_NEW,				//First frame with the identifier, all the SPNs are given in the mask
+	FRAME_NOT_TRACKED,		//Longer than a CAN frame, the changes are not tracked
+};
+
+struct ChangeResult {
+	EFrameChange status;
+	u64 changedSPNs;				//Bit i set if the SPN of index i in the layout changed. A CAN frame holds 64 SPNs at most.
+	const FrameLayout* layout;		//Null if the PGN has no compiled layout, in which case the mask is empty
+};
+
+class ChangeDetector {
+
+private:
+	/*
+	 * Bits of the payload covered by every SPN of a PGN
+	 */
+	struct PGNMasks {
+		std::shared_ptr<const FrameLayout> layout;
+		std::vector<u64> spnMasks;
+		u64 allSPNs;
+	};
+
+	struct Entry {
+		u32 id;
+		u8 length;			//0 means that the entry is empty, every payload is stored with length + 1
+		u64 payload;
+		const PGNMasks* masks;
+	};
+
+	//Factory where the layouts of the PGNs are taken from
+	J1939Factory* mFactory;
+
+	std::vector<Entry> mEntries;
+	size_t mCount;
+	u32 mShift;
+
+	std::map<u32, PGNMasks> mMasks;
+	PGNTable<const PGNMasks*> mMasksTable;
+
+	const PGNMasks* getMasks(u32 pgn);
+
+	Entry* findSlot(std::vector<Entry>& entries, u32 shift, u32 id) const;
+
+	void grow();
+
+public:
+	/*
+	 * The masks are built from the layouts of the given factory, the default instance if null
+	 */
+	ChangeDetector(size_t initialCapacity = 256, J1939Factory* factory = nullptr);
+	virtual ~ChangeDetector() {}
+
+	ChangeDetector(const ChangeDetector&) = delete;
+	ChangeDetector& operator=(const ChangeDetector&) = delete;
+
+	/*
+	 * Compares the payload with the previous one of the same identifier and stores it for the next comparison.
+	 * A change of length changes the SPNs of the bytes that are only present in one of the payloads.
+	 */
+	ChangeResult update(u32 id, const u8* data, size_t length);
+
+	/*
+	 * Forgets the last payload of the identifier, the next frame will be FRAME_NEW
+	 */
+	void erase(u32 id);
+
+	/*
+	 * Forgets all the payloads. The masks of the PGNs are kept.
+	 */
+	void clear();
+
+	/*
+	 * Discards the masks of the PGNs, to be called when the frames registered in J1939Factory change
+	 */
+	void clearMasks();
+
+	size_t size() const { return mCount; }
+
+	/*
+	 * Calls f(index, op) for every changed SPN of the result, in the order of the layout
+	 */
+	template<class F>
+	static void forEachChangedSPN(const ChangeResult& result, F f) {
+
+		for(u64 mask = result.changedSPNs; mask != 0; mask &= (mask - 1)) {
+
+			size_t index = __builtin_ctzll(mask);
+
+			f(index, result.layout->getOp(index));
+		}
+	}
+
+};
+
+} /* namespace J1939 */
+
+#endif /* CHANGEDETECTOR_H_ */
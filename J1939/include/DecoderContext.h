@@ -0,0 +1,87 @@
+/*
+ * DecoderContext.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Everything needed to decode the traffic of one bus: the registered frames, the BAM reassembler and the table of
+ *  claimed addresses. Every bus can use its own context, with its own database, and be decoded in its own thread
+ *  without sharing any mutable state with the others:
+ *
+ *  	DecoderContext truck, implement;
+ *  	truck.registerDatabaseFrames("truck.json");
+ *  	implement.registerDatabaseFrames("isobus.json");
+ *  	...
+ *  	std::unique_ptr<J1939Frame> frame = truck.decode(id, data, length, now);
+ *
+ *  A context can also be built over an existing factory, as the default instance of J1939Factory, to share its frames.
+ *  A context is not thread safe, it must be used from a single thread.
+ */
+
+#ifndef DECODERCONTEXT_H_
+#define DECODERCONTEXT_H_
+
+#include <memory>
+#include <string>
+
+#include <Types.h>
+
+#include "J1939Factory.h"
+#include "Transport/BAM/BamReassembler.h"
+#include "Addressing/AddressTable.h"
+
+namespace J1939 {
+
+class DecoderContext {
+
+private:
+	std::unique_ptr<J1939Factory> mOwnedFactory;
+	J1939Factory* mFactory;
+
+	BamReassembler mReassembler;
+	AddressTable mAddressTable;
+
+public:
+	/*
+	 * Context with its own factory, with only the predefined frames registered
+	 */
+	DecoderContext();
+
+	/*
+	 * Context sharing the frames registered in the given factory, which must outlive the context
+	 */
+	explicit DecoderContext(J1939Factory& factory);
+
+	virtual ~DecoderContext() {}
+
+	DecoderContext(const DecoderContext&) = delete;
+	DecoderContext& operator=(const DecoderContext&) = delete;
+
+	J1939Factory& getFactory() { return *mFactory; }
+
+	BamReassembler& getReassembler() { return mReassembler; }
+
+	AddressTable& getAddressTable() { return mAddressTable; }
+	const AddressTable& getAddressTable() const { return mAddressTable; }
+
+	bool registerDatabaseFrames(const std::string& ddbbFile) { return mFactory->registerDatabaseFrames(ddbbFile); }
+
+	/*
+	 * Decodes a frame received in the bus at the given time, usually its timestamp in milliseconds. The packets of
+	 * the BAM protocol are given to the reassembler and the reassembled frame is returned with the last packet. Every
+	 * frame advances the reassembler, so the BAM sessions that stall expire. The address claims update the address table.
+	 * Returns null if the PGN is not registered or the frame is a packet of an incomplete BAM message.
+	 * Decode errors are thrown as in J1939Factory::getJ1939Frame.
+	 */
+	std::unique_ptr<J1939Frame> decode(u32 id, const u8* data, size_t length, u64 now);
+
+	/*
+	 * Forgets the incomplete BAM messages and the claimed addresses, the registered frames are kept
+	 */
+	void reset();
+
+};
+
+} /* namespace J1939 */
+
+#endif /* DECODERCONTEXT_H_ */
@@ -9,6 +9,7 @@
 #define DIAGNOSIS_DTC_H_
 
 #include <Types.h>
+#include <J1939Common.h>
 #include <string>
 
 #define DTC_SIZE		4
@@ -62,6 +63,8 @@ public:
 	void decode(const u8* buffer);
 	void encode(u8* buffer) const;
 
+	ECodecStatus tryDecode(const u8* buffer);
+
 	std::string toString() const;
 
 	u8 getFmi() const { return mFMI; }
@@ -26,6 +26,8 @@ private:
 protected:
 	void decodeData(const u8* buffer, size_t length);
 	void encodeData(u8* buffer, size_t length) const;
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
+	ECodecStatus tryEncodeData(u8* buffer, size_t length) const override;
 
 public:
 	DM1();
@@ -36,8 +36,10 @@ private:
 protected:
 
 	void decodeData(const u8* buffer, size_t length) override;
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
 
 	void encodeData(u8* buffer, size_t length) const override;
+	ECodecStatus tryEncodeData(u8* buffer, size_t length) const override;
 
 public:
 	FMS1Frame();
@@ -0,0 +1,109 @@
+/*
+ * FrameArena.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Monotonic arena used to place a cloned GenericFrame, its SPNs and the nodes of its SPN map in one contiguous
+ *  block (see GenericFrame::cloneInArena). Nothing is freed individually: the whole block is released at once by
+ *  ArenaFrameDeleter when the frame is destroyed. Allocations that do not fit, for instance SPNs registered after
+ *  cloning, fall back to the global operator new and are freed as usual.
+ */
+
+#ifndef FRAMEARENA_H_
+#define FRAMEARENA_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <new>
+
+#include <Types.h>
+
+namespace J1939 {
+
+class J1939Frame;
+
+class FrameArena {
+
+private:
+	u8* mBegin;
+	size_t mSize;
+	size_t mUsed;
+
+public:
+	FrameArena(void* buffer, size_t size) : mBegin(static_cast<u8*>(buffer)), mSize(size), mUsed(0) {}
+	virtual ~FrameArena() {}
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	/*
+	 * Returns null if there is not enough space left in the arena
+	 */
+	void* allocate(size_t size, size_t alignment);
+
+	bool contains(const void* ptr) const {
+		return static_cast<const u8*>(ptr) >= mBegin && static_cast<const u8*>(ptr) < mBegin + mSize;
+	}
+
+	size_t getSize() const { return mSize; }
+
+	size_t getUsed() const { return mUsed; }
+
+};
+
+/*
+ * Allocator for the containers of the frames placed in an arena. Without arena, it behaves as std::allocator.
+ */
+template<class T>
+class ArenaAllocator {
+
+private:
+	FrameArena* mArena;
+
+public:
+	typedef T value_type;
+
+	ArenaAllocator() : mArena(nullptr) {}
+	explicit ArenaAllocator(FrameArena* arena) : mArena(arena) {}
+
+	template<class U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : mArena(other.getArena()) {}
+
+	FrameArena* getArena() const { return mArena; }
+
+	T* allocate(size_t n) {
+
+		void* ptr = (mArena ? mArena->allocate(n * sizeof(T), alignof(T)) : nullptr);
+
+		return static_cast<T*>(ptr ? ptr : ::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t) {
+
+		if(!mArena || !mArena->contains(ptr)) {
+			::operator delete(ptr);
+		}
+	}
+
+	template<class U>
+	bool operator==(const ArenaAllocator<U>& other) const { return mArena == other.getArena(); }
+
+	template<class U>
+	bool operator!=(const ArenaAllocator<U>& other) const { return mArena != other.getArena(); }
+
+};
+
+/*
+ * Destroys frames cloned in an arena releasing the whole block. Frames allocated with new are deleted.
+ */
+struct ArenaFrameDeleter {
+	void operator()(J1939Frame* frame) const;
+};
+
+typedef std::unique_ptr<J1939Frame, ArenaFrameDeleter> ArenaFrame;
+
+} /* namespace J1939 */
+
+#endif /* FRAMEARENA_H_ */
@@ -0,0 +1,88 @@
+/*
+ * FrameFormatter.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Writes decoded frames as text lines into buffers given by the caller, without streams nor locales, to pipe
+ *  whole captures to files or to other tools. The layouts are stable, new fields will only be appended.
+ *
+ *  TSV and CSV write one row per SPN with the columns:
+ *
+ *  	timestamp id pgn name source destination priority spn spn_name value units description
+ *
+ *  The value is the formatted value of numeric SPNs, the raw value of status SPNs, whose description is given
+ *  in the last column, and the text of string SPNs. Frames without SPNs are written in a single row with the SPN
+ *  columns empty. The DTCs of DM1 are written as rows with "DTC" as spn_name, the FMI as value and the occurrence
+ *  count as description. The destination is empty for frames of PDU format 2.
+ *
+ *  NDJSON writes one object per frame:
+ *
+ *  	{"timestamp":12.000250,"id":"0CF00400","pgn":"F004","name":"EEC1","source":0,"priority":3,
+ *  	 "spns":[{"spn":190,"name":"Engine Speed","value":1000.5,"units":"rpm"},...],"dtcs":[...]}
+ */
+
+#ifndef FRAMEFORMATTER_H_
+#define FRAMEFORMATTER_H_
+
+#include <string>
+#include <vector>
+
+#include <Types.h>
+#include <Utils.h>
+
+namespace J1939 {
+
+class J1939Frame;
+class SPN;
+
+enum EFrameFormat {
+	FRAME_FORMAT_TSV,
+	FRAME_FORMAT_CSV,
+	FRAME_FORMAT_NDJSON,
+};
+
+class FrameFormatter {
+
+private:
+	EFrameFormat mFormat;
+
+public:
+	explicit FrameFormatter(EFrameFormat format) : mFormat(format) {}
+	virtual ~FrameFormatter() {}
+
+	/*
+	 * Converts the name of the format ("tsv", "csv" or "ndjson") given in the command line of the tools
+	 */
+	static bool parseFormat(const std::string& name, EFrameFormat& format);
+
+	EFrameFormat getFormat() const { return mFormat; }
+
+	/*
+	 * Writes the line with the names of the columns for TSV and CSV. Nothing is written for NDJSON.
+	 * Returns the number of bytes written or 0 if the buffer is too small.
+	 */
+	size_t formatHeader(char* buffer, size_t size) const;
+
+	/*
+	 * Writes the lines of the frame, every line terminated by '\n'. Nothing is null terminated.
+	 * Returns the number of bytes written or 0 if the buffer is too small, the content of the buffer is undefined then.
+	 */
+	size_t format(const J1939Frame& frame, const Utils::TimeStamp& timestamp, char* buffer, size_t size) const;
+
+	/*
+	 * Same as format but writing only the given SPN of the frame
+	 */
+	size_t formatSPN(const J1939Frame& frame, const SPN& spn, const Utils::TimeStamp& timestamp, char* buffer, size_t size) const;
+
+	/*
+	 * Same as above but growing the buffer until the lines fit. The buffer is meant to be reused between frames.
+	 */
+	size_t format(const J1939Frame& frame, const Utils::TimeStamp& timestamp, std::vector<char>& buffer) const;
+	size_t formatSPN(const J1939Frame& frame, const SPN& spn, const Utils::TimeStamp& timestamp, std::vector<char>& buffer) const;
+
+};
+
+} /* namespace J1939 */
+
+#endif /* FRAMEFORMATTER_H_ */
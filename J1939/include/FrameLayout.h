@@ -0,0 +1,147 @@
+/*
+ * FrameLayout.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Compiled form of a GenericFrame. Each SPN is translated into an extraction operation with the offset, width,
+ *  shift and mask of the raw value, so that a frame can be decoded in a single pass without virtual calls or
+ *  exceptions. Numeric SPNs of 1 byte carry a lookup table with the 256 possible formatted values.
+ *
+ *  Frames with SPNs of type string cannot be compiled because their offsets depend on the content of the frame.
+ */
+
+#ifndef FRAMELAYOUT_H_
+#define FRAMELAYOUT_H_
+
+#include <memory>
+#include <vector>
+
+#include <Types.h>
+
+#define FRAME_LAYOUT_LUT_SIZE			256
+
+namespace J1939 {
+
+class GenericFrame;
+class BinaryDataBase;
+struct BinaryFrameRecord;
+
+struct SPNExtractOp {
+	u32 spnNumber;
+	u8 type;				//SPN::EType
+	u8 offset;				//Byte offset in the frame
+	u8 width;				//Number of bytes to read
+	u8 shift;				//Bits to shift right after reading
+	u32 mask;				//Mask applied after shifting
+	double gain;			//1 for status SPNs
+	double formatOffset;	//0 for status SPNs
+	const double* lut;		//Formatted values for 1 byte numeric SPNs, null otherwise
+};
+
+class FrameLayout {
+
+private:
+	std::vector<SPNExtractOp> mOps;
+	std::vector<double> mLuts;
+	size_t mMinLength;
+
+	FrameLayout() : mMinLength(0) {}
+
+	/*
+	 * Append the operation of an SPN. Return false if the SPN cannot be compiled.
+	 */
+	bool addNumeric(u32 number, size_t offset, u8 byteSize, double gain, double formatOffset);
+	bool addStatus(u32 number, size_t offset, u8 bitOffset, u8 bitSize);
+
+	/*
+	 * Fills the lookup tables once all the operations are added
+	 */
+	void buildLuts();
+
+public:
+	virtual ~FrameLayout() {}
+
+	/*
+	 * Builds the layout of the given frame. Returns null if the frame contains SPNs that cannot be compiled.
+	 */
+	static std::shared_ptr<const FrameLayout> compile(const GenericFrame& frame);
+
+	/*
+	 * Builds the layout straight from the records of a binary database, without building the GenericFrame
+	 */
+	static std::shared_ptr<const FrameLayout> compile(const BinaryDataBase& database, const BinaryFrameRecord& record);
+
+	/*
+	 * Minimum length that the data must have to be decoded with this layout
+	 */
+	size_t getMinLength() const { return mMinLength; }
+
+	/*
+	 * Number of SPNs, ordered by SPN number as they are in GenericFrame
+	 */
+	size_t getSPNCount() const { return mOps.size(); }
+
+	const SPNExtractOp& getOp(size_t index) const { return mOps[index]; }
+
+	const SPNExtractOp* getOps() const { return mOps.data(); }
+
+	/*
+	 * Returns the index of the given SPN or -1 if the SPN is not part of the layout
+	 */
+	int getSPNIndex(u32 spnNumber) const;
+
+	/*
+	 * Returns the raw value of the SPN of the given index. The data must be at least getMinLength() bytes long.
+	 */
+	u32 extractRaw(size_t index, const u8* data) const { return extractRaw(mOps[index], data); }
+
+	/*
+	 * Returns the formatted value (gain and offset applied for numeric SPNs, raw value for status SPNs)
+	 */
+	double extractValue(size_t index, const u8* data) const { return extractValue(mOps[index], data); }
+
+	/*
+	 * Decodes all the SPNs. The arrays must have getSPNCount() elements.
+	 */
+	void decodeRaw(const u8* data, u32* raw) const;
+	void decodeValues(const u8* data, double* values) const;
+
+	static u32 extractRaw(const SPNExtractOp& op, const u8* data) {
+
+		const u8* ptr = data + op.offset;
+		u32 raw = ptr[0];
+
+		switch(op.width) {
+		case 4:
+			raw |= (static_cast<u32>(ptr[3]) << 24);
+			//Falls through
+		case 3:
+			raw |= (static_cast<u32>(ptr[2]) << 16);
+			//Falls through
+		case 2:
+			raw |= (static_cast<u32>(ptr[1]) << 8);
+			//Falls through
+		default:
+			break;
+		}
+
+		return (raw >> op.shift) & op.mask;
+	}
+
+	static double extractValue(const SPNExtractOp& op, const u8* data) {
+
+		if(op.lut) {
+			return op.lut[data[op.offset]];
+		}
+
+		u32 raw = extractRaw(op, data);
+
+		return raw * op.gain + op.formatOffset;
+	}
+
+};
+
+} /* namespace J1939 */
+
+#endif /* FRAMELAYOUT_H_ */
@@ -0,0 +1,114 @@
+/*
+ * FramePool.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Pool of recyclable frames per PGN. The frames are cloned from the prototypes registered in J1939Factory
+ *  the first time that a PGN is requested and they are given back to the pool when the returned pointer is destroyed,
+ *  so that decoding a known PGN in steady state does not allocate memory.
+ */
+
+#ifndef FRAMEPOOL_H_
+#define FRAMEPOOL_H_
+
+#include <memory>
+#include <map>
+#include <vector>
+
+#include <Types.h>
+
+#include "PGNTable.h"
+
+#define FRAME_POOL_DEFAULT_FRAMES_PER_PGN		8
+
+namespace J1939 {
+
+class J1939Frame;
+class J1939Factory;
+class FramePool;
+
+/*
+ * Deleter that returns the frame to the pool it was acquired from
+ */
+class FrameRecycler {
+private:
+	FramePool* mPool;
+public:
+	FrameRecycler() : mPool(nullptr) {}
+	FrameRecycler(FramePool* pool) : mPool(pool) {}
+
+	void operator()(J1939Frame* frame) const;
+};
+
+typedef std::unique_ptr<J1939Frame, FrameRecycler> PooledFrame;
+
+
+/*
+ * The pool must outlive the frames acquired from it. It is not thread safe, each thread must use its own pool.
+ */
+class FramePool {
+
+private:
+	typedef std::vector<J1939Frame*> FreeList;
+
+	size_t mMaxFramesPerPGN;
+
+	//Factory where the prototypes of the frames are registered
+	J1939Factory* mFactory;
+
+	//The map owns the free lists, the table is used for the lookups
+	std::map<u32, FreeList> mFreeLists;
+	PGNTable<FreeList*> mFreeListTable;
+
+	FreeList* getFreeList(u32 pgn);
+
+public:
+	/*
+	 * The frames are cloned from the given factory, the default instance if null
+	 */
+	FramePool(size_t maxFramesPerPGN = FRAME_POOL_DEFAULT_FRAMES_PER_PGN, J1939Factory* factory = nullptr);
+	virtual ~FramePool();
+
+	FramePool(const FramePool&) = delete;
+	FramePool& operator=(const FramePool&) = delete;
+
+	/*
+	 * Returns a frame for the given PGN or nullptr if the PGN is not registered in the factory.
+	 * The content of the frame is the one of the last decoded message.
+	 */
+	PooledFrame acquire(u32 pgn);
+
+	/*
+	 * Returns a frame decoded from the given id, data and length or nullptr if the PGN is not registered in the factory.
+	 * Decode errors are thrown as in J1939Factory::getJ1939Frame.
+	 */
+	PooledFrame decode(u32 id, const u8* data, size_t length);
+
+	/*
+	 * Non throwing version of decode. The frame is only returned if the status is CODEC_OK.
+	 */
+	PooledFrame decode(u32 id, const u8* data, size_t length, ECodecStatus& status);
+
+	/*
+	 * Builds in advance the given number of frames for the PGN, so that not even the first acquisitions allocate memory.
+	 */
+	bool reserve(u32 pgn, size_t count);
+
+	/*
+	 * Gives back a frame to the pool. If the free list of the PGN is full, the frame is deleted.
+	 */
+	void release(J1939Frame* frame);
+
+	size_t getFreeFrames(u32 pgn) const;
+
+	/*
+	 * Deletes all the frames kept in the pool
+	 */
+	void clear();
+
+};
+
+} /* namespace J1939 */
+
+#endif /* FRAMEPOOL_H_ */
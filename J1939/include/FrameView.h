@@ -0,0 +1,117 @@
+/*
+ * FrameView.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Read only view of a received frame. It does not copy the payload: it keeps the identifier, a pointer to the
+ *  payload and a reference to the compiled layout of the PGN, and the SPNs are only decoded when they are read.
+ *  A view is meant to live on the stack, for instance inside the receive callback of CanSniffer:
+ *
+ *  	FrameView view = J1939Factory::getInstance().getFrameView(frame.getId(), (const u8*)frame.getData().c_str(), frame.getData().size());
+ *  	double speed;
+ *  	if(view.getValue(84, speed)) ...
+ *
+ *  The payload must remain valid while the view is used. The layout is shared, so the view can still be used after
+ *  the PGN is unregistered or the database reloaded, decoding with the layout it was created with.
+ */
+
+#ifndef FRAMEVIEW_H_
+#define FRAMEVIEW_H_
+
+#include <memory>
+
+#include <Types.h>
+
+#include "J1939Common.h"
+#include "FrameLayout.h"
+#include "PGNTable.h"
+
+namespace J1939 {
+
+class FrameView {
+
+private:
+	u32 mId;
+	const u8* mData;
+	size_t mLength;
+	std::shared_ptr<const FrameLayout> mLayout;
+
+	bool isReadable(const SPNExtractOp& op) const { return static_cast<size_t>(op.offset + op.width) <= mLength; }
+
+public:
+	FrameView() : mId(0), mData(nullptr), mLength(0), mLayout(nullptr) {}
+	FrameView(u32 id, const u8* data, size_t length, std::shared_ptr<const FrameLayout> layout) :
+		mId(id), mData(data), mLength(length), mLayout(std::move(layout)) {}
+
+	/*
+	 * A view is valid if the PGN has a compiled layout. Even if valid, some SPNs may not be readable if the payload is too short.
+	 */
+	bool isValid() const { return mLayout != nullptr; }
+
+	u32 getId() const { return mId; }
+
+	u32 getPGN() const { return getPGNFromId(mId); }
+
+	u8 getSrcAddr() const { return mId & J1939_SRC_ADDR_MASK; }
+
+	u8 getPriority() const { return (mId >> J1939_PRIORITY_OFFSET) & J1939_PRIORITY_MASK; }
+
+	const u8* getData() const { return mData; }
+
+	size_t getLength() const { return mLength; }
+
+	const FrameLayout* getLayout() const { return mLayout.get(); }
+
+	size_t getSPNCount() const { return mLayout ? mLayout->getSPNCount() : 0; }
+
+	bool hasSPN(u32 spnNumber) const { return mLayout && mLayout->getSPNIndex(spnNumber) >= 0; }
+
+	u32 getSPNNumberAt(size_t index) const { return mLayout->getOp(index).spnNumber; }
+
+	/*
+	 * Access by index in the layout (SPNs ordered by number). The index must be lower than getSPNCount().
+	 * Return false if the payload is too short to contain the SPN.
+	 */
+	bool getRawValueAt(size_t index, u32& raw) const {
+
+		const SPNExtractOp& op = mLayout->getOp(index);
+
+		if(!isReadable(op)) return false;
+
+		raw = FrameLayout::extractRaw(op, mData);
+		return true;
+	}
+
+	bool getValueAt(size_t index, double& value) const {
+
+		const SPNExtractOp& op = mLayout->getOp(index);
+
+		if(!isReadable(op)) return false;
+
+		value = FrameLayout::extractValue(op, mData);
+		return true;
+	}
+
+	/*
+	 * Access by SPN number. Return false if the SPN does not belong to the PGN or the payload is too short to contain it.
+	 */
+	bool getRawValue(u32 spnNumber, u32& raw) const {
+
+		int index = (mLayout ? mLayout->getSPNIndex(spnNumber) : -1);
+
+		return (index >= 0 && getRawValueAt(index, raw));
+	}
+
+	bool getValue(u32 spnNumber, double& value) const {
+
+		int index = (mLayout ? mLayout->getSPNIndex(spnNumber) : -1);
+
+		return (index >= 0 && getValueAt(index, value));
+	}
+
+};
+
+} /* namespace J1939 */
+
+#endif /* FRAMEVIEW_H_ */
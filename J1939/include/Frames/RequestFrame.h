@@ -8,6 +8,8 @@
 #ifndef ADDRESSING_REQUESTFRAME_H_
 #define ADDRESSING_REQUESTFRAME_H_
 
+#include <memory>
+
 #include <J1939Frame.h>
 
 #define REQUEST_FRAME_LENGTH		3
@@ -15,13 +17,18 @@
 
 namespace J1939 {
 
+class J1939Factory;
+
 class RequestFrame: public J1939Frame {
 private:
 	u32 mRequestPGN = 0;
 
+	std::weak_ptr<J1939Factory> mFactory;
+
 protected:
 
 	void decodeData(const u8* buffer, size_t length);
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
 	void encodeData(u8* buffer, size_t length) const;
 
 public:
@@ -35,6 +42,12 @@ public:
 
 	void setRequestPGN(u32 requestPGN) { mRequestPGN = requestPGN; }
 
+	/*
+	 * Factory where toString looks up the name of the requested PGN. It is set in the frames built by a factory,
+	 * the name is not printed for other frames or once the factory is destroyed.
+	 */
+	void setFactory(std::weak_ptr<J1939Factory> factory) { mFactory = factory; }
+
 	std::string toString() const;
 
 	IMPLEMENT_CLONEABLE(J1939Frame,RequestFrame);
@@ -9,20 +9,60 @@
 #define GENERICFRAME_H_
 
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "J1939Frame.h"
 #include "SPN/SPN.h"
+#include "FrameLayout.h"
+#include "FrameArena.h"
 
 namespace J1939 {
 
 class GenericFrame : public J1939Frame {
+
+	friend class BinaryDataBase;
+	friend class BinaryFrame;
+	friend class FrameFormatter;
+	friend struct ArenaFrameDeleter;
+	friend class SPN;
+
 private:
+	typedef std::map<u32/*SpnNumber*/, SPN*, std::less<u32>, ArenaAllocator<std::pair<const u32, SPN*> > > SPNMap;
+
 	size_t mLength;
-	std::map<u32/*SpnNumber*/, SPN*> mSPNs;
+	SPNMap mSPNs;
+
+	//Arena where the frame, its SPNs and the nodes of mSPNs are placed, if it was cloned with cloneInArena
+	FrameArena* mArena;
+
+	//Compiled layout shared with the clones of this frame. It is discarded when the SPNs are modified.
+	std::shared_ptr<const FrameLayout> mLayout;
+
+	//Payload of the last encode and SPNs modified since then. Encoding copies the payload after encoding again only
+	//the modified SPNs. As the values of the SPNs, the cache must not be accessed concurrently from several threads.
+	mutable std::vector<u8> mEncoded;
+	mutable bool mEncodedValid;
+	mutable std::vector<SPN*> mDirtySPNs;
+
+	void invalidateEncoded() { mEncodedValid = false; }
+
+	ECodecStatus updateEncoded() const;
+
+	ECodecStatus encodeSPN(SPN* spn) const;
+
+	//Called by the SPNs the first time their value changes after an encode
+	void onSPNModified(SPN* spn);
 protected:
 	virtual void decodeData(const u8* buffer, size_t length);
 	virtual void encodeData(u8* buffer, size_t length) const;
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
+	ECodecStatus tryEncodeData(u8* buffer, size_t length) const override;
+
+	GenericFrame(const GenericFrame& other, FrameArena* arena);
+
+	void releaseSPN(SPN* spn);
 public:
     GenericFrame(u32 pgn);
 	GenericFrame(const GenericFrame& other);
@@ -50,11 +90,11 @@ public:
 
 	std::set<u32> getSPNNumbers() const;
 
-	std::map<u32/*SpnNumber*/, SPN*> getSPNs() { return mSPNs; };
+	std::map<u32/*SpnNumber*/, SPN*> getSPNs() { return std::map<u32, SPN*>(mSPNs.begin(), mSPNs.end()); };
 
 	virtual size_t getDataLength() const;
 
-	void setLength(size_t length) { mLength = length; }
+	void setLength(size_t length) { mLength = length; invalidateEncoded(); }
 
     void setName(const std::string& name) { mName = name; }
 
@@ -65,10 +105,32 @@ public:
     /*
      * Returns a set of SPNs that have changed with respect to the data
      */
-    std::set<SPN*> compare(const std::string& newData, const std::string oldData);
+    std::set<SPN*> compare(const std::string& newData, const std::string& oldData);
 
     void copy(const J1939Frame& other) override;
 
+    /*
+     * Compiles the SPNs of the frame into a FrameLayout, which is used to decode when the data is long enough
+     * to contain all the SPNs. Returns false if the frame cannot be compiled (it contains SPNs of type string).
+     */
+    bool compileLayout();
+
+    std::shared_ptr<const FrameLayout> getLayout() const { return mLayout; }
+
+    /*
+     * Decodes the formatted values of all the SPNs, ordered by SPN number, without modifying the frame.
+     * The array must have as many elements as SPNs. Returns false if the frame has no layout or the data is too short.
+     */
+    bool decodeValues(const u8* buffer, size_t length, double* values) const;
+
+    /*
+     * Clones the frame placing the frame, its SPNs and the nodes of the SPN map in a single block of memory, which
+     * is released at once when the returned frame is destroyed. Improves locality when traversing the SPNs and
+     * reduces the calls to the allocator to one per clone.
+     * Frames derived from GenericFrame, such as DM1, are cloned with clone as usual.
+     */
+    ArenaFrame cloneInArena() const;
+
 	IMPLEMENT_CLONEABLE(J1939Frame,GenericFrame);
 };
 
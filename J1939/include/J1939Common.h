@@ -38,6 +38,7 @@
 #define	NULL_TERMINATOR				0
 
 #define TP_DT_PACKET_SIZE			7
+#define TP_MAX_MSG_SIZE				1785		//255 packets
 
 #define PDU_FMT_DELIMITER			0xF0
 
@@ -52,6 +53,31 @@
 namespace J1939 {
 
 
+/*
+ * Result of the non throwing decode and encode methods
+ */
+enum ECodecStatus {
+	CODEC_OK = 0,
+	CODEC_PGN_MISMATCH,					//The PGN of the identifier does not correspond to the frame
+	CODEC_UNKNOWN_PGN,					//No frame registered for the PGN
+	CODEC_BUFFER_TOO_SHORT,				//The buffer is shorter than needed
+	CODEC_INVALID_LENGTH,				//The frame has a fixed length different from the one of the buffer
+	CODEC_INVALID_PRIORITY,
+	CODEC_INVALID_SPN_FORMAT,			//The definition of the SPN does not allow to decode/encode it
+	CODEC_VALUE_OUT_OF_RANGE,
+	CODEC_STRING_NOT_TERMINATED,
+	CODEC_STRING_NOT_ASCII,
+	CODEC_UNKNOWN_CTRL_TYPE,
+	CODEC_UNKNOWN_CONVERSION_METHOD,
+	CODEC_INCONSISTENT_FRAME,			//The content of the frame can not be encoded
+	CODEC_EXCEPTION,					//Exception thrown by a frame without non throwing implementation
+};
+
+/*
+ * Returns a static string describing the status
+ */
+const char* getCodecStatusDescription(ECodecStatus status);
+
 
 class J1939DecodeException : public std::exception {
 private:
@@ -34,6 +34,7 @@ public:
 		ERROR_UNKNOWN_SPN_TYPE,		//The type of spn is not recognized
 		ERROR_FORBIDDEN_TOKEN,		//A token that should not be present in the database which is reserved for internal use in the software
 									//and could cause misbehaviour (example: PGN=FECA which corresponds to reserved PGN for DM1 frame, casts to this class are done after verifying the PGN)
+		ERROR_INVALID_BINARY,		//The binary database is corrupted or was compiled with another version of the format
 	};
 
 private:
@@ -56,6 +57,13 @@ public:
 
 	bool writeJsonFile(const std::string& file);
 
+	/*
+	 * Precompiled database, see BinaryDataBase. Reading it does not need to parse json.
+	 */
+	bool parseBinaryFile(const std::string& file);
+
+	bool writeBinaryFile(const std::string& file);
+
 	const std::vector<GenericFrame>& getParsedFrames() const;
 
 	void addFrame(const GenericFrame&);
@@ -33,42 +33,132 @@ SOFTWARE.
 #ifndef J1939FACTORY_H_
 #define J1939FACTORY_H_
 
+#include <atomic>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <set>
+#include <vector>
 
 
 #include <Types.h>
 #include <Singleton.h>
 
+#include "PGNTable.h"
+#include "FrameView.h"
+#include "FrameArena.h"
 
 
 namespace J1939 {
 
 class J1939Frame;
+class FrameLayout;
+class BinaryDataBase;
+class BinaryFrame;
 
 class J1939Factory : public ISingleton<J1939Factory> {
 
 	SINGLETON_ACCESS;
 
-	virtual ~J1939Factory();
-
 private:
-	J1939Factory();
-	std::map<u32, J1939Frame*> mFrames;
+	/*
+	 * Immutable set of registered prototypes. Every change builds a new registry which is published atomically,
+	 * the readers keep using the registry they loaded and it is freed once all of them are done (see RCU.h).
+	 * The prototypes are shared between consecutive registries, so a change only copies the pointers.
+	 */
+	struct Registry {
+		std::map<u32, std::shared_ptr<J1939Frame> > frames;
+
+		/*
+		 * Dispatch table for the hot path. It points to the same prototypes owned by frames.
+		 */
+		PGNTable<J1939Frame*> dispatchTable;
+
+		/*
+		 * Frames of the binary databases whose PGN is not in frames. They are looked up in the mapped records and
+		 * their GenericFrame is only built when a frame of the PGN is requested. The files stay mapped as long as
+		 * a registry uses them.
+		 */
+		std::vector<std::shared_ptr<const BinaryDataBase> > databases;
+		PGNTable<const BinaryFrame*> databaseTable;
+
+		bool contains(u32 pgn) const { return dispatchTable.contains(pgn) || databaseTable.contains(pgn); }
+
+		/*
+		 * Returns the prototype of the PGN or null if it is not registered
+		 */
+		const J1939Frame* find(u32 pgn) const;
+
+		/*
+		 * Returns the layout of the PGN, without building the frame if it comes from a binary database
+		 */
+		std::shared_ptr<const FrameLayout> findLayout(u32 pgn) const;
+	};
+
+	std::atomic<const Registry*> mRegistry;
+
+	//Serializes the writers, the readers never take it
+	std::mutex mWriteLock;
+
+	/*
+	 * Does not own the factory, it expires when the factory is destroyed. The frames that look up other frames
+	 * in the factory that built them (RequestFrame) keep a weak reference to it.
+	 */
+	std::shared_ptr<J1939Factory> mSelf;
+
+	/*
+	 * Replaces the current registry and frees the old one once no reader uses it. Called with mWriteLock held.
+	 */
+	void publish(const Registry* registry);
+
+	static bool registerFrame(Registry& registry, const J1939Frame& frame);
 
 	 /*
 	 * Registers the predefined frames that we can find in J1939Protocol
 	 */
-	void registerPredefinedFrames();
+	void registerPredefinedFrames(Registry& registry) const;
+
+	/*
+	 * Registers the frames of the database that are not already registered
+	 */
+	static bool registerDatabaseFrames(Registry& registry, const std::string& ddbbFile);
 
 
 public:
 
+	/*
+	 * The instance returned by getInstance is the default one. Other instances, with their own registered frames,
+	 * can be created to decode several buses independently (see DecoderContext).
+	 */
+	J1939Factory();
+	virtual ~J1939Factory();
+
+	J1939Factory(const J1939Factory&) = delete;
+	J1939Factory& operator=(const J1939Factory&) = delete;
+
 	/*
 	 * Returns the corresponding frame (if registered) from the given id and decodes the information from data and length
 	 */
     std::unique_ptr<J1939Frame> getJ1939Frame(u32 id, const u8* data, size_t length);
+
+    /*
+     * Decodes the given id, data and length in an already existing frame, without creating a new one.
+     * Returns false if the PGN of the id does not correspond to the frame. Decode errors are thrown as in getJ1939Frame.
+     */
+    bool decodeInto(u32 id, const u8* data, size_t length, J1939Frame& frame) const;
+
+    /*
+     * Non throwing versions of getJ1939Frame and decodeInto. The frame is only returned if the status is CODEC_OK.
+     */
+    std::unique_ptr<J1939Frame> getJ1939Frame(u32 id, const u8* data, size_t length, ECodecStatus& status);
+    ECodecStatus tryDecodeInto(u32 id, const u8* data, size_t length, J1939Frame& frame) const;
+
+    /*
+     * Same as getJ1939Frame but generic frames are cloned in a single block with GenericFrame::cloneInArena.
+     * Decode errors are thrown as in getJ1939Frame.
+     */
+    ArenaFrame getArenaFrame(u32 id, const u8* data, size_t length);
+
     /*
      * Returns the corresponding frame (if registered) from the given PGN
      */
@@ -83,19 +173,80 @@ public:
 
     /*
      * Registers the given frame in the factory letting the factory to create a copy of it and, if neccesary, decoding it.
+     *
+     * The methods that change the registered frames can be called while other threads decode frames, which are
+     * never blocked. The decoding threads see the change in their next call.
      */
     bool registerFrame(const J1939Frame&);
 
+    /*
+     * Registers the frames of the range whose PGN is not registered yet. All of them are published at once, so
+     * registering many frames does not copy the registered ones again for every frame. Returns the number of
+     * frames registered.
+     */
+    template<class Iterator>
+    size_t registerFrames(Iterator first, Iterator last);
+
     void unRegisterFrame(u32 pgn);
 
+    /*
+     * Registers the frames of the database whose PGN is not registered yet. All of them are published at once.
+     */
     bool registerDatabaseFrames(const std::string& ddbbFile);
 
+    /*
+     * Replaces all the registered frames by the predefined ones and the frames of the database, to update the
+     * database of a running application. Frames registered by other means are dropped. Nothing changes if the
+     * database cannot be read.
+     */
+    bool reloadDatabaseFrames(const std::string& ddbbFile);
+
     void unregisterAllFrames();
 
 	std::set<u32> getAllRegisteredPGNs() const;
 
+	/*
+	 * Returns true if there is a frame registered for the given PGN
+	 */
+	bool isRegistered(u32 pgn) const;
+
+	/*
+	 * Returns the compiled layout of the frame registered for the given PGN or null if the frame is not a generic frame or could not be compiled
+	 */
+	std::shared_ptr<const FrameLayout> getFrameLayout(u32 pgn) const;
+
+	/*
+	 * Returns a view over the given data that decodes the SPNs on demand, without creating any frame.
+	 * The view is not valid if the PGN is not registered as a generic frame with a compiled layout.
+	 * The view shares the layout, so it remains usable once the frame is unregistered or the database reloaded.
+	 */
+	FrameView getFrameView(u32 id, const u8* data, size_t length) const;
+
 };
 
+template<class Iterator>
+size_t J1939Factory::registerFrames(Iterator first, Iterator last) {
+
+	std::lock_guard<std::mutex> lock(mWriteLock);
+
+	std::unique_ptr<Registry> registry(new Registry(*mRegistry.load(std::memory_order_relaxed)));
+
+	size_t registered = 0;
+
+	for(; first != last; ++first) {
+		if(registerFrame(*registry, *first)) {
+			++registered;
+		}
+	}
+
+	if(registered > 0) {
+		publish(registry.release());
+	}
+
+	return registered;
+
+}
+
 } /* namespace J1939 */
 
 #endif /* J1939FACTORY_H_ */
@@ -118,6 +118,12 @@ public:
 	void decode(u32 identifier, const u8* buffer, size_t length);
 	void encode(u32& identifier, u8* buffer, size_t& length) const;
 
+	/*
+	 * Non throwing versions of decode and encode. If decoding fails, the content of the frame is undefined.
+	 */
+	ECodecStatus tryDecode(u32 identifier, const u8* buffer, size_t length);
+	ECodecStatus tryEncode(u32& identifier, u8* buffer, size_t& length) const;
+
 	u32 getIdentifier() const;
 
 protected:
@@ -132,6 +138,17 @@ protected:
 	 */
 	virtual void encodeData(u8* buffer, size_t length) const = 0;
 
+	/**
+	 * Non throwing versions of decodeData and encodeData. By default, they call decodeData and encodeData and catch the exceptions.
+	 * Frames can override them and implement decodeData and encodeData on top of them.
+	 */
+	virtual ECodecStatus tryDecodeData(const u8* buffer, size_t length);
+	virtual ECodecStatus tryEncodeData(u8* buffer, size_t length) const;
+
+private:
+	ECodecStatus decodeIdentifier(u32 identifier);
+	ECodecStatus checkEncode(size_t length) const;
+
 public:
 	u32 getPGN() const { return mPgn; }
 
@@ -0,0 +1,137 @@
+/*
+ * PGNTable.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Flat lookup structure indexed by the 18 bit PGN.
+ *
+ *  The table is split in 1024 pages (Extended Data Page, Data Page and PDU Format) of 256 entries (PDU Specific)
+ *  which are only allocated when a PGN of the page is inserted. A presence bitmap of 2^18 bits (32 KB) works as a
+ *  negative cache: unknown PGNs, which are the majority of the traffic in a bus full of proprietary frames,
+ *  are rejected with a single bit test without touching the pages.
+ */
+
+#ifndef PGNTABLE_H_
+#define PGNTABLE_H_
+
+#include <bitset>
+#include <vector>
+
+#include <Types.h>
+
+#include "J1939Common.h"
+
+#define PGN_TABLE_PAGE_BITS		8
+#define PGN_TABLE_PAGE_SIZE		(1 << PGN_TABLE_PAGE_BITS)
+#define PGN_TABLE_PAGE_MASK		(PGN_TABLE_PAGE_SIZE - 1)
+#define PGN_TABLE_PAGES			((J1939_PGN_MASK + 1) >> PGN_TABLE_PAGE_BITS)
+
+namespace J1939 {
+
+/*
+ * T is expected to be a pointer-like type where the value initialized T() means "no entry".
+ */
+template<class T>
+class PGNTable {
+
+private:
+	std::bitset<J1939_PGN_MASK + 1> mPresent;
+	std::vector<std::vector<T> > mPages;
+	size_t mSize;
+
+public:
+	PGNTable() : mPages(PGN_TABLE_PAGES), mSize(0) {}
+	virtual ~PGNTable() {}
+
+	/*
+	 * Returns true if there is an entry for the given PGN. Does not touch the pages.
+	 */
+	bool contains(u32 pgn) const { return mPresent[pgn & J1939_PGN_MASK]; }
+
+	/*
+	 * Returns the entry for the given PGN or T() if there is none.
+	 */
+	T find(u32 pgn) const {
+
+		pgn &= J1939_PGN_MASK;
+
+		if(!mPresent[pgn])	return T();
+
+		return mPages[pgn >> PGN_TABLE_PAGE_BITS][pgn & PGN_TABLE_PAGE_MASK];
+	}
+
+	/*
+	 * Sets the entry for the given PGN. Setting T() is equivalent to erase the entry.
+	 */
+	void set(u32 pgn, T value) {
+
+		pgn &= J1939_PGN_MASK;
+
+		if(value == T()) {
+			erase(pgn);
+			return;
+		}
+
+		std::vector<T>& page = mPages[pgn >> PGN_TABLE_PAGE_BITS];
+
+		if(page.empty()) {
+			page.resize(PGN_TABLE_PAGE_SIZE, T());
+		}
+
+		if(!mPresent[pgn]) {
+			mPresent[pgn] = true;
+			++mSize;
+		}
+
+		page[pgn & PGN_TABLE_PAGE_MASK] = value;
+
+	}
+
+	void erase(u32 pgn) {
+
+		pgn &= J1939_PGN_MASK;
+
+		if(!mPresent[pgn])	return;
+
+		mPresent[pgn] = false;
+		--mSize;
+
+		mPages[pgn >> PGN_TABLE_PAGE_BITS][pgn & PGN_TABLE_PAGE_MASK] = T();
+
+	}
+
+	void clear() {
+
+		mPresent.reset();
+		mSize = 0;
+
+		for(auto page = mPages.begin(); page != mPages.end(); ++page) {
+			std::vector<T>().swap(*page);		//Release the memory of the page
+		}
+	}
+
+	size_t size() const { return mSize; }
+
+	bool empty() const { return mSize == 0; }
+
+};
+
+/*
+ * Extracts the PGN from a CAN identifier, removing the destination address for PGNs in PDU format 1.
+ */
+inline u32 getPGNFromId(u32 id) {
+
+	u32 pgn = ((id >> J1939_PGN_OFFSET) & J1939_PGN_MASK);
+
+	//Check if PDU format belongs to the first group
+	if(((pgn >> J1939_PDU_FMT_OFFSET) & J1939_PDU_FMT_MASK) < PDU_FMT_DELIMITER) {
+		pgn &= ~J1939_PDU_SPECIFIC_MASK;
+	}
+
+	return pgn;
+}
+
+} /* namespace J1939 */
+
+#endif /* PGNTABLE_H_ */
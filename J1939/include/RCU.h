@@ -0,0 +1,62 @@
+/*
+ * RCU.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Minimal read-copy-update for structures that are read from many threads and rarely replaced, as the registry
+ *  of J1939Factory. Readers mark the beginning and the end of the read side critical sections, which costs a
+ *  couple of atomic stores into a slot owned by the thread, with no locks nor loops. Writers publish a new copy
+ *  of the structure with an atomic store and call synchronize, which waits until every reader that could still
+ *  see the old copy leaves its critical section, before freeing it.
+ *
+ *  	RCUReadGuard guard;
+ *  	const Registry* registry = mRegistry.load(std::memory_order_acquire);
+ *  	... use registry until the guard is destroyed ...
+ *
+ *  Critical sections may be nested. A thread must not call synchronize inside a critical section.
+ */
+
+#ifndef RCU_H_
+#define RCU_H_
+
+#include <Types.h>
+
+namespace J1939 {
+
+class RCU {
+
+public:
+	/*
+	 * Enters the read side critical section of the calling thread. Wait free once the thread got its slot,
+	 * which only happens in the first call from every thread.
+	 */
+	static void readLock();
+
+	static void readUnlock();
+
+	/*
+	 * Waits until all the critical sections that began before the call have finished. The structures unpublished
+	 * before the call can be freed afterwards.
+	 */
+	static void synchronize();
+
+};
+
+/*
+ * Scoped read side critical section
+ */
+class RCUReadGuard {
+
+public:
+	RCUReadGuard() { RCU::readLock(); }
+	~RCUReadGuard() { RCU::readUnlock(); }
+
+	RCUReadGuard(const RCUReadGuard&) = delete;
+	RCUReadGuard& operator=(const RCUReadGuard&) = delete;
+
+};
+
+} /* namespace J1939 */
+
+#endif /* RCU_H_ */
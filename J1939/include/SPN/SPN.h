@@ -13,6 +13,7 @@
 
 #include <Types.h>
 #include <ICloneable.h>
+#include <J1939Common.h>
 
 #include <SPN/SPNSpec/SPNSpec.h>
 
@@ -30,13 +31,31 @@ public:
 
 private:
 	std::shared_ptr<const SPNSpec> mSpec;
+
+	//The value changed since the owner encoded it for the last time
+	bool mDirty = true;
+
+	void notifyDirty();
 protected:
 	GenericFrame *mOwner = nullptr;		//Owner of this spn
 
+	/*
+	 * To be called whenever the value changes, so that the owner re-encodes the SPN in its cached payload.
+	 * Only the first change after an encode reaches the owner.
+	 */
+	void setDirty() { if(!mDirty) notifyDirty(); }
+
 public:
     SPN(u32 number, const std::string& name, size_t offset);
 	virtual ~SPN();
 
+	/*
+	 * A copy does not belong to the owner of the original, the frame that takes the copy sets itself as its owner.
+	 * Assigning keeps the owner of the assigned SPN, which is notified of the new value.
+	 */
+	SPN(const SPN& other);
+	SPN& operator=(const SPN& other);
+
 	virtual size_t getOffset() const {
 		return mSpec->getOffset();
 	}
@@ -55,12 +74,22 @@ public:
 
 	void setOwner(GenericFrame* owner) { mOwner = owner; }
 
+	bool isDirty() const { return mDirty; }
+
+	void clearDirty() { mDirty = false; }
+
 	//To implement by inherited classes
 
 	virtual EType getType() const = 0;
 
-    virtual void decode(const u8* buffer, size_t length) = 0;
-    virtual void encode(u8* buffer, size_t length) const = 0;
+    /*
+     * Throw J1939DecodeException/J1939EncodeException if the status returned by tryDecode/tryEncode is not CODEC_OK
+     */
+    virtual void decode(const u8* buffer, size_t length);
+    virtual void encode(u8* buffer, size_t length) const;
+
+    virtual ECodecStatus tryDecode(const u8* buffer, size_t length) = 0;
+    virtual ECodecStatus tryEncode(u8* buffer, size_t length) const = 0;
 
 	virtual std::string toString() const;
 
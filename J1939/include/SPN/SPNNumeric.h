@@ -28,8 +28,8 @@ public:
 
 	bool setFormattedValue(double value);
 
-    void decode(const u8* buffer, size_t length);
-    void encode(u8* buffer, size_t length) const;
+    ECodecStatus tryDecode(const u8* buffer, size_t length) override;
+    ECodecStatus tryEncode(u8* buffer, size_t length) const override;
 
 	EType getType() const { return SPN_NUMERIC; }
 
@@ -56,6 +56,7 @@ public:
 
     void setValue(u32 value) {
         mValue = value;
+        setDirty();
     }
 
     /*
@@ -49,7 +49,12 @@ public:
     void setValueDescription(u8 value, const std::string& desc);
     std::string getValueDescription(u8 value) const;
     void clearValueDescriptions();
-    DescMap getValueDescriptionsMap() const;
+    const DescMap& getValueDescriptionsMap() const;
+
+    /*
+     * Returns the description of the value or null if it has none, without copying it
+     */
+    const std::string* findValueDescription(u8 value) const;
 
 };
 
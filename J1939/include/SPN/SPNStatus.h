@@ -22,6 +22,8 @@ public:
     typedef std::map<u8, std::string> DescMap;
 private:
 	u8 mValue;
+
+	friend class GenericFrame;		//Decodes the value directly from the compiled layout
 	std::shared_ptr<const SPNStatusSpec> mStatSpec;
 
 public:
@@ -29,8 +31,8 @@ public:
 	virtual ~SPNStatus();
 
 
-	void decode(const u8* buffer, size_t length);
-	void encode(u8* buffer, size_t length) const;
+	ECodecStatus tryDecode(const u8* buffer, size_t length) override;
+	ECodecStatus tryEncode(u8* buffer, size_t length) const override;
 
 	EType getType() const { return SPN_STATUS; }
 
@@ -47,7 +49,8 @@ public:
 	u8 getByteSize() const override { return 1; }		//Spn status has always size of 1
 
 	std::string getValueDescription(u8 value) const { return mStatSpec->getValueDescription(value); }
-	DescMap getValueDescriptionsMap() const { return mStatSpec->getValueDescriptionsMap(); }
+	const DescMap& getValueDescriptionsMap() const { return mStatSpec->getValueDescriptionsMap(); }
+	const std::string* findValueDescription(u8 value) const { return mStatSpec->findValueDescription(value); }
 
 	std::shared_ptr<const SPNStatusSpec> getStatusSpec() const { return mStatSpec; }
 
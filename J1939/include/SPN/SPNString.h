@@ -23,8 +23,8 @@ public:
 	SPNString(u32 number, const std::string& name);
 	virtual ~SPNString();
 
-	void decode(const u8* buffer, size_t length) override;
-	void encode(u8* buffer, size_t length) const override;
+	ECodecStatus tryDecode(const u8* buffer, size_t length) override;
+	ECodecStatus tryEncode(u8* buffer, size_t length) const override;
 
 	EType getType() const { return SPN_STRING; }
 
@@ -32,7 +32,7 @@ public:
 
 	u8 getByteSize() const override { return mValue.size() + 1; }		//Include the * terminator
 
-	std::string getValue() const { return mValue; }
+	const std::string& getValue() const { return mValue; }
 
 	void setValue(std::string value);
 
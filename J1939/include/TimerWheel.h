@@ -0,0 +1,166 @@
+/*
+ * TimerWheel.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Hashed timer wheel for the timeouts of the transport sessions. The timers are embedded in the objects that own
+ *  them and linked in the slot of their deadline, so scheduling, rescheduling and cancelling are O(1) and never
+ *  allocate. The wheel has no clock: it is advanced with the time of the frames, which may come from a capture.
+ *
+ *  	TimerWheel wheel;
+ *  	session.timer.key = srcAddr;
+ *  	wheel.schedule(session.timer, now + 750);
+ *  	...
+ *  	wheel.advance(now, [&](TimerWheel::Timer& timer) { ... timer.key expired ... });
+ *
+ *  Times are milliseconds. A timer expires in the first advance at or after its deadline. The expired callback may
+ *  schedule and cancel any timer, including the expired one.
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <vector>
+
+#include <Types.h>
+
+#define TIMER_WHEEL_DEFAULT_RESOLUTION		10			//Milliseconds per slot
+#define TIMER_WHEEL_DEFAULT_SLOTS			256			//A turn of 2.56 s covers all the J1939-21 timeouts
+
+namespace J1939 {
+
+class TimerWheel {
+
+public:
+
+	class Timer {
+
+	private:
+		Timer* mPrev;
+		Timer* mNext;
+
+		friend class TimerWheel;
+
+	public:
+		u64 deadline;
+		u32 key;			//Free for the owner, to find the object of the timer
+
+		Timer() : mPrev(nullptr), mNext(nullptr), deadline(0), key(0) {}
+
+		//Linked in the wheel, never copied
+		Timer(const Timer&) = delete;
+		Timer& operator=(const Timer&) = delete;
+
+		bool isScheduled() const { return mPrev != nullptr; }
+
+	};
+
+private:
+
+	//Sentinels of the circular lists of the slots
+	std::vector<Timer> mSlots;
+	size_t mMask;
+	u32 mResolution;
+
+	u64 mTime;
+	size_t mCount;
+
+	static void link(Timer& head, Timer& timer);
+	static void unlink(Timer& timer);
+
+	/*
+	 * Moves the expired timers of the slot to the list
+	 */
+	void collect(Timer& slot, Timer& expired);
+
+public:
+
+	/*
+	 * The number of slots is rounded up to a power of two
+	 */
+	TimerWheel(u32 resolution = TIMER_WHEEL_DEFAULT_RESOLUTION, size_t slots = TIMER_WHEEL_DEFAULT_SLOTS);
+	virtual ~TimerWheel();
+
+	TimerWheel(const TimerWheel&) = delete;
+	TimerWheel& operator=(const TimerWheel&) = delete;
+
+	/*
+	 * Schedules the timer at the deadline, replacing its previous deadline if it was scheduled
+	 */
+	void schedule(Timer& timer, u64 deadline);
+
+	void cancel(Timer& timer);
+
+	/*
+	 * Advances the wheel to the given time and calls expired for every timer whose deadline has been reached,
+	 * unscheduled before the call. Going back in time does nothing. Returns the number of expired timers.
+	 * Only the slots between the previous time and the new one are visited, a whole turn at most.
+	 */
+	template<class Callback>
+	size_t advance(u64 now, Callback expired);
+
+	/*
+	 * Time of the last advance
+	 */
+	u64 getTime() const { return mTime; }
+
+	size_t size() const { return mCount; }
+
+	/*
+	 * Cancels all the timers. Must not be called from the expired callback, the timers expired in the same advance
+	 * are not cancelled: cancel them one by one instead.
+	 */
+	void clear();
+
+};
+
+template<class Callback>
+size_t TimerWheel::advance(u64 now, Callback expired) {
+
+	if(now < mTime) {
+		return 0;
+	}
+
+	u64 tick = mTime / mResolution;
+	u64 lastTick = now / mResolution;
+
+	if(lastTick - tick > mMask) {
+		lastTick = tick + mMask;		//The whole turn
+	}
+
+	mTime = now;
+
+	if(mCount == 0) {
+		return 0;
+	}
+
+	Timer list;
+
+	list.mPrev = list.mNext = &list;
+
+	for(; tick <= lastTick; ++tick) {
+		collect(mSlots[tick & mMask], list);
+	}
+
+	size_t count = 0;
+
+	//Unlinked one by one, the callbacks may cancel the timers still in the list
+	while(list.mNext != &list) {
+
+		Timer& timer = *list.mNext;
+
+		unlink(timer);
+		--mCount;
+		++count;
+
+		expired(timer);
+	}
+
+	return count;
+
+}
+
+} /* namespace J1939 */
+
+#endif /* TIMERWHEEL_H_ */
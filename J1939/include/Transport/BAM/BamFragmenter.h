@@ -9,7 +9,7 @@
 #define TRANSPORT_BAM_BAMFRAGMENTER_H_
 
 #include <vector>
-#include <map>
+#include <functional>
 
 #include "../TPCMFrame.h"
 #include "../TPDTFrame.h"
@@ -18,10 +18,16 @@ namespace J1939 {
 
 class BamFragmenter{
 
+public:
+	/*
+	 * Receives the identifier and the payload of a packet ready to be put on the bus
+	 */
+	typedef std::function<void(u32 id, const u8* data, size_t length)> PacketCallback;
+
 private:
 
 	TPCMFrame mCMFrame;
-	std::map<u8/*Sequence number*/, TPDTFrame> mDTFrames;
+	std::vector<TPDTFrame> mDTFrames;		//Ordered by sequence number
 
 public:
 	BamFragmenter();
@@ -29,10 +35,17 @@ public:
 
 	bool fragment(const J1939Frame& frame);
 
+	/*
+	 * Encodes the TP.CM and the TP.DT packets of the frame in order of transmission, without building the
+	 * intermediate frames. Returns false without calling the callback if the frame fits in a single packet or
+	 * is longer than TP_MAX_MSG_SIZE.
+	 */
+	static bool fragment(const J1939Frame& frame, const PacketCallback& callback);
+
 	void clear() { mDTFrames.clear(); mCMFrame.clear(); }
 
 	const TPCMFrame& getConnFrame() const { return mCMFrame; }
-	std::vector<TPDTFrame> getDataFrames() const;
+	const std::vector<TPDTFrame>& getDataFrames() const { return mDTFrames; }
 };
 
 } /* namespace J1939 */
@@ -19,19 +19,28 @@
 #define BAMFRAMESET_H_
 
 #include <vector>
-#include <map>
 #include <queue>
 #include <memory>
 
 
 #include "../TPCMFrame.h"
 #include "../TPDTFrame.h"
+#include "../../TimerWheel.h"
 
+//J1939-21 T1, maximum time between the packets of a BAM in milliseconds
+#define BAM_TIMEOUT_T1				750
+
+//Sources that can send a BAM at the same time by default, a slot takes TP_MAX_MSG_SIZE bytes. When all of them are
+//used, a new message replaces the session that has been waiting the longest for a packet.
+#define BAM_DEFAULT_SLOTS			32
+#define BAM_NO_SLOT					0xFFFF
 
 
 
 namespace J1939 {
 
+class J1939Factory;
+
 class BamReassembler {
 
 public:
@@ -41,44 +50,124 @@ public:
 	    BAM_ERROR_UNEXPECTED_FRAME,
 		BAM_ERROR_NOT_BCAST_ADDR,
 		BAM_ERROR_DECODING,
+		BAM_ERROR_NO_SLOT,			//All the slots were used by other sources, the oldest session was dropped
 	    BAM_ERROR_OK,
 	};
 
 private:
 
-	class BAMFragments {
-	private:
-		TPCMFrame mCMFrame;
-		std::vector<TPDTFrame> mDTFrames;
-
-	public:
-		const TPCMFrame& getCmFrame() const { return mCMFrame; }
-		void setCmFrame(const TPCMFrame& cmFrame) { mCMFrame = cmFrame; }
-		const std::vector<TPDTFrame>& getDtFrames() const { return mDTFrames; }
-		void addDtFrame(const TPDTFrame& dtFrame) { mDTFrames.push_back(dtFrame); }
-		u8 getLastSQ() const;
+	/*
+	 * Message being received from a source. The payload of the TP.DT frames is written straight into the slot.
+	 */
+	struct Session {
+		u32 pgn;
+		u8 priority;
+		u16 totalSize;
+		u8 totalPackets;
+		u8 lastSQ;
+		u8* data;
+		TimerWheel::Timer timer;		//Keyed by source address
 	};
 
 
-	//Fragments of frames sortered by Source Address
-	std::map<u8, BAMFragments> mFragments;
+	//Factory where the reassembled frames are decoded
+	J1939Factory* mFactory;
+
+	//Slots of TP_MAX_MSG_SIZE bytes, allocated once
+	std::vector<u8> mBuffer;
+	std::unique_ptr<Session[]> mSessions;
+	size_t mSlotCount;
+	std::vector<u16> mFreeSlots;
+
+	//Slot of the session of every source address, BAM_NO_SLOT if none
+	u16 mSlotBySource[J1939_BROADCAST_ADDRESS + 1];
 
     EBamError mLastError;
 
     std::queue<J1939Frame*> mReassembledFrames;
 
+    //Declared after the sessions, it is destroyed before their timers
+    TimerWheel mWheel;
+    u32 mTimeout;
+    u64 mExpiredSessions;
+    u64 mEvictedSessions;
+
+
+	size_t handleConnection(u8 srcAddr, u8 priority, u32 pgn, u16 totalSize, u8 totalPackets);
+	size_t handleData(u8 srcAddr, u8 sq, const u8* data);
 
-	void reassemble(const BAMFragments& fragments, u8** data, size_t& length);
+	void releaseSlot(u8 srcAddr);
+
+	/*
+	 * Drops the session that has not received a packet for the longest time
+	 */
+	void evictOldest();
 
 public:
 
-	BamReassembler();
+	/*
+	 * The reassembled frames are decoded with the given factory, the default instance if null.
+	 * Up to slots sources can be sending at the same time, the memory of the slots is reserved here. Beyond that,
+	 * the oldest sessions are dropped.
+	 */
+	BamReassembler(J1939Factory* factory = nullptr, size_t slots = BAM_DEFAULT_SLOTS);
 	virtual ~BamReassembler();
 
+	BamReassembler(const BamReassembler&) = delete;
+	BamReassembler& operator=(const BamReassembler&) = delete;
+
 	bool toBeHandled(const J1939Frame&) const;
 
+	/*
+	 * Raw identifier of a TP.CM or TP.DT frame to the broadcast address, without looking at the payload
+	 */
+	static bool isTransportId(u32 id) {
+		u32 pgn = id & (J1939_PGN_MASK << J1939_PGN_OFFSET);
+		return pgn == ((TP_CM_PGN | J1939_BROADCAST_ADDRESS) << J1939_PGN_OFFSET) ||
+				pgn == ((TP_DT_PGN | J1939_BROADCAST_ADDRESS) << J1939_PGN_OFFSET);
+	}
+
+	/*
+	 * Same as toBeHandled for a frame not decoded yet: a TP.CM BAM or a TP.DT of the right length
+	 */
+	static bool toBeHandled(u32 id, const u8* data, size_t length);
+
+	/*
+	 * Handles the frame at the time of the last call to tick. The sessions only expire if tick is called.
+	 */
 	size_t handleFrame(const J1939Frame&);
 
+	/*
+	 * Same as above but at the given time, usually the timestamp of the frame in milliseconds. The sessions
+	 * that have not received a packet within the timeout are dropped first.
+	 */
+	size_t handleFrame(const J1939Frame&, u64 now);
+
+	/*
+	 * Same as handleFrame for the raw frames of the bus, reassembled straight from their payload. Only the complete
+	 * messages are decoded by the factory, the packets are never decoded nor allocated.
+	 */
+	size_t handleFrame(u32 id, const u8* data, size_t length);
+	size_t handleFrame(u32 id, const u8* data, size_t length, u64 now);
+
+	/*
+	 * Drops the sessions that have not received a packet within the timeout at the given time
+	 */
+	void tick(u64 now);
+
+	void setTimeout(u32 timeout) { mTimeout = timeout; }
+	u32 getTimeout() const { return mTimeout; }
+
+	/*
+	 * Sessions dropped by timeout since the creation or the last clear
+	 */
+	u64 getExpiredSessions() const { return mExpiredSessions; }
+
+	/*
+	 * Sessions dropped to make room for the messages of other sources since the creation or the last clear
+	 */
+	u64 getEvictedSessions() const { return mEvictedSessions; }
+
 	void clear();
     void setError(EBamError status) { mLastError = status; }
 
@@ -88,6 +177,13 @@ public:
 
     std::unique_ptr<J1939Frame> dequeueReassembledFrame();
 
+    size_t getSlotCount() const { return mSlotCount; }
+
+    /*
+     * Sources in the middle of a message
+     */
+    size_t getActiveSessions() const { return mSlotCount - mFreeSlots.size(); }
+
 
 };
 
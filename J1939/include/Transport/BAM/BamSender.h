@@ -0,0 +1,67 @@
+/*
+ * BamSender.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  Sends J1939 frames longer than 8 bytes through a CAN sender with the Broadcast Announce Message. The packets are
+ *  paced by the scheduler of the sender, no thread is created. Header only, the J1939 library does not depend on the
+ *  CAN one: the applications using it link both.
+ */
+
+#ifndef TRANSPORT_BAM_BAMSENDER_H_
+#define TRANSPORT_BAM_BAMSENDER_H_
+
+#include <string>
+#include <vector>
+
+#include <Utils.h>
+#include <ICanSender.h>
+
+#include "BamFragmenter.h"
+
+//J1939-21 time between the packets of a BAM in milliseconds
+#define BAM_MIN_INTERVAL			50
+#define BAM_MAX_INTERVAL			200
+
+namespace J1939 {
+
+/*
+ * Key of the sequences of the given source in the sender, the identifier of its TP.CM without the priority
+ */
+inline u32 getBamSequenceKey(u8 srcAddr) {
+	return ((TP_CM_PGN | J1939_BROADCAST_ADDRESS) << J1939_PGN_OFFSET) | srcAddr;
+}
+
+/*
+ * Queues the TP.CM and TP.DT packets of the frame in the sender, once, with the given interval between them clamped
+ * to the J1939-21 range. The messages of a source are sent one after the other, as a source can only send one BAM at a
+ * time, and the messages of different sources are interleaved. Returns false if the frame fits in a single packet.
+ */
+inline bool sendBam(Can::ICanSender& sender, const J1939Frame& frame, u32 interval = BAM_MIN_INTERVAL) {
+
+	std::vector<Can::CanFrame> canFrames;
+
+	bool fragmented = BamFragmenter::fragment(frame, [&canFrames](u32 id, const u8* data, size_t length) {
+		canFrames.push_back(Can::CanFrame(true, id, data, length));
+	});
+
+	if(!fragmented) {
+		return false;
+	}
+
+	return sender.sendSequence(getBamSequenceKey(frame.getSrcAddr()), std::move(canFrames),
+			J1939_MIN(J1939_MAX(interval, BAM_MIN_INTERVAL), BAM_MAX_INTERVAL));
+
+}
+
+/*
+ * True while messages of the source are being sent
+ */
+inline bool isBamSent(Can::ICanSender& sender, u8 srcAddr) {
+	return sender.isSequenceSent(getBamSequenceKey(srcAddr));
+}
+
+} /* namespace J1939 */
+
+#endif /* TRANSPORT_BAM_BAMSENDER_H_ */
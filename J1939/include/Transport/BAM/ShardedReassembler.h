@@ -0,0 +1,143 @@
+/*
+ * ShardedReassembler.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ *  BAM reassembly spread over several worker threads, for gateways where one thread receives the traffic of many
+ *  buses. The packets are sharded by interface and source address: all the packets of a source in an interface go
+ *  to the same worker, which reassembles them in order with its own BamReassembler, so the sessions are never shared
+ *  between threads. The handoff is done through lock free queues, one per worker for the packets and a single one
+ *  for the reassembled messages of all the workers, which also decode them.
+ *
+ *  	ShardedReassembler reassembler(4);
+ *  	...
+ *  	if(ShardedReassembler::toBeHandled(id, data, length)) {		//Receiving thread
+ *  		reassembler.push(interface, id, data, length, timestamp);
+ *  	}
+ *  	...
+ *  	ShardedReassembler::Message message;
+ *  	while(reassembler.pop(message)) { ... message.frame ... }
+ *
+ *  The messages of a source in an interface are popped in the order they were completed. The connection mode
+ *  transfers (RTS/CTS, ETP) are not handled here, they need the connection managers to answer in the bus.
+ */
+
+#ifndef TRANSPORT_BAM_SHARDEDREASSEMBLER_H_
+#define TRANSPORT_BAM_SHARDEDREASSEMBLER_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BamReassembler.h"
+#include "../../BoundedQueue.h"
+
+#define SHARDED_DEFAULT_QUEUE_SIZE			4096
+
+
+namespace J1939 {
+
+class ShardedReassembler {
+
+public:
+
+	struct Message {
+		std::unique_ptr<J1939Frame> frame;
+		u32 interface;
+		u64 timestamp;					//Of the last packet
+	};
+
+private:
+
+	struct Packet {
+		u32 interface;
+		u32 id;
+		u8 data[J1939_MAX_SIZE];
+		u8 length;
+		u64 timestamp;
+	};
+
+	struct Worker {
+		BoundedQueue<Packet> packets;
+
+		//Reassembler of every interface, created with the first packet
+		std::unordered_map<u32, std::unique_ptr<BamReassembler> > reassemblers;
+
+		std::atomic<u64> pushed;
+		std::atomic<u64> processed;
+
+		std::thread thread;
+
+		Worker(size_t queueSize) : packets(queueSize), pushed(0), processed(0) {}
+	};
+
+	J1939Factory* mFactory;
+
+	std::vector<std::unique_ptr<Worker> > mWorkers;
+
+	BoundedQueue<Message> mMessages;
+
+	std::atomic<bool> mFinished;
+	std::atomic<u64> mDroppedPackets;
+
+	void run(Worker& worker);
+	void process(Worker& worker, const Packet& packet);
+
+public:
+
+	/*
+	 * Starts the given number of workers, as many as cores if 0. The reassembled frames are decoded with the given
+	 * factory, the default instance if null. Every worker queues up to queueSize packets, and queueSize messages
+	 * wait to be popped.
+	 */
+	ShardedReassembler(size_t workers = 0, J1939Factory* factory = nullptr, size_t queueSize = SHARDED_DEFAULT_QUEUE_SIZE);
+
+	/*
+	 * Stops the workers, the packets and messages not processed yet are dropped
+	 */
+	virtual ~ShardedReassembler();
+
+	ShardedReassembler(const ShardedReassembler&) = delete;
+	ShardedReassembler& operator=(const ShardedReassembler&) = delete;
+
+	/*
+	 * Packets of the BAM protocol, the ones to push
+	 */
+	static bool toBeHandled(u32 id, const u8* data, size_t length) { return BamReassembler::toBeHandled(id, data, length); }
+
+	/*
+	 * Hands the packet to the worker of its source, the timestamp in milliseconds expires the sessions of the worker.
+	 * Returns false if the packet is dropped because the queue of the worker is full.
+	 * The packets of an interface must be pushed from a single thread to keep their order.
+	 */
+	bool push(u32 interface, u32 id, const u8* data, size_t length, u64 timestamp);
+
+	/*
+	 * Takes the next reassembled message, returns false if there is none. It can be called from any thread.
+	 * While the messages are not popped the workers wait and their queues fill up.
+	 */
+	bool pop(Message& message) { return mMessages.pop(message); }
+
+	/*
+	 * Waits until the workers have processed all the packets pushed before the call. If they complete more messages
+	 * than fit in the queue, these must be popped meanwhile from another thread.
+	 */
+	void flush();
+
+	size_t getWorkerCount() const { return mWorkers.size(); }
+
+	/*
+	 * Worker to which the packets of the source in the interface go
+	 */
+	size_t getWorker(u32 interface, u8 srcAddr) const;
+
+	u64 getDroppedPackets() const { return mDroppedPackets.load(std::memory_order_relaxed); }
+
+};
+
+} /* namespace J1939 */
+
+#endif /* TRANSPORT_BAM_SHARDEDREASSEMBLER_H_ */
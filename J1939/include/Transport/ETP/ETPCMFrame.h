@@ -0,0 +1,183 @@
+/*
+ * ETPCMFrame.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#ifndef TRANSPORT_ETP_ETPCMFRAME_H_
+#define TRANSPORT_ETP_ETPCMFRAME_H_
+
+
+#include "../../J1939Frame.h"
+#include "../TPCMFrame.h"
+
+#define ETP_CM_PGN		0x00C800
+#define ETP_CM_SIZE		8
+
+//Packet numbers of the Extended Transport Protocol are 24 bits long
+#define ETP_MAX_PACKETS			0xFFFFFF
+#define ETP_MAX_MSG_SIZE		(ETP_MAX_PACKETS * TP_DT_PACKET_SIZE)
+
+//Messages up to this size use the Transport Protocol instead
+#define ETP_MIN_MSG_SIZE		(TP_MAX_MSG_SIZE + 1)
+
+
+//CM Types
+
+/*
+ * The ETP.CM_RTS message informs a node that another node wishes to open a virtual connection with it to transfer more
+ * than 1785 bytes. Bytes 2 to 5 carry the number of bytes of the message.
+ * ETP.CM_RTS is only transmitted by the originator.
+ */
+#define CTRL_ETPCM_RTS		20
+
+/*
+ * The ETP.CM_CTS message is used to respond to the Request To Send message. Byte 2 is the number of packets that can be
+ * sent and bytes 3 to 5 the number of the next packet to be sent, counted from 1 for the whole message.
+ * A CTS of 0 packets holds the connection open.
+ * ETP.CM_CTS is only transmitted by the responder.
+ */
+#define CTRL_ETPCM_CTS		21
+
+/*
+ * The ETP.CM_DPO (Data Packet Offset) message is sent by the originator before the packets cleared by a CTS. Byte 2 is
+ * the number of packets that follow and bytes 3 to 5 the offset to add to their sequence numbers to get the packet
+ * numbers in the message.
+ * ETP.CM_DPO is only transmitted by the originator.
+ */
+#define CTRL_ETPCM_DPO		22
+
+/*
+ * The ETP.CM_EOMA message is passed from the recipient of a large message to its originator indicating that the entire
+ * message was received. Bytes 2 to 5 carry the number of bytes transferred.
+ * ETP.CM_EOMA is only transmitted by the responder.
+ */
+#define CTRL_ETPCM_ACK		23
+
+/*
+ * Same as TP.Conn_Abort, with the ETP PGN
+ */
+#define CTRL_ETPCM_ABORT	255
+
+
+//Connection abort reasons specific to the data packets of ETP, the others are shared with TP
+
+/*
+ * Unexpected data transfer packet
+ */
+#define CONN_ABORT_UNEXPECTED_DT		6
+
+/*
+ * Bad sequence number, the DPO and the sequence numbers do not match
+ */
+#define CONN_ABORT_BAD_SQ				7
+
+/*
+ * Unexpected ETP.CM_DPO message
+ */
+#define CONN_ABORT_UNEXPECTED_DPO		10
+
+/*
+ * The ETP.CM_DPO announces more packets than cleared by the CTS
+ */
+#define CONN_ABORT_DPO_PACKETS			12
+
+/*
+ * The offset of the ETP.CM_DPO is not the one requested by the CTS
+ */
+#define CONN_ABORT_BAD_DPO_OFFSET		13
+
+/*
+ * The ETP.CM_CTS requests packets beyond the end of the message
+ */
+#define CONN_ABORT_BAD_CTS				15
+
+
+namespace J1939 {
+
+class ETPCMFrame: public J1939Frame {
+
+private:
+
+	/*
+	 * Control byte
+	 */
+	u8 mCtrlType;
+
+	/*
+	 * Total message size, number of bytes
+	 */
+	u32 mTotalMsgSize;
+
+	/*
+	 * Number of packets that can be sent for CTS, number of packets that follow for DPO
+	 */
+	u8 mPacketsToTx;
+
+	/*
+	 * Next packet number to be sent, from 1
+	 */
+	u32 mNextPacket;
+
+	/*
+	 * Offset of the sequence numbers of the packets that follow the DPO
+	 */
+	u32 mPacketOffset;
+
+	/*
+	 * Connection Abort reason
+	 */
+	u8 mAbortReason;
+
+	/*
+	 * Parameter Group Number of the packeted message
+	 */
+	u32 mDataPgn;
+
+public:
+	ETPCMFrame();
+
+	virtual ~ETPCMFrame();
+
+
+	void clear();
+
+	//Implements J1939Frame methods
+	void decodeData(const u8* buffer, size_t length);
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
+	void encodeData(u8* buffer, size_t length) const;
+	ECodecStatus tryEncodeData(u8* buffer, size_t length) const override;
+
+	size_t getDataLength() const { return ETP_CM_SIZE; }
+
+
+	u8 getAbortReason() const { return mAbortReason; }
+	void setAbortReason(u8 abortReason) { mAbortReason = abortReason; }
+
+	u8 getCtrlType() const { return mCtrlType; }
+	void setCtrlType(u8 ctrlType) { mCtrlType = ctrlType; }
+
+	u32 getDataPgn() const { return mDataPgn; }
+	void setDataPgn(u32 dataPgn) { mDataPgn = dataPgn; }
+
+	u32 getTotalMsgSize() const { return mTotalMsgSize; }
+	void setTotalMsgSize(u32 totalMsgSize) { mTotalMsgSize = totalMsgSize; }
+
+	u8 getPacketsToTx() const { return mPacketsToTx; }
+	void setPacketsToTx(u8 packetsToTx) { mPacketsToTx = packetsToTx; }
+
+	u32 getNextPacket() const { return mNextPacket; }
+	void setNextPacket(u32 nextPacket) { mNextPacket = nextPacket; }
+
+	u32 getPacketOffset() const { return mPacketOffset; }
+	void setPacketOffset(u32 packetOffset) { mPacketOffset = packetOffset; }
+
+	IMPLEMENT_CLONEABLE(J1939Frame,ETPCMFrame);
+
+};
+
+
+} /* namespace J1939 */
+
+#endif /* TRANSPORT_ETP_ETPCMFRAME_H_ */
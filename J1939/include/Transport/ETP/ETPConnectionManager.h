@@ -0,0 +1,284 @@
+/*
+ * ETPConnectionManager.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ *
+ * Extended Transport Protocol (ISO 11783-3): connection mode transfers of more than 1785 bytes, up to 117440505, for
+ * firmware downloads or calibration data. It works as the RTS/CTS protocol of TP with 24 bit packet numbers: the
+ * responder clears windows of up to 255 packets with ETP.CM_CTS and the originator announces the offset of every
+ * window with an ETP.CM_DPO before its ETP.DT packets.
+ *
+ * The messages are streamed in both directions so they are never buffered whole. The originator reads the window
+ * being sent from a read callback, the responder gives the data to the data callback as soon as it is received in
+ * order, at most one window is kept per session.
+ *
+ * Same model as RTSCTSConnectionManager: no thread nor clock, the frames are given to consumeFrame, the frames to
+ * transmit to the send callback and tick expires the J1939-21 timeouts.
+ *
+ * 	ETPConnectionManager manager;
+ * 	manager.addLocalAddress(0x20);
+ * 	manager.setSendCallback([&](u32 id, const u8* data, size_t length) { ... write the frame to the bus ... });
+ * 	manager.setDataCallback([&](u8 src, u8 dst, u32 pgn, u32 offset, const u8* data, size_t length, u32 total) { ... });
+ * 	...
+ * 	manager.consumeFrame(*frame, now);
+ * 	manager.tick(now);
+ *
+ * The send, read and data callbacks must not call back into the manager, the finished callback may.
+ */
+
+#ifndef TRANSPORT_ETP_ETPCONNECTIONMANAGER_H_
+#define TRANSPORT_ETP_ETPCONNECTIONMANAGER_H_
+
+#include <bitset>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "ETPCMFrame.h"
+#include "ETPDTFrame.h"
+#include "../../TimerWheel.h"
+
+#define ETP_MAX_WINDOW				255
+
+//Same J1939-21 timeouts as the Transport Protocol, in milliseconds
+#define ETP_DEFAULT_T1				750
+#define ETP_DEFAULT_T2				1250
+#define ETP_DEFAULT_T3				1250
+#define ETP_DEFAULT_T4				1050
+
+
+namespace J1939 {
+
+struct ETPConfig {
+
+	/*
+	 * Packets requested in every CTS as responder, from 1 to 255
+	 */
+	u8 windowSize = ETP_MAX_WINDOW;
+
+	/*
+	 * Retransmission requests of the responder for a window before aborting the session. The count starts again
+	 * with every window received completely.
+	 */
+	u8 maxRetransmits = 2;
+
+	/*
+	 * Sessions open at the same time in both directions. The RTS received beyond are aborted.
+	 */
+	size_t maxSessions = 16;
+
+	/*
+	 * Biggest message accepted as responder
+	 */
+	u32 maxMsgSize = ETP_MAX_MSG_SIZE;
+
+	u32 t1 = ETP_DEFAULT_T1;		//Responder, time between data packets of a window
+	u32 t2 = ETP_DEFAULT_T2;		//Responder, time from the CTS to the DPO and from the DPO to the first data packet
+	u32 t3 = ETP_DEFAULT_T3;		//Originator, time from the last data packet sent to the CTS or EndOfMsgACK
+	u32 t4 = ETP_DEFAULT_T4;		//Originator, time from a CTS holding the connection to the next CTS
+
+};
+
+struct ETPStats {
+	u64 messagesSent = 0;
+	u64 messagesReceived = 0;
+	u64 bytesSent = 0;
+	u64 bytesReceived = 0;
+	u64 packetsSent = 0;
+	u64 packetsReceived = 0;
+	u64 retransmitRequests = 0;
+	u64 abortsSent = 0;
+	u64 abortsReceived = 0;
+	u64 timeouts = 0;
+};
+
+class ETPConnectionManager {
+
+public:
+
+	enum ETransferResult {
+		TRANSFER_COMPLETED,
+		TRANSFER_ABORTED,			//Aborted by this side, as after a timeout
+		TRANSFER_ABORTED_BY_PEER,
+	};
+
+	typedef std::function<void(u32 id, const u8* data, size_t length)> SendCallback;
+
+	/*
+	 * Fills the buffer with the bytes of the message being sent from the given offset. The same bytes can be read more
+	 * than once if the responder requests a retransmission.
+	 */
+	typedef std::function<void(u32 offset, u8* data, size_t length)> ReadCallback;
+
+	/*
+	 * Receives the bytes of a message in order, every byte once. The last call is made before the finished callback.
+	 */
+	typedef std::function<void(u8 originator, u8 responder, u32 pgn, u32 offset, const u8* data, size_t length,
+			u32 totalSize)> DataCallback;
+
+	/*
+	 * Called when an RTS is received, returns false to reject the transfer. All the transfers are accepted by default.
+	 */
+	typedef std::function<bool(u8 originator, u8 responder, u32 pgn, u32 totalSize)> AcceptCallback;
+
+	/*
+	 * Called when a session finishes in any direction. The abort reason is 0 for completed transfers.
+	 */
+	typedef std::function<void(u8 originator, u8 responder, u32 pgn, ETransferResult result, u8 abortReason)> FinishedCallback;
+
+private:
+
+	enum ESessionState {
+		STATE_WAIT_CTS,				//Originator
+		STATE_HELD,					//Originator, CTS of 0 packets received
+		STATE_WAIT_ACK,				//Originator, all packets sent
+		STATE_WAIT_DPO,				//Responder, CTS sent
+		STATE_RECEIVING,			//Responder, DPO received
+	};
+
+	struct Session {
+		ESessionState state;
+		bool originator;			//Role of this side
+		u8 priority;
+		u32 pgn;
+		u32 totalSize;
+		u32 totalPackets;
+		u32 windowStart;			//Number of the first packet of the current CTS, from 1
+		u8 windowCount;				//Packets requested by the CTS, announced by the DPO once received
+		u8 retransmits;				//Requests for the current window
+		bool windowStarted;			//Some packet of the window received, T1 applies instead of T2
+		TimerWheel::Timer timer;	//Keyed by session key, always scheduled
+		std::bitset<ETP_MAX_WINDOW + 1> received;		//Indexed by sequence number
+		std::vector<u8> window;		//Responder, data of the current window
+		ReadCallback read;			//Originator
+	};
+
+	typedef std::unordered_map<u16, Session> SessionMap;
+
+	ETPConfig mConfig;
+
+	std::bitset<J1939_BROADCAST_ADDRESS + 1> mLocalAddresses;
+
+	//Sessions by originator and responder addresses
+	SessionMap mSessions;
+
+	//Declared after the sessions, it is destroyed before their timers
+	TimerWheel mWheel;
+
+	SendCallback mSendCallback;
+	DataCallback mDataCallback;
+	AcceptCallback mAcceptCallback;
+	FinishedCallback mFinishedCallback;
+
+	ETPStats mStats;
+
+	//Reused to encode the connection management frames and to read the windows to send
+	ETPCMFrame mCMFrame;
+	std::vector<u8> mReadBuffer;
+
+
+	void handleRTS(const ETPCMFrame& conn, u64 now);
+	void handleCTS(const ETPCMFrame& conn, u64 now);
+	void handleDPO(const ETPCMFrame& conn, u64 now);
+	void handleAck(const ETPCMFrame& conn);
+	void handleAbort(const ETPCMFrame& conn);
+	void handleData(const ETPDTFrame& data, u64 now);
+
+	void requestWindow(u16 key, Session& session, u32 firstPacket, u64 now);
+	void endOfWindow(SessionMap::iterator iter, u64 now);
+	void expire(SessionMap::iterator iter, u64 now);
+
+	/*
+	 * Gives the data of the first packets of the window to the data callback
+	 */
+	void deliver(u16 key, const Session& session, u32 packets);
+
+	SessionMap::iterator eraseSession(SessionMap::iterator iter);
+
+	void transmit(const J1939Frame& frame);
+	void sendCM(u8 ctrlType, u16 key, const Session& session, u8 packets = 0, u32 packetNumber = 0);
+	void sendAbort(u8 srcAddr, u8 dstAddr, u32 pgn, u8 priority, u8 reason);
+	void sendWindow(u16 key, Session& session, u32 firstPacket, u8 count);
+
+	/*
+	 * Removes the session, sending an abort to the peer if aborted by this side, and notifies the result
+	 */
+	void finish(SessionMap::iterator iter, ETransferResult result, u8 abortReason);
+
+public:
+
+	ETPConnectionManager(const ETPConfig& config = ETPConfig());
+	virtual ~ETPConnectionManager();
+
+	ETPConnectionManager(const ETPConnectionManager&) = delete;
+	ETPConnectionManager& operator=(const ETPConnectionManager&) = delete;
+
+	const ETPConfig& getConfig() const { return mConfig; }
+
+	/*
+	 * The new configuration applies to the sessions opened afterwards, the timeouts to all of them
+	 */
+	void setConfig(const ETPConfig& config) { mConfig = config; }
+
+	void setSendCallback(SendCallback callback) { mSendCallback = callback; }
+	void setDataCallback(DataCallback callback) { mDataCallback = callback; }
+	void setAcceptCallback(AcceptCallback callback) { mAcceptCallback = callback; }
+	void setFinishedCallback(FinishedCallback callback) { mFinishedCallback = callback; }
+
+	/*
+	 * Addresses for which the manager answers the RTS and from which it can send. The sessions of a removed address
+	 * are dropped without aborts.
+	 */
+	void addLocalAddress(u8 address) { mLocalAddresses.set(address); }
+	void removeLocalAddress(u8 address);
+	bool isLocalAddress(u8 address) const { return mLocalAddresses.test(address); }
+
+	/*
+	 * ETP.CM and ETP.DT frames addressed to a local address
+	 */
+	bool toBeHandled(const J1939Frame& frame) const;
+
+	/*
+	 * Expires the timeouts elapsed at the given time, usually the timestamp of the frame, and handles the frame
+	 */
+	void consumeFrame(const J1939Frame& frame, u64 now);
+
+	/*
+	 * Opens a session to send a message of the given size, from ETP_MIN_MSG_SIZE to ETP_MAX_MSG_SIZE bytes, read from
+	 * the callback while it is sent. Returns false if the size is out of range, if the source is not a local address or
+	 * if there is already a session between both addresses in the same direction.
+	 * The result is given to the finished callback.
+	 */
+	bool send(u32 pgn, u8 priority, u8 srcAddr, u8 dstAddr, u32 length, ReadCallback read, u64 now);
+
+	/*
+	 * Same as above reading from the buffer, which is not copied and must be valid until the session finishes
+	 */
+	bool send(u32 pgn, u8 priority, u8 srcAddr, u8 dstAddr, const u8* data, u32 length, u64 now);
+
+	/*
+	 * Aborts the session from the originator to the responder, if open
+	 */
+	void abort(u8 originator, u8 responder, u8 reason = CONN_ABORT_TERMINATED);
+
+	/*
+	 * Expires the timeouts elapsed at the given time
+	 */
+	void tick(u64 now);
+
+	size_t getSessionCount() const { return mSessions.size(); }
+
+	/*
+	 * Drops all the sessions, without sending aborts. Can be called from the finished callback.
+	 */
+	void clear();
+
+	const ETPStats& getStats() const { return mStats; }
+	void resetStats() { mStats = ETPStats(); }
+
+};
+
+} /* namespace J1939 */
+
+#endif /* TRANSPORT_ETP_ETPCONNECTIONMANAGER_H_ */
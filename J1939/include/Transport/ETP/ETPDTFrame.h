@@ -0,0 +1,31 @@
+/*
+ * ETPDTFrame.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: famez
+ */
+
+#ifndef TRANSPORT_ETP_ETPDTFRAME_H_
+#define TRANSPORT_ETP_ETPDTFRAME_H_
+
+#include "../TPDTFrame.h"
+
+#define ETP_DT_PGN		0x00C700
+
+namespace J1939 {
+
+/*
+ * Same layout as TP.DT. The sequence number is relative to the offset of the last ETP.CM_DPO.
+ */
+class ETPDTFrame : public TPDTFrame {
+
+public:
+	ETPDTFrame();
+	virtual ~ETPDTFrame();
+
+	IMPLEMENT_CLONEABLE(J1939Frame,ETPDTFrame);
+};
+
+} /* namespace J1939 */
+
+#endif /* TRANSPORT_ETP_ETPDTFRAME_H_ */
@@ -8,25 +8,284 @@
  * With this protocol the sender establishes a connection to the receiver.
  * The receiver has the option of controlling and influencing the flow control of the individual data packets.
  * Both the receiver and sender can abort the connection (e.g. in case of errors).
- * The Connection Mode Data Transfer protocol is not subject to any time limitation.
  * All nodes potentially exchange their data with one another at their maximum possible speed.
  *
+ * The manager runs the sessions of the local addresses, as originator and as responder, for any number of peers at the
+ * same time. It does not own any thread nor clock: the received TP.CM and TP.DT frames are given to consumeFrame, the
+ * frames to transmit are given to the send callback and tick must be called periodically to expire the J1939-21
+ * timeouts. The times are milliseconds of any monotonic clock, the timestamps of a capture can be used as well.
+ *
+ * 	RTSCTSConnectionManager manager;
+ * 	manager.addLocalAddress(0x20);
+ * 	manager.setSendCallback([&](u32 id, const u8* data, size_t length) { ... write the frame to the bus ... });
+ * 	...
+ * 	manager.consumeFrame(*frame, now);
+ * 	manager.tick(now);
+ * 	while(manager.reassembledFramesPending()) { std::unique_ptr<J1939Frame> msg = manager.dequeueReassembledFrame(); }
+ *
+ * The send callback must not call back into the manager, the finished callback may.
  */
 
 #ifndef TRANSPORT_RTSCTS_RTSCTSCONNECTIONMANAGER_H_
 #define TRANSPORT_RTSCTS_RTSCTSCONNECTIONMANAGER_H_
 
-#include "../ConnectionManager.h"
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "../TPCMFrame.h"
+#include "../TPDTFrame.h"
+#include "../../TimerWheel.h"
+
+#define RTSCTS_MAX_MSG_SIZE			TP_MAX_MSG_SIZE
+#define RTSCTS_MAX_PACKETS			255
+
+//Value of byte 5 of the RTS when the originator does not limit the packets per CTS
+#define RTSCTS_NO_LIMIT				0xFF
+
+//J1939-21 timeouts, in milliseconds
+#define RTSCTS_DEFAULT_TR			200
+#define RTSCTS_DEFAULT_TH			500
+#define RTSCTS_DEFAULT_T1			750
+#define RTSCTS_DEFAULT_T2			1250
+#define RTSCTS_DEFAULT_T3			1250
+#define RTSCTS_DEFAULT_T4			1050
+
 
 namespace J1939 {
 
-class RTSCTSConnectionManager : public ConnectionManager {
+class J1939Factory;
+
+struct RTSCTSConfig {
+
+	/*
+	 * Packets requested in every CTS as responder, from 1 to 255. Bigger windows need less CTS per message,
+	 * smaller ones retransmit less data when a packet is lost.
+	 */
+	u8 windowSize = RTSCTS_MAX_PACKETS;
+
+	/*
+	 * Packets per CTS accepted as originator, sent in byte 5 of the RTS
+	 */
+	u8 maxPacketsPerCTS = RTSCTS_NO_LIMIT;
+
+	/*
+	 * Retransmission requests of the responder for a window before aborting the session. The count starts again
+	 * with every window received completely.
+	 */
+	u8 maxRetransmits = 2;
+
+	/*
+	 * Sessions open at the same time in both directions. The RTS received beyond are aborted.
+	 */
+	size_t maxSessions = 256;
+
+	/*
+	 * Reassembled frames waiting to be dequeued from which the responder holds the connections with CTS of 0 packets
+	 * instead of requesting more data. 0 for no limit.
+	 */
+	size_t maxPendingFrames = 0;
+
+	u32 tr = RTSCTS_DEFAULT_TR;		//Responder, time to send a CTS once the hold is released
+	u32 th = RTSCTS_DEFAULT_TH;		//Responder, interval of the CTS holding the connection
+	u32 t1 = RTSCTS_DEFAULT_T1;		//Responder, time between data packets of a window
+	u32 t2 = RTSCTS_DEFAULT_T2;		//Responder, time from the CTS to the first data packet
+	u32 t3 = RTSCTS_DEFAULT_T3;		//Originator, time from the last data packet sent to the CTS or EndOfMsgACK
+	u32 t4 = RTSCTS_DEFAULT_T4;		//Originator, time from a CTS holding the connection to the next CTS
+
+};
+
+struct RTSCTSStats {
+	u64 messagesSent = 0;
+	u64 messagesReceived = 0;
+	u64 packetsSent = 0;
+	u64 packetsReceived = 0;
+	u64 retransmitRequests = 0;
+	u64 abortsSent = 0;
+	u64 abortsReceived = 0;
+	u64 timeouts = 0;
+	u64 decodeErrors = 0;
+};
+
+class RTSCTSConnectionManager {
+
 public:
-	RTSCTSConnectionManager();
+
+	enum ETransferResult {
+		TRANSFER_COMPLETED,
+		TRANSFER_ABORTED,			//Aborted by this side, as after a timeout
+		TRANSFER_ABORTED_BY_PEER,
+	};
+
+	typedef std::function<void(u32 id, const u8* data, size_t length)> SendCallback;
+
+	/*
+	 * Called when a session finishes in any direction. The abort reason is 0 for completed transfers.
+	 */
+	typedef std::function<void(u8 originator, u8 responder, u32 pgn, ETransferResult result, u8 abortReason)> FinishedCallback;
+
+private:
+
+	enum ESessionState {
+		STATE_WAIT_CTS,				//Originator
+		STATE_HELD,					//Originator, CTS of 0 packets received
+		STATE_WAIT_ACK,				//Originator, all packets sent
+		STATE_RECEIVING,			//Responder, CTS sent
+		STATE_HOLDING,				//Responder, CTS of 0 packets sent
+	};
+
+	struct Session {
+		ESessionState state;
+		bool originator;			//Role of this side
+		u8 priority;
+		u32 pgn;
+		u16 totalSize;
+		u8 totalPackets;
+		u8 maxPacketsPerCTS;		//Limit announced by the originator in the RTS
+		u8 windowStart;				//First and last packets of the current CTS
+		u8 windowEnd;
+		u8 retransmits;				//Requests for the current window
+		bool windowStarted;			//Some packet of the window received, T1 applies instead of T2
+		u64 lastHold;
+		TimerWheel::Timer timer;	//Keyed by session key, always scheduled
+		std::bitset<RTSCTS_MAX_PACKETS + 1> received;		//Indexed by sequence number
+		std::vector<u8> data;
+	};
+
+	typedef std::unordered_map<u16, Session> SessionMap;
+
+	RTSCTSConfig mConfig;
+
+	//Factory where the reassembled frames are decoded
+	J1939Factory* mFactory;
+
+	std::bitset<J1939_BROADCAST_ADDRESS + 1> mLocalAddresses;
+
+	//Sessions by originator and responder addresses
+	SessionMap mSessions;
+
+	//Declared after the sessions, it is destroyed before their timers
+	TimerWheel mWheel;
+
+	SendCallback mSendCallback;
+	FinishedCallback mFinishedCallback;
+
+	std::queue<J1939Frame*> mReassembledFrames;
+
+	RTSCTSStats mStats;
+
+	//Reused to encode the connection management frames and the frames to send
+	TPCMFrame mCMFrame;
+	std::vector<u8> mEncodeBuffer;
+
+
+	void handleRTS(const TPCMFrame& conn, u64 now);
+	void handleCTS(const TPCMFrame& conn, u64 now);
+	void handleAck(const TPCMFrame& conn);
+	void handleAbort(const TPCMFrame& conn);
+	void handleData(const TPDTFrame& data, u64 now);
+
+	void requestWindow(u16 key, Session& session, u8 firstPacket, u64 now);
+	void endOfWindow(SessionMap::iterator iter, u64 now);
+	void complete(SessionMap::iterator iter);
+	void expire(SessionMap::iterator iter, u64 now);
+
+	SessionMap::iterator eraseSession(SessionMap::iterator iter);
+
+	void transmit(const J1939Frame& frame);
+	void sendCM(u8 ctrlType, u16 key, const Session& session, u8 packets = 0, u8 nextPacket = 0);
+	void sendAbort(u8 srcAddr, u8 dstAddr, u32 pgn, u8 priority, u8 reason);
+	void sendPackets(u16 key, const Session& session, u8 firstPacket, u8 count);
+
+	/*
+	 * Removes the session, sending an abort to the peer if aborted by this side, and notifies the result
+	 */
+	void finish(SessionMap::iterator iter, ETransferResult result, u8 abortReason);
+
+	size_t getPendingFrames() const { return mReassembledFrames.size(); }
+
+public:
+
+	/*
+	 * The reassembled frames are decoded with the given factory, the default instance if null
+	 */
+	RTSCTSConnectionManager(const RTSCTSConfig& config = RTSCTSConfig(), J1939Factory* factory = nullptr);
 	virtual ~RTSCTSConnectionManager();
 
+	RTSCTSConnectionManager(const RTSCTSConnectionManager&) = delete;
+	RTSCTSConnectionManager& operator=(const RTSCTSConnectionManager&) = delete;
+
+	const RTSCTSConfig& getConfig() const { return mConfig; }
+
+	/*
+	 * The new configuration applies to the sessions opened afterwards, the timeouts to all of them
+	 */
+	void setConfig(const RTSCTSConfig& config) { mConfig = config; }
+
+	void setSendCallback(SendCallback callback) { mSendCallback = callback; }
+	void setFinishedCallback(FinishedCallback callback) { mFinishedCallback = callback; }
+
+	/*
+	 * Addresses for which the manager answers the RTS and from which it can send. The sessions of a removed address
+	 * are dropped without aborts.
+	 */
+	void addLocalAddress(u8 address) { mLocalAddresses.set(address); }
+	void removeLocalAddress(u8 address);
+	bool isLocalAddress(u8 address) const { return mLocalAddresses.test(address); }
+
+	/*
+	 * TP.CM frames other than BAM and TP.DT frames addressed to a local address
+	 */
+	bool toBeHandled(const J1939Frame& frame) const;
+
+	/*
+	 * Expires the timeouts elapsed at the given time, usually the timestamp of the frame, and handles the frame
+	 */
+	void consumeFrame(const J1939Frame& frame, u64 now);
+
+	/*
+	 * Opens a session to send the frame, from its source address to its destination address.
+	 * Returns false if the frame does not need the transport protocol or cannot be sent with it, if the source is
+	 * not a local address or if there is already a session between both addresses in the same direction.
+	 * The result is given to the finished callback.
+	 */
+	bool send(const J1939Frame& frame, u64 now);
+	bool send(u32 pgn, u8 priority, u8 srcAddr, u8 dstAddr, const u8* data, size_t length, u64 now);
+
+	/*
+	 * Aborts the session from the originator to the responder, if open
+	 */
+	void abort(u8 originator, u8 responder, u8 reason = CONN_ABORT_TERMINATED);
+
+	/*
+	 * Expires the timeouts elapsed at the given time and sends the CTS delayed by holds. The sessions are kept in
+	 * a timer wheel, only the sessions whose timeouts elapsed are visited.
+	 */
+	void tick(u64 now);
+
+	/*
+	 * Returns false if there are no sessions open, otherwise the earliest time at which tick has something to do.
+	 * All the sessions are visited.
+	 */
+	bool getNextDeadline(u64& deadline) const;
+
+	size_t getSessionCount() const { return mSessions.size(); }
+
+	bool reassembledFramesPending() const { return !mReassembledFrames.empty(); }
+
+	std::unique_ptr<J1939Frame> dequeueReassembledFrame();
+
+	/*
+	 * Drops all the sessions, without sending aborts, and the reassembled frames. Can be called from the finished callback.
+	 */
+	void clear();
+
+	const RTSCTSStats& getStats() const { return mStats; }
+	void resetStats() { mStats = RTSCTSStats(); }
 
-	void consumeFrame(const J1939Frame&);
 };
 
 } /* namespace J1939 */
@@ -125,6 +125,16 @@ transfer, including a timeout, it shall send a Connection Abort message with the
  */
 #define CONN_ABORT_RTX_LIMIT		5
 
+/*
+ * Total message size is greater than 1785 bytes
+ */
+#define CONN_ABORT_MSG_TOO_LONG		9
+
+/*
+ * Any other reason, as an announced number of packets not matching the message size
+ */
+#define CONN_ABORT_OTHER			250
+
 
 namespace J1939 {
 
@@ -200,7 +210,9 @@ public:
 
 	//Implements J1939Frame methods
 	void decodeData(const u8* buffer, size_t length);
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
 	void encodeData(u8* buffer, size_t length) const;
+	ECodecStatus tryEncodeData(u8* buffer, size_t length) const override;
 
 	size_t getDataLength() const { return TP_CM_SIZE; }
 	
@@ -22,6 +22,12 @@ private:
 	u8 mSQ;
 	u8 mData[TP_DT_PACKET_SIZE];
 
+protected:
+	/*
+	 * Same layout with other PGN, as ETP.DT
+	 */
+	TPDTFrame(u32 pgn, const std::string& name);
+
 public:
 	TPDTFrame();
 	TPDTFrame(u8 sq, u8* data, size_t length);
@@ -30,6 +36,7 @@ public:
 
 	//Implements J1939Frame methods
 	void decodeData(const u8* buffer, size_t length);
+	ECodecStatus tryDecodeData(const u8* buffer, size_t length) override;
 	void encodeData(u8* buffer, size_t length) const;
 
 	size_t getDataLength() const { return BAM_DT_SIZE; }
@@ -0,0 +1,49 @@
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+#include <AllocationCounter.h>
+
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+
+	++allocations;
+
+	void* ptr = malloc(size ? size : 1);
+
+	if(!ptr) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	free(ptr);
+}
+
+namespace AllocationCounter {
+
+size_t getAllocations() {
+	return allocations;
+}
+
+}
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include <TestFrame.h>
+#include <AllocationCounter.h>
 
 #include <Transport/BAM/BamReassembler.h>
 #include <Transport/BAM/BamFragmenter.h>
@@ -130,6 +131,65 @@ TEST(BAM_test, BamFragmenter) {
 
 }
 
+TEST(BAM_test, BamFragmenter_packets) {
+
+	TestFrame frame(0xF005);
+	std::basic_string<u8> payload;
+
+	for(size_t i = 0; i < TP_MAX_MSG_SIZE; ++i) {
+		payload.push_back(i * 7);
+	}
+
+	frame.decode(0x18F00550, payload.data(), payload.size());
+
+	std::vector<u32> ids;
+	std::vector<std::basic_string<u8> > packets;
+
+	ASSERT_TRUE(BamFragmenter::fragment(frame, [&](u32 id, const u8* data, size_t length) {
+		ids.push_back(id);
+		packets.push_back(std::basic_string<u8>(data, length));
+	}));
+
+	//Same packets as the frames of the fragmenter
+	BamFragmenter fragmenter;
+	fragmenter.fragment(frame);
+
+	std::vector<const J1939Frame*> frames;
+
+	frames.push_back(&fragmenter.getConnFrame());
+
+	for(auto iter = fragmenter.getDataFrames().begin(); iter != fragmenter.getDataFrames().end(); ++iter) {
+		frames.push_back(&(*iter));
+	}
+
+	ASSERT_EQ(ids.size(), frames.size());
+	ASSERT_EQ(ids.size(), 256);
+
+	for(size_t i = 0; i < frames.size(); ++i) {
+
+		u8 buff[J1939_MAX_SIZE];
+		size_t length = sizeof(buff);
+		u32 id;
+
+		frames[i]->encode(id, buff, length);
+
+		ASSERT_EQ(ids[i], id);
+		ASSERT_EQ(packets[i], std::basic_string<u8>(buff, length));
+	}
+
+	ASSERT_EQ(ids[0], 0x18ECFF50);
+	ASSERT_EQ(ids[1], 0x18EBFF50);
+
+	//Nothing to fragment
+	TestFrame single(0xF005);
+	u8 raw[] = {0x01, 0x02};
+
+	single.decode(0x18F00550, raw, sizeof(raw));
+
+	ASSERT_FALSE(BamFragmenter::fragment(single, [](u32, const u8*, size_t) { FAIL(); }));
+
+}
+
 TEST(BAM_test, BamReassembler_ok) {
 
 
@@ -691,3 +751,301 @@ TEST(BAM_test, BamReassembler_ko5) {
 	J1939Factory::getInstance().unRegisterFrame(0xF005);
 
 }
+
+TEST(BAM_test, BamReassembler_slots) {
+
+	J1939Factory factory;
+	BamReassembler slotsReassembler(&factory, 2);
+
+	ASSERT_TRUE(factory.registerFrame(TestFrame(0xF005)));
+
+	//Longest message, interleaved from three sources
+	TestFrame message(0xF005);
+	std::basic_string<u8> payload;
+
+	for(size_t i = 0; i < TP_MAX_MSG_SIZE; ++i) {
+		payload.push_back(i * 13);
+	}
+
+	message.decode(0x00F00500, payload.data(), payload.size());
+
+	std::vector<TPCMFrame> connFrames;
+	std::vector<std::vector<TPDTFrame> > dataFrames;
+
+	for(u8 src = 0x50; src < 0x53; ++src) {
+
+		BamFragmenter fragmenter;
+
+		message.setSrcAddr(src);
+		fragmenter.fragment(message);
+
+		connFrames.push_back(fragmenter.getConnFrame());
+		dataFrames.push_back(fragmenter.getDataFrames());
+	}
+
+	ASSERT_EQ(slotsReassembler.getSlotCount(), 2);
+
+	for(size_t i = 0; i < connFrames.size(); ++i) {
+		slotsReassembler.handleFrame(connFrames[i]);
+	}
+
+	//No slot left for the third source, the session of the first one is dropped
+	ASSERT_EQ(slotsReassembler.getLastError(), BamReassembler::BAM_ERROR_NO_SLOT);
+	ASSERT_EQ(slotsReassembler.getActiveSessions(), 2);
+	ASSERT_EQ(slotsReassembler.getEvictedSessions(), 1);
+
+	size_t allocations = AllocationCounter::getAllocations();
+
+	//The packets are written into the slots, the heap is only used to decode the complete messages
+	for(size_t sq = 0; sq + 1 < dataFrames[0].size(); ++sq) {
+		for(size_t i = 0; i < dataFrames.size(); ++i) {
+			slotsReassembler.handleFrame(dataFrames[i][sq]);
+		}
+	}
+
+	ASSERT_EQ(AllocationCounter::getAllocations(), allocations);
+
+	slotsReassembler.handleFrame(dataFrames[0].back());
+
+	ASSERT_EQ(slotsReassembler.getLastError(), BamReassembler::BAM_ERROR_UNEXPECTED_FRAME);
+
+	slotsReassembler.handleFrame(dataFrames[1].back());
+	slotsReassembler.handleFrame(dataFrames[2].back());
+
+	ASSERT_EQ(slotsReassembler.getActiveSessions(), 0);
+
+	for(u8 src = 0x51; src < 0x53; ++src) {
+
+		ASSERT_TRUE(slotsReassembler.reassembledFramesPending());
+
+		std::unique_ptr<J1939Frame> frame = slotsReassembler.dequeueReassembledFrame();
+
+		ASSERT_EQ(frame->getSrcAddr(), src);
+		ASSERT_EQ(static_cast<TestFrame*>(frame.get())->getRaw(), payload);
+	}
+
+	ASSERT_FALSE(slotsReassembler.reassembledFramesPending());
+
+	//Messages that do not fit in a slot
+	TPCMFrame tooLong = connFrames[2];
+
+	tooLong.setTotalMsgSize(TP_MAX_MSG_SIZE + 1);
+	slotsReassembler.handleFrame(tooLong);
+
+	ASSERT_EQ(slotsReassembler.getLastError(), BamReassembler::BAM_ERROR_UNEXPECTED_FRAME);
+	ASSERT_EQ(slotsReassembler.getActiveSessions(), 0);
+
+	//The slots are free again
+	slotsReassembler.handleFrame(connFrames[2]);
+
+	ASSERT_EQ(slotsReassembler.getLastError(), BamReassembler::BAM_ERROR_OK);
+
+	for(auto frame = dataFrames[2].begin(); frame != dataFrames[2].end(); ++frame) {
+		slotsReassembler.handleFrame(*frame);
+	}
+
+	ASSERT_TRUE(slotsReassembler.reassembledFramesPending());
+	ASSERT_EQ(slotsReassembler.dequeueReassembledFrame()->getSrcAddr(), 0x52);
+
+}
+
+TEST(BAM_test, BamReassembler_timeout) {
+
+	J1939Factory factory;
+	BamReassembler timeoutReassembler(&factory);
+
+	ASSERT_TRUE(factory.registerFrame(TestFrame(0xF005)));
+
+	TestFrame message(0xF005);
+	std::basic_string<u8> payload(30, 0x11);
+
+	message.decode(0x00F00500, payload.data(), payload.size());
+
+	std::vector<TPCMFrame> connFrames;
+	std::vector<std::vector<TPDTFrame> > dataFrames;
+
+	for(u8 src = 0x50; src < 0x52; ++src) {
+
+		BamFragmenter fragmenter;
+
+		message.setSrcAddr(src);
+		fragmenter.fragment(message);
+
+		connFrames.push_back(fragmenter.getConnFrame());
+		dataFrames.push_back(fragmenter.getDataFrames());
+	}
+
+	ASSERT_EQ(timeoutReassembler.getTimeout(), BAM_TIMEOUT_T1);
+
+	timeoutReassembler.handleFrame(connFrames[0], 1000);
+	timeoutReassembler.handleFrame(connFrames[1], 1000);
+	timeoutReassembler.handleFrame(dataFrames[0][0], 1500);
+
+	//Only the second source has been silent for longer than T1
+	timeoutReassembler.tick(1000 + BAM_TIMEOUT_T1 - 1);
+	ASSERT_EQ(timeoutReassembler.getActiveSessions(), 2);
+
+	timeoutReassembler.tick(1000 + BAM_TIMEOUT_T1);
+	ASSERT_EQ(timeoutReassembler.getActiveSessions(), 1);
+	ASSERT_EQ(timeoutReassembler.getExpiredSessions(), 1);
+
+	//The packets of the expired session are discarded
+	timeoutReassembler.handleFrame(dataFrames[1][1], 1800);
+	ASSERT_EQ(timeoutReassembler.getLastError(), BamReassembler::BAM_ERROR_UNEXPECTED_FRAME);
+
+	for(size_t i = 1; i < dataFrames[0].size(); ++i) {
+		timeoutReassembler.handleFrame(dataFrames[0][i], 1500 + i * 100);
+	}
+
+	ASSERT_TRUE(timeoutReassembler.reassembledFramesPending());
+	ASSERT_EQ(timeoutReassembler.dequeueReassembledFrame()->getSrcAddr(), 0x50);
+	ASSERT_EQ(timeoutReassembler.getActiveSessions(), 0);
+
+	//Timestamps far apart
+	timeoutReassembler.handleFrame(connFrames[1], 2000);
+	timeoutReassembler.handleFrame(dataFrames[1][0], 1000000);
+
+	ASSERT_EQ(timeoutReassembler.getExpiredSessions(), 2);
+	ASSERT_EQ(timeoutReassembler.getActiveSessions(), 0);
+
+	timeoutReassembler.clear();
+	ASSERT_EQ(timeoutReassembler.getExpiredSessions(), 0);
+
+}
+
+TEST(BAM_test, BamReassembler_eviction) {
+
+	J1939Factory factory;
+	BamReassembler evictionReassembler(&factory);
+
+	ASSERT_TRUE(factory.registerFrame(TestFrame(0xF005)));
+
+	TestFrame message(0xF005);
+	std::basic_string<u8> payload(30, 0x22);
+
+	message.decode(0x00F00500, payload.data(), payload.size());
+
+	std::vector<TPCMFrame> connFrames;
+	std::vector<std::vector<TPDTFrame> > dataFrames;
+
+	for(size_t src = 0; src <= BAM_DEFAULT_SLOTS; ++src) {
+
+		BamFragmenter fragmenter;
+
+		message.setSrcAddr(src);
+		fragmenter.fragment(message);
+
+		connFrames.push_back(fragmenter.getConnFrame());
+		dataFrames.push_back(fragmenter.getDataFrames());
+	}
+
+	//All the slots are taken by sources that go silent, the first one receives a packet later than the others
+	for(size_t src = 0; src < BAM_DEFAULT_SLOTS; ++src) {
+		evictionReassembler.handleFrame(connFrames[src], 1000 + src);
+	}
+
+	evictionReassembler.handleFrame(dataFrames[0][0], 1100);
+
+	ASSERT_EQ(evictionReassembler.getActiveSessions(), BAM_DEFAULT_SLOTS);
+
+	//Another source is still reassembled, replacing the session that has been silent for the longest time
+	evictionReassembler.handleFrame(connFrames[BAM_DEFAULT_SLOTS], 1200);
+
+	ASSERT_EQ(evictionReassembler.getLastError(), BamReassembler::BAM_ERROR_NO_SLOT);
+
+	for(auto frame = dataFrames[BAM_DEFAULT_SLOTS].begin(); frame != dataFrames[BAM_DEFAULT_SLOTS].end(); ++frame) {
+		evictionReassembler.handleFrame(*frame, 1200);
+	}
+
+	ASSERT_TRUE(evictionReassembler.reassembledFramesPending());
+	ASSERT_EQ(evictionReassembler.dequeueReassembledFrame()->getSrcAddr(), BAM_DEFAULT_SLOTS);
+	ASSERT_EQ(evictionReassembler.getEvictedSessions(), 1);
+	ASSERT_EQ(evictionReassembler.getExpiredSessions(), 0);
+
+	//The first source keeps its session, the second one lost it
+	evictionReassembler.handleFrame(dataFrames[0][1], 1200);
+	ASSERT_EQ(evictionReassembler.getLastError(), BamReassembler::BAM_ERROR_OK);
+
+	evictionReassembler.handleFrame(dataFrames[1][0], 1200);
+	ASSERT_EQ(evictionReassembler.getLastError(), BamReassembler::BAM_ERROR_UNEXPECTED_FRAME);
+
+	evictionReassembler.clear();
+	ASSERT_EQ(evictionReassembler.getEvictedSessions(), 0);
+
+}
+
+TEST(BAM_test, BamReassembler_raw) {
+
+	J1939Factory factory;
+	BamReassembler rawReassembler(&factory);
+
+	ASSERT_TRUE(factory.registerFrame(TestFrame(0xF005)));
+
+	TestFrame message(0xF005);
+	std::basic_string<u8> payload;
+
+	for(size_t i = 0; i < 100; ++i) {
+		payload.push_back(i * 11);
+	}
+
+	message.decode(0x18F00550, payload.data(), payload.size());
+
+	std::vector<u32> ids;
+	std::vector<std::basic_string<u8> > packets;
+
+	ASSERT_TRUE(BamFragmenter::fragment(message, [&](u32 id, const u8* data, size_t length) {
+		ids.push_back(id);
+		packets.push_back(std::basic_string<u8>(data, length));
+	}));
+
+	ASSERT_TRUE(BamReassembler::isTransportId(ids[0]));
+	ASSERT_TRUE(BamReassembler::isTransportId(ids[1]));
+	ASSERT_FALSE(BamReassembler::isTransportId(0x18F00550));
+	ASSERT_FALSE(BamReassembler::isTransportId(0x18EC2050));			//TP.CM to a destination
+
+	//Connection management other than BAM
+	u8 rts[] = {CTRL_TPCM_RTS, 100, 0, 15, 0xFF, 0x05, 0xF0, 0x00};
+
+	ASSERT_FALSE(rawReassembler.toBeHandled(ids[0], rts, sizeof(rts)));
+	ASSERT_FALSE(rawReassembler.toBeHandled(ids[1], packets[1].data(), 7));
+
+	rawReassembler.handleFrame(ids[0], rts, sizeof(rts));
+
+	ASSERT_EQ(rawReassembler.getLastError(), BamReassembler::BAM_ERROR_UNEXPECTED_FRAME);
+
+	rawReassembler.handleFrame(0x18EC2050, packets[0].data(), packets[0].size());
+
+	ASSERT_EQ(rawReassembler.getLastError(), BamReassembler::BAM_ERROR_NOT_BCAST_ADDR);
+
+	ASSERT_TRUE(rawReassembler.toBeHandled(ids[0], packets[0].data(), packets[0].size()));
+	ASSERT_EQ(rawReassembler.handleFrame(ids[0], packets[0].data(), packets[0].size()), payload.size());
+	ASSERT_EQ(rawReassembler.getLastError(), BamReassembler::BAM_ERROR_OK);
+
+	size_t allocations = AllocationCounter::getAllocations();
+
+	//The packets are neither decoded nor allocated
+	for(size_t i = 1; i + 1 < ids.size(); ++i) {
+		ASSERT_TRUE(rawReassembler.toBeHandled(ids[i], packets[i].data(), packets[i].size()));
+		rawReassembler.handleFrame(ids[i], packets[i].data(), packets[i].size());
+	}
+
+	ASSERT_EQ(AllocationCounter::getAllocations(), allocations);
+	ASSERT_FALSE(rawReassembler.reassembledFramesPending());
+
+	rawReassembler.handleFrame(ids.back(), packets.back().data(), packets.back().size());
+
+	ASSERT_TRUE(rawReassembler.reassembledFramesPending());
+
+	std::unique_ptr<J1939Frame> frame = rawReassembler.dequeueReassembledFrame();
+
+	ASSERT_EQ(frame->getSrcAddr(), 0x50);
+	ASSERT_EQ(frame->getPriority(), 6);
+	ASSERT_EQ(static_cast<TestFrame*>(frame.get())->getRaw(), payload);
+
+	//Packets out of sequence from the raw path too
+	rawReassembler.handleFrame(ids[0], packets[0].data(), packets[0].size());
+	rawReassembler.handleFrame(ids[2], packets[2].data(), packets[2].size());
+
+	ASSERT_EQ(rawReassembler.getLastError(), BamReassembler::BAM_ERROR_UNEXPECTED_FRAME);
+
+}
@@ -0,0 +1,134 @@
+#include <time.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <TestFrame.h>
+
+#include <CommonCanSender.h>
+#include <Transport/BAM/BamSender.h>
+
+
+using namespace J1939;
+
+namespace {
+
+/*
+ * Records the frames instead of sending them to a backend
+ */
+class RecordingSender : public Can::CommonCanSender {
+public:
+	struct Record {
+		u32 id;
+		u8 sq;
+		timespec timestamp;
+	};
+
+private:
+	mutable std::mutex mLock;
+	mutable std::vector<Record> mRecords;
+
+protected:
+	void _sendFrame(const Can::CanFrame& frame) const override {
+
+		Record record;
+
+		record.id = frame.getId();
+		record.sq = frame.getData()[0];
+		clock_gettime(CLOCK_MONOTONIC, &record.timestamp);
+
+		std::lock_guard<std::mutex> lock(mLock);
+		mRecords.push_back(record);
+	}
+
+public:
+	~RecordingSender() { finalize(); }
+
+	std::vector<Record> getRecords() const {
+		std::lock_guard<std::mutex> lock(mLock);
+		return mRecords;
+	}
+
+};
+
+double elapsedMillis(const timespec& start, const timespec& end) {
+	return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+}
+
+TEST(BamSender_test, pacing) {
+
+	RecordingSender sender;
+
+	u8 raw[20];
+
+	for(size_t i = 0; i < sizeof(raw); ++i) {
+		raw[i] = i;
+	}
+
+	TestFrame first(0xF005), second(0xF005), other(0xF005);
+
+	first.decode(0x18F00550, raw, sizeof(raw));
+	second.decode(0x18F00550, raw, sizeof(raw));
+	other.decode(0x18F00560, raw, sizeof(raw));
+
+	//A CM and 3 DT each
+	ASSERT_TRUE(sendBam(sender, first));
+	ASSERT_TRUE(sendBam(sender, second, 10));
+	ASSERT_TRUE(sendBam(sender, other, 60));
+
+	ASSERT_TRUE(isBamSent(sender, 0x50));
+	ASSERT_TRUE(isBamSent(sender, 0x60));
+
+	//Single packet frames are not transported
+	TestFrame single(0xF005);
+	single.decode(0x18F00550, raw, 8);
+
+	ASSERT_FALSE(sendBam(sender, single));
+
+	for(int i = 0; i < 200 && (isBamSent(sender, 0x50) || isBamSent(sender, 0x60)); ++i) {
+		usleep(10000);
+	}
+
+	ASSERT_FALSE(isBamSent(sender, 0x50));
+	ASSERT_FALSE(isBamSent(sender, 0x60));
+
+	std::vector<RecordingSender::Record> records = sender.getRecords();
+
+	ASSERT_EQ(records.size(), 12);
+
+	std::vector<RecordingSender::Record> bySource[2];
+
+	for(auto record = records.begin(); record != records.end(); ++record) {
+		bySource[(record->id & J1939_SRC_ADDR_MASK) == 0x50 ? 0 : 1].push_back(*record);
+	}
+
+	ASSERT_EQ(bySource[0].size(), 8);
+	ASSERT_EQ(bySource[1].size(), 4);
+
+	//The messages of a source one after the other, never faster than the minimum interval
+	for(size_t i = 0; i < bySource[0].size(); ++i) {
+
+		ASSERT_EQ(bySource[0][i].id, (i % 4 == 0 ? 0x18ECFF50 : 0x18EBFF50));
+
+		if(i % 4 != 0) {
+			ASSERT_EQ(bySource[0][i].sq, i % 4);
+		}
+
+		if(i > 0) {
+			ASSERT_GE(elapsedMillis(bySource[0][i - 1].timestamp, bySource[0][i].timestamp), BAM_MIN_INTERVAL);
+		}
+	}
+
+	for(size_t i = 1; i < bySource[1].size(); ++i) {
+		ASSERT_GE(elapsedMillis(bySource[1][i - 1].timestamp, bySource[1][i].timestamp), 60);
+	}
+
+	//Both sources at the same time, the other source starts before the end of the first message
+	ASSERT_GT(elapsedMillis(bySource[1][0].timestamp, bySource[0][3].timestamp), 0);
+
+}
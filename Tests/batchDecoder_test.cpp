@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <J1939Factory.h>
+#include <BatchDecoder.h>
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+using namespace J1939;
+
+#define EEC1_PGN		0xF004
+
+class BatchDecoder_test : public testing::Test
+{
+public:
+	std::vector<RawFrame> frames;
+
+virtual void SetUp()
+{
+	GenericFrame eec1(EEC1_PGN);
+
+	eec1.setName("EEC1");
+	eec1.setLength(8);
+
+	eec1.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+	eec1.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	eec1.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	eec1.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+	eec1.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+	J1939Factory::getInstance().registerFrame(eec1);
+
+	u32 seed = 1939;
+
+	for(u32 i = 0; i < 1003; ++i) {
+
+		RawFrame frame;
+
+		frame.id = 0x0CF00400 | (i & 0x3);
+		frame.length = 8;
+		frame.timestamp = i;
+
+		for(int j = 0; j < 8; ++j) {
+			seed = seed * 1103515245 + 12345;
+			frame.data[j] = (seed >> 16) & 0xFF;
+		}
+
+		frames.push_back(frame);
+	}
+
+	//Frames which can not be decoded
+	RawFrame unknown = frames[0];
+	unknown.id = 0x18FF0000;
+	frames.push_back(unknown);
+
+	RawFrame tooShort = frames[0];
+	tooShort.length = 5;
+	frames.push_back(tooShort);
+
+}
+
+virtual void TearDown()
+{
+	J1939Factory::getInstance().unRegisterFrame(EEC1_PGN);
+}
+};
+
+TEST_F(BatchDecoder_test, kernels) {
+
+	std::unique_ptr<J1939Frame> frame = J1939Factory::getInstance().getJ1939Frame(EEC1_PGN);
+	GenericFrame* eec1 = static_cast<GenericFrame*>(frame.get());
+
+	EBatchKernel kernels[] = {BATCH_KERNEL_SCALAR, BATCH_KERNEL_SSE2, BATCH_KERNEL_AVX2};
+
+	for(size_t k = 0; k < sizeof(kernels)/sizeof(kernels[0]); ++k) {
+
+		BatchDecoder decoder;
+
+		if(!decoder.setKernel(kernels[k])) {
+			continue;
+		}
+
+		//In two batches to check that the values are appended
+		ASSERT_EQ(decoder.decode(frames.data(), 500), 500);
+		ASSERT_EQ(decoder.decode(frames.data() + 500, frames.size() - 500), 503);
+
+		ASSERT_EQ(decoder.getDecodedFrames(), 1003);
+		ASSERT_EQ(decoder.getSkippedFrames(), 2);
+
+		ASSERT_FALSE(decoder.getColumns(0xFF00));
+
+		const PGNColumns* columns = decoder.getColumns(EEC1_PGN);
+
+		ASSERT_TRUE(columns);
+		ASSERT_EQ(columns->getRows(), 1003);
+		ASSERT_FALSE(columns->getSPNColumn(84));
+		ASSERT_EQ(columns->getSPNColumn(512), &(columns->getColumn(1)));
+
+		double values[5];
+
+		for(size_t row = 0; row < columns->getRows(); ++row) {
+
+			ASSERT_TRUE(eec1->decodeValues(frames[row].data, frames[row].length, values));
+
+			ASSERT_EQ(columns->getTimestamps()[row], frames[row].timestamp);
+			ASSERT_EQ(columns->getSrcAddrs()[row], frames[row].id & 0xFF);
+
+			for(size_t index = 0; index < 5; ++index) {
+				ASSERT_EQ(columns->getColumn(index)[row], values[index]);
+			}
+		}
+
+		decoder.clear();
+
+		ASSERT_EQ(decoder.getColumns(EEC1_PGN)->getRows(), 0);
+	}
+
+}
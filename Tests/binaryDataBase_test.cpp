@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+
+#include <fstream>
+
+#include <GenericFrame.h>
+#include <J1939DataBase.h>
+#include <J1939Factory.h>
+#include <BinaryDataBase.h>
+#include <FrameLayout.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+#include <SPN/SPNString.h>
+
+#define BINARY_DATABASE_FILE	"/tmp/J1939BinaryDataBase_test.j1939db"
+
+using namespace J1939;
+
+
+class BinaryDataBase_test : public testing::Test
+{
+protected:
+
+	void SetUp() override {
+		ASSERT_TRUE(mJson.parseJsonFile("Database/frames.json"));
+		ASSERT_TRUE(mJson.writeBinaryFile(BINARY_DATABASE_FILE));
+	}
+
+	void TearDown() override {
+		remove(BINARY_DATABASE_FILE);
+	}
+
+	J1939DataBase mJson;
+};
+
+
+TEST_F(BinaryDataBase_test, lookups) {
+
+	BinaryDataBase binary;
+
+	ASSERT_TRUE(BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_FILE));
+	ASSERT_FALSE(BinaryDataBase::isBinaryDataBase("Database/frames.json"));
+
+	ASSERT_TRUE(binary.open(BINARY_DATABASE_FILE));
+
+	const std::vector<GenericFrame>& frames = mJson.getParsedFrames();
+
+	ASSERT_EQ(frames.size(), binary.getFrameCount());
+
+	//Every PGN must be found with the first definition in the json database
+	std::set<u32> found;
+
+	for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+
+		if(!found.insert(frame->getPGN()).second) {
+			continue;
+		}
+
+		const BinaryFrameRecord* record = binary.findFrame(frame->getPGN());
+
+		ASSERT_TRUE(record != nullptr);
+		ASSERT_EQ(frame->getPGN(), record->pgn);
+		ASSERT_EQ(frame->getName(), binary.getString(record->name));
+
+		std::set<u32> numbers = frame->getSPNNumbers();
+
+		ASSERT_EQ(numbers.size(), record->spnCount);
+
+		for(auto number = numbers.begin(); number != numbers.end(); ++number) {
+
+			const SPN* spn = frame->getSPN(*number);
+			const BinarySPNRecord* spnRecord = binary.findSPN(*record, *number);
+
+			ASSERT_TRUE(spnRecord != nullptr);
+			ASSERT_EQ(spn->getName(), binary.getString(spnRecord->name));
+			ASSERT_EQ(spn->getType(), spnRecord->type);
+
+			if(spn->getType() == SPN::SPN_NUMERIC) {
+				const SPNNumeric* spnNum = static_cast<const SPNNumeric*>(spn);
+
+				ASSERT_EQ(spnNum->getOffset(), spnRecord->offset);
+				ASSERT_EQ(spnNum->getByteSize(), spnRecord->byteSize);
+				ASSERT_EQ(spnNum->getFormatGain(), spnRecord->formatGain);
+				ASSERT_EQ(spnNum->getFormatOffset(), spnRecord->formatOffset);
+				ASSERT_EQ(spnNum->getUnits(), binary.getString(spnRecord->units));
+			}
+		}
+
+		ASSERT_TRUE(binary.findSPN(*record, 0xFFFFFFFF) == nullptr);
+	}
+
+	ASSERT_TRUE(binary.findFrame(0x3FFFF) == nullptr);
+
+	//Frames built from the binary database must be equivalent to the ones parsed from json
+	J1939DataBase fromBinary;
+
+	ASSERT_TRUE(fromBinary.parseBinaryFile(BINARY_DATABASE_FILE));
+
+	const BinaryFrameRecord* ccvsRecord = binary.findFrame(0xFEF1);
+
+	ASSERT_TRUE(ccvsRecord != nullptr);
+
+	GenericFrame ccvs(0xFEF1);
+	binary.toGenericFrame(*ccvsRecord, ccvs);
+
+	ASSERT_EQ(ccvs.getDataLength(), 8);
+
+	const SPNStatus* brakeSwitch = static_cast<const SPNStatus*>(ccvs.getSPN(597));
+
+	ASSERT_TRUE(brakeSwitch != nullptr);
+	ASSERT_EQ(4, brakeSwitch->getBitOffset());
+	ASSERT_EQ(2, brakeSwitch->getBitSize());
+	ASSERT_EQ("Pedal depressed", brakeSwitch->getValueDescription(1));
+
+	u8 payload[] = {0xC1, 0x00, 0x32, 0xD4, 0x55, 0x01, 0x02, 0x03};
+
+	for(auto frame = fromBinary.getParsedFrames().begin(); frame != fromBinary.getParsedFrames().end(); ++frame) {
+		if(frame->getPGN() == 0xFEF1) {
+			GenericFrame decoded(*frame);
+			decoded.decode(0xFEF1 << J1939_PGN_OFFSET, payload, sizeof(payload));
+			ASSERT_EQ(0x32, static_cast<const SPNNumeric*>(decoded.getSPN(84))->getValue() >> 8);
+		}
+	}
+
+}
+
+TEST_F(BinaryDataBase_test, corrupted) {
+
+	BinaryDataBase binary;
+
+	ASSERT_FALSE(binary.open("/tmp/J1939BinaryDataBase_test_not_found.j1939db"));
+	ASSERT_EQ(BinaryDataBase::ERROR_FILE_NOT_FOUND, binary.getLastError());
+
+	ASSERT_FALSE(binary.open("Database/frames.json"));
+	ASSERT_EQ(BinaryDataBase::ERROR_INVALID_FORMAT, binary.getLastError());
+
+	std::string content;
+
+	{
+		std::ifstream ifs(BINARY_DATABASE_FILE, std::ifstream::binary);
+		content.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	}
+
+	//Truncated file
+	{
+		std::ofstream ofs(BINARY_DATABASE_FILE, std::ofstream::binary | std::ofstream::trunc);
+		ofs.write(content.data(), content.size() - 1);
+	}
+
+	ASSERT_FALSE(binary.open(BINARY_DATABASE_FILE));
+	ASSERT_EQ(BinaryDataBase::ERROR_INVALID_FORMAT, binary.getLastError());
+	ASSERT_FALSE(binary.isOpen());
+
+	//Another version of the format
+	std::string otherVersion = content;
+	otherVersion[offsetof(BinaryDataBaseHeader, version)] ^= 0xFF;
+
+	{
+		std::ofstream ofs(BINARY_DATABASE_FILE, std::ofstream::binary | std::ofstream::trunc);
+		ofs.write(otherVersion.data(), otherVersion.size());
+	}
+
+	ASSERT_FALSE(binary.open(BINARY_DATABASE_FILE));
+	ASSERT_EQ(BinaryDataBase::ERROR_VERSION_MISMATCH, binary.getLastError());
+
+	J1939DataBase database;
+
+	ASSERT_FALSE(database.parseBinaryFile(BINARY_DATABASE_FILE));
+	ASSERT_EQ(J1939DataBase::ERROR_INVALID_BINARY, database.getLastError());
+
+}
+
+TEST_F(BinaryDataBase_test, invalidRecords) {
+
+	std::vector<GenericFrame> frames(1, GenericFrame(0xEF00));
+
+	frames[0].registerSPN(SPNNumeric(1000, "First", 0, 1, 0, 1, "rpm"));
+	frames[0].registerSPN(SPNNumeric(1001, "Second", 1, 1, 0, 1, "rpm"));
+
+	ASSERT_TRUE(BinaryDataBase::compile(frames, BINARY_DATABASE_FILE));
+
+	std::string content;
+
+	{
+		std::ifstream ifs(BINARY_DATABASE_FILE, std::ifstream::binary);
+		content.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	}
+
+	BinaryDataBase binary;
+
+	ASSERT_TRUE(binary.open(BINARY_DATABASE_FILE));
+	binary.close();
+
+	//Records that would abort when the frames are built are rejected when the file is opened
+	auto openModified = [&](size_t offset, u8 value) {
+
+		std::string modified = content;
+		modified[offset] = value;
+
+		std::ofstream ofs(BINARY_DATABASE_FILE, std::ofstream::binary | std::ofstream::trunc);
+		ofs.write(modified.data(), modified.size());
+		ofs.close();
+
+		return binary.open(BINARY_DATABASE_FILE);
+	};
+
+	//Destination address in a PGN of PDU format 1
+	ASSERT_FALSE(openModified(sizeof(BinaryDataBaseHeader) + offsetof(BinaryFrameRecord, pgn), 0x01));
+	ASSERT_EQ(BinaryDataBase::ERROR_INVALID_FORMAT, binary.getLastError());
+
+	//String mixed with numeric SPNs
+	ASSERT_FALSE(openModified(sizeof(BinaryDataBaseHeader) + sizeof(BinaryFrameRecord) + sizeof(BinarySPNRecord) +
+			offsetof(BinarySPNRecord, type), SPN::SPN_STRING));
+	ASSERT_EQ(BinaryDataBase::ERROR_INVALID_FORMAT, binary.getLastError());
+
+}
+
+TEST_F(BinaryDataBase_test, registerInFactory) {
+
+	J1939Factory& factory = J1939Factory::getInstance();
+
+	std::set<u32> registered = factory.getAllRegisteredPGNs();
+
+	ASSERT_TRUE(factory.registerDatabaseFrames(BINARY_DATABASE_FILE));
+
+	std::unique_ptr<J1939Frame> frame = factory.getJ1939Frame(0xFEF1);
+
+	ASSERT_TRUE(frame.get() != nullptr);
+	ASSERT_EQ("CCVS", frame->getName());
+
+	//Keep a clear state for the factory
+	std::set<u32> all = factory.getAllRegisteredPGNs();
+
+	for(auto pgn = all.begin(); pgn != all.end(); ++pgn) {
+		if(registered.find(*pgn) == registered.end()) {
+			factory.unRegisterFrame(*pgn);
+		}
+	}
+
+}
+
+TEST_F(BinaryDataBase_test, servedFromMapping) {
+
+	J1939Factory factory;
+
+	ASSERT_TRUE(factory.registerDatabaseFrames(BINARY_DATABASE_FILE));
+
+	//The file is not needed any more once mapped
+	remove(BINARY_DATABASE_FILE);
+
+	ASSERT_TRUE(factory.isRegistered(0xFEF1));
+
+	std::set<u32> registered = factory.getAllRegisteredPGNs();
+
+	for(auto frame = mJson.getParsedFrames().begin(); frame != mJson.getParsedFrames().end(); ++frame) {
+		ASSERT_TRUE(registered.find(frame->getPGN()) != registered.end());
+	}
+
+	//Layouts are compiled from the records
+	std::shared_ptr<const FrameLayout> layout = factory.getFrameLayout(0xFEF1);
+
+	ASSERT_TRUE(layout.get() != nullptr);
+	ASSERT_EQ(5, layout->getSPNCount());
+	ASSERT_GE(layout->getSPNIndex(84), 0);
+	ASSERT_EQ(layout.get(), factory.getFrameLayout(0xFEF1).get());
+
+	u8 raw[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0x3C, 0xFF, 0xFF};
+	double value;
+
+	FrameView view = factory.getFrameView(0x18FEF120, raw, sizeof(raw));
+
+	ASSERT_TRUE(view.isValid());
+	ASSERT_TRUE(view.getValue(84, value));
+	ASSERT_EQ(80, value);
+
+	//Frames are built on request
+	std::unique_ptr<J1939Frame> frame = factory.getJ1939Frame(0x18FEF120, raw, sizeof(raw));
+
+	ASSERT_TRUE(frame.get() != nullptr);
+	ASSERT_EQ("CCVS", frame->getName());
+	ASSERT_EQ(80, static_cast<const SPNNumeric*>(static_cast<GenericFrame*>(frame.get())->getSPN(84))->getFormattedValue());
+
+	frame = factory.getJ1939Frame("CCVS");
+
+	ASSERT_TRUE(frame.get() != nullptr);
+	ASSERT_EQ(0xFEF1, frame->getPGN());
+
+	//The database frames are not replaced
+	GenericFrame ccvs(0xFEF1);
+	ccvs.setName("Other CCVS");
+
+	ASSERT_FALSE(factory.registerFrame(ccvs));
+	ASSERT_EQ("CCVS", factory.getJ1939Frame(0xFEF1)->getName());
+
+	factory.unRegisterFrame(0xFEF1);
+
+	ASSERT_FALSE(factory.isRegistered(0xFEF1));
+	ASSERT_TRUE(factory.getJ1939Frame(0xFEF1).get() == nullptr);
+	ASSERT_TRUE(factory.getFrameLayout(0xFEF1).get() == nullptr);
+	ASSERT_FALSE(factory.getFrameView(0x18FEF120, raw, sizeof(raw)).isValid());
+
+	ASSERT_TRUE(factory.registerFrame(ccvs));
+	ASSERT_EQ("Other CCVS", factory.getJ1939Frame(0xFEF1)->getName());
+
+	//The view keeps the compiled layout alive
+	ASSERT_TRUE(view.getValue(84, value));
+	ASSERT_EQ(80, value);
+}
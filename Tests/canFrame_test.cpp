@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <type_traits>
+#include <vector>
+
+#include <AllocationCounter.h>
+
+#include <CanFrame.h>
+
+
+using namespace Can;
+
+TEST(CanFrame_test, payload) {
+
+	const u8 payload[] = {0x01, 0x02, 0x03, 0xFF};
+
+	CanFrame frame(true, 0x18FEF100, payload, sizeof(payload));
+
+	ASSERT_EQ(frame.getData().size(), sizeof(payload));
+	ASSERT_EQ(frame.getData()[3], 0xFF);
+	ASSERT_EQ(frame.hexDump(), "01 02 03 ff ");
+
+	//Same as the frames built from strings
+	CanFrame fromString(true, 0x18FEF100, std::string("\x01\x02\x03\xFF", 4));
+
+	ASSERT_EQ(frame.getData(), fromString.getData());
+	ASSERT_EQ(frame.getData(), std::string("\x01\x02\x03\xFF", 4));
+	ASSERT_EQ(std::string(frame.getData()), std::string("\x01\x02\x03\xFF", 4));
+
+	//Too long payloads are rejected keeping the current one
+	const u8 tooLong[MAX_CAN_DATA_SIZE + 1] = {};
+
+	ASSERT_FALSE(frame.setData(tooLong, sizeof(tooLong)));
+	ASSERT_EQ(frame.getData(), fromString.getData());
+
+	ASSERT_TRUE(frame.setData(tooLong, MAX_CAN_DATA_SIZE));
+	ASSERT_EQ(frame.getData().size(), MAX_CAN_DATA_SIZE);
+
+	frame.clear();
+
+	ASSERT_TRUE(frame.getData().empty());
+	ASSERT_EQ(frame.getId(), 0);
+
+}
+
+TEST(CanFrame_test, copies) {
+
+	ASSERT_TRUE(std::is_trivially_copyable<CanFrame>::value);
+
+	std::vector<CanFrame> ring(256);
+	CanFrame frame(true, 0x18FEF100, std::string("\x11\x22\x33\x44\x55\x66\x77\x88", 8));
+
+	size_t allocations = AllocationCounter::getAllocations();
+
+	//Copies of full frames into a preallocated buffer
+	for(size_t i = 0; i < 4 * ring.size(); ++i) {
+		frame.setId(i);
+		ring[i % ring.size()] = frame;
+	}
+
+	ASSERT_EQ(AllocationCounter::getAllocations(), allocations);
+
+	ASSERT_EQ(ring[0].getId(), 3 * ring.size());
+	ASSERT_EQ(ring[0].getData(), frame.getData());
+
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <CanSniffer.h>
+#include <Backends/Sockets/SocketCanReceiver.h>
+
+
+using namespace Can;
+using namespace Utils;
+
+namespace {
+
+/*
+ * Socket datagrams with the layout of the frames of a raw CAN socket
+ */
+void sendFrame(int sock, u32 id, u8 value) {
+
+	canfd_frame frame;
+
+	memset(&frame, 0, sizeof(frame));
+
+	frame.can_id = id | CAN_EFF_FLAG;
+	frame.len = 3;
+	frame.data[0] = value;
+	frame.data[1] = value + 1;
+	frame.data[2] = value + 2;
+
+	ASSERT_EQ(write(sock, &frame, sizeof(can_frame)), sizeof(can_frame));
+
+}
+
+struct Batches {
+	CanSniffer* sniffer;
+	std::vector<size_t> sizes;
+	std::vector<u32> ids;
+	std::string interface;
+};
+
+void onBatch(const CanFrame* frames, const TimeStamp*, size_t count, const std::string& interface, void* data) {
+
+	Batches* batches = static_cast<Batches*>(data);
+
+	batches->sizes.push_back(count);
+	batches->interface = interface;
+
+	for(size_t i = 0; i < count; ++i) {
+		batches->ids.push_back(frames[i].getId());
+	}
+
+	batches->sniffer->finish();
+
+}
+
+bool onTimeout() {
+	return true;
+}
+
+CanSniffer* timedSniffer = nullptr;
+std::vector<std::chrono::steady_clock::time_point> timeouts;
+
+bool onCountedTimeout() {
+
+	timeouts.push_back(std::chrono::steady_clock::now());
+
+	if(timeouts.size() == 3) {
+		timedSniffer->finish();
+	}
+
+	return true;
+}
+
+struct Counter {
+	CanSniffer* sniffer;
+	size_t frames;
+	size_t expected;
+	std::vector<std::string> interfaces;
+};
+
+void onCountedFrame(const CanFrame&, const TimeStamp&, const std::string& interface, void* data) {
+
+	Counter* counter = static_cast<Counter*>(data);
+
+	counter->interfaces.push_back(interface);
+
+	if(++counter->frames == counter->expected) {
+		counter->sniffer->finish();
+	}
+
+}
+
+}
+
+TEST(CanReceiver_test, batch) {
+
+	int socks[2];
+
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, socks), 0);
+
+	Sockets::SocketCanReceiver* receiver = new Sockets::SocketCanReceiver(socks[0], false);
+
+	receiver->setInterface("can0");
+
+	for(u8 i = 0; i < 5; ++i) {
+		sendFrame(socks[1], 0x18FEF100 | i, i);
+	}
+
+	//All the queued frames with a single call
+	CanFrame frames[CAN_RECEIVE_BATCH_SIZE];
+	TimeStamp timestamps[CAN_RECEIVE_BATCH_SIZE];
+
+	ASSERT_EQ(receiver->receive(frames, timestamps, 3), 3);
+	ASSERT_EQ(receiver->receive(frames + 3, timestamps + 3, CAN_RECEIVE_BATCH_SIZE), 2);
+
+	for(u8 i = 0; i < 5; ++i) {
+		ASSERT_TRUE(frames[i].isExtendedFormat());
+		ASSERT_EQ(frames[i].getId(), 0x18FEF100 | i);
+		ASSERT_EQ(frames[i].getData(), std::string({(char)i, (char)(i + 1), (char)(i + 2)}));
+	}
+
+	//Batch mode of the sniffer, the queued frames come in a single batch
+	CanSniffer sniffer;
+	Batches batches;
+
+	batches.sniffer = &sniffer;
+
+	sniffer.addReceiver(receiver);
+	sniffer.setOnRecvBatch(onBatch);
+	sniffer.setOnTimeout(onTimeout);
+	sniffer.setData(&batches);
+
+	for(u8 i = 0; i < 10; ++i) {
+		sendFrame(socks[1], 0x18FEF100 | i, i);
+	}
+
+	sniffer.sniff(1000);
+
+	ASSERT_EQ(batches.sizes, std::vector<size_t>({10}));
+	ASSERT_EQ(batches.interface, "can0");
+	ASSERT_EQ(batches.ids.size(), 10);
+
+	close(socks[0]);
+	close(socks[1]);
+
+}
+
+TEST(CanReceiver_test, sniffer) {
+
+	const size_t interfaces = 16, framesPerInterface = 100;
+	std::vector<int> readers, writers;
+
+	CanSniffer sniffer;
+	Counter counter;
+
+	counter.sniffer = &sniffer;
+	counter.frames = 0;
+	counter.expected = interfaces * framesPerInterface;
+
+	for(size_t i = 0; i < interfaces; ++i) {
+
+		int socks[2];
+
+		ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, socks), 0);
+
+		Sockets::SocketCanReceiver* receiver = new Sockets::SocketCanReceiver(socks[0], false);
+
+		receiver->setInterface("can" + std::to_string(i));
+		sniffer.addReceiver(receiver);
+
+		readers.push_back(socks[0]);
+		writers.push_back(socks[1]);
+	}
+
+	sniffer.setOnRecv(onCountedFrame);
+	sniffer.setOnTimeout(onTimeout);
+	sniffer.setData(&counter);
+
+	//Written from other thread while sniffing, the receivers are drained every time they get new frames
+	std::thread writer([&]() {
+		for(size_t n = 0; n < framesPerInterface; ++n) {
+			for(size_t i = 0; i < interfaces; ++i) {
+				sendFrame(writers[i], 0x18FEF100, n);
+			}
+		}
+	});
+
+	sniffer.sniff(1000);
+	writer.join();
+
+	ASSERT_EQ(counter.frames, counter.expected);
+
+	for(size_t i = 0; i < interfaces; ++i) {
+		ASSERT_EQ(std::count(counter.interfaces.begin(), counter.interfaces.end(), "can" + std::to_string(i)),
+				framesPerInterface);
+	}
+
+	//Timeouts shorter than a second
+	timedSniffer = &sniffer;
+	timeouts.clear();
+
+	sniffer.reset();
+	sniffer.setOnTimeout(onCountedTimeout);
+
+	auto start = std::chrono::steady_clock::now();
+
+	sniffer.sniff(50);
+
+	ASSERT_EQ(timeouts.size(), 3);
+	ASSERT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(timeouts[0] - start).count(), 49);
+	ASSERT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(timeouts[2] - timeouts[1]).count(), 49);
+	ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(timeouts[2] - start).count(), 1000);
+
+	//Finished from other thread without waiting for the timeout
+	sniffer.reset();
+	sniffer.setOnTimeout(onTimeout);
+
+	start = std::chrono::steady_clock::now();
+
+	std::thread finisher([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		sniffer.finish();
+	});
+
+	sniffer.sniff(10000);
+	finisher.join();
+
+	ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), 1000);
+
+	for(size_t i = 0; i < interfaces; ++i) {
+		close(readers[i]);
+		close(writers[i]);
+	}
+
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include <thread>
+#include <vector>
+
+#include <Backends/Sockets/SocketCanSender.h>
+
+
+using namespace Can;
+
+TEST(CanSender_test, txQueue) {
+
+	int socks[2];
+
+	//The datagrams of a socket pair stand for the frames of a raw CAN socket, the peer only queues a few of them
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, socks), 0);
+
+	int bufferSize = 1;			//Minimum allowed
+
+	setsockopt(socks[0], SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+	setsockopt(socks[1], SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+	const u32 frames = 100;
+
+	{
+		Sockets::SocketCanSender sender(socks[0]);
+
+		for(u32 i = 0; i < frames; ++i) {
+			sender.sendFrameOnce(CanFrame(true, 0x18FEF100, std::string({(char)i, (char)(i >> 8)})));
+		}
+
+		//Not all the frames fit, the rest are retried by the sender thread while they are read
+		Sockets::SocketTxStats stats = sender.getTxStats();
+
+		ASSERT_GT(stats.noBufferErrors, 0);
+		ASSERT_GT(sender.getPendingFrames(), 0);
+		ASSERT_EQ(stats.droppedFrames, 0);
+
+		for(u32 i = 0; i < frames; ++i) {
+
+			can_frame frame;
+
+			ASSERT_EQ(read(socks[1], &frame, sizeof(frame)), sizeof(frame));
+
+			ASSERT_EQ(frame.can_id, 0x18FEF100 | CAN_EFF_FLAG);
+			ASSERT_EQ(frame.can_dlc, 2);
+			ASSERT_EQ(frame.data[0] | (frame.data[1] << 8), i);
+		}
+
+		stats = sender.getTxStats();
+
+		ASSERT_EQ(stats.framesSent, frames);
+		ASSERT_EQ(stats.droppedFrames, 0);
+		ASSERT_EQ(stats.writeErrors, 0);
+		ASSERT_EQ(sender.getPendingFrames(), 0);
+		ASSERT_LT(stats.writeCalls, frames);
+	}
+
+	close(socks[0]);
+	close(socks[1]);
+
+}
+
+TEST(CanSender_test, lastAttempt) {
+
+	int socks[2];
+
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, socks), 0);
+
+	int bufferSize = 1;
+
+	setsockopt(socks[0], SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+	setsockopt(socks[1], SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+	const u32 frames = 100;
+
+	u32 received = 0;
+	can_frame frame;
+
+	{
+		Sockets::SocketCanSender sender(socks[0]);
+
+		for(u32 i = 0; i < frames; ++i) {
+			sender.sendFrameOnce(CanFrame(true, 0x18FEF100, std::string({(char)i, (char)(i >> 8)})));
+		}
+
+		ASSERT_GT(sender.getTxStats().noBufferErrors, 0);
+
+		//Room is made while the sender is backing off
+		while(recv(socks[1], &frame, sizeof(frame), MSG_DONTWAIT) == sizeof(frame)) {
+			ASSERT_EQ(frame.data[0] | (frame.data[1] << 8), received);
+			++received;
+		}
+
+		ASSERT_GT(sender.getPendingFrames(), 0);
+	}
+
+	//The frames written on destruction are not lost, even if the sender was still waiting to retry
+	u32 afterDestruction = 0;
+
+	while(recv(socks[1], &frame, sizeof(frame), MSG_DONTWAIT) == sizeof(frame)) {
+		ASSERT_EQ(frame.data[0] | (frame.data[1] << 8), received);
+		++received;
+		++afterDestruction;
+	}
+
+	ASSERT_GT(afterDestruction, 0);
+	ASSERT_LT(received, frames);
+
+	close(socks[0]);
+	close(socks[1]);
+
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <J1939Factory.h>
+#include <ChangeDetector.h>
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+using namespace J1939;
+
+#define EEC1_PGN		0xF004
+#define EEC1_ID			0x0CF00400
+
+class ChangeDetector_test : public testing::Test
+{
+public:
+
+virtual void SetUp()
+{
+	GenericFrame eec1(EEC1_PGN);
+
+	eec1.setName("EEC1");
+	eec1.setLength(8);
+
+	eec1.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4));
+	eec1.registerSPN(SPNNumeric(512, "Driver's Demand Engine - Percent Torque", 1, 1, -125, 1, "%"));
+	eec1.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	eec1.registerSPN(SPNStatus(1675, "Engine Starter Mode", 6, 0, 4));
+	eec1.registerSPN(SPNNumeric(2432, "Engine Demand - Percent Torque", 7, 1, -125, 1, "%"));
+
+	J1939Factory::getInstance().registerFrame(eec1);
+}
+
+virtual void TearDown()
+{
+	J1939Factory::getInstance().unRegisterFrame(EEC1_PGN);
+}
+
+/*
+ * Numbers of the SPNs given in the mask of the result
+ */
+std::set<u32> getChangedSPNs(const ChangeResult& result) {
+
+	std::set<u32> spns;
+
+	ChangeDetector::forEachChangedSPN(result, [&](size_t, const SPNExtractOp& op) { spns.insert(op.spnNumber); });
+
+	return spns;
+}
+};
+
+TEST_F(ChangeDetector_test, changedSPNs) {
+
+	ChangeDetector detector;
+
+	u8 data[] = {0xF1, 0x7D, 0xFF, 0x20, 0x1C, 0xFF, 0xF0, 0x7D};
+
+	ChangeResult result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_NEW, result.status);
+	ASSERT_TRUE(result.layout != nullptr);
+	ASSERT_EQ(std::set<u32>({190, 512, 899, 1675, 2432}), getChangedSPNs(result));
+	ASSERT_EQ(1, detector.size());
+
+	//Same payload
+	result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_UNCHANGED, result.status);
+	ASSERT_EQ(0, result.changedSPNs);
+
+	//Engine speed
+	data[4] = 0x1D;
+	result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_CHANGED, result.status);
+	ASSERT_EQ(std::set<u32>({190}), getChangedSPNs(result));
+
+	//Engine torque mode and engine demand
+	data[0] = 0xF2;
+	data[7] = 0x7E;
+	result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_CHANGED, result.status);
+	ASSERT_EQ(std::set<u32>({899, 2432}), getChangedSPNs(result));
+
+	//Only bits not covered by any SPN
+	data[0] = 0xE2;
+	data[2] = 0xFE;
+	result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_CHANGED, result.status);
+	ASSERT_EQ(0, result.changedSPNs);
+
+	//The same PGN from another source address is tracked separately
+	result = detector.update(EEC1_ID | 0x01, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_NEW, result.status);
+	ASSERT_EQ(2, detector.size());
+
+}
+
+TEST_F(ChangeDetector_test, lengthChange) {
+
+	ChangeDetector detector;
+
+	u8 data[] = {0xF1, 0x7D, 0xFF, 0x00, 0x00, 0xFF, 0xF0, 0x00};
+
+	detector.update(EEC1_ID, data, sizeof(data));
+
+	//The removed bytes were zero, the SPNs placed on them changed anyway
+	ChangeResult result = detector.update(EEC1_ID, data, 5);
+
+	ASSERT_EQ(FRAME_CHANGED, result.status);
+	ASSERT_EQ(std::set<u32>({1675, 2432}), getChangedSPNs(result));
+
+	result = detector.update(EEC1_ID, data, 5);
+
+	ASSERT_EQ(FRAME_UNCHANGED, result.status);
+
+	result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_CHANGED, result.status);
+	ASSERT_EQ(std::set<u32>({1675, 2432}), getChangedSPNs(result));
+
+}
+
+TEST_F(ChangeDetector_test, untracked) {
+
+	ChangeDetector detector;
+
+	u8 data[J1939_MAX_SIZE + 1] = {0x01, 0x02, 0x03};
+
+	//PGN not registered in the factory
+	ChangeResult result = detector.update(0x18FF0000, data, 3);
+
+	ASSERT_EQ(FRAME_NEW, result.status);
+	ASSERT_TRUE(result.layout == nullptr);
+	ASSERT_EQ(0, result.changedSPNs);
+
+	ASSERT_EQ(FRAME_UNCHANGED, detector.update(0x18FF0000, data, 3).status);
+
+	data[1] = 0x04;
+
+	ASSERT_EQ(FRAME_CHANGED, detector.update(0x18FF0000, data, 3).status);
+
+	//Longer than a CAN frame
+	result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_NOT_TRACKED, result.status);
+	ASSERT_EQ(1, detector.size());
+
+}
+
+TEST_F(ChangeDetector_test, eraseAndClear) {
+
+	ChangeDetector detector(2);
+
+	u8 data[] = {0xF1, 0x7D, 0xFF, 0x20, 0x1C, 0xFF, 0xF0, 0x7D};
+
+	//Enough identifiers to grow the table several times
+	for(u32 sa = 0; sa < 200; ++sa) {
+		ASSERT_EQ(FRAME_NEW, detector.update(EEC1_ID | sa, data, sizeof(data)).status);
+	}
+
+	ASSERT_EQ(200, detector.size());
+
+	for(u32 sa = 0; sa < 200; sa += 2) {
+		detector.erase(EEC1_ID | sa);
+	}
+
+	detector.erase(EEC1_ID | 0xFF);		//Not tracked, nothing to do
+
+	ASSERT_EQ(100, detector.size());
+
+	//The entries left must still be found after the deletions
+	for(u32 sa = 0; sa < 200; ++sa) {
+		ASSERT_EQ((sa % 2 ? FRAME_UNCHANGED : FRAME_NEW), detector.update(EEC1_ID | sa, data, sizeof(data)).status);
+	}
+
+	ASSERT_EQ(200, detector.size());
+
+	detector.clear();
+
+	ASSERT_EQ(0, detector.size());
+	ASSERT_EQ(FRAME_NEW, detector.update(EEC1_ID, data, sizeof(data)).status);
+
+	//The masks are rebuilt from the factory
+	detector.clearMasks();
+
+	data[4] = 0x1D;
+	ChangeResult result = detector.update(EEC1_ID, data, sizeof(data));
+
+	ASSERT_EQ(FRAME_CHANGED, result.status);
+	ASSERT_EQ(std::set<u32>({190}), getChangedSPNs(result));
+
+}
+
+TEST_F(ChangeDetector_test, compareShorterData) {
+
+	std::unique_ptr<J1939Frame> frame = J1939Factory::getInstance().getJ1939Frame(EEC1_PGN);
+	GenericFrame* eec1 = static_cast<GenericFrame*>(frame.get());
+
+	std::string newData("\xF1\x7D\xFF\x20\x1C\xFF\xF0\x7D", 8);
+	std::string oldData("\xF1\x7D\xFF\x20\x1C", 5);
+
+	std::set<SPN*> spns = eec1->compare(newData, oldData);
+
+	//Bytes missing in the old data
+	ASSERT_EQ(2, spns.size());
+	ASSERT_TRUE(spns.find(eec1->getSPN(1675)) != spns.end());
+	ASSERT_TRUE(spns.find(eec1->getSPN(2432)) != spns.end());
+
+	ASSERT_EQ(2, eec1->compare(oldData, newData).size());
+
+}
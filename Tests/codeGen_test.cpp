@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <J1939CodeGenTestFrames.h>
+
+
+using namespace J1939CodeGenTest;
+
+//The header is generated from Tests/database/codegen.json, that it compiles is already half of the test
+TEST(CodeGen_test, escaping) {
+
+	//The comments of the frame name are closed and continued lines do not swallow the struct
+	typedef FrameWithANewline Frame;
+
+	ASSERT_EQ(0xFF00u, Frame::pgn());
+
+	ASSERT_STREQ("\"quoted\" \\ units\n\xC3\xA9", Frame::Decode_1::units());
+	ASSERT_STREQ("*/", Frame::Int_2::units());
+
+	ASSERT_EQ(1, Frame::Length_3::VALUE_On);
+
+}
+
+TEST(CodeGen_test, reservedNames) {
+
+	typedef FrameWithANewline Frame;
+
+	//SPNs named as the generated methods or as keywords are renamed with their number
+	Frame frame;
+
+	u8 data[] = {0x10, 0x00, 0x04, 0xFD, 0xFF, 0xFF, 0xFF, 0xFF};
+
+	ASSERT_TRUE(frame.decode(data, sizeof(data)));
+
+	ASSERT_EQ(0x10u, frame.decode1);
+	ASSERT_EQ(0x04u, frame.int2);
+	ASSERT_EQ(Frame::Length_3::VALUE_On, frame.length3);
+
+	ASSERT_DOUBLE_EQ(-38, Frame::Decode_1::format(frame.decode1));
+
+	u8 encoded[Frame::length()];
+
+	ASSERT_TRUE(frame.encode(encoded, sizeof(encoded)));
+	ASSERT_EQ(0, memcmp(data, encoded, sizeof(data)));
+
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <TestFrame.h>
+
+#include <DecoderContext.h>
+#include <GenericFrame.h>
+#include <Frames/RequestFrame.h>
+#include <Transport/BAM/BamFragmenter.h>
+
+
+using namespace J1939;
+
+TEST(DecoderContext_test, independentRegistries) {
+
+	DecoderContext truck, implement;
+
+	GenericFrame truckFrame(0xFF10);
+	truckFrame.setName("TRUCK");
+
+	GenericFrame implementFrame(0xFF10);
+	implementFrame.setName("IMPLEMENT");
+
+	ASSERT_TRUE(truck.getFactory().registerFrame(truckFrame));
+	ASSERT_TRUE(implement.getFactory().registerFrame(implementFrame));
+
+	u8 raw[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+	std::unique_ptr<J1939Frame> frame = truck.decode(0x18FF1020, raw, sizeof(raw), 0);
+
+	ASSERT_TRUE(frame.get() != nullptr);
+	ASSERT_EQ(frame->getName(), "TRUCK");
+
+	frame = implement.decode(0x18FF1020, raw, sizeof(raw), 0);
+
+	ASSERT_TRUE(frame.get() != nullptr);
+	ASSERT_EQ(frame->getName(), "IMPLEMENT");
+
+	//Neither is visible in the default instance
+	ASSERT_FALSE(J1939Factory::getInstance().isRegistered(0xFF10));
+
+	//The predefined frames are registered in every context
+	ASSERT_TRUE(truck.getFactory().isRegistered(ADDRESS_CLAIM_PGN));
+
+	//Sharing the frames of the default instance
+	DecoderContext shared(J1939Factory::getInstance());
+
+	ASSERT_EQ(&shared.getFactory(), &J1939Factory::getInstance());
+	ASSERT_TRUE(shared.decode(0x18FF1020, raw, sizeof(raw), 0).get() == nullptr);
+
+}
+
+TEST(DecoderContext_test, requestNames) {
+
+	std::unique_ptr<J1939Frame> request;
+
+	{
+		DecoderContext truck;
+
+		GenericFrame truckFrame(0xFF10);
+		truckFrame.setName("TRUCK");
+
+		ASSERT_TRUE(truck.getFactory().registerFrame(truckFrame));
+
+		u8 raw[] = {0x10, 0xFF, 0x00};
+
+		request = truck.decode(0x18EAFF20, raw, sizeof(raw), 0);
+
+		ASSERT_TRUE(request.get() != nullptr);
+		ASSERT_EQ(REQUEST_PGN, request->getPGN());
+
+		//The name of the requested PGN comes from the factory of the context, not from the default instance
+		ASSERT_NE(std::string::npos, request->toString().find("Request PGN: ff10 TRUCK"));
+	}
+
+	//Printed without name once the factory is destroyed
+	ASSERT_NE(std::string::npos, request->toString().find("Request PGN: ff10 \n"));
+
+	//Frames not built by a factory
+	ASSERT_NE(std::string::npos, RequestFrame(0xFF10).toString().find("Request PGN: ff10 \n"));
+
+}
+
+TEST(DecoderContext_test, bam) {
+
+	DecoderContext truck, implement;
+
+	ASSERT_TRUE(truck.getFactory().registerFrame(TestFrame(0xF005)));
+
+	TestFrame frame(0xF005);
+
+	{
+		u8 raw[] = {0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0xAB, 0xCD, 0xEF, 0xAB, 0xCD, 0xEF, 0xAB, 0xCD, 0xEF};
+
+		frame.decode(0x00F00550, raw, sizeof(raw));
+	}
+
+	BamFragmenter fragmenter;
+	fragmenter.fragment(frame);
+
+	std::vector<const J1939Frame*> packets;
+
+	packets.push_back(&fragmenter.getConnFrame());
+
+	std::vector<TPDTFrame> dataFrames = fragmenter.getDataFrames();
+
+	for(auto dataFrame = dataFrames.begin(); dataFrame != dataFrames.end(); ++dataFrame) {
+		packets.push_back(&(*dataFrame));
+	}
+
+	std::unique_ptr<J1939Frame> truckFrame, implementFrame;
+
+	for(auto packet = packets.begin(); packet != packets.end(); ++packet) {
+
+		u8 buff[J1939_MAX_SIZE];
+		u32 id;
+		size_t length = (*packet)->getDataLength();
+
+		(*packet)->encode(id, buff, length);
+
+		//Nothing is returned until the message is complete
+		ASSERT_TRUE(truckFrame.get() == nullptr);
+
+		truckFrame = truck.decode(id, buff, length, 0);
+		implementFrame = implement.decode(id, buff, length, 0);
+
+		//The PGN is not registered in the implement bus
+		ASSERT_TRUE(implementFrame.get() == nullptr);
+	}
+
+	ASSERT_TRUE(truckFrame.get() != nullptr);
+	ASSERT_EQ(truckFrame->getPGN(), 0xF005);
+	ASSERT_EQ(truckFrame->getSrcAddr(), 0x50);
+	ASSERT_EQ(static_cast<TestFrame*>(truckFrame.get())->getRaw(), frame.getRaw());
+
+	ASSERT_FALSE(truck.getReassembler().reassembledFramesPending());
+	ASSERT_FALSE(implement.getReassembler().reassembledFramesPending());
+
+}
+
+TEST(DecoderContext_test, addressClaims) {
+
+	DecoderContext context;
+
+	EcuName engine(25898, 1256, 5, 16, 241, 90, 15, 2, false);
+	EcuName brakes(1234, 1256, 5, 16, 241, 90, 15, 2, false);
+
+	auto claim = [&context](const EcuName& name, u8 address) {
+
+		AddressClaimFrame frame(name);
+		u8 buff[J1939_MAX_SIZE];
+		u32 id;
+		size_t length = frame.getDataLength();
+
+		frame.setSrcAddr(address);
+		frame.setDstAddr(0xFF);
+		frame.encode(id, buff, length);
+
+		return context.decode(id, buff, length, 0);
+	};
+
+	ASSERT_TRUE(claim(engine, 0x00).get() != nullptr);
+	ASSERT_TRUE(claim(brakes, 0x0B).get() != nullptr);
+
+	const AddressTable& table = context.getAddressTable();
+	EcuName name;
+	u8 address;
+
+	ASSERT_EQ(table.size(), 2);
+	ASSERT_TRUE(table.getName(0x00, name));
+	ASSERT_EQ(name.getValue(), engine.getValue());
+	ASSERT_TRUE(table.getAddress(brakes, address));
+	ASSERT_EQ(address, 0x0B);
+
+	//The engine moves to another address
+	claim(engine, 0x01);
+
+	ASSERT_EQ(table.size(), 2);
+	ASSERT_FALSE(table.isClaimed(0x00));
+	ASSERT_TRUE(table.getAddress(engine, address));
+	ASSERT_EQ(address, 0x01);
+
+	//The brakes cannot claim any address
+	claim(brakes, J1939_INVALID_ADDRESS);
+
+	ASSERT_EQ(table.size(), 1);
+	ASSERT_FALSE(table.getAddress(brakes, address));
+
+	context.reset();
+
+	ASSERT_EQ(table.size(), 0);
+
+}
+
+TEST(DecoderContext_test, stalledBam) {
+
+	DecoderContext context;
+
+	TestFrame frame(0xF005);
+
+	{
+		u8 raw[20] = {0};
+
+		frame.decode(0x00F00550, raw, sizeof(raw));
+	}
+
+	BamFragmenter fragmenter;
+	fragmenter.fragment(frame);
+
+	u8 buff[J1939_MAX_SIZE];
+	u32 id;
+	size_t length = fragmenter.getConnFrame().getDataLength();
+
+	//Only the announcement is received, the source goes silent afterwards
+	fragmenter.getConnFrame().encode(id, buff, length);
+
+	ASSERT_TRUE(context.decode(id, buff, length, 1000).get() == nullptr);
+	ASSERT_EQ(context.getReassembler().getActiveSessions(), 1);
+
+	//Any other frame of the bus received after the timeout releases the session
+	u8 raw[] = {0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89};
+
+	context.decode(0x18FF1020, raw, sizeof(raw), 1000 + BAM_TIMEOUT_T1 / 2);
+
+	ASSERT_EQ(context.getReassembler().getActiveSessions(), 1);
+
+	context.decode(0x18FF1020, raw, sizeof(raw), 1000 + 2 * BAM_TIMEOUT_T1);
+
+	ASSERT_EQ(context.getReassembler().getActiveSessions(), 0);
+	ASSERT_EQ(context.getReassembler().getExpiredSessions(), 1);
+
+}
@@ -0,0 +1,415 @@
+#include <deque>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Utils.h>
+
+#include <J1939Factory.h>
+#include <Transport/ETP/ETPConnectionManager.h>
+
+
+using namespace J1939;
+
+#define ORIGINATOR_ADDR		0x10
+#define RESPONDER_ADDR		0x20
+#define TEST_PGN			0xEF00
+
+
+class ETP_test : public testing::Test {
+
+protected:
+
+	struct RawFrame {
+		u32 id;
+		std::vector<u8> data;
+	};
+
+	struct Result {
+		u8 originator;
+		u8 responder;
+		u32 pgn;
+		ETPConnectionManager::ETransferResult result;
+		u8 abortReason;
+	};
+
+	J1939Factory factory;
+	ETPConnectionManager originator, responder;
+	std::deque<RawFrame> bus;
+	u64 now = 0;
+
+	//Returns true for the frames lost in the bus
+	std::function<bool(u32 id, const u8* data)> lost;
+
+	std::vector<Result> sent, received;
+	std::vector<u8> payload, reassembled;
+	size_t biggestChunk = 0;
+
+	void SetUp() override {
+
+		originator.addLocalAddress(ORIGINATOR_ADDR);
+		responder.addLocalAddress(RESPONDER_ADDR);
+
+		auto send = [this](u32 id, const u8* data, size_t length) {
+			RawFrame frame;
+			frame.id = id;
+			frame.data.assign(data, data + length);
+			bus.push_back(frame);
+		};
+
+		originator.setSendCallback(send);
+		responder.setSendCallback(send);
+
+		responder.setDataCallback([this](u8, u8, u32, u32 offset, const u8* data, size_t length, u32 totalSize) {
+			//In order and every byte once
+			EXPECT_EQ(offset, reassembled.size());
+			EXPECT_LE(offset + length, totalSize);
+			reassembled.insert(reassembled.end(), data, data + length);
+			biggestChunk = J1939_MAX(biggestChunk, length);
+		});
+
+		originator.setFinishedCallback([this](u8 src, u8 dst, u32 pgn, ETPConnectionManager::ETransferResult result, u8 reason) {
+			sent.push_back(Result{src, dst, pgn, result, reason});
+		});
+
+		responder.setFinishedCallback([this](u8 src, u8 dst, u32 pgn, ETPConnectionManager::ETransferResult result, u8 reason) {
+			received.push_back(Result{src, dst, pgn, result, reason});
+		});
+
+		setPayload(100000);
+	}
+
+	void setPayload(size_t length) {
+
+		payload.resize(length);
+
+		for(size_t i = 0; i < length; ++i) {
+			payload[i] = i * 7 + (i >> 8);
+		}
+	}
+
+	bool send() {
+		reassembled.clear();
+		return originator.send(TEST_PGN, 6, ORIGINATOR_ADDR, RESPONDER_ADDR, payload.data(), payload.size(), now);
+	}
+
+	size_t run() {
+
+		size_t delivered = 0;
+
+		while(!bus.empty()) {
+
+			RawFrame frame = bus.front();
+			bus.pop_front();
+
+			if(lost && lost(frame.id, frame.data.data())) {
+				continue;
+			}
+
+			std::unique_ptr<J1939Frame> decoded = factory.getJ1939Frame(frame.id, frame.data.data(), frame.data.size());
+
+			originator.consumeFrame(*decoded, now);
+			responder.consumeFrame(*decoded, now);
+
+			++delivered;
+		}
+
+		return delivered;
+	}
+
+};
+
+TEST_F(ETP_test, frames) {
+
+	ETPCMFrame conn;
+
+	conn.setCtrlType(CTRL_ETPCM_RTS);
+	conn.setTotalMsgSize(ETP_MAX_MSG_SIZE);
+	conn.setDataPgn(0x00FEDA);
+	conn.setSrcAddr(ORIGINATOR_ADDR);
+	conn.setDstAddr(RESPONDER_ADDR);
+	conn.setPriority(7);
+
+	u8 raw[ETP_CM_SIZE];
+	size_t length = sizeof(raw);
+	u32 id;
+
+	conn.encode(id, raw, length);
+
+	u8 expected[] = {CTRL_ETPCM_RTS, 0xF9, 0xFF, 0xFF, 0x06, 0xDA, 0xFE, 0x00};
+
+	ASSERT_EQ(id, 0x1CC82010);
+	ASSERT_EQ(memcmp(raw, expected, sizeof(raw)), 0);
+
+	//24 bit packet numbers
+	u8 cts[] = {CTRL_ETPCM_CTS, 0x10, 0x56, 0x34, 0x12, 0xDA, 0xFE, 0x00};
+
+	std::unique_ptr<J1939Frame> decoded = factory.getJ1939Frame(0x1CC81020, cts, sizeof(cts));
+
+	ASSERT_TRUE(decoded.get() != nullptr);
+	ASSERT_EQ(decoded->getPGN(), ETP_CM_PGN);
+
+	ETPCMFrame* ctsFrame = static_cast<ETPCMFrame*>(decoded.get());
+
+	ASSERT_EQ(ctsFrame->getCtrlType(), CTRL_ETPCM_CTS);
+	ASSERT_EQ(ctsFrame->getPacketsToTx(), 0x10);
+	ASSERT_EQ(ctsFrame->getNextPacket(), 0x123456);
+	ASSERT_EQ(ctsFrame->getDataPgn(), 0x00FEDA);
+
+	u8 dt[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+	decoded = factory.getJ1939Frame(0x1CC72010, dt, sizeof(dt));
+
+	ASSERT_TRUE(decoded.get() != nullptr);
+	ASSERT_EQ(decoded->getPGN(), ETP_DT_PGN);
+	ASSERT_EQ(static_cast<ETPDTFrame*>(decoded.get())->getSq(), 1);
+
+}
+
+TEST_F(ETP_test, transfer) {
+
+	u8 windows[] = {1, 16, 255};
+
+	for(size_t i = 0; i < sizeof(windows); ++i) {
+
+		ETPConfig config;
+		config.windowSize = windows[i];
+		responder.setConfig(config);
+
+		sent.clear();
+		received.clear();
+		biggestChunk = 0;
+		originator.resetStats();
+		responder.resetStats();
+
+		ASSERT_TRUE(send());
+
+		//Only one session in each direction between two nodes
+		ASSERT_FALSE(send());
+
+		run();
+
+		ASSERT_EQ(sent.size(), 1);
+		ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_COMPLETED);
+		ASSERT_EQ(sent[0].pgn, TEST_PGN);
+
+		ASSERT_EQ(received.size(), 1);
+		ASSERT_EQ(received[0].result, ETPConnectionManager::TRANSFER_COMPLETED);
+		ASSERT_EQ(received[0].originator, ORIGINATOR_ADDR);
+		ASSERT_EQ(received[0].responder, RESPONDER_ADDR);
+
+		ASSERT_EQ(reassembled, payload);
+
+		//Never more than a window buffered
+		ASSERT_LE(biggestChunk, windows[i] * TP_DT_PACKET_SIZE);
+
+		ASSERT_EQ(originator.getStats().packetsSent, (payload.size() + TP_DT_PACKET_SIZE - 1) / TP_DT_PACKET_SIZE);
+		ASSERT_EQ(originator.getStats().bytesSent, payload.size());
+		ASSERT_EQ(responder.getStats().bytesReceived, payload.size());
+		ASSERT_EQ(responder.getStats().messagesReceived, 1);
+		ASSERT_EQ(originator.getSessionCount(), 0);
+		ASSERT_EQ(responder.getSessionCount(), 0);
+	}
+
+	//Messages that fit in TP are not sent with ETP
+	setPayload(ETP_MIN_MSG_SIZE - 1);
+	ASSERT_FALSE(send());
+
+}
+
+TEST_F(ETP_test, retransmission) {
+
+	ETPConfig config;
+	config.windowSize = 16;
+	responder.setConfig(config);
+
+	bool dropped = false;
+
+	//The fifth packet of the third window is lost once
+	u32 dpo = 0;
+
+	lost = [&](u32 id, const u8* data) {
+
+		if(getPGNFromId(id) == ETP_CM_PGN && data[0] == CTRL_ETPCM_DPO) {
+			++dpo;
+		}
+
+		if(!dropped && dpo == 3 && getPGNFromId(id) == ETP_DT_PGN && data[0] == 5) {
+			dropped = true;
+			return true;
+		}
+		return false;
+	};
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	ASSERT_TRUE(dropped);
+	ASSERT_EQ(responder.getStats().retransmitRequests, 1);
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_COMPLETED);
+	ASSERT_EQ(reassembled, payload);
+
+	//The last packet of a window lost, T1 expires in the responder, which requests it again
+	dropped = false;
+	dpo = 0;
+	sent.clear();
+
+	lost = [&](u32 id, const u8* data) {
+
+		if(getPGNFromId(id) == ETP_CM_PGN && data[0] == CTRL_ETPCM_DPO) {
+			++dpo;
+		}
+
+		if(!dropped && dpo == 2 && getPGNFromId(id) == ETP_DT_PGN && data[0] == 16) {
+			dropped = true;
+			return true;
+		}
+		return false;
+	};
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	ASSERT_TRUE(sent.empty());
+
+	now += ETP_DEFAULT_T1 - 1;
+	responder.tick(now);
+	ASSERT_EQ(run(), 0);
+
+	now += 1;
+	responder.tick(now);
+	run();
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_COMPLETED);
+	ASSERT_EQ(reassembled, payload);
+
+	//Packets of many windows lost once, more than the retransmissions allowed for a window
+	std::set<u32> lossy = {1, 10, 20, 30};
+	u64 requests = responder.getStats().retransmitRequests;
+
+	dpo = 0;
+	sent.clear();
+
+	lost = [&](u32 id, const u8* data) {
+
+		if(getPGNFromId(id) == ETP_CM_PGN && data[0] == CTRL_ETPCM_DPO) {
+			++dpo;
+		}
+
+		return (getPGNFromId(id) == ETP_DT_PGN && data[0] == 5 && lossy.erase(dpo) > 0);
+	};
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	ASSERT_TRUE(lossy.empty());
+	ASSERT_EQ(responder.getStats().retransmitRequests - requests, 4);
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_COMPLETED);
+	ASSERT_EQ(reassembled, payload);
+
+}
+
+TEST_F(ETP_test, clearFromCallback) {
+
+	//Nobody answers, the sessions to both responders time out in the same tick
+	lost = [](u32, const u8*) { return true; };
+
+	ASSERT_TRUE(send());
+	ASSERT_TRUE(originator.send(TEST_PGN, 6, ORIGINATOR_ADDR, RESPONDER_ADDR + 1, payload.data(), payload.size(), now));
+
+	run();
+
+	ASSERT_EQ(originator.getSessionCount(), 2);
+
+	//The session not notified yet is dropped while its timer is expiring
+	originator.setFinishedCallback([this](u8 src, u8 dst, u32 pgn, ETPConnectionManager::ETransferResult result, u8 reason) {
+		sent.push_back(Result{src, dst, pgn, result, reason});
+		originator.clear();
+	});
+
+	now += ETP_DEFAULT_T3;
+	originator.tick(now);
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_TIMEOUT);
+	ASSERT_EQ(originator.getSessionCount(), 0);
+
+	//The manager is still usable
+	lost = nullptr;
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	ASSERT_EQ(sent.size(), 2);
+	ASSERT_EQ(sent[1].result, ETPConnectionManager::TRANSFER_COMPLETED);
+	ASSERT_EQ(reassembled, payload);
+
+}
+
+TEST_F(ETP_test, aborts) {
+
+	//Rejected by the application
+	responder.setAcceptCallback([](u8, u8, u32, u32 totalSize) { return totalSize < 50000; });
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_ABORTED_BY_PEER);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_NOT_SUPPORTED);
+	ASSERT_TRUE(received.empty());
+	ASSERT_TRUE(reassembled.empty());
+
+	//Nobody answers, T3 expires in the originator
+	responder.removeLocalAddress(RESPONDER_ADDR);
+	sent.clear();
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	originator.tick(now + ETP_DEFAULT_T3 - 1);
+	ASSERT_TRUE(sent.empty());
+
+	originator.tick(now + ETP_DEFAULT_T3);
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_ABORTED);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_TIMEOUT);
+	ASSERT_EQ(originator.getStats().timeouts, 1);
+	ASSERT_EQ(originator.getSessionCount(), 0);
+
+	//Aborted by the originator in the middle of the transfer
+	responder.addLocalAddress(RESPONDER_ADDR);
+	responder.setAcceptCallback(ETPConnectionManager::AcceptCallback());
+	sent.clear();
+
+	lost = [this](u32 id, const u8* data) {
+		if(getPGNFromId(id) == ETP_CM_PGN && data[0] == CTRL_ETPCM_CTS && reassembled.size() > 0) {
+			originator.abort(ORIGINATOR_ADDR, RESPONDER_ADDR);
+			return true;
+		}
+		return false;
+	};
+
+	ASSERT_TRUE(send());
+
+	run();
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, ETPConnectionManager::TRANSFER_ABORTED);
+	ASSERT_EQ(received.size(), 1);
+	ASSERT_EQ(received[0].result, ETPConnectionManager::TRANSFER_ABORTED_BY_PEER);
+	ASSERT_EQ(received[0].abortReason, CONN_ABORT_TERMINATED);
+	ASSERT_EQ(responder.getSessionCount(), 0);
+
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <FrameFormatter.h>
+#include <GenericFrame.h>
+#include <Diagnosis/Frames/DM1.h>
+#include <Frames/RequestFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+#include <SPN/SPNString.h>
+
+using namespace J1939;
+using namespace Utils;
+
+class FrameFormatter_test : public testing::Test
+{
+public:
+	GenericFrame frame;
+
+	FrameFormatter_test() : frame(0xF004) {}
+
+virtual void SetUp()
+{
+	SPNStatusSpec::DescMap descriptions;
+	descriptions[1] = "Accelerator pedal, operator selection";
+
+	frame.setName("EEC1");
+	frame.setLength(8);
+
+	frame.registerSPN(SPNStatus(899, "Engine Torque Mode", 0, 0, 4, descriptions));
+	frame.registerSPN(SPNNumeric(190, "Engine Speed", 3, 0.125, 0, 2, "rpm"));
+	frame.registerSPN(SPNNumeric(512, "Driver's Demand Engine, \"Percent\" Torque", 1, 1, -125, 1, "%"));
+
+	u8 data[] = {0xF1, 0x7D, 0xFF, 0x44, 0x1F, 0xFF, 0xFF, 0xFF};
+
+	frame.decode(0x0CF00400, data, sizeof(data));
+}
+
+std::string format(const FrameFormatter& formatter, const J1939Frame& j1939Frame) {
+
+	char buffer[1024];
+
+	size_t length = formatter.format(j1939Frame, TimeStamp(12, 250), buffer, sizeof(buffer));
+
+	return std::string(buffer, length);
+}
+};
+
+TEST_F(FrameFormatter_test, tsv) {
+
+	FrameFormatter formatter(FRAME_FORMAT_TSV);
+
+	char buffer[256];
+
+	size_t length = formatter.formatHeader(buffer, sizeof(buffer));
+
+	ASSERT_EQ("timestamp\tid\tpgn\tname\tsource\tdestination\tpriority\tspn\tspn_name\tvalue\tunits\tdescription\n",
+			std::string(buffer, length));
+
+	ASSERT_EQ("12.000250\t0CF00400\tF004\tEEC1\t0\t\t3\t190\tEngine Speed\t1000.5\trpm\t\n"
+			"12.000250\t0CF00400\tF004\tEEC1\t0\t\t3\t512\tDriver's Demand Engine, \"Percent\" Torque\t0\t%\t\n"
+			"12.000250\t0CF00400\tF004\tEEC1\t0\t\t3\t899\tEngine Torque Mode\t1\t\tAccelerator pedal, operator selection\n",
+			format(formatter, frame));
+
+}
+
+TEST_F(FrameFormatter_test, csv) {
+
+	FrameFormatter formatter(FRAME_FORMAT_CSV);
+
+	SPNNumeric* speed = static_cast<SPNNumeric*>(frame.getSPN(190));
+	speed->setFormattedValue(0.375);
+
+	ASSERT_EQ("12.000250,0CF00400,F004,EEC1,0,,3,190,Engine Speed,0.375,rpm,\n"
+			"12.000250,0CF00400,F004,EEC1,0,,3,512,\"Driver's Demand Engine, \"\"Percent\"\" Torque\",0,%,\n"
+			"12.000250,0CF00400,F004,EEC1,0,,3,899,Engine Torque Mode,1,,\"Accelerator pedal, operator selection\"\n",
+			format(formatter, frame));
+
+	char buffer[256];
+
+	ASSERT_EQ("12.000250,0CF00400,F004,EEC1,0,,3,190,Engine Speed,0.375,rpm,\n",
+			std::string(buffer, formatter.formatSPN(frame, *speed, TimeStamp(12, 250), buffer, sizeof(buffer))));
+
+	//Frames without SPNs
+	RequestFrame request(0xFEE5);
+	request.setSrcAddr(0x21);
+	request.setDstAddr(0xFF);
+	request.setPriority(6);
+
+	ASSERT_EQ("12.000250,18EAFF21,EA00,Request,33,255,6,,,,,\n", format(formatter, request));
+
+}
+
+TEST_F(FrameFormatter_test, ndjson) {
+
+	FrameFormatter formatter(FRAME_FORMAT_NDJSON);
+
+	char buffer[16];
+
+	ASSERT_EQ(0, formatter.formatHeader(buffer, sizeof(buffer)));
+
+	static_cast<SPNNumeric*>(frame.getSPN(512))->setFormattedValue(-12);
+
+	ASSERT_EQ("{\"timestamp\":12.000250,\"id\":\"0CF00400\",\"pgn\":\"F004\",\"name\":\"EEC1\",\"source\":0,\"priority\":3,\"spns\":["
+			"{\"spn\":190,\"name\":\"Engine Speed\",\"value\":1000.5,\"units\":\"rpm\"},"
+			"{\"spn\":512,\"name\":\"Driver's Demand Engine, \\\"Percent\\\" Torque\",\"value\":-12,\"units\":\"%\"},"
+			"{\"spn\":899,\"name\":\"Engine Torque Mode\",\"value\":1,\"description\":\"Accelerator pedal, operator selection\"}]}\n",
+			format(formatter, frame));
+
+	GenericFrame strFrame(0xFEEB);
+	strFrame.setName("Component\tIdentification");
+	strFrame.registerSPN(SPNString(586, "Make"));
+	static_cast<SPNString*>(strFrame.getSPN(586))->setValue("ACME\n");
+
+	ASSERT_EQ("{\"timestamp\":12.000250,\"id\":\"00FEEBFE\",\"pgn\":\"FEEB\",\"name\":\"Component\\u0009Identification\",\"source\":254,"
+			"\"priority\":0,\"spns\":[{\"spn\":586,\"name\":\"Make\",\"value\":\"ACME\\u000A\"}]}\n", format(formatter, strFrame));
+
+	//A string SPN padded with 0xFF
+	u8 padded[] = {'A', 'C', 'M', 'E', J1939_STR_TERMINATOR, 0xFF, 0xFF, 0xFF};
+
+	ASSERT_EQ(CODEC_OK, strFrame.tryDecode(0x18FEEB00, padded, sizeof(padded)));
+
+	//The names come from the database and are not checked, the bytes that are not UTF-8 are escaped and the sequences that are UTF-8 are kept
+	strFrame.setName(std::string("Component \xC2\xB0\xC2\xFF\xFF", 15));
+
+	ASSERT_EQ("{\"timestamp\":12.000250,\"id\":\"18FEEB00\",\"pgn\":\"FEEB\",\"name\":\"Component \xC2\xB0\\u00C2\\u00FF\\u00FF\",\"source\":0,"
+			"\"priority\":6,\"spns\":[{\"spn\":586,\"name\":\"Make\",\"value\":\"ACME\"}]}\n", format(formatter, strFrame));
+
+}
+
+TEST_F(FrameFormatter_test, dm1) {
+
+	DM1 dm1;
+	dm1.addDTC(DTC(100, FMI_DATA_BELOW_RANGE, 3));
+
+	std::string tsv = format(FrameFormatter(FRAME_FORMAT_TSV), dm1);
+
+	ASSERT_NE(std::string::npos, tsv.find("\t100\tDTC\t1\t\t3\n"));
+
+	std::string ndjson = format(FrameFormatter(FRAME_FORMAT_NDJSON), dm1);
+
+	ASSERT_NE(std::string::npos, ndjson.find(",\"dtcs\":[{\"spn\":100,\"fmi\":1,\"oc\":3}]}\n"));
+
+	//Generic frames with the PGN of DM1 are not written as DM1
+	GenericFrame generic(DM1_PGN);
+	generic.registerSPN(SPNNumeric(1213, "Lamp", 0, 1, 0, 1, ""));
+
+	ndjson = format(FrameFormatter(FRAME_FORMAT_NDJSON), generic);
+
+	ASSERT_NE(std::string::npos, ndjson.find("\"spns\":[{\"spn\":1213,"));
+	ASSERT_EQ(std::string::npos, ndjson.find("\"dtcs\""));
+
+}
+
+TEST_F(FrameFormatter_test, bufferTooSmall) {
+
+	FrameFormatter formatter(FRAME_FORMAT_TSV);
+
+	char buffer[1024];
+
+	size_t length = formatter.format(frame, TimeStamp(), buffer, sizeof(buffer));
+
+	ASSERT_GT(length, 0);
+	ASSERT_EQ(0, formatter.format(frame, TimeStamp(), buffer, length - 1));
+	ASSERT_EQ(length, formatter.format(frame, TimeStamp(), buffer, length));
+
+	EFrameFormat format;
+
+	ASSERT_TRUE(FrameFormatter::parseFormat("ndjson", format));
+	ASSERT_EQ(FRAME_FORMAT_NDJSON, format);
+	ASSERT_FALSE(FrameFormatter::parseFormat("xml", format));
+
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <J1939Factory.h>
+#include <FramePool.h>
+#include <GenericFrame.h>
+#include <Diagnosis/Frames/DM1.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+#include <AllocationCounter.h>
+
+using namespace J1939;
+
+#define CCVS_PGN		0xFEF1
+
+class FramePool_test : public testing::Test
+{
+public:
+
+virtual void SetUp()
+{
+	GenericFrame ccvs(CCVS_PGN);
+
+	ccvs.setName("CCVS");
+	ccvs.setLength(8);
+
+	SPNNumeric wheelSpeed(84, "Wheel Speed", 1, 0.00390625, 0, 2, "km/h");
+	ccvs.registerSPN(wheelSpeed);
+
+	SPNStatus brakeSwitch(597, "Brake Switch", 3, 4, 2);
+	ccvs.registerSPN(brakeSwitch);
+
+	J1939Factory::getInstance().registerFrame(ccvs);
+}
+
+virtual void TearDown()
+{
+	J1939Factory::getInstance().unRegisterFrame(CCVS_PGN);
+}
+};
+
+TEST_F(FramePool_test, decodeInto) {
+
+	u8 raw[] = {0xFF, 0x00, 0x32, 0x10, 0xFF, 0xFF, 0xFF, 0xFF};
+
+	std::unique_ptr<J1939Frame> frame = J1939Factory::getInstance().getJ1939Frame(CCVS_PGN);
+
+	ASSERT_TRUE(J1939Factory::getInstance().decodeInto(0x18FEF120, raw, sizeof(raw), *frame));
+
+	GenericFrame* ccvs = static_cast<GenericFrame*>(frame.get());
+
+	ASSERT_EQ(ccvs->getSrcAddr(), 0x20);
+	ASSERT_EQ(static_cast<SPNNumeric*>(ccvs->getSPN(84))->getValue(), 0x3200);
+	ASSERT_EQ(static_cast<SPNStatus*>(ccvs->getSPN(597))->getValue(), 1);
+
+	//The PGN of the id does not belong to the frame
+	ASSERT_FALSE(J1939Factory::getInstance().decodeInto(0x18FEF220, raw, sizeof(raw), *frame));
+
+	//DTCs from previous decodes must not be kept
+	DM1 dm1;
+	u8 dm1Raw[] = {0x00, 0xFF, 0x61, 0x02, 0x13, 0x01, 0xFF, 0xFF};
+
+	ASSERT_TRUE(J1939Factory::getInstance().decodeInto(0x18FECA00, dm1Raw, sizeof(dm1Raw), dm1));
+	ASSERT_TRUE(J1939Factory::getInstance().decodeInto(0x18FECA00, dm1Raw, sizeof(dm1Raw), dm1));
+	ASSERT_EQ(dm1.getDTCs().size(), 1);
+
+}
+
+TEST_F(FramePool_test, recycle) {
+
+	FramePool pool(2);
+
+	u8 raw[] = {0xFF, 0x00, 0x32, 0x10, 0xFF, 0xFF, 0xFF, 0xFF};
+
+	ASSERT_FALSE(pool.decode(0x18FEF220, raw, sizeof(raw)));
+
+	{
+		PooledFrame frame1 = pool.decode(0x18FEF120, raw, sizeof(raw));
+		PooledFrame frame2 = pool.decode(0x18FEF120, raw, sizeof(raw));
+		PooledFrame frame3 = pool.decode(0x18FEF120, raw, sizeof(raw));
+
+		ASSERT_TRUE(frame1 && frame2 && frame3);
+		ASSERT_EQ(pool.getFreeFrames(CCVS_PGN), 0);
+	}
+
+	//Only 2 frames are kept
+	ASSERT_EQ(pool.getFreeFrames(CCVS_PGN), 2);
+
+	J1939Frame* recycled;
+
+	{
+		PooledFrame frame = pool.acquire(CCVS_PGN);
+		recycled = frame.get();
+	}
+
+	ASSERT_EQ(pool.acquire(CCVS_PGN).get(), recycled);
+
+}
+
+TEST_F(FramePool_test, noAllocations) {
+
+	FramePool pool;
+
+	u8 ccvsRaw[] = {0xFF, 0x00, 0x32, 0x10, 0xFF, 0xFF, 0xFF, 0xFF};
+	u8 dm1Raw[] = {0x00, 0xFF, 0x61, 0x02, 0x13, 0x01, 0xFF, 0xFF};
+
+	//Warm up the pool
+	pool.decode(0x18FEF120, ccvsRaw, sizeof(ccvsRaw));
+	pool.decode(0x18FECA00, dm1Raw, sizeof(dm1Raw));
+
+	size_t allocations = AllocationCounter::getAllocations();
+
+	for(int i = 0; i < 1000; ++i) {
+
+		ccvsRaw[2] = i & 0xFF;
+
+		PooledFrame ccvs = pool.decode(0x18FEF120, ccvsRaw, sizeof(ccvsRaw));
+		PooledFrame dm1 = pool.decode(0x18FECA00, dm1Raw, sizeof(dm1Raw));
+
+		if(!ccvs || !dm1) break;
+	}
+
+	ASSERT_EQ(AllocationCounter::getAllocations(), allocations);
+
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <GenericFrame.h>
+#include <J1939DataBase.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+
+#include <J1939GeneratedFrames.h>
+
+using namespace J1939;
+
+
+class GeneratedFrames_test : public testing::Test
+{
+protected:
+
+	const GenericFrame* findFrame(u32 pgn) {
+
+		const std::vector<GenericFrame>& frames = mDatabase.getParsedFrames();
+
+		for(auto frame = frames.begin(); frame != frames.end(); ++frame) {
+			if(frame->getPGN() == pgn) {
+				return &(*frame);
+			}
+		}
+
+		return nullptr;
+	}
+
+	void SetUp() override {
+		ASSERT_TRUE(mDatabase.parseJsonFile("Database/frames.json"));
+	}
+
+	J1939DataBase mDatabase;
+};
+
+
+TEST_F(GeneratedFrames_test, layout) {
+
+	typedef J1939Generated::CCVS CCVS;
+
+	//The constants are bound to the references of ASSERT_EQ
+	const GenericFrame* generic = findFrame(CCVS::pgn());
+
+	ASSERT_TRUE(generic != nullptr);
+
+	ASSERT_EQ(CCVS::length(), generic->getDataLength());
+	ASSERT_EQ(CCVS::minLength(), std::min(CCVS::minLength(), CCVS::length()));
+
+	const SPNNumeric* wheelSpeed = static_cast<const SPNNumeric*>(generic->getSPN(CCVS::WheelSpeed::number()));
+
+	ASSERT_TRUE(wheelSpeed != nullptr);
+
+	ASSERT_EQ(CCVS::WheelSpeed::byteOffset(), wheelSpeed->getOffset());
+	ASSERT_EQ(CCVS::WheelSpeed::byteSize(), wheelSpeed->getByteSize());
+	ASSERT_EQ(CCVS::WheelSpeed::gain(), wheelSpeed->getFormatGain());
+	ASSERT_EQ(CCVS::WheelSpeed::offset(), wheelSpeed->getFormatOffset());
+
+	const SPNStatus* brakeSwitch = static_cast<const SPNStatus*>(generic->getSPN(CCVS::BrakeSwitch::number()));
+
+	ASSERT_TRUE(brakeSwitch != nullptr);
+
+	ASSERT_EQ(CCVS::BrakeSwitch::byteOffset(), brakeSwitch->getOffset());
+	ASSERT_EQ(CCVS::BrakeSwitch::bitOffset(), brakeSwitch->getBitOffset());
+	ASSERT_EQ(CCVS::BrakeSwitch::bitSize(), brakeSwitch->getBitSize());
+
+}
+
+TEST_F(GeneratedFrames_test, decodeEncode) {
+
+	const GenericFrame* ccvsFrame = findFrame(J1939Generated::CCVS::pgn());
+
+	ASSERT_TRUE(ccvsFrame != nullptr);
+
+	GenericFrame generic(*ccvsFrame);
+
+	u8 payload[] = {0xC1, 0x00, 0x32, 0xD4, 0x55, 0x01, 0x02, 0x03};
+
+	generic.decode(generic.getPGN() << J1939_PGN_OFFSET, payload, sizeof(payload));
+
+	J1939Generated::CCVS ccvs;
+
+	ASSERT_FALSE(ccvs.decode(payload, 1));
+
+	ASSERT_TRUE(ccvs.decode(payload, sizeof(payload)));
+
+	//Same raw values than the generic frame
+	J1939Generated::CCVS copy;
+
+	ASSERT_TRUE(copy.copyFrom(generic));
+
+	u8 encoded[8], copyEncoded[8];
+
+	ASSERT_TRUE(ccvs.encode(encoded, sizeof(encoded)));
+	ASSERT_TRUE(copy.encode(copyEncoded, sizeof(copyEncoded)));
+
+	ASSERT_EQ(0, memcmp(encoded, copyEncoded, sizeof(encoded)));
+
+	ASSERT_EQ(static_cast<const SPNNumeric*>(generic.getSPN(84))->getValue(), ccvs.wheelSpeed);
+	ASSERT_DOUBLE_EQ(static_cast<const SPNNumeric*>(generic.getSPN(84))->getFormattedValue(),
+			J1939Generated::CCVS::WheelSpeed::format(ccvs.wheelSpeed));
+	ASSERT_EQ(static_cast<const SPNStatus*>(generic.getSPN(597))->getValue(), ccvs.brakeSwitch);
+
+	//Encoding must give the same result than the generic frame
+	size_t length = generic.getDataLength();
+	u32 id;
+	u8 genericEncoded[8];
+
+	generic.encode(id, genericEncoded, length);
+
+	ASSERT_EQ(0, memcmp(encoded, genericEncoded, sizeof(encoded)));
+
+	//Values set in the typed struct are moved back to the generic frame
+	ccvs.wheelSpeed = 0x1234;
+	ccvs.brakeSwitch = J1939Generated::CCVS::BrakeSwitch::VALUE_PedalDepressed;
+
+	ASSERT_TRUE(ccvs.copyTo(generic));
+
+	ASSERT_EQ(0x1234u, static_cast<const SPNNumeric*>(generic.getSPN(84))->getValue());
+	ASSERT_EQ(1, static_cast<const SPNStatus*>(generic.getSPN(597))->getValue());
+
+	//Frames of other PGNs are rejected
+	GenericFrame other(0xF004);
+
+	ASSERT_FALSE(ccvs.copyTo(other));
+	ASSERT_FALSE(ccvs.copyFrom(other));
+
+}
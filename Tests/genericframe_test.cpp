@@ -4,6 +4,9 @@
 #include <SPN/SPNNumeric.h>
 #include <SPN/SPNStatus.h>
 #include <SPN/SPNString.h>
+#include <Diagnosis/Frames/DM1.h>
+
+#include <AllocationCounter.h>
 
 using namespace J1939;
 
@@ -182,6 +185,144 @@ TEST_F(GenericFrame_test, encode) {
 }
 
 
+TEST_F(GenericFrame_test, incrementalEncode) {
+
+	u8 encodedCCVS[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0xFF, 0x1F, 0xFF};
+
+	ccvs.decode(0x18FEF120, encodedCCVS, sizeof(encodedCCVS));
+
+	u8 buff[8], expected[8];
+	size_t length = sizeof(buff), expectedLength = sizeof(expected);
+	u32 id;
+
+	//The result must always be the same as encoding a fresh copy of the frame
+	auto checkEncode = [&]() {
+
+		length = sizeof(buff);
+		ccvs.encode(id, buff, length);
+
+		std::unique_ptr<J1939Frame> copy(ccvs.clone());
+		expectedLength = sizeof(expected);
+		copy->encode(id, expected, expectedLength);
+
+		ASSERT_EQ(length, expectedLength);
+		ASSERT_EQ(0, memcmp(buff, expected, length));
+	};
+
+	checkEncode();
+
+	//Once the payload is cached, encoding again does not allocate
+	size_t allocations = AllocationCounter::getAllocations();
+
+	static_cast<SPNNumeric*>(ccvs.getSPN(84))->setValue(0x1234);
+
+	length = sizeof(buff);
+	ccvs.encode(id, buff, length);
+
+	ASSERT_EQ(AllocationCounter::getAllocations(), allocations);
+	ASSERT_EQ(0x34, buff[1]);
+	ASSERT_EQ(0x12, buff[2]);
+
+	checkEncode();
+
+	//Several changes of the same SPN and of SPNs sharing the byte
+	static_cast<SPNStatus*>(ccvs.getSPN(597))->setValue(0);
+	static_cast<SPNStatus*>(ccvs.getSPN(597))->setValue(3);
+	static_cast<SPNStatus*>(ccvs.getSPN(598))->setValue(0);
+	static_cast<SPNNumeric*>(ccvs.getSPN(84))->setFormattedValue(25);
+
+	checkEncode();
+
+	ASSERT_EQ(0x3F, buff[3]);
+
+	//Nothing changed
+	checkEncode();
+
+	//Decoding replaces all the values
+	u8 otherCCVS[] = {0xFF, 0x10, 0x20, 0x5F, 0xFF, 0xFF, 0x00, 0xFF};
+
+	ccvs.decode(0x18FEF120, otherCCVS, sizeof(otherCCVS));
+
+	checkEncode();
+
+	ASSERT_EQ(0, memcmp(buff, otherCCVS, 6));
+
+	//Copying the values from another frame
+	std::unique_ptr<J1939Frame> other(ccvs.clone());
+	static_cast<SPNStatus*>(static_cast<GenericFrame*>(other.get())->getSPN(976))->setValue(5);
+
+	ccvs.copy(*other);
+
+	checkEncode();
+
+	ASSERT_EQ(0xE5, buff[6]);
+
+	//Copies of the SPNs are detached from the frame, their changes are not encoded nor tracked by it
+	{
+		SPNNumeric copy = *static_cast<SPNNumeric*>(ccvs.getSPN(84));
+
+		copy.setFormattedValue(100);
+	}
+
+	checkEncode();
+
+	ASSERT_EQ(0, memcmp(buff + 1, otherCCVS + 1, 2));
+
+	//Assigning an SPN of the frame changes its value in the payload
+	SPNNumeric speed = *static_cast<SPNNumeric*>(ccvs.getSPN(84));
+
+	speed.setValue(0x4321);
+	*static_cast<SPNNumeric*>(ccvs.getSPN(84)) = speed;
+
+	checkEncode();
+
+	ASSERT_EQ(0x21, buff[1]);
+	ASSERT_EQ(0x43, buff[2]);
+
+	//New SPNs and lengths change the layout of the payload
+	SPNNumeric spnNum(190, "Engine Speed", 8, 0.125, 0, 2, "rpm");
+	ccvs.registerSPN(spnNum)->decode(encodedCCVS + 1, 2);
+
+	ASSERT_EQ(ccvs.getDataLength(), 10);
+
+	u8 longBuff[10];
+	length = sizeof(longBuff);
+
+	ccvs.encode(id, longBuff, length);
+
+	ASSERT_EQ(length, 10);
+	ASSERT_EQ(0, memcmp(longBuff, buff, 8));
+	ASSERT_EQ(0x00, longBuff[8]);
+	ASSERT_EQ(0x50, longBuff[9]);
+
+	ASSERT_TRUE(ccvs.deleteSPN(190));
+	ccvs.setLength(8);
+
+	ASSERT_EQ(ccvs.getDataLength(), 8);
+
+	checkEncode();
+
+	//Strings change the offsets of the following SPNs
+	static_cast<SPNString*>(vin.getSPN(237))->setValue("abc");
+
+	length = 4;
+	vin.encode(id, buff, length);
+
+	ASSERT_EQ(0, memcmp(buff, "abc*", 4));
+
+	static_cast<SPNString*>(vin.getSPN(237))->setValue("abcdef");
+
+	ASSERT_EQ(vin.getDataLength(), 7);
+
+	length = sizeof(buff);
+	vin.encode(id, buff, length);
+
+	ASSERT_EQ(length, 7);
+	ASSERT_EQ(0, memcmp(buff, "abcdef*", 7));
+
+}
+
+
 TEST_F(GenericFrame_test, decode) {
 	u8 encodedCCVS[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0xFF, 0x1F, 0xFF};
 	u32 id = 0x18FEF120;
@@ -250,3 +391,173 @@ TEST_F(GenericFrame_test, decode) {
 }
 
 
+
+TEST_F(GenericFrame_test, layout) {
+
+	//Frames with strings have variable offsets and can not be compiled
+	ASSERT_FALSE(vin.compileLayout());
+
+	ASSERT_TRUE(ccvs.compileLayout());
+
+	std::shared_ptr<const FrameLayout> layout = ccvs.getLayout();
+
+	ASSERT_EQ(layout->getSPNCount(), 4);
+	ASSERT_EQ(layout->getMinLength(), 7);
+	ASSERT_EQ(layout->getSPNIndex(597), 1);
+	ASSERT_EQ(layout->getSPNIndex(1000), -1);
+
+	u8 encodedCCVS[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0xFF, 0x1F, 0xFF};
+
+	//Values ordered by SPN number: 84, 597, 598, 976
+	double values[4];
+
+	ASSERT_TRUE(ccvs.decodeValues(encodedCCVS, sizeof(encodedCCVS), values));
+	ASSERT_EQ(values[0], 80);
+	ASSERT_EQ(values[1], 1);
+	ASSERT_EQ(values[2], 2);
+	ASSERT_EQ(values[3], 0x1F);
+
+	ASSERT_FALSE(ccvs.decodeValues(encodedCCVS, 6, values));
+
+	//The compiled layout must give the same results as the SPNs
+	std::unique_ptr<J1939Frame> clone(ccvs.clone());
+	GenericFrame* compiled = static_cast<GenericFrame*>(clone.get());
+
+	ASSERT_EQ(compiled->getLayout(), layout);
+
+	compiled->decode(0x18FEF120, encodedCCVS, sizeof(encodedCCVS));
+
+	ASSERT_EQ(static_cast<SPNNumeric*>(compiled->getSPN(84))->getFormattedValue(), 80);
+	ASSERT_EQ(static_cast<SPNStatus*>(compiled->getSPN(597))->getValue(), 1);
+	ASSERT_EQ(static_cast<SPNStatus*>(compiled->getSPN(598))->getValue(), 2);
+	ASSERT_EQ(static_cast<SPNStatus*>(compiled->getSPN(976))->getValue(), 0x1F);
+
+	//Too short, the frame is decoded without the layout and fails as before
+	try {
+		compiled->decode(0x18FEF120, encodedCCVS, 6);
+		FAIL();
+	} catch (J1939DecodeException &) {
+		SUCCEED();
+	}
+
+	//Modifying the SPNs discards the layout
+	SPNNumeric spnNum(190, "Engine Speed", 3, 0.125, 0, 2, "rpm");
+	compiled->registerSPN(spnNum);
+
+	ASSERT_FALSE(compiled->getLayout());
+
+}
+
+TEST_F(GenericFrame_test, tryDecode) {
+
+	u8 encodedCCVS[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0xFF, 0x1F, 0xFF};
+
+	ASSERT_EQ(ccvs.tryDecode(0x18FEF120, encodedCCVS, sizeof(encodedCCVS)), CODEC_OK);
+	ASSERT_EQ(static_cast<SPNNumeric*>(ccvs.getSPN(84))->getFormattedValue(), 80);
+
+	ASSERT_EQ(ccvs.tryDecode(0x18FEF320, encodedCCVS, sizeof(encodedCCVS)), CODEC_PGN_MISMATCH);
+	ASSERT_EQ(ccvs.tryDecode(0x18FEF120, encodedCCVS, 3), CODEC_BUFFER_TOO_SHORT);
+
+	ASSERT_EQ(vin.tryDecode(0x04FEEC15, (u8 *)("ghijklmnopqrs"), sizeof("ghijklmnopqrs") - 1), CODEC_STRING_NOT_TERMINATED);
+	ASSERT_EQ(vin.tryDecode(0x04FEEC15, (u8 *)("ghij\xC1klmn*"), sizeof("ghij\xC1klmn*")), CODEC_STRING_NOT_ASCII);
+
+	u32 id;
+	u8 buff[8];
+	size_t length = 7;
+
+	ASSERT_EQ(ccvs.tryEncode(id, buff, length), CODEC_BUFFER_TOO_SHORT);
+
+	length = sizeof(buff);
+
+	ASSERT_EQ(ccvs.tryEncode(id, buff, length), CODEC_OK);
+	ASSERT_EQ(length, 8);
+	//Bits not belonging to any SPN are set to 1
+	u8 expected[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0xFF, 0xFF, 0xFF};
+	ASSERT_EQ(memcmp(buff, expected, length), 0);
+
+}
+
+TEST_F(GenericFrame_test, cloneInArena) {
+
+	ASSERT_TRUE(ccvs.compileLayout());
+
+	u8 encodedCCVS[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0xFF, 0x1F, 0xFF};
+
+	//The frame, the SPNs and the nodes of the map are placed in a single block
+	size_t allocations = AllocationCounter::getAllocations();
+
+	ArenaFrame clone = ccvs.cloneInArena();
+
+	ASSERT_EQ(AllocationCounter::getAllocations(), allocations + 1);
+
+	GenericFrame* arenaFrame = static_cast<GenericFrame*>(clone.get());
+
+	ASSERT_EQ(arenaFrame->getLayout(), ccvs.getLayout());
+	ASSERT_EQ(arenaFrame->getSPNNumbers(), ccvs.getSPNNumbers());
+	ASSERT_EQ(arenaFrame->getDataLength(), ccvs.getDataLength());
+
+	arenaFrame->decode(0x18FEF120, encodedCCVS, sizeof(encodedCCVS));
+
+	ASSERT_EQ(static_cast<SPNNumeric*>(arenaFrame->getSPN(84))->getFormattedValue(), 80);
+	ASSERT_EQ(static_cast<SPNStatus*>(arenaFrame->getSPN(597))->getValue(), 1);
+	ASSERT_EQ(static_cast<SPNStatus*>(arenaFrame->getSPN(598))->getValue(), 2);
+	ASSERT_EQ(static_cast<SPNStatus*>(arenaFrame->getSPN(976))->getValue(), 0x1F);
+
+	//Same encoding as a regular clone
+	std::unique_ptr<J1939Frame> regular(ccvs.clone());
+	regular->decode(0x18FEF120, encodedCCVS, sizeof(encodedCCVS));
+
+	u8 encoded[8], regularEncoded[8];
+	size_t length = sizeof(encoded), regularLength = sizeof(regularEncoded);
+	u32 id;
+
+	arenaFrame->encode(id, encoded, length);
+	regular->encode(id, regularEncoded, regularLength);
+
+	ASSERT_EQ(length, regularLength);
+	ASSERT_EQ(0, memcmp(encoded, regularEncoded, sizeof(encoded)));
+
+	//SPNs registered after cloning do not fit in the arena and are allocated apart
+	SPNNumeric spnNum(190, "Engine Speed", 4, 0.125, 0, 2, "rpm");
+	arenaFrame->registerSPN(spnNum);
+
+	ASSERT_TRUE(arenaFrame->deleteSPN(597));
+	ASSERT_TRUE(arenaFrame->hasSPN(190));
+
+	//Regular clones of a frame placed in an arena are independent of it
+	std::unique_ptr<J1939Frame> copy(arenaFrame->clone());
+
+	clone.reset();
+
+	ASSERT_EQ(static_cast<GenericFrame*>(copy.get())->getSPNNumbers(), std::set<u32>({84, 190, 598, 976}));
+	ASSERT_EQ(static_cast<SPNNumeric*>(static_cast<GenericFrame*>(copy.get())->getSPN(84))->getFormattedValue(), 80);
+
+}
+
+TEST_F(GenericFrame_test, derivedFrameEncode) {
+
+	//The payload cached by GenericFrame only holds the SPNs, DM1 appends the DTCs
+	DM1 dm1;
+
+	dm1.addDTC(DTC(100, 3, 1));
+	dm1.addDTC(DTC(101, 4, 2));
+	dm1.addDTC(DTC(102, 5, 3));
+
+	u8 buffer[14];
+	size_t length = sizeof(buffer);
+	u32 id;
+
+	ASSERT_EQ(dm1.getDataLength(), 14);
+	ASSERT_EQ(dm1.tryEncode(id, buffer, length), CODEC_OK);
+
+	//Encoded twice, from the cached payload
+	ASSERT_EQ(dm1.tryEncode(id, buffer, length), CODEC_OK);
+
+	DM1 decoded;
+	decoded.decode(id, buffer, length);
+
+	ASSERT_EQ(decoded.getDTCs().size(), 3);
+	ASSERT_EQ(decoded.getDTCs()[2].getSpn(), 102);
+	ASSERT_EQ(decoded.getDTCs()[2].getFmi(), 5);
+
+}
@@ -0,0 +1,16 @@
+#ifndef ALLOCATIONCOUNTER_H_
+#define ALLOCATIONCOUNTER_H_
+
+#include <stddef.h>
+
+/*
+ * The global operator new of the test executable is replaced to count the number of allocations,
+ * so that the tests can check that some paths do not allocate memory.
+ */
+namespace AllocationCounter {
+
+size_t getAllocations();
+
+}
+
+#endif /* ALLOCATIONCOUNTER_H_ */
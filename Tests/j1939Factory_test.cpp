@@ -1,7 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <J1939Factory.h>
 #include <TestFrame.h>
+#include <GenericFrame.h>
+#include <SPN/SPNNumeric.h>
+#include <SPN/SPNStatus.h>
+#include <Diagnosis/Frames/DM1.h>
 
 using namespace J1939;
 
@@ -89,3 +97,239 @@ TEST_F(J1939Factory_test, getJ1939Frame) {
 	}
 
 }
+
+TEST_F(J1939Factory_test, unknownPGN) {
+
+	u8 raw[] = {0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89};
+
+	ASSERT_TRUE(J1939Factory::getInstance().isRegistered(0xDE00));
+	ASSERT_FALSE(J1939Factory::getInstance().isRegistered(0xDF00));
+
+	//Not registered PGNs
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x00DF0050, raw, sizeof(raw)));
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x00FEEE40, raw, sizeof(raw)));
+
+	//Same PDU format but in the other data page
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x01DEAA50, raw, sizeof(raw)));
+
+	J1939Factory::getInstance().unRegisterFrame(0xDE00);
+
+	ASSERT_FALSE(J1939Factory::getInstance().isRegistered(0xDE00));
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x00DEAA50, raw, sizeof(raw)));
+
+}
+
+TEST_F(J1939Factory_test, frameView) {
+
+	GenericFrame ccvs(0xFEF1);
+
+	ccvs.setLength(8);
+	ccvs.registerSPN(SPNNumeric(84, "Wheel Speed", 1, 0.00390625, 0, 2, "km/h"));
+	ccvs.registerSPN(SPNStatus(597, "Brake Switch", 3, 4, 2));
+	ccvs.registerSPN(SPNNumeric(86, "Cruise Control Set Speed", 5, 1, 0, 1, "km/h"));
+
+	J1939Factory::getInstance().registerFrame(ccvs);
+
+	u8 raw[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0x3C, 0xFF, 0xFF};
+
+	FrameView view = J1939Factory::getInstance().getFrameView(0x18FEF120, raw, sizeof(raw));
+
+	ASSERT_TRUE(view.isValid());
+	ASSERT_EQ(view.getPGN(), 0xFEF1);
+	ASSERT_EQ(view.getSrcAddr(), 0x20);
+	ASSERT_EQ(view.getPriority(), 6);
+	ASSERT_EQ(view.getSPNCount(), 3);
+	ASSERT_EQ(view.getSPNNumberAt(0), 84);
+
+	double value;
+	u32 rawValue;
+
+	ASSERT_TRUE(view.getValue(84, value));
+	ASSERT_EQ(value, 80);
+	ASSERT_TRUE(view.getRawValue(597, rawValue));
+	ASSERT_EQ(rawValue, 1);
+	ASSERT_TRUE(view.getValueAt(1, value));
+	ASSERT_EQ(value, 0x3C);
+
+	ASSERT_FALSE(view.hasSPN(190));
+	ASSERT_FALSE(view.getValue(190, value));
+
+	//Only the SPNs contained in the payload can be read
+	FrameView shortView = J1939Factory::getInstance().getFrameView(0x18FEF120, raw, 4);
+
+	ASSERT_TRUE(shortView.getValue(597, value));
+	ASSERT_FALSE(shortView.getValue(86, value));
+
+	//Not generic frames or not registered PGNs
+	ASSERT_FALSE(J1939Factory::getInstance().getFrameView(0x00DEAA50, raw, sizeof(raw)).isValid());
+	ASSERT_FALSE(J1939Factory::getInstance().getFrameView(0x18FEF220, raw, sizeof(raw)).isValid());
+
+	J1939Factory::getInstance().unRegisterFrame(0xFEF1);
+
+	//The view keeps the layout alive once the prototype is gone
+	ASSERT_FALSE(J1939Factory::getInstance().getFrameView(0x18FEF120, raw, sizeof(raw)).isValid());
+
+	ASSERT_TRUE(view.isValid());
+	ASSERT_TRUE(view.getValue(84, value));
+	ASSERT_EQ(value, 80);
+	ASSERT_TRUE(view.getValue(86, value));
+	ASSERT_EQ(value, 0x3C);
+
+}
+
+TEST_F(J1939Factory_test, tryDecode) {
+
+	ECodecStatus status;
+
+	//Request frame with the wrong length
+	u8 raw[] = {0x00, 0xEE, 0x00, 0x00};
+
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x18EAFF00, raw, sizeof(raw), status));
+	ASSERT_EQ(status, CODEC_INVALID_LENGTH);
+
+	ASSERT_TRUE(J1939Factory::getInstance().getJ1939Frame(0x18EAFF00, raw, 3, status));
+	ASSERT_EQ(status, CODEC_OK);
+
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x18FF0000, raw, sizeof(raw), status));
+	ASSERT_EQ(status, CODEC_UNKNOWN_PGN);
+
+	//TP.CM with an unknown control byte
+	u8 tpcm[] = {0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+	ASSERT_FALSE(J1939Factory::getInstance().getJ1939Frame(0x1CECFF00, tpcm, sizeof(tpcm), status));
+	ASSERT_EQ(status, CODEC_UNKNOWN_CTRL_TYPE);
+
+	//Frames without non throwing implementation
+	TestFrame frame(0xDE00);
+	ASSERT_EQ(J1939Factory::getInstance().tryDecodeInto(0x00DEAA50, raw, sizeof(raw), frame), CODEC_OK);
+	ASSERT_EQ(J1939Factory::getInstance().tryDecodeInto(0x00AFAA50, raw, sizeof(raw), frame), CODEC_PGN_MISMATCH);
+
+}
+
+TEST_F(J1939Factory_test, arenaFrameDM1) {
+
+	DM1 dm1;
+
+	dm1.addDTC(DTC(100, 3, 1));
+
+	u8 raw[8];
+	size_t length = sizeof(raw);
+	u32 id;
+
+	dm1.setSrcAddr(0x20);
+	dm1.encode(id, raw, length);
+
+	//Frames derived from GenericFrame are not sliced when cloned for the arena
+	ArenaFrame arenaFrame = J1939Factory::getInstance().getArenaFrame(id, raw, length);
+	std::unique_ptr<J1939Frame> heapFrame = J1939Factory::getInstance().getJ1939Frame(id, raw, length);
+
+	ASSERT_TRUE(arenaFrame != nullptr);
+
+	DM1* decoded = dynamic_cast<DM1*>(arenaFrame.get());
+
+	ASSERT_TRUE(decoded != nullptr);
+	ASSERT_EQ(decoded->getDataLength(), heapFrame->getDataLength());
+	ASSERT_EQ(decoded->getDTCs().size(), 1);
+	ASSERT_EQ(decoded->getDTCs()[0].getSpn(), 100);
+	ASSERT_EQ(decoded->getDTCs()[0].getFmi(), 3);
+
+}
+
+TEST_F(J1939Factory_test, registerFrames) {
+
+	J1939Factory factory;
+
+	std::vector<TestFrame> frames;
+
+	frames.push_back(TestFrame(0xDE00));
+	frames.push_back(TestFrame(0xDF00));
+	frames.push_back(TestFrame(0xDE00));			//Repeated PGN, the first one is registered
+
+	ASSERT_EQ(factory.registerFrames(frames.begin(), frames.end()), 2);
+	ASSERT_TRUE(factory.isRegistered(0xDE00));
+	ASSERT_TRUE(factory.isRegistered(0xDF00));
+
+	//Already registered
+	ASSERT_EQ(factory.registerFrames(frames.begin(), frames.end()), 0);
+
+	u8 raw[] = {0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89};
+
+	std::unique_ptr<J1939Frame> frame = factory.getJ1939Frame(0x00DF0050, raw, sizeof(raw));
+
+	ASSERT_TRUE(frame.get() != nullptr);
+	ASSERT_EQ(frame->getPGN(), 0xDF00);
+
+}
+
+TEST_F(J1939Factory_test, reloadDatabase) {
+
+	J1939Factory& factory = J1939Factory::getInstance();
+
+	std::set<u32> registered = factory.getAllRegisteredPGNs();
+
+	//Nothing changes if the database cannot be read
+	ASSERT_FALSE(factory.reloadDatabaseFrames("Database/notFound.json"));
+	ASSERT_TRUE(factory.isRegistered(0xDE00));
+
+	ASSERT_TRUE(factory.reloadDatabaseFrames("Database/frames.json"));
+
+	//The frames registered by hand are dropped, the predefined ones are kept
+	ASSERT_FALSE(factory.isRegistered(0xDE00));
+	ASSERT_TRUE(factory.isRegistered(0xEA00));
+	ASSERT_TRUE(factory.isRegistered(0xFEF1));
+
+	//Frames decoded by other threads while the database is reloaded
+	std::atomic<bool> finished(false);
+	std::atomic<u32> decoded(0), failed(0);
+	std::vector<std::thread> readers;
+
+	for(int i = 0; i < 4; ++i) {
+		readers.push_back(std::thread([&]() {
+
+			u8 raw[] = {0xFF, 0x00, 0x50, 0x9F, 0xFF, 0x3C, 0xFF, 0xFF};
+
+			while(!finished) {
+
+				//Always registered
+				std::unique_ptr<J1939Frame> frame = factory.getJ1939Frame(0x18FEF120, raw, sizeof(raw));
+
+				if(frame && frame->getName() == "CCVS") {
+					++decoded;
+				} else {
+					++failed;
+				}
+
+				//Registered and unregistered by the writer
+				factory.getJ1939Frame(0x00DE0050, raw, sizeof(raw));
+				factory.getFrameLayout(0xFEF1);
+			}
+		}));
+	}
+
+	for(int i = 0; i < 20; ++i) {
+
+		ASSERT_TRUE(factory.reloadDatabaseFrames("Database/frames.json"));
+		ASSERT_TRUE(factory.registerFrame(TestFrame(0xDE00)));
+
+		factory.unRegisterFrame(0xDE00);
+	}
+
+	finished = true;
+
+	for(auto reader = readers.begin(); reader != readers.end(); ++reader) {
+		reader->join();
+	}
+
+	ASSERT_GT(decoded, 0);
+	ASSERT_EQ(failed, 0);
+
+	//Keep a clear state for the factory
+	std::set<u32> all = factory.getAllRegisteredPGNs();
+
+	for(auto pgn = all.begin(); pgn != all.end(); ++pgn) {
+		if(registered.find(*pgn) == registered.end()) {
+			factory.unRegisterFrame(*pgn);
+		}
+	}
+
+}
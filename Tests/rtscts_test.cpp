@@ -0,0 +1,485 @@
+#include <deque>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <TestFrame.h>
+
+#include <J1939Factory.h>
+#include <Transport/RTSCTS/RTSCTSConnectionManager.h>
+
+
+using namespace J1939;
+
+#define ORIGINATOR_ADDR		0x10
+#define RESPONDER_ADDR		0x20
+#define TEST_PGN			0xEF00
+
+
+/*
+ * Bus connecting the managers. The frames sent are queued and given to all the managers when the bus runs.
+ */
+class VirtualBus {
+
+private:
+	struct RawFrame {
+		u32 id;
+		std::vector<u8> data;
+	};
+
+	J1939Factory& mFactory;
+	std::vector<RTSCTSConnectionManager*> mNodes;
+	std::deque<RawFrame> mFrames;
+
+public:
+	u64 now = 0;
+
+	//Returns true for the frames lost in the bus
+	std::function<bool(u32 id, const u8* data)> lost;
+
+	VirtualBus(J1939Factory& factory) : mFactory(factory) {}
+
+	void attach(RTSCTSConnectionManager& node) {
+
+		mNodes.push_back(&node);
+
+		node.setSendCallback([this](u32 id, const u8* data, size_t length) {
+			RawFrame frame;
+			frame.id = id;
+			frame.data.assign(data, data + length);
+			mFrames.push_back(frame);
+		});
+	}
+
+	size_t run() {
+
+		size_t delivered = 0;
+
+		while(!mFrames.empty()) {
+
+			RawFrame frame = mFrames.front();
+			mFrames.pop_front();
+
+			if(lost && lost(frame.id, frame.data.data())) {
+				continue;
+			}
+
+			std::unique_ptr<J1939Frame> decoded = mFactory.getJ1939Frame(frame.id, frame.data.data(), frame.data.size());
+
+			for(auto node = mNodes.begin(); node != mNodes.end(); ++node) {
+				(*node)->consumeFrame(*decoded, now);
+			}
+
+			++delivered;
+		}
+
+		return delivered;
+	}
+
+};
+
+class RTSCTS_test : public testing::Test {
+
+protected:
+
+	struct Result {
+		u8 originator;
+		u8 responder;
+		u32 pgn;
+		RTSCTSConnectionManager::ETransferResult result;
+		u8 abortReason;
+	};
+
+	J1939Factory factory;
+	VirtualBus bus;
+	RTSCTSConnectionManager originator, responder;
+	std::vector<Result> sent, received;
+	std::vector<u8> payload;
+
+	RTSCTS_test() : bus(factory), originator(RTSCTSConfig(), &factory), responder(RTSCTSConfig(), &factory) {}
+
+	void SetUp() override {
+
+		factory.registerFrame(TestFrame(TEST_PGN));
+
+		originator.addLocalAddress(ORIGINATOR_ADDR);
+		responder.addLocalAddress(RESPONDER_ADDR);
+
+		bus.attach(originator);
+		bus.attach(responder);
+
+		originator.setFinishedCallback([this](u8 src, u8 dst, u32 pgn, RTSCTSConnectionManager::ETransferResult result, u8 reason) {
+			sent.push_back(Result{src, dst, pgn, result, reason});
+		});
+
+		responder.setFinishedCallback([this](u8 src, u8 dst, u32 pgn, RTSCTSConnectionManager::ETransferResult result, u8 reason) {
+			received.push_back(Result{src, dst, pgn, result, reason});
+		});
+
+		setPayload(RTSCTS_MAX_MSG_SIZE);
+	}
+
+	void setPayload(size_t length) {
+
+		payload.resize(length);
+
+		for(size_t i = 0; i < length; ++i) {
+			payload[i] = i * 7 + (i >> 8);
+		}
+	}
+
+	bool send() {
+		return originator.send(TEST_PGN, 6, ORIGINATOR_ADDR, RESPONDER_ADDR, payload.data(), payload.size(), bus.now);
+	}
+
+	void checkReceived() {
+
+		ASSERT_TRUE(responder.reassembledFramesPending());
+
+		std::unique_ptr<J1939Frame> frame = responder.dequeueReassembledFrame();
+
+		ASSERT_EQ(frame->getPGN(), TEST_PGN);
+		ASSERT_EQ(frame->getSrcAddr(), ORIGINATOR_ADDR);
+		ASSERT_EQ(frame->getDstAddr(), RESPONDER_ADDR);
+		ASSERT_EQ(frame->getPriority(), 6);
+		ASSERT_EQ(static_cast<TestFrame*>(frame.get())->getRaw(), std::basic_string<u8>(payload.data(), payload.size()));
+	}
+
+};
+
+TEST_F(RTSCTS_test, transfer) {
+
+	u8 windows[] = {1, 16, 255};
+
+	for(size_t i = 0; i < sizeof(windows); ++i) {
+
+		RTSCTSConfig config;
+		config.windowSize = windows[i];
+		responder.setConfig(config);
+
+		sent.clear();
+		received.clear();
+		originator.resetStats();
+		responder.resetStats();
+
+		ASSERT_TRUE(send());
+
+		//Only one session in each direction between two nodes
+		ASSERT_FALSE(send());
+
+		bus.run();
+
+		ASSERT_EQ(sent.size(), 1);
+		ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+		ASSERT_EQ(sent[0].originator, ORIGINATOR_ADDR);
+		ASSERT_EQ(sent[0].responder, RESPONDER_ADDR);
+		ASSERT_EQ(sent[0].pgn, TEST_PGN);
+
+		ASSERT_EQ(received.size(), 1);
+		ASSERT_EQ(received[0].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+
+		checkReceived();
+
+		ASSERT_EQ(originator.getStats().packetsSent, 255);
+		ASSERT_EQ(originator.getStats().messagesSent, 1);
+		ASSERT_EQ(responder.getStats().packetsReceived, 255);
+		ASSERT_EQ(responder.getStats().messagesReceived, 1);
+		ASSERT_EQ(originator.getSessionCount(), 0);
+		ASSERT_EQ(responder.getSessionCount(), 0);
+	}
+
+	//Limited by the originator
+	RTSCTSConfig config;
+	config.maxPacketsPerCTS = 4;
+	originator.setConfig(config);
+
+	u32 cts = 0;
+
+	bus.lost = [&cts](u32 id, const u8* data) {
+		if(getPGNFromId(id) == TP_CM_PGN && data[0] == CTRL_TPCM_CTS) {
+			++cts;
+			EXPECT_LE(data[1], 4);
+		}
+		return false;
+	};
+
+	setPayload(100);
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	checkReceived();
+	ASSERT_EQ(cts, 4);
+
+}
+
+TEST_F(RTSCTS_test, retransmission) {
+
+	RTSCTSConfig config;
+	config.windowSize = 16;
+	responder.setConfig(config);
+
+	bool dropped = false;
+
+	//The fifth packet is lost once
+	bus.lost = [&dropped](u32 id, const u8* data) {
+		if(!dropped && getPGNFromId(id) == TP_DT_PGN && data[0] == 5) {
+			dropped = true;
+			return true;
+		}
+		return false;
+	};
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	ASSERT_TRUE(dropped);
+	ASSERT_EQ(responder.getStats().retransmitRequests, 1);
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+
+	checkReceived();
+
+	//Packets of several windows lost once, more than the retransmissions allowed for a window
+	std::set<u8> lossy = {5, 21, 37, 53};
+
+	bus.lost = [&lossy](u32 id, const u8* data) {
+		return (getPGNFromId(id) == TP_DT_PGN && lossy.erase(data[0]) > 0);
+	};
+
+	sent.clear();
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	ASSERT_TRUE(lossy.empty());
+	ASSERT_EQ(responder.getStats().retransmitRequests, 5);
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+
+	checkReceived();
+
+	//Lost always, the responder gives up after the allowed retransmissions
+	bus.lost = [](u32 id, const u8* data) {
+		return (getPGNFromId(id) == TP_DT_PGN && data[0] == 5);
+	};
+
+	sent.clear();
+	received.clear();
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	ASSERT_EQ(received.size(), 1);
+	ASSERT_EQ(received[0].result, RTSCTSConnectionManager::TRANSFER_ABORTED);
+	ASSERT_EQ(received[0].abortReason, CONN_ABORT_RTX_LIMIT);
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_ABORTED_BY_PEER);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_RTX_LIMIT);
+
+	ASSERT_FALSE(responder.reassembledFramesPending());
+
+}
+
+TEST_F(RTSCTS_test, clearFromCallback) {
+
+	//Nobody answers, the sessions to both responders time out in the same tick
+	bus.lost = [](u32, const u8*) { return true; };
+
+	ASSERT_TRUE(send());
+	ASSERT_TRUE(originator.send(TEST_PGN, 6, ORIGINATOR_ADDR, RESPONDER_ADDR + 1, payload.data(), payload.size(), bus.now));
+
+	bus.run();
+
+	ASSERT_EQ(originator.getSessionCount(), 2);
+
+	//The session not notified yet is dropped while its timer is expiring
+	originator.setFinishedCallback([this](u8 src, u8 dst, u32 pgn, RTSCTSConnectionManager::ETransferResult result, u8 reason) {
+		sent.push_back(Result{src, dst, pgn, result, reason});
+		originator.clear();
+	});
+
+	originator.tick(bus.now + RTSCTS_DEFAULT_T3);
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_TIMEOUT);
+	ASSERT_EQ(originator.getSessionCount(), 0);
+
+	//The manager is still usable
+	bus.lost = nullptr;
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	checkReceived();
+
+}
+
+TEST_F(RTSCTS_test, timeouts) {
+
+	//The last packet of the window is lost, T1 expires in the responder
+	RTSCTSConfig config;
+	config.windowSize = 16;
+	responder.setConfig(config);
+
+	bool dropped = false;
+
+	bus.lost = [&dropped](u32 id, const u8* data) {
+		if(!dropped && getPGNFromId(id) == TP_DT_PGN && data[0] == 16) {
+			dropped = true;
+			return true;
+		}
+		return false;
+	};
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	ASSERT_EQ(responder.getSessionCount(), 1);
+
+	u64 deadline;
+
+	ASSERT_TRUE(responder.getNextDeadline(deadline));
+	ASSERT_EQ(deadline, RTSCTS_DEFAULT_T1);
+
+	bus.now = deadline - 1;
+	responder.tick(bus.now);
+	ASSERT_EQ(bus.run(), 0);
+
+	bus.now = deadline;
+	responder.tick(bus.now);
+	bus.run();
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+
+	checkReceived();
+
+	//Nobody answers, T3 expires in the originator
+	responder.removeLocalAddress(RESPONDER_ADDR);
+	sent.clear();
+
+	ASSERT_TRUE(send());
+
+	bus.run();
+
+	originator.tick(bus.now + RTSCTS_DEFAULT_T3 - 1);
+	ASSERT_TRUE(sent.empty());
+
+	originator.tick(bus.now + RTSCTS_DEFAULT_T3);
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_ABORTED);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_TIMEOUT);
+	ASSERT_EQ(originator.getStats().timeouts, 1);
+	ASSERT_EQ(originator.getStats().abortsSent, 1);
+	ASSERT_EQ(originator.getSessionCount(), 0);
+
+}
+
+TEST_F(RTSCTS_test, hold) {
+
+	RTSCTSConfig config;
+	config.maxPendingFrames = 1;
+	responder.setConfig(config);
+
+	setPayload(20);
+
+	ASSERT_TRUE(send());
+	bus.run();
+
+	//The first frame is not dequeued, the connection is held
+	sent.clear();
+
+	ASSERT_TRUE(send());
+	bus.run();
+
+	ASSERT_TRUE(sent.empty());
+	ASSERT_EQ(responder.getSessionCount(), 1);
+
+	//The hold is repeated every Th while the frame is pending
+	u32 holds = 0;
+
+	bus.lost = [&holds](u32 id, const u8* data) {
+		if(getPGNFromId(id) == TP_CM_PGN && data[0] == CTRL_TPCM_CTS && data[1] == 0) {
+			++holds;
+		}
+		return false;
+	};
+
+	for(bus.now = RTSCTS_DEFAULT_TR; bus.now < RTSCTS_DEFAULT_TH + RTSCTS_DEFAULT_TR; bus.now += RTSCTS_DEFAULT_TR) {
+		responder.tick(bus.now);
+		originator.tick(bus.now);
+		bus.run();
+	}
+
+	ASSERT_EQ(holds, 1);
+	ASSERT_EQ(originator.getSessionCount(), 1);
+
+	checkReceived();
+
+	//Released in the next check
+	bus.now += RTSCTS_DEFAULT_TR;
+	responder.tick(bus.now);
+	bus.run();
+
+	ASSERT_EQ(sent.size(), 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+
+	checkReceived();
+
+}
+
+TEST_F(RTSCTS_test, rejectedRTS) {
+
+	RTSCTSConfig config;
+	config.maxSessions = 1;
+	responder.setConfig(config);
+
+	originator.addLocalAddress(ORIGINATOR_ADDR + 1);
+
+	//Both RTS are sent before any answer
+	ASSERT_TRUE(send());
+	ASSERT_TRUE(originator.send(TEST_PGN, 6, ORIGINATOR_ADDR + 1, RESPONDER_ADDR, payload.data(), payload.size(), bus.now));
+
+	bus.run();
+
+	ASSERT_EQ(sent.size(), 2);
+	ASSERT_EQ(sent[0].originator, ORIGINATOR_ADDR + 1);
+	ASSERT_EQ(sent[0].result, RTSCTSConnectionManager::TRANSFER_ABORTED_BY_PEER);
+	ASSERT_EQ(sent[0].abortReason, CONN_ABORT_NOT_SUPPORTED);
+	ASSERT_EQ(sent[1].originator, ORIGINATOR_ADDR);
+	ASSERT_EQ(sent[1].result, RTSCTSConnectionManager::TRANSFER_COMPLETED);
+
+	//Messages that do not need the transport protocol or do not fit in it
+	setPayload(8);
+	ASSERT_FALSE(send());
+
+	setPayload(RTSCTS_MAX_MSG_SIZE + 1);
+	ASSERT_FALSE(send());
+
+	//Not a local address
+	setPayload(20);
+	ASSERT_FALSE(originator.send(TEST_PGN, 6, 0x30, RESPONDER_ADDR, payload.data(), payload.size(), bus.now));
+
+	//The frames sent to other nodes are ignored
+	TPCMFrame rts;
+	rts.setCtrlType(CTRL_TPCM_RTS);
+	rts.setSrcAddr(ORIGINATOR_ADDR);
+	rts.setDstAddr(0x30);
+
+	ASSERT_FALSE(responder.toBeHandled(rts));
+
+	rts.setDstAddr(RESPONDER_ADDR);
+
+	ASSERT_TRUE(responder.toBeHandled(rts));
+
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <TestFrame.h>
+
+#include <BoundedQueue.h>
+#include <J1939Factory.h>
+#include <Transport/BAM/ShardedReassembler.h>
+#include <Transport/BAM/BamFragmenter.h>
+
+
+using namespace J1939;
+
+TEST(ShardedReassembler_test, boundedQueue) {
+
+	BoundedQueue<u32> queue(3);
+
+	ASSERT_EQ(queue.capacity(), 4);
+	ASSERT_TRUE(queue.empty());
+
+	for(u32 i = 0; i < 4; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+
+	ASSERT_FALSE(queue.push(4));
+	ASSERT_EQ(queue.size(), 4);
+
+	u32 value;
+
+	ASSERT_TRUE(queue.pop(value));
+	ASSERT_EQ(value, 0);
+	ASSERT_TRUE(queue.push(4));
+
+	for(u32 i = 1; i < 5; ++i) {
+		ASSERT_TRUE(queue.pop(value));
+		ASSERT_EQ(value, i);
+	}
+
+	ASSERT_FALSE(queue.pop(value));
+
+	//Several producers, the items of each one keep their order
+	BoundedQueue<u32> shared(64);
+	const u32 producers = 4, items = 2000;
+	std::vector<std::thread> threads;
+
+	for(u32 p = 0; p < producers; ++p) {
+		threads.push_back(std::thread([&shared, p]() {
+			for(u32 i = 0; i < items; ++i) {
+				while(!shared.push((p << 24) | i)) {
+					std::this_thread::yield();
+				}
+			}
+		}));
+	}
+
+	std::vector<u32> next(producers, 0);
+
+	for(u32 count = 0; count < producers * items;) {
+
+		if(!shared.pop(value)) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		ASSERT_EQ(value & 0xFFFFFF, next[value >> 24]);
+		++next[value >> 24];
+		++count;
+	}
+
+	for(auto thread = threads.begin(); thread != threads.end(); ++thread) {
+		thread->join();
+	}
+
+}
+
+TEST(ShardedReassembler_test, reassemble) {
+
+	J1939Factory factory;
+
+	ASSERT_TRUE(factory.registerFrame(TestFrame(0xF005)));
+
+	ShardedReassembler reassembler(3, &factory);
+
+	ASSERT_EQ(reassembler.getWorkerCount(), 3);
+
+	struct Packet {
+		u32 interface;
+		u32 id;
+		std::basic_string<u8> data;
+	};
+
+	//Two messages from every source in two interfaces, all the packets interleaved as in the bus
+	const u32 interfaces = 2, sources = 20, messages = 2;
+	std::vector<std::vector<Packet> > streams;
+
+	for(u32 iface = 0; iface < interfaces; ++iface) {
+		for(u32 src = 0; src < sources; ++src) {
+
+			std::vector<Packet> stream;
+
+			for(u32 msg = 0; msg < messages; ++msg) {
+
+				TestFrame message(0xF005);
+				std::basic_string<u8> payload;
+
+				payload.push_back(iface);
+				payload.push_back(src);
+				payload.push_back(msg);
+
+				for(size_t i = 3; i < 40 + src; ++i) {
+					payload.push_back(i);
+				}
+
+				message.decode(0x18F00500 | src, payload.data(), payload.size());
+
+				BamFragmenter::fragment(message, [&](u32 id, const u8* data, size_t length) {
+					stream.push_back(Packet{iface, id, std::basic_string<u8>(data, length)});
+				});
+			}
+
+			streams.push_back(stream);
+		}
+	}
+
+	bool pending = true;
+
+	for(size_t i = 0; pending; ++i) {
+
+		pending = false;
+
+		for(auto stream = streams.begin(); stream != streams.end(); ++stream) {
+
+			if(i >= stream->size()) continue;
+
+			const Packet& packet = (*stream)[i];
+
+			ASSERT_TRUE(ShardedReassembler::toBeHandled(packet.id, packet.data.data(), packet.data.size()));
+			ASSERT_TRUE(reassembler.push(packet.interface, packet.id, packet.data.data(), packet.data.size(), i));
+
+			pending = true;
+		}
+	}
+
+	reassembler.flush();
+
+	//Next message expected from every source of every interface
+	std::map<std::pair<u32, u8>, u8> next;
+	ShardedReassembler::Message message;
+	u32 count = 0;
+
+	while(reassembler.pop(message)) {
+
+		const std::basic_string<u8>& payload = static_cast<TestFrame*>(message.frame.get())->getRaw();
+
+		ASSERT_EQ(payload[0], message.interface);
+		ASSERT_EQ(payload[1], message.frame->getSrcAddr());
+		ASSERT_EQ(payload.size(), 40 + message.frame->getSrcAddr());
+
+		u8& expected = next[std::make_pair(message.interface, message.frame->getSrcAddr())];
+
+		ASSERT_EQ(payload[2], expected);
+		++expected;
+		++count;
+	}
+
+	ASSERT_EQ(count, interfaces * sources * messages);
+	ASSERT_EQ(reassembler.getDroppedPackets(), 0);
+
+	//The same source goes to the same worker, the sources are spread among all of them
+	std::vector<size_t> perWorker(reassembler.getWorkerCount(), 0);
+
+	for(u32 src = 0; src < 64; ++src) {
+		ASSERT_EQ(reassembler.getWorker(0, src), reassembler.getWorker(0, src));
+		++perWorker[reassembler.getWorker(0, src)];
+	}
+
+	for(auto workerCount = perWorker.begin(); workerCount != perWorker.end(); ++workerCount) {
+		ASSERT_GT(*workerCount, 0);
+	}
+
+}
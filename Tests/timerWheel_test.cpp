@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <TimerWheel.h>
+
+
+using namespace J1939;
+
+TEST(TimerWheel_test, expire) {
+
+	TimerWheel wheel(10, 8);
+	TimerWheel::Timer timers[3];
+
+	for(u32 i = 0; i < 3; ++i) {
+		timers[i].key = i;
+	}
+
+	wheel.schedule(timers[0], 25);
+	wheel.schedule(timers[1], 40);
+	wheel.schedule(timers[2], 40);
+
+	ASSERT_EQ(wheel.size(), 3);
+
+	std::vector<u32> expired;
+	auto collect = [&expired](TimerWheel::Timer& timer) { expired.push_back(timer.key); };
+
+	//Same slot as the deadline but not reached yet
+	ASSERT_EQ(wheel.advance(24, collect), 0);
+	ASSERT_EQ(wheel.advance(25, collect), 1);
+	ASSERT_EQ(expired, std::vector<u32>({0}));
+	ASSERT_FALSE(timers[0].isScheduled());
+
+	//Cancelled and rescheduled timers
+	wheel.cancel(timers[1]);
+	wheel.schedule(timers[2], 50);
+
+	ASSERT_EQ(wheel.advance(45, collect), 0);
+	ASSERT_EQ(wheel.advance(50, collect), 1);
+	ASSERT_EQ(expired, std::vector<u32>({0, 2}));
+	ASSERT_EQ(wheel.size(), 0);
+
+	//Going back in time does nothing
+	ASSERT_EQ(wheel.advance(10, collect), 0);
+	ASSERT_EQ(wheel.getTime(), 50);
+
+	//Already elapsed deadlines expire in the next advance
+	wheel.schedule(timers[1], 20);
+	ASSERT_EQ(wheel.advance(50, collect), 1);
+	ASSERT_EQ(expired, std::vector<u32>({0, 2, 1}));
+
+}
+
+TEST(TimerWheel_test, turns) {
+
+	//A turn of 80 ms
+	TimerWheel wheel(10, 8);
+	TimerWheel::Timer near, far;
+
+	near.key = 1;
+	far.key = 2;
+
+	wheel.schedule(near, 30);
+	wheel.schedule(far, 30 + 3 * 80);
+
+	std::vector<u32> expired;
+	auto collect = [&expired](TimerWheel::Timer& timer) { expired.push_back(timer.key); };
+
+	//The timer of a later turn stays in the slot
+	ASSERT_EQ(wheel.advance(100, collect), 1);
+	ASSERT_EQ(expired, std::vector<u32>({1}));
+
+	ASSERT_EQ(wheel.advance(260, collect), 0);
+	ASSERT_EQ(wheel.advance(270, collect), 1);
+	ASSERT_EQ(expired, std::vector<u32>({1, 2}));
+
+	//Jumps of several turns visit every slot once
+	TimerWheel::Timer timers[8];
+
+	for(u32 i = 0; i < 8; ++i) {
+		timers[i].key = i;
+		wheel.schedule(timers[i], 280 + i * 10);
+	}
+
+	expired.clear();
+
+	ASSERT_EQ(wheel.advance(100000, collect), 8);
+	ASSERT_EQ(expired.size(), 8);
+	ASSERT_EQ(wheel.size(), 0);
+
+}
+
+TEST(TimerWheel_test, scheduleFromCallback) {
+
+	TimerWheel wheel(10, 8);
+	TimerWheel::Timer first, second;
+
+	first.key = 1;
+	second.key = 2;
+
+	wheel.schedule(first, 10);
+	wheel.schedule(second, 10);
+
+	size_t calls = 0;
+
+	//The first expired timer is rescheduled and cancels the other one
+	size_t count = wheel.advance(10, [&](TimerWheel::Timer& timer) {
+
+		++calls;
+
+		wheel.schedule(timer, 100);
+		wheel.cancel(timer.key == 1 ? second : first);
+	});
+
+	ASSERT_EQ(count, 1);
+	ASSERT_EQ(calls, 1);
+	ASSERT_EQ(wheel.size(), 1);
+
+	//Timers must be cancelled before going out of scope
+	{
+		TimerWheel::Timer scoped;
+
+		wheel.schedule(scoped, 50);
+		wheel.cancel(scoped);
+	}
+
+	wheel.clear();
+
+	ASSERT_EQ(wheel.size(), 0);
+	ASSERT_FALSE(first.isScheduled());
+	ASSERT_FALSE(second.isScheduled());
+
+}
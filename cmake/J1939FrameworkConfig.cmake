@@ -1,2 +1,3 @@
 include("${CMAKE_CURRENT_LIST_DIR}/J1939FrameworkTargets.cmake")
 set(J1939_Database ${CMAKE_INSTALL_PREFIX}/etc/j1939/frames.json)
+set(J1939_BinaryDatabase ${CMAKE_INSTALL_PREFIX}/etc/j1939/frames.j1939db)
@@ -20,6 +20,7 @@ void proto_reg_handoff_j1939(void);
 #include <J1939Factory.h>
 #include <J1939Frame.h>
 #include <J1939DataBase.h>
+#include <BinaryDataBase.h>
 #include <GenericFrame.h>
 #include <SPN/SPNNumeric.h>
 #include <SPN/SPNStatus.h>
@@ -33,6 +34,10 @@ void proto_reg_handoff_j1939(void);
 #define DATABASE_PATH		"/etc/j1939/frames.json"
 #endif
 
+#ifndef BINARY_DATABASE_PATH
+#define BINARY_DATABASE_PATH	"/etc/j1939/frames.j1939db"
+#endif
+
 
 using namespace J1939;
 
@@ -208,21 +213,20 @@ void proto_reg_handoff_j1939(void) {
 
 	j1939_handle = create_dissector_handle( dissect_J1939, proto_j1939 );
 
-	//Load database
+	//Load database, the precompiled one is mapped straight into the factory if it is installed
+	bool binaryLoaded = BinaryDataBase::isBinaryDataBase(BINARY_DATABASE_PATH) &&
+			J1939Factory::getInstance().registerDatabaseFrames(BINARY_DATABASE_PATH);
+
 	J1939DataBase ddbb;
-	if(!ddbb.parseJsonFile(DATABASE_PATH)) {		//Something went wrong
+	if(!binaryLoaded && !ddbb.parseJsonFile(DATABASE_PATH)) {		//Something went wrong
 		return;
 	}
 
 	const std::vector<GenericFrame>& ddbbFrames = ddbb.getParsedFrames();
 
 
-	//Register all the frames listed in the database
-	for(auto iter = ddbbFrames.begin(); iter != ddbbFrames.end(); ++iter) {
-
-		J1939Factory::getInstance().registerFrame(*iter);
-
-	}
+	//Register all the frames listed in the database, none if the precompiled database was loaded
+	J1939Factory::getInstance().registerFrames(ddbbFrames.begin(), ddbbFrames.end());
 
 	header_field_info* info;
 	std::string abbrev;